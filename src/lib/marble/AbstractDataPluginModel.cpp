@@ -20,9 +20,12 @@
 #include <QVariant>
 #include <QAbstractListModel>
 #include <QMetaProperty>
+#include <QSet>
+#include <QtMath>
 
 // Marble
 #include "MarbleDebug.h"
+#include "MarbleGlobal.h"
 #include "AbstractDataPluginItem.h"
 #include "CacheStoragePolicy.h"
 #include "GeoDataCoordinates.h"
@@ -53,6 +56,97 @@ const QChar fileIdSeparator = QLatin1Char('_');
 
 class FavoritesModel;
 
+namespace
+{
+
+/**
+ * Screen rectangles of the items shown, kept in the cells of a uniform grid
+ * so that collision tests only look at rectangles nearby.
+ */
+class CollisionGrid
+{
+public:
+    explicit CollisionGrid( const QSize &size );
+
+    bool intersects( const QRectF &rect ) const;
+    void insert( const QRectF &rect );
+
+private:
+    QRect cells( const QRectF &rect ) const;
+
+    static const int s_cellSize = 64;
+    int m_columns;
+    int m_rows;
+    QVector<QVector<QRectF> > m_cells;
+};
+
+CollisionGrid::CollisionGrid( const QSize &size ) :
+    m_columns( qMax( 1, size.width() / s_cellSize + 1 ) ),
+    m_rows( qMax( 1, size.height() / s_cellSize + 1 ) ),
+    m_cells( m_columns * m_rows )
+{
+}
+
+QRect CollisionGrid::cells( const QRectF &rect ) const
+{
+    // Rectangles partially outside of the screen fall into the border cells.
+    int const left = qBound( 0, qFloor( rect.left() / s_cellSize ), m_columns - 1 );
+    int const right = qBound( 0, qFloor( rect.right() / s_cellSize ), m_columns - 1 );
+    int const top = qBound( 0, qFloor( rect.top() / s_cellSize ), m_rows - 1 );
+    int const bottom = qBound( 0, qFloor( rect.bottom() / s_cellSize ), m_rows - 1 );
+    return QRect( QPoint( left, top ), QPoint( right, bottom ) );
+}
+
+bool CollisionGrid::intersects( const QRectF &rect ) const
+{
+    QRect const range = cells( rect );
+    for ( int row = range.top(); row <= range.bottom(); ++row ) {
+        for ( int column = range.left(); column <= range.right(); ++column ) {
+            for ( const QRectF &other: m_cells.at( row * m_columns + column ) ) {
+                if ( rect.intersects( other ) ) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void CollisionGrid::insert( const QRectF &rect )
+{
+    QRect const range = cells( rect );
+    for ( int row = range.top(); row <= range.bottom(); ++row ) {
+        for ( int column = range.left(); column <= range.right(); ++column ) {
+            m_cells[row * m_columns + column].append( rect );
+        }
+    }
+}
+
+/**
+ * Returns whether @p coordinates are within @p margin (radian) of @p box.
+ */
+bool isNear( const GeoDataLatLonBox &box, const GeoDataCoordinates &coordinates, qreal margin )
+{
+    qreal const lat = coordinates.latitude();
+    if ( lat < box.south() - margin || lat > box.north() + margin ) {
+        return false;
+    }
+
+    qreal const width = box.width() + 2 * margin;
+    if ( width >= 2 * M_PI ) {
+        return true;
+    }
+
+    // distance east of the western edge, handling boxes crossing the date line
+    qreal offset = fmod( coordinates.longitude() - box.west() + margin, 2 * M_PI );
+    if ( offset < 0 ) {
+        offset += 2 * M_PI;
+    }
+    return offset <= width;
+}
+
+}
+
 class AbstractDataPluginModelPrivate
 {
 public:
@@ -76,6 +170,7 @@ public:
     qint32 m_downloadedNumber;
     QString m_currentPlanetId;
     QList<AbstractDataPluginItem*> m_itemSet;
+    QHash<QString, AbstractDataPluginItem*> m_itemsById;
     QHash<QString, AbstractDataPluginItem*> m_downloadingItems;
     QList<AbstractDataPluginItem*> m_displayedItems;
     QTimer m_downloadTimer;
@@ -297,6 +392,10 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         d->m_needsSorting =  false;
     }
 
+    QSet<AbstractDataPluginItem*> const displayedItems = d->m_displayedItems.toSet();
+    QSet<AbstractDataPluginItem*> listedItems;
+    CollisionGrid collisionGrid( viewport->size() );
+
     QList<AbstractDataPluginItem*>::const_iterator i = candidates.constBegin();
     QList<AbstractDataPluginItem*>::const_iterator end = candidates.constEnd();
 
@@ -311,33 +410,40 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         if( d->m_favoriteItemsOnly && !(*i)->isFavorite() ) {
             continue;
         }
-        
-        (*i)->setProjection( viewport );
-        if( (*i)->positions().isEmpty() ) {
+
+        if ( listedItems.contains( *i ) ) {
             continue;
         }
 
-        if ( list.contains( *i ) ) {
+        // Skip items far away from the viewport before projecting them. The margin
+        // keeps items whose anchor is outside while a part of them is visible.
+        QSizeF const size = (*i)->size();
+        if ( !isNear( currentBox, (*i)->coordinate(),
+                      qMax( size.width(), size.height() ) * viewport->angularResolution() ) ) {
+            continue;
+        }
+
+        (*i)->setProjection( viewport );
+        if( (*i)->positions().isEmpty() ) {
             continue;
         }
 
         // If the item was added initially at a nearer position, they don't have priority,
         // because we zoomed out since then.
-        bool const alreadyDisplayed = d->m_displayedItems.contains( *i );
+        bool const alreadyDisplayed = displayedItems.contains( *i );
         if ( !alreadyDisplayed || (*i)->addedAngularResolution() >= viewport->angularResolution() || (*i)->isSticky() ) {
+            QVector<QRectF> const boundingRects = (*i)->boundingRects();
             bool collides = false;
-            int const length = list.length();
-            for ( int j=0; !collides && j<length; ++j ) {
-                for( const QRectF &rect: list[j]->boundingRects() ) {
-                    for( const QRectF &itemRect: (*i)->boundingRects() ) {
-                        if ( rect.intersects( itemRect ) )
-                            collides = true;
-                    }
-                }
+            for ( int j = 0; !collides && j < boundingRects.size(); ++j ) {
+                collides = collisionGrid.intersects( boundingRects[j] );
             }
 
             if ( !collides ) {
                 list.append( *i );
+                listedItems.insert( *i );
+                for( const QRectF &rect: boundingRects ) {
+                    collisionGrid.insert( rect );
+                }
                 (*i)->setSettings( d->m_itemSettings );
 
                 // We want to save the angular resolution of the first time the item got added.
@@ -414,7 +520,7 @@ void AbstractDataPluginModel::addItemsToList( const QList<AbstractDataPluginItem
         }
 
         // If the item is already in our list, don't add it.
-        if ( d->m_itemSet.contains( item ) ) {
+        if ( d->m_itemsById.value( item->id() ) == item ) {
             continue;
         }
 
@@ -432,6 +538,7 @@ void AbstractDataPluginModel::addItemsToList( const QList<AbstractDataPluginItem
                                                                   lessThanByPointer );
         // Insert the item on the right position in the list
         d->m_itemSet.insert( i, item );
+        d->m_itemsById.insert( item->id(), item );
 
         connect( item, SIGNAL(stickyChanged()), this, SLOT(scheduleItemSort()) );
         connect( item, SIGNAL(destroyed(QObject*)), this, SLOT(removeItem(QObject*)) );
@@ -540,13 +647,7 @@ QString AbstractDataPluginModelPrivate::generateFilepath( const QString& id, con
 
 AbstractDataPluginItem *AbstractDataPluginModel::findItem( const QString& id ) const
 {
-    for ( AbstractDataPluginItem *item: d->m_itemSet ) {
-        if( item->id() == id ) {
-            return item;
-        }
-    }
-    
-    return nullptr;
+    return d->m_itemsById.value( id );
 }
 
 bool AbstractDataPluginModel::itemExists( const QString& id ) const
@@ -637,12 +738,23 @@ void AbstractDataPluginModel::processFinishedJob( const QString& relativeUrlStri
 
 void AbstractDataPluginModel::removeItem( QObject *item )
 {
-    AbstractDataPluginItem * pluginItem = qobject_cast<AbstractDataPluginItem*>( item );
+    // The item is being destroyed already, so it can only be compared by its address
+    AbstractDataPluginItem * pluginItem = static_cast<AbstractDataPluginItem*>( item );
     d->m_itemSet.removeAll( pluginItem );
-    QHash<QString, AbstractDataPluginItem *>::iterator i;
-    for( i = d->m_downloadingItems.begin(); i != d->m_downloadingItems.end(); ++i ) {
+    d->m_displayedItems.removeAll( pluginItem );
+    for ( QHash<QString, AbstractDataPluginItem *>::iterator i = d->m_itemsById.begin(); i != d->m_itemsById.end(); ) {
+        if( *i == pluginItem ) {
+            i = d->m_itemsById.erase( i );
+        } else {
+            ++i;
+        }
+    }
+    QHash<QString, AbstractDataPluginItem *>::iterator i = d->m_downloadingItems.begin();
+    while ( i != d->m_downloadingItems.end() ) {
         if( *i == pluginItem ) {
             i = d->m_downloadingItems.erase( i );
+        } else {
+            ++i;
         }
     }
 }
@@ -656,6 +768,7 @@ void AbstractDataPluginModel::clear()
         (*iter)->deleteLater();
     }
     d->m_itemSet.clear();
+    d->m_itemsById.clear();
     d->m_lastBox = GeoDataLatLonAltBox();
     d->m_downloadedBox = GeoDataLatLonAltBox();
     d->m_downloadedNumber = 0;
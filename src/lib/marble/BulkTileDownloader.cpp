@@ -0,0 +1,837 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "BulkTileDownloader.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QNetworkAccessManager>
+#include <QPair>
+#include <QRect>
+#include <QSaveFile>
+#include <QTimer>
+#include <QUrl>
+
+#include <algorithm>
+#include <climits>
+
+#include "DownloadPolicy.h"
+#include "FileStoragePolicy.h"
+#include "GeoSceneAbstractTileProjection.h"
+#include "GeoSceneTextureTileDataset.h"
+#include "HttpJob.h"
+#include "MarbleDebug.h"
+#include "MarbleDirs.h"
+#include "TileCoordsPyramid.h"
+#include "TileId.h"
+#include "TileLoader.h"
+
+namespace Marble
+{
+
+static const quint32 journalMagic = 0x4d424a31; // "MBJ1"
+static const quint32 journalVersion = 1;
+
+// Number of tile positions examined before returning to the event loop.
+// Fresh tiles are skipped without network access, so this bounds the time
+// spent skipping through a region which has been downloaded before.
+static const int positionsPerBatch = 500;
+
+// Minimum time between two journal updates in ms
+static const int journalInterval = 1000;
+
+// Minimum time between two progressChanged() signals in ms
+static const int progressInterval = 250;
+
+// Time before a failed download is tried again in ms
+static const int retryDelay = 2000;
+
+class Q_DECL_HIDDEN BulkTileDownloader::Private
+{
+ public:
+    struct Cursor
+    {
+        int level;
+        int pyramid;
+        int x;
+        int y;
+    };
+
+    struct Statistics
+    {
+        Statistics();
+        void add( const Statistics &other );
+
+        qint64 positions;
+        qint64 downloaded;
+        qint64 skipped;
+        qint64 failed;
+        qint64 bytes;
+    };
+
+    struct Position
+    {
+        Cursor cursor;
+        int pendingJobs;
+        Statistics statistics;
+    };
+
+    struct Job
+    {
+        qint64 ordinal;
+        TileId tileId;
+    };
+
+    explicit Private( BulkTileDownloader *parent );
+
+    int topLevel() const;
+    int bottomLevel() const;
+    bool hasLevel( int pyramid, int level ) const;
+    Cursor firstCursor() const;
+    bool atEnd( const Cursor &cursor ) const;
+    void advance( Cursor &cursor ) const;
+    void nextPyramid( Cursor &cursor ) const;
+    bool isFirstCover( const Cursor &cursor ) const;
+    void seek( Cursor &cursor ) const;
+    qint64 countTiles() const;
+    QByteArray signature() const;
+    bool providesTile( const GeoSceneTileDataset *dataset, const TileId &id ) const;
+
+    void scheduleProcessing();
+    void processRegion();
+    void startJob( const GeoSceneTileDataset *dataset, const TileId &id, qint64 ordinal );
+    void handleData( HttpJob *job, const QByteArray &data );
+    void handleError( HttpJob *job );
+    void handleRedirect( HttpJob *job, const QUrl &url );
+    void countFailure( HttpJob *job );
+    void removeJob( HttpJob *job );
+    void completePositions();
+    void abortJobs();
+    void finish();
+
+    bool readJournal();
+    void writeJournal();
+    void reportProgress( bool force );
+
+    BulkTileDownloader *const q;
+
+    QVector<const GeoSceneTileDataset *> m_datasets;
+    QVector<TileCoordsPyramid> m_region;
+    int m_maximumConnections;
+    QString m_journalFileName;
+
+    FileStoragePolicy m_storagePolicy;
+    QNetworkAccessManager m_networkAccessManager;
+
+    bool m_downloadEnabled;
+    bool m_running;
+    bool m_processingScheduled;
+    int m_connections;
+    qint64 m_totalTiles;
+
+    /// the next tile position to examine
+    Cursor m_cursor;
+    qint64 m_nextOrdinal;
+
+    /// positions which have been examined, from the first unfinished one on
+    QMap<qint64, Position> m_positions;
+
+    /// the position and tile of each running job
+    QHash<HttpJob *, Job> m_jobs;
+
+    /// statistics of the positions before the first unfinished one, as recorded in the journal
+    Statistics m_committed;
+    /// statistics of all finished positions and jobs
+    Statistics m_total;
+    /// statistics when the current run started
+    Statistics m_start;
+
+    QElapsedTimer m_runTime;
+    QElapsedTimer m_journalTime;
+    QElapsedTimer m_progressTime;
+};
+
+BulkTileDownloader::Private::Statistics::Statistics() :
+    positions( 0 ),
+    downloaded( 0 ),
+    skipped( 0 ),
+    failed( 0 ),
+    bytes( 0 )
+{
+}
+
+void BulkTileDownloader::Private::Statistics::add( const Statistics &other )
+{
+    positions += other.positions;
+    downloaded += other.downloaded;
+    skipped += other.skipped;
+    failed += other.failed;
+    bytes += other.bytes;
+}
+
+BulkTileDownloader::Private::Private( BulkTileDownloader *parent ) :
+    q( parent ),
+    m_maximumConnections( 2 ),
+    m_storagePolicy( MarbleDirs::localPath() ),
+    m_downloadEnabled( true ),
+    m_running( false ),
+    m_processingScheduled( false ),
+    m_connections( 2 ),
+    m_totalTiles( 0 ),
+    m_nextOrdinal( 0 )
+{
+    m_storagePolicy.setTileStore( TileLoader::tileStore() );
+    m_cursor.level = INT_MAX;
+    m_cursor.pyramid = 0;
+    m_cursor.x = 0;
+    m_cursor.y = 0;
+}
+
+int BulkTileDownloader::Private::topLevel() const
+{
+    int result = INT_MAX;
+    for ( const TileCoordsPyramid &pyramid: m_region ) {
+        result = qMin( result, pyramid.topLevel() );
+    }
+    return result;
+}
+
+int BulkTileDownloader::Private::bottomLevel() const
+{
+    int result = -1;
+    for ( const TileCoordsPyramid &pyramid: m_region ) {
+        result = qMax( result, pyramid.bottomLevel() );
+    }
+    return result;
+}
+
+bool BulkTileDownloader::Private::hasLevel( int pyramid, int level ) const
+{
+    const TileCoordsPyramid &coords = m_region[pyramid];
+    return coords.topLevel() <= level && level <= coords.bottomLevel() && !coords.coords( level ).isEmpty();
+}
+
+BulkTileDownloader::Private::Cursor BulkTileDownloader::Private::firstCursor() const
+{
+    Cursor cursor;
+    cursor.level = topLevel();
+    cursor.pyramid = -1;
+    cursor.x = 0;
+    cursor.y = 0;
+    nextPyramid( cursor );
+    seek( cursor );
+    return cursor;
+}
+
+bool BulkTileDownloader::Private::atEnd( const Cursor &cursor ) const
+{
+    return cursor.level > bottomLevel();
+}
+
+void BulkTileDownloader::Private::advance( Cursor &cursor ) const
+{
+    const QRect rect = m_region[cursor.pyramid].coords( cursor.level );
+    if ( ++cursor.x <= rect.right() ) {
+        return;
+    }
+    cursor.x = rect.left();
+    if ( ++cursor.y <= rect.bottom() ) {
+        return;
+    }
+    nextPyramid( cursor );
+}
+
+void BulkTileDownloader::Private::nextPyramid( Cursor &cursor ) const
+{
+    // pyramids are walked for each level, so that low resolution tiles come first
+    while ( !atEnd( cursor ) ) {
+        if ( ++cursor.pyramid >= m_region.size() ) {
+            cursor.pyramid = 0;
+            ++cursor.level;
+            if ( atEnd( cursor ) ) {
+                return;
+            }
+        }
+        if ( hasLevel( cursor.pyramid, cursor.level ) ) {
+            const QRect rect = m_region[cursor.pyramid].coords( cursor.level );
+            cursor.x = rect.left();
+            cursor.y = rect.top();
+            return;
+        }
+    }
+}
+
+bool BulkTileDownloader::Private::isFirstCover( const Cursor &cursor ) const
+{
+    // pyramids may overlap, e.g. along a route, a tile belongs to the first one covering it
+    for ( int i = 0; i < cursor.pyramid; ++i ) {
+        if ( hasLevel( i, cursor.level ) && m_region[i].coords( cursor.level ).contains( cursor.x, cursor.y ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BulkTileDownloader::Private::seek( Cursor &cursor ) const
+{
+    while ( !atEnd( cursor ) && !isFirstCover( cursor ) ) {
+        advance( cursor );
+    }
+}
+
+qint64 BulkTileDownloader::Private::countTiles() const
+{
+    qint64 result = 0;
+
+    for ( int level = topLevel(); level <= bottomLevel(); ++level ) {
+        QVector<QRect> rects;
+        for ( int i = 0; i < m_region.size(); ++i ) {
+            if ( hasLevel( i, level ) ) {
+                rects << m_region[i].coords( level );
+            }
+        }
+
+        // sweep over the columns between the vertical edges of the rectangles
+        QVector<int> edges;
+        for ( const QRect &rect: rects ) {
+            edges << rect.left() << rect.right() + 1;
+        }
+        std::sort( edges.begin(), edges.end() );
+        edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+
+        for ( int i = 0; i + 1 < edges.size(); ++i ) {
+            QVector<QPair<int, int> > rows;
+            for ( const QRect &rect: rects ) {
+                if ( rect.left() <= edges[i] && edges[i] <= rect.right() ) {
+                    rows << qMakePair( rect.top(), rect.bottom() + 1 );
+                }
+            }
+            std::sort( rows.begin(), rows.end() );
+
+            qint64 height = 0;
+            int end = INT_MIN;
+            for ( const QPair<int, int> &row: rows ) {
+                if ( row.second > end ) {
+                    height += row.second - qMax( row.first, end );
+                    end = row.second;
+                }
+            }
+            result += height * ( edges[i + 1] - edges[i] );
+        }
+    }
+
+    return result;
+}
+
+QByteArray BulkTileDownloader::Private::signature() const
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    for ( const GeoSceneTileDataset *dataset: m_datasets ) {
+        hash.addData( dataset->sourceDir().toUtf8() );
+        hash.addData( "\n" );
+    }
+    for ( const TileCoordsPyramid &pyramid: m_region ) {
+        const QRect rect = pyramid.coords( pyramid.bottomLevel() );
+        hash.addData( QString( "%1 %2 %3 %4 %5 %6\n" )
+                      .arg( pyramid.topLevel() ).arg( pyramid.bottomLevel() )
+                      .arg( rect.left() ).arg( rect.top() ).arg( rect.right() ).arg( rect.bottom() )
+                      .toLatin1() );
+    }
+    return hash.result();
+}
+
+bool BulkTileDownloader::Private::providesTile( const GeoSceneTileDataset *dataset, const TileId &id ) const
+{
+    // the same levels TileLoader downloads while browsing
+    const int level = id.zoomLevel();
+    if ( level > 0 ) {
+        if ( level < dataset->minimumTileLevel() ) {
+            return false;
+        }
+        if ( dataset->hasMaximumTileLevel() && level > dataset->maximumTileLevel() ) {
+            return false;
+        }
+        const QVector<int> tileLevels = dataset->tileLevels();
+        if ( !tileLevels.isEmpty() && !tileLevels.contains( level ) ) {
+            return false;
+        }
+    }
+
+    const GeoSceneTextureTileDataset *texture = dynamic_cast<const GeoSceneTextureTileDataset *>( dataset );
+    if ( texture && !texture->latLonBox().isNull() ) {
+        return texture->latLonBox().intersects( dataset->tileProjection()->geoCoordinates( id ) );
+    }
+
+    return true;
+}
+
+void BulkTileDownloader::Private::scheduleProcessing()
+{
+    if ( !m_processingScheduled ) {
+        m_processingScheduled = true;
+        QTimer::singleShot( 0, q, [this]() { processRegion(); } );
+    }
+}
+
+void BulkTileDownloader::Private::processRegion()
+{
+    m_processingScheduled = false;
+
+    int examined = 0;
+    while ( m_running && m_jobs.size() < m_connections && !atEnd( m_cursor ) ) {
+        if ( examined++ == positionsPerBatch ) {
+            scheduleProcessing();
+            break;
+        }
+
+        const qint64 ordinal = m_nextOrdinal++;
+        Position &position = m_positions[ordinal];
+        position.cursor = m_cursor;
+        position.pendingJobs = 0;
+
+        for ( const GeoSceneTileDataset *dataset: m_datasets ) {
+            const TileId id( dataset->sourceDir(), m_cursor.level, m_cursor.x, m_cursor.y );
+            if ( !providesTile( dataset, id ) ) {
+                continue;
+            }
+
+            if ( TileLoader::tileStatus( dataset, id ) == TileLoader::Available ) {
+                ++position.statistics.skipped;
+                ++m_total.skipped;
+            } else {
+                ++position.pendingJobs;
+                startJob( dataset, id, ordinal );
+            }
+        }
+
+        advance( m_cursor );
+        seek( m_cursor );
+
+        if ( position.pendingJobs == 0 ) {
+            ++position.statistics.positions;
+            ++m_total.positions;
+            completePositions();
+        }
+    }
+
+    if ( m_running && atEnd( m_cursor ) && m_positions.isEmpty() ) {
+        finish();
+        return;
+    }
+
+    reportProgress( false );
+}
+
+void BulkTileDownloader::Private::startJob( const GeoSceneTileDataset *dataset, const TileId &id, qint64 ordinal )
+{
+    HttpJob *const job = new HttpJob( dataset->downloadUrl( id ), dataset->relativeTileFileName( id ),
+                                      QString(), &m_networkAccessManager );
+    job->setUserAgentPluginId( "QNamNetworkPlugin" );
+    job->setDownloadUsage( DownloadBulk );
+
+    Job entry;
+    entry.ordinal = ordinal;
+    entry.tileId = id;
+    m_jobs.insert( job, entry );
+
+    QObject::connect( job, &HttpJob::dataReceived, q,
+                      [this]( HttpJob *job, const QByteArray &data ) { handleData( job, data ); } );
+    QObject::connect( job, &HttpJob::jobDone, q,
+                      [this]( HttpJob *job, int ) { handleError( job ); } );
+    QObject::connect( job, &HttpJob::redirected, q,
+                      [this]( HttpJob *job, const QUrl &url ) { handleRedirect( job, url ); } );
+
+    job->execute();
+}
+
+void BulkTileDownloader::Private::handleData( HttpJob *job, const QByteArray &data )
+{
+    if ( !m_jobs.contains( job ) ) {
+        return;
+    }
+
+    if ( !m_storagePolicy.updateFile( job->destinationFileName(), data ) ) {
+        mDebug() << "Could not save" << job->destinationFileName();
+        countFailure( job );
+        removeJob( job );
+        return;
+    }
+
+    const TileId tileId = m_jobs.value( job ).tileId;
+    Position &position = m_positions[ m_jobs.value( job ).ordinal ];
+    ++position.statistics.downloaded;
+    ++m_total.downloaded;
+    position.statistics.bytes += data.size();
+    m_total.bytes += data.size();
+    removeJob( job );
+
+    emit q->tileDownloaded( tileId, data );
+}
+
+void BulkTileDownloader::Private::handleError( HttpJob *job )
+{
+    if ( !m_jobs.contains( job ) ) {
+        return;
+    }
+
+    if ( job->tryAgain() ) {
+        QTimer::singleShot( retryDelay, job, SLOT(execute()) );
+        return;
+    }
+
+    mDebug() << "Download of" << job->sourceUrl() << "failed";
+    countFailure( job );
+    removeJob( job );
+}
+
+void BulkTileDownloader::Private::handleRedirect( HttpJob *job, const QUrl &url )
+{
+    if ( !m_jobs.contains( job ) ) {
+        return;
+    }
+
+    // redirections use up the retries as well, which ends redirection loops
+    if ( job->tryAgain() ) {
+        job->setSourceUrl( url );
+        // the job is still busy with the reply of the redirection
+        QTimer::singleShot( 0, job, SLOT(execute()) );
+        return;
+    }
+
+    mDebug() << "Too many redirections for" << job->destinationFileName();
+    countFailure( job );
+    removeJob( job );
+}
+
+void BulkTileDownloader::Private::countFailure( HttpJob *job )
+{
+    ++m_positions[ m_jobs.value( job ).ordinal ].statistics.failed;
+    ++m_total.failed;
+}
+
+void BulkTileDownloader::Private::removeJob( HttpJob *job )
+{
+    const qint64 ordinal = m_jobs.take( job ).ordinal;
+    job->disconnect();
+    job->deleteLater();
+
+    Position &position = m_positions[ordinal];
+    if ( --position.pendingJobs == 0 ) {
+        ++position.statistics.positions;
+        ++m_total.positions;
+        completePositions();
+    }
+
+    reportProgress( false );
+    scheduleProcessing();
+}
+
+void BulkTileDownloader::Private::completePositions()
+{
+    while ( !m_positions.isEmpty() && m_positions.first().pendingJobs == 0 ) {
+        m_committed.add( m_positions.first().statistics );
+        m_positions.erase( m_positions.begin() );
+    }
+
+    if ( m_journalTime.elapsed() >= journalInterval ) {
+        writeJournal();
+    }
+}
+
+void BulkTileDownloader::Private::abortJobs()
+{
+    QHash<HttpJob *, Job>::const_iterator pos = m_jobs.constBegin();
+    QHash<HttpJob *, Job>::const_iterator const end = m_jobs.constEnd();
+    for (; pos != end; ++pos ) {
+        // disconnect first, a pending retry may still execute the job
+        pos.key()->disconnect();
+        pos.key()->abort();
+        pos.key()->deleteLater();
+    }
+    m_jobs.clear();
+}
+
+void BulkTileDownloader::Private::finish()
+{
+    m_running = false;
+    if ( !m_journalFileName.isEmpty() ) {
+        QFile::remove( m_journalFileName );
+    }
+
+    mDebug() << "Bulk download finished:" << m_total.downloaded << "tiles downloaded,"
+             << m_total.skipped << "skipped," << m_total.failed << "failed";
+    reportProgress( true );
+    emit q->finished();
+}
+
+bool BulkTileDownloader::Private::readJournal()
+{
+    if ( m_journalFileName.isEmpty() ) {
+        return false;
+    }
+
+    QFile file( m_journalFileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_6 );
+
+    quint32 magic;
+    quint32 version;
+    QByteArray journalSignature;
+    stream >> magic >> version >> journalSignature;
+    if ( stream.status() != QDataStream::Ok || magic != journalMagic || version != journalVersion
+         || journalSignature != signature() ) {
+        mDebug() << "Ignoring the journal" << m_journalFileName << "of another download";
+        return false;
+    }
+
+    qint32 level;
+    qint32 pyramid;
+    qint32 x;
+    qint32 y;
+    Statistics statistics;
+    stream >> level >> pyramid >> x >> y;
+    stream >> statistics.positions >> statistics.downloaded >> statistics.skipped
+           >> statistics.failed >> statistics.bytes;
+    if ( stream.status() != QDataStream::Ok || pyramid < 0 || pyramid >= m_region.size()
+         || level < topLevel() || level > bottomLevel() + 1 ) {
+        return false;
+    }
+
+    m_cursor.level = level;
+    m_cursor.pyramid = pyramid;
+    m_cursor.x = x;
+    m_cursor.y = y;
+    seek( m_cursor );
+    m_committed = statistics;
+
+    mDebug() << "Resuming the download of" << m_journalFileName << "after" << statistics.positions << "tiles";
+    return true;
+}
+
+void BulkTileDownloader::Private::writeJournal()
+{
+    m_journalTime.restart();
+    if ( m_journalFileName.isEmpty() ) {
+        return;
+    }
+
+    QDir().mkpath( QFileInfo( m_journalFileName ).absolutePath() );
+    QSaveFile file( m_journalFileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Cannot write the journal" << m_journalFileName;
+        return;
+    }
+
+    // continue with the first position which has not been finished yet
+    const Cursor &cursor = m_positions.isEmpty() ? m_cursor : m_positions.first().cursor;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_6 );
+    stream << journalMagic << journalVersion << signature();
+    stream << qint32( cursor.level ) << qint32( cursor.pyramid ) << qint32( cursor.x ) << qint32( cursor.y );
+    stream << m_committed.positions << m_committed.downloaded << m_committed.skipped
+           << m_committed.failed << m_committed.bytes;
+    file.commit();
+}
+
+void BulkTileDownloader::Private::reportProgress( bool force )
+{
+    if ( force || m_progressTime.elapsed() >= progressInterval ) {
+        m_progressTime.restart();
+        emit q->progressChanged();
+    }
+}
+
+BulkTileDownloader::BulkTileDownloader( QObject *parent ) :
+    QObject( parent ),
+    d( new Private( this ) )
+{
+}
+
+BulkTileDownloader::~BulkTileDownloader()
+{
+    stop();
+    delete d;
+}
+
+void BulkTileDownloader::setTileDatasets( const QVector<const GeoSceneTileDataset *> &datasets )
+{
+    Q_ASSERT( !d->m_running );
+    d->m_datasets = datasets;
+}
+
+void BulkTileDownloader::setRegion( const QVector<TileCoordsPyramid> &region )
+{
+    Q_ASSERT( !d->m_running );
+    d->m_region = region;
+}
+
+void BulkTileDownloader::setMaximumConnections( int connections )
+{
+    d->m_maximumConnections = qMax( 1, connections );
+}
+
+int BulkTileDownloader::maximumConnections() const
+{
+    return d->m_maximumConnections;
+}
+
+void BulkTileDownloader::setJournalFileName( const QString &fileName )
+{
+    Q_ASSERT( !d->m_running );
+    d->m_journalFileName = fileName;
+}
+
+QString BulkTileDownloader::journalFileName() const
+{
+    return d->m_journalFileName;
+}
+
+void BulkTileDownloader::setDownloadEnabled( bool enable )
+{
+    d->m_downloadEnabled = enable;
+    d->m_networkAccessManager.setNetworkAccessible( enable ? QNetworkAccessManager::Accessible : QNetworkAccessManager::NotAccessible );
+    if ( !enable ) {
+        // the journal lets the next start() continue where this run stopped
+        stop();
+    }
+}
+
+bool BulkTileDownloader::isDownloadEnabled() const
+{
+    return d->m_downloadEnabled;
+}
+
+bool BulkTileDownloader::isRunning() const
+{
+    return d->m_running;
+}
+
+qint64 BulkTileDownloader::totalTiles() const
+{
+    return d->m_totalTiles;
+}
+
+qint64 BulkTileDownloader::processedTiles() const
+{
+    return d->m_total.positions;
+}
+
+qint64 BulkTileDownloader::downloadedTiles() const
+{
+    return d->m_total.downloaded;
+}
+
+qint64 BulkTileDownloader::skippedTiles() const
+{
+    return d->m_total.skipped;
+}
+
+qint64 BulkTileDownloader::failedTiles() const
+{
+    return d->m_total.failed;
+}
+
+qint64 BulkTileDownloader::downloadedBytes() const
+{
+    return d->m_total.bytes;
+}
+
+qreal BulkTileDownloader::bytesPerSecond() const
+{
+    const qint64 elapsed = d->m_runTime.isValid() ? d->m_runTime.elapsed() : 0;
+    if ( elapsed <= 0 ) {
+        return 0.0;
+    }
+    return ( d->m_total.bytes - d->m_start.bytes ) * 1000.0 / elapsed;
+}
+
+qint64 BulkTileDownloader::estimatedTimeRemaining() const
+{
+    const qint64 remaining = d->m_totalTiles - d->m_total.positions;
+    if ( remaining <= 0 ) {
+        return 0;
+    }
+
+    const qint64 processed = d->m_total.positions - d->m_start.positions;
+    const qint64 elapsed = d->m_runTime.isValid() ? d->m_runTime.elapsed() : 0;
+    if ( !d->m_running || processed <= 0 || elapsed < 1000 ) {
+        return -1;
+    }
+
+    return qRound64( remaining * ( elapsed / 1000.0 ) / processed );
+}
+
+void BulkTileDownloader::start()
+{
+    if ( d->m_running ) {
+        return;
+    }
+
+    if ( !d->m_downloadEnabled ) {
+        mDebug() << "Not downloading the region while working offline";
+        return;
+    }
+
+    d->m_totalTiles = d->countTiles();
+    d->m_positions.clear();
+    d->m_nextOrdinal = 0;
+    d->m_committed = Private::Statistics();
+
+    // respect the limits of the tile servers
+    d->m_connections = d->m_maximumConnections;
+    for ( const GeoSceneTileDataset *dataset: d->m_datasets ) {
+        for ( const DownloadPolicy *policy: dataset->downloadPolicies() ) {
+            if ( policy->key().usage() == DownloadBulk ) {
+                d->m_connections = qMax( 1, qMin( d->m_connections, policy->maximumConnections() ) );
+            }
+        }
+    }
+
+    if ( !d->readJournal() ) {
+        d->m_cursor = d->firstCursor();
+    }
+    d->m_total = d->m_committed;
+    d->m_start = d->m_committed;
+
+    mDebug() << "Downloading" << d->m_totalTiles << "tiles with" << d->m_connections << "connections";
+
+    d->m_running = true;
+    d->m_runTime.start();
+    d->m_journalTime.start();
+    d->m_progressTime.start();
+    d->reportProgress( true );
+    d->scheduleProcessing();
+}
+
+void BulkTileDownloader::stop()
+{
+    if ( !d->m_running ) {
+        return;
+    }
+
+    d->m_running = false;
+    d->abortJobs();
+    d->writeJournal();
+    d->m_positions.clear();
+    d->reportProgress( true );
+}
+
+}
+
+#include "moc_BulkTileDownloader.cpp"
@@ -0,0 +1,145 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_BULKTILEDOWNLOADER_H
+#define MARBLE_BULKTILEDOWNLOADER_H
+
+#include <QObject>
+#include <QVector>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class GeoSceneTileDataset;
+class TileCoordsPyramid;
+class TileId;
+
+/**
+ * @short Downloads all tiles of a region for offline use.
+ *
+ * The tiles of the region are enumerated level by level, starting with the lowest
+ * resolution. Only as many tiles are enumerated as there are free connections, so
+ * a region of millions of tiles does not need more memory than a small one. At each
+ * tile position, the tiles of all datasets providing that level are downloaded,
+ * unless they are cached already and have not expired.
+ *
+ * Progress is recorded in a journal file. If a download is stopped or the
+ * application quits, starting a download of the same region with the same journal
+ * continues where the previous run stopped. The journal is removed when the
+ * download has finished.
+ *
+ * Downloaded tiles are stored where tiles downloaded while browsing are stored,
+ * and tileDownloaded() is emitted for them so that tiles on display are updated.
+ */
+class MARBLE_EXPORT BulkTileDownloader : public QObject
+{
+    Q_OBJECT
+
+ public:
+    explicit BulkTileDownloader( QObject *parent = nullptr );
+    ~BulkTileDownloader() override;
+
+    /**
+     * Sets the datasets to download tiles of. The datasets have to stay alive
+     * while the download is running.
+     */
+    void setTileDatasets( const QVector<const GeoSceneTileDataset *> &datasets );
+
+    /**
+     * Sets the region to download. Tiles covered by several pyramids are
+     * downloaded once.
+     */
+    void setRegion( const QVector<TileCoordsPyramid> &region );
+
+    /**
+     * Sets the number of tiles which are downloaded at the same time. The default
+     * is 2. Bulk download policies of the datasets may restrict it further.
+     */
+    void setMaximumConnections( int connections );
+    int maximumConnections() const;
+
+    /**
+     * Sets the file progress is recorded in, or an empty string for not recording
+     * progress.
+     */
+    void setJournalFileName( const QString &fileName );
+    QString journalFileName() const;
+
+    /**
+     * Switches downloading on/off, useful for offline mode. Switching it off
+     * stops a running download, and start() does not start one until it is
+     * switched on again. The default is on.
+     */
+    void setDownloadEnabled( bool enable );
+    bool isDownloadEnabled() const;
+
+    bool isRunning() const;
+
+    /**
+     * Returns the number of tile positions in the region. Each of them may
+     * require a download per dataset.
+     */
+    qint64 totalTiles() const;
+
+    /**
+     * Returns the number of tile positions which have been handled, including
+     * those handled by the run which has been resumed.
+     */
+    qint64 processedTiles() const;
+
+    qint64 downloadedTiles() const;
+    qint64 skippedTiles() const;
+    qint64 failedTiles() const;
+    qint64 downloadedBytes() const;
+
+    /**
+     * Returns the average download rate of the current run in bytes per second.
+     */
+    qreal bytesPerSecond() const;
+
+    /**
+     * Returns the estimated time until the download has finished in seconds,
+     * or -1 if it cannot be estimated yet.
+     */
+    qint64 estimatedTimeRemaining() const;
+
+ public Q_SLOTS:
+    /**
+     * Starts downloading the region, or resumes downloading it if the journal
+     * belongs to the same datasets and region. Does nothing while downloading
+     * is disabled.
+     */
+    void start();
+
+    /**
+     * Stops downloading and records the progress in the journal.
+     */
+    void stop();
+
+ Q_SIGNALS:
+    void progressChanged();
+    void finished();
+
+    /**
+     * Emitted when the tile @p tileId has been downloaded and stored. @p data
+     * holds the tile as it has been downloaded.
+     */
+    void tileDownloaded( const TileId &tileId, const QByteArray &data );
+
+ private:
+    Q_DISABLE_COPY( BulkTileDownloader )
+
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif
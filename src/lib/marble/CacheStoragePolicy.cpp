@@ -12,16 +12,16 @@
 // Own
 #include "CacheStoragePolicy.h"
 
-// Qt
-#include <QDir>
+// Marble
+#include "TileStore.h"
 
 using namespace Marble;
 
 CacheStoragePolicy::CacheStoragePolicy( const QString &cacheDirectory )
-    : m_cache( cacheDirectory )
+    : m_cache( TileStore::sharedStore( cacheDirectory + QLatin1String("/cache.mts") ) )
 {
-    if ( ! QDir( cacheDirectory ).exists() ) 
-        QDir::root().mkpath( cacheDirectory );
+    if ( m_cache->sizeLimit() == 0 )
+        m_cache->setSizeLimit( 300 * 1024 * 1024 );
 }
 
 CacheStoragePolicy::~CacheStoragePolicy()
@@ -30,12 +30,12 @@ CacheStoragePolicy::~CacheStoragePolicy()
 
 bool CacheStoragePolicy::fileExists( const QString &fileName ) const
 {
-    return m_cache.exists( fileName );
+    return m_cache->contains( fileName );
 }
 
 bool CacheStoragePolicy::updateFile( const QString &fileName, const QByteArray &data )
 {
-    if ( !m_cache.insert( fileName, data ) ) {
+    if ( !m_cache->insert( fileName, data ) ) {
         m_errorMsg = QObject::tr("Unable to insert data into cache");
         return false;
     }
@@ -45,7 +45,7 @@ bool CacheStoragePolicy::updateFile( const QString &fileName, const QByteArray &
 
 void CacheStoragePolicy::clearCache()
 {
-    m_cache.clear();
+    m_cache->clear();
 }
 
 QString CacheStoragePolicy::lastErrorMessage() const
@@ -55,20 +55,17 @@ QString CacheStoragePolicy::lastErrorMessage() const
 
 QByteArray CacheStoragePolicy::data( const QString &fileName )
 {
-    QByteArray data;
-    m_cache.find( fileName, data );
-
-    return data;
+    return m_cache->data( fileName );
 }
 
 void CacheStoragePolicy::setCacheLimit( quint64 bytes )
 {
-    m_cache.setCacheLimit( bytes );
+    m_cache->setSizeLimit( bytes );
 }
 
 quint64 CacheStoragePolicy::cacheLimit() const
 {
-    return m_cache.cacheLimit();
+    return m_cache->sizeLimit();
 }
 
 #include "moc_CacheStoragePolicy.cpp"
@@ -11,7 +11,6 @@
 #ifndef MARBLE_CACHESTORAGEPOLICY_H
 #define MARBLE_CACHESTORAGEPOLICY_H
 
-#include "DiscCache.h"
 #include "StoragePolicy.h"
 
 #include <QString>
@@ -23,6 +22,8 @@ class QByteArray;
 namespace Marble
 {
 
+class TileStore;
+
 class MARBLE_EXPORT CacheStoragePolicy : public StoragePolicy
 {
     Q_OBJECT
@@ -76,7 +77,7 @@ class MARBLE_EXPORT CacheStoragePolicy : public StoragePolicy
         quint64 cacheLimit() const;
 
     private:
-        DiscCache m_cache;
+        TileStore *const m_cache;
         QString m_errorMsg;
 };
 
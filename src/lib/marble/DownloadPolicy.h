@@ -20,11 +20,12 @@
 #include <QStringList>
 
 #include "MarbleGlobal.h"
+#include "marble_export.h"
 
 namespace Marble
 {
 
-class DownloadPolicyKey
+class MARBLE_EXPORT DownloadPolicyKey
 {
     friend bool operator==( DownloadPolicyKey const & lhs, DownloadPolicyKey const & rhs );
 
@@ -52,7 +53,7 @@ inline bool operator==( const DownloadPolicyKey & lhs, const DownloadPolicyKey &
 }
 
 
-class DownloadPolicy
+class MARBLE_EXPORT DownloadPolicy
 {
     friend bool operator==( const DownloadPolicy & lhs, const DownloadPolicy & rhs );
 
@@ -63,16 +64,25 @@ class DownloadPolicy
     int maximumConnections() const;
     void setMaximumConnections( const int );
 
+    /**
+     * Returns how many of the connections may go to the same host at a time,
+     * or 0 if only maximumConnections() applies.
+     */
+    int maximumConnectionsPerHost() const;
+    void setMaximumConnectionsPerHost( const int );
+
     DownloadPolicyKey key() const;
 
  private:
     DownloadPolicyKey m_key;
     int m_maximumConnections;
+    int m_maximumConnectionsPerHost;
 };
 
 inline bool operator==( const DownloadPolicy & lhs, const DownloadPolicy & rhs )
 {
-    return lhs.m_key == rhs.m_key && lhs.m_maximumConnections == rhs.m_maximumConnections;
+    return lhs.m_key == rhs.m_key && lhs.m_maximumConnections == rhs.m_maximumConnections
+        && lhs.m_maximumConnectionsPerHost == rhs.m_maximumConnectionsPerHost;
 }
 
 }
@@ -19,17 +19,21 @@
 
 #include "HttpJob.h"
 
+#include <algorithm>
+
 namespace Marble
 {
 
 DownloadQueueSet::DownloadQueueSet( QObject * const parent )
-    : QObject( parent )
+    : QObject( parent ),
+      m_sequence( 0 )
 {
 }
 
 DownloadQueueSet::DownloadQueueSet( DownloadPolicy const & policy, QObject * const parent )
     : QObject( parent ),
-      m_downloadPolicy( policy )
+      m_downloadPolicy( policy ),
+      m_sequence( 0 )
 {
 }
 
@@ -75,27 +79,88 @@ bool DownloadQueueSet::canAcceptJob( const QUrl& sourceUrl,
 
 void DownloadQueueSet::addJob( HttpJob * const job )
 {
-    m_jobs.push( job );
-    mDebug() << "addJob: new job queue size:" << m_jobs.count();
+    m_jobQueues[ job->sourceUrl().host() ].push( job, ++m_sequence );
+    m_queuedJobs.insert( job->destinationFileName(), job );
+    mDebug() << "addJob: new job queue size:" << m_queuedJobs.count();
     emit jobAdded();
-    emit progressChanged( m_activeJobs.size(), m_jobs.count() );
+    emit progressChanged( m_activeJobs.size(), m_queuedJobs.count() );
     activateJobs();
 }
 
+void DownloadQueueSet::setJobPriorities( const QHash<QString, int> &priorities )
+{
+    QHash<QString, int>::const_iterator pos = priorities.constBegin();
+    QHash<QString, int>::const_iterator const end = priorities.constEnd();
+    for (; pos != end; ++pos ) {
+        HttpJob * const job = m_queuedJobs.value( pos.key() );
+        if ( !job ) {
+            // jobs which are not waiting get their priority when they are requeued
+            HttpJob * const retryJob = m_retryJobs.value( pos.key() );
+            if ( retryJob ) {
+                retryJob->setPriority( pos.value() );
+            }
+            continue;
+        }
+        if ( job->priority() != pos.value() ) {
+            m_jobQueues[ job->sourceUrl().host() ].setPriority( job, pos.value(), ++m_sequence );
+        }
+    }
+}
+
+void DownloadQueueSet::removeJobs( const QStringList &destinationFileNames )
+{
+    bool removed = false;
+    for ( const QString &destinationFileName: destinationFileNames ) {
+        HttpJob * const job = takeJob( destinationFileName );
+        if ( job ) {
+            mDebug() << "removeJobs:" << destinationFileName;
+            job->abort();
+            job->deleteLater();
+            emit jobRemoved();
+            removed = true;
+        }
+    }
+
+    if ( removed ) {
+        emit progressChanged( m_activeJobs.size(), m_queuedJobs.count() );
+        activateJobs();
+    }
+}
+
 void DownloadQueueSet::activateJobs()
 {
-    while ( !m_jobs.isEmpty()
+    while ( !m_queuedJobs.isEmpty()
             && m_activeJobs.count() < m_downloadPolicy.maximumConnections() )
     {
-        HttpJob * const job = m_jobs.pop();
+        // pick the most urgent job of all hosts which have a free connection
+        JobQueue * next = nullptr;
+        QHash<QString, JobQueue>::iterator pos = m_jobQueues.begin();
+        QHash<QString, JobQueue>::iterator const end = m_jobQueues.end();
+        for (; pos != end; ++pos ) {
+            if ( pos.value().isEmpty() || hostIsBusy( pos.key() ) ) {
+                continue;
+            }
+            if ( !next || JobQueue::isLessUrgent( next->top(), pos.value().top() ) ) {
+                next = &pos.value();
+            }
+        }
+
+        if ( !next ) {
+            // all hosts with waiting jobs are busy
+            break;
+        }
+
+        HttpJob * const job = next->pop();
+        m_queuedJobs.remove( job->destinationFileName() );
         activateJob( job );
     }
 }
 
 void DownloadQueueSet::retryJobs()
 {
-    while ( !m_retryQueue.isEmpty() ) {
-        HttpJob * const job = m_retryQueue.dequeue();
+    const QList<HttpJob*> jobs = m_retryJobs.values();
+    m_retryJobs.clear();
+    for ( HttpJob * const job: jobs ) {
         mDebug() << "Requeuing" << job->destinationFileName();
         // FIXME: addJob calls activateJobs every time
         addJob( job );
@@ -105,21 +170,29 @@ void DownloadQueueSet::retryJobs()
 void DownloadQueueSet::purgeJobs()
 {
     // purge all waiting jobs
-    while( !m_jobs.isEmpty() ) {
-        HttpJob * const job = m_jobs.pop();
-        job->deleteLater();
+    QHash<QString, JobQueue>::iterator pos = m_jobQueues.begin();
+    QHash<QString, JobQueue>::iterator const end = m_jobQueues.end();
+    for (; pos != end; ++pos ) {
+        for ( HttpJob * const job: pos.value().jobs() ) {
+            job->deleteLater();
+        }
+        pos.value().clear();
     }
+    m_queuedJobs.clear();
 
     // purge all retry jobs
-    qDeleteAll( m_retryQueue );
-    m_retryQueue.clear();
+    qDeleteAll( m_retryJobs );
+    m_retryJobs.clear();
 
     // cancel all current jobs
     while( !m_activeJobs.isEmpty() ) {
-        deactivateJob( m_activeJobs.first() );
+        HttpJob * const job = m_activeJobs.begin().value();
+        deactivateJob( job );
+        job->abort();
+        job->deleteLater();
     }
 
-    emit progressChanged( m_activeJobs.size(), m_jobs.count() );
+    emit progressChanged( m_activeJobs.size(), m_queuedJobs.count() );
 }
 
 void DownloadQueueSet::finishJob( HttpJob * job, const QByteArray& data )
@@ -147,7 +220,7 @@ void DownloadQueueSet::redirectJob( HttpJob * job, const QUrl& newSourceUrl )
 void DownloadQueueSet::retryOrBlacklistJob( HttpJob * job, const int errorCode )
 {
     Q_ASSERT( errorCode != 0 );
-    Q_ASSERT( !m_retryQueue.contains( job ));
+    Q_ASSERT( !m_retryJobs.contains( job->destinationFileName() ));
 
     deactivateJob( job );
     emit jobRemoved();
@@ -155,7 +228,7 @@ void DownloadQueueSet::retryOrBlacklistJob( HttpJob * job, const int errorCode )
     if ( job->tryAgain() ) {
         mDebug() << QString( "Download of %1 to %2 failed, but trying again soon" )
             .arg( job->sourceUrl().toString(), job->destinationFileName() );
-        m_retryQueue.enqueue( job );
+        m_retryJobs.insert( job->destinationFileName(), job );
         emit jobRetry();
     }
     else {
@@ -175,8 +248,9 @@ void DownloadQueueSet::retryOrBlacklistJob( HttpJob * job, const int errorCode )
 
 void DownloadQueueSet::activateJob( HttpJob * const job )
 {
-    m_activeJobs.push_back( job );
-    emit progressChanged( m_activeJobs.size(), m_jobs.count() );
+    m_activeJobs.insert( job->destinationFileName(), job );
+    ++m_activeJobsPerHost[ job->sourceUrl().host() ];
+    emit progressChanged( m_activeJobs.size(), m_queuedJobs.count() );
 
     connect( job, SIGNAL(jobDone(HttpJob*,int)),
              SLOT(retryOrBlacklistJob(HttpJob*,int)));
@@ -200,39 +274,57 @@ void DownloadQueueSet::deactivateJob( HttpJob * const job )
     const bool disconnected = job->disconnect();
     Q_ASSERT( disconnected );
     Q_UNUSED( disconnected ); // for Q_ASSERT in release mode
-    const bool removed = m_activeJobs.removeOne( job );
+    const bool removed = m_activeJobs.remove( job->destinationFileName() ) > 0;
     Q_ASSERT( removed );
     Q_UNUSED( removed ); // for Q_ASSERT in release mode
-    emit progressChanged( m_activeJobs.size(), m_jobs.count() );
+    const QString hostName = job->sourceUrl().host();
+    if ( --m_activeJobsPerHost[ hostName ] <= 0 ) {
+        m_activeJobsPerHost.remove( hostName );
+    }
+    emit progressChanged( m_activeJobs.size(), m_queuedJobs.count() );
 }
 
-bool DownloadQueueSet::jobIsActive( QString const & destinationFileName ) const
+/**
+   Takes the job for @p destinationFileName out of whatever state it is in.
+   An active job is disconnected, but keeps running.
+ */
+HttpJob * DownloadQueueSet::takeJob( const QString& destinationFileName )
 {
-    QList<HttpJob*>::const_iterator pos = m_activeJobs.constBegin();
-    QList<HttpJob*>::const_iterator const end = m_activeJobs.constEnd();
-    for (; pos != end; ++pos) {
-        if ( (*pos)->destinationFileName() == destinationFileName ) {
-            return true;
-        }
+    HttpJob * job = m_queuedJobs.take( destinationFileName );
+    if ( job ) {
+        m_jobQueues[ job->sourceUrl().host() ].remove( job );
+        return job;
     }
-    return false;
+
+    job = m_activeJobs.value( destinationFileName );
+    if ( job ) {
+        deactivateJob( job );
+        return job;
+    }
+
+    return m_retryJobs.take( destinationFileName );
+}
+
+bool DownloadQueueSet::hostIsBusy( const QString& hostName ) const
+{
+    const int maximumConnectionsPerHost = m_downloadPolicy.maximumConnectionsPerHost();
+    return maximumConnectionsPerHost > 0
+        && m_activeJobsPerHost.value( hostName ) >= maximumConnectionsPerHost;
+}
+
+inline bool DownloadQueueSet::jobIsActive( QString const & destinationFileName ) const
+{
+    return m_activeJobs.contains( destinationFileName );
 }
 
 inline bool DownloadQueueSet::jobIsQueued( QString const & destinationFileName ) const
 {
-    return m_jobs.contains( destinationFileName );
+    return m_queuedJobs.contains( destinationFileName );
 }
 
-bool DownloadQueueSet::jobIsWaitingForRetry( QString const & destinationFileName ) const
+inline bool DownloadQueueSet::jobIsWaitingForRetry( QString const & destinationFileName ) const
 {
-    QList<HttpJob*>::const_iterator pos = m_retryQueue.constBegin();
-    QList<HttpJob*>::const_iterator const end = m_retryQueue.constEnd();
-    for (; pos != end; ++pos) {
-        if ( (*pos)->destinationFileName() == destinationFileName ) {
-            return true;
-        }
-    }
-    return false;
+    return m_retryJobs.contains( destinationFileName );
 }
 
 bool DownloadQueueSet::jobIsBlackListed( const QUrl& sourceUrl ) const
@@ -243,36 +335,102 @@ bool DownloadQueueSet::jobIsBlackListed( const QUrl& sourceUrl ) const
 }
 
 
-inline bool DownloadQueueSet::JobStack::contains( const QString& destinationFileName ) const
+// The heap functions of the standard library keep the largest element on top,
+// so the job to download next has to compare greater than all others.
+bool DownloadQueueSet::JobQueue::isLessUrgent( const Entry& lhs, const Entry& rhs )
 {
-    return m_jobsContent.contains( destinationFileName );
+    return lhs.priority > rhs.priority
+        || ( lhs.priority == rhs.priority && lhs.sequence < rhs.sequence );
 }
 
-inline int DownloadQueueSet::JobStack::count() const
+DownloadQueueSet::JobQueue::JobQueue()
 {
-    return m_jobs.count();
 }
 
-inline bool DownloadQueueSet::JobStack::isEmpty() const
+inline bool DownloadQueueSet::JobQueue::isEmpty() const
 {
-    return m_jobs.isEmpty();
+    return m_sequences.isEmpty();
 }
 
-inline HttpJob * DownloadQueueSet::JobStack::pop()
+inline int DownloadQueueSet::JobQueue::count() const
 {
-    HttpJob * const job = m_jobs.pop();
-    bool const removed = m_jobsContent.remove( job->destinationFileName() );
-    Q_UNUSED( removed ); // for Q_ASSERT in release mode
-    Q_ASSERT( removed );
+    return m_sequences.count();
+}
+
+inline const DownloadQueueSet::JobQueue::Entry & DownloadQueueSet::JobQueue::top() const
+{
+    Q_ASSERT( !m_heap.isEmpty() && isValid( m_heap.first() ));
+    return m_heap.first();
+}
+
+HttpJob * DownloadQueueSet::JobQueue::pop()
+{
+    std::pop_heap( m_heap.begin(), m_heap.end(), isLessUrgent );
+    HttpJob * const job = m_heap.last().job;
+    m_heap.removeLast();
+    m_sequences.remove( job );
+    removeStaleEntries();
     return job;
 }
 
-inline void DownloadQueueSet::JobStack::push( HttpJob * const job )
+void DownloadQueueSet::JobQueue::push( HttpJob * const job, quint64 sequence )
+{
+    const Entry entry = { job->priority(), sequence, job };
+    m_heap.append( entry );
+    std::push_heap( m_heap.begin(), m_heap.end(), isLessUrgent );
+    m_sequences.insert( job, sequence );
+}
+
+void DownloadQueueSet::JobQueue::remove( HttpJob * const job )
 {
-    m_jobs.push( job );
-    m_jobsContent.insert( job->destinationFileName() );
+    const bool removed = m_sequences.remove( job ) > 0;
+    Q_ASSERT( removed );
+    Q_UNUSED( removed ); // for Q_ASSERT in release mode
+    removeStaleEntries();
 }
 
+void DownloadQueueSet::JobQueue::setPriority( HttpJob * const job, int priority, quint64 sequence )
+{
+    job->setPriority( priority );
+    push( job, sequence );
+    removeStaleEntries();
+}
+
+QList<HttpJob*> DownloadQueueSet::JobQueue::jobs() const
+{
+    return m_sequences.keys();
+}
+
+void DownloadQueueSet::JobQueue::clear()
+{
+    m_heap.clear();
+    m_sequences.clear();
+}
+
+inline bool DownloadQueueSet::JobQueue::isValid( const Entry& entry ) const
+{
+    // stale entries may point to deleted jobs, so they are only compared, never dereferenced
+    QHash<HttpJob*, quint64>::const_iterator const pos = m_sequences.constFind( entry.job );
+    return pos != m_sequences.constEnd() && pos.value() == entry.sequence;
+}
+
+void DownloadQueueSet::JobQueue::removeStaleEntries()
+{
+    if ( m_heap.size() > 2 * m_sequences.size() + 64 ) {
+        // too many stale entries, rebuild the heap from the valid ones
+        QVector<Entry>::iterator const validEnd =
+            std::remove_if( m_heap.begin(), m_heap.end(),
+                            [this]( const Entry &entry ) { return !isValid( entry ); } );
+        m_heap.erase( validEnd, m_heap.end() );
+        std::make_heap( m_heap.begin(), m_heap.end(), isLessUrgent );
+        return;
+    }
+
+    while ( !m_heap.isEmpty() && !isValid( m_heap.first() ) ) {
+        std::pop_heap( m_heap.begin(), m_heap.end(), isLessUrgent );
+        m_heap.removeLast();
+    }
+}
 
 }
 
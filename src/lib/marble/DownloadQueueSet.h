@@ -16,11 +16,10 @@
 #ifndef MARBLE_DOWNLOADQUEUESET_H
 #define MARBLE_DOWNLOADQUEUESET_H
 
-#include <QList>
-#include <QQueue>
+#include <QHash>
 #include <QObject>
 #include <QSet>
-#include <QStack>
+#include <QVector>
 
 #include "DownloadPolicy.h"
 
@@ -35,11 +34,14 @@ class HttpJob;
    Life of a HttpJob
    =================
    - Job is added to the QueueSet (by calling addJob() )
-     the HttpJob is put into the m_jobQueue where it waits for "activation"
+     the HttpJob is put into the job queue of its host where it waits for
+     "activation"
      signal jobAdded is emitted
    - Job is activated
-     Job is moved from m_jobQueue to m_activeJobs and signals of the job
-     are connected to slots (local or HttpDownloadManager)
+     The job with the lowest priority value of all hosts which have less than
+     maximumConnectionsPerHost() active jobs is moved from its job queue to
+     m_activeJobs and signals of the job are connected to slots (local or
+     HttpDownloadManager)
      Job is executed by calling the jobs execute() method
 
    now there are different possibilities:
@@ -58,8 +60,15 @@ class HttpJob;
       Job is removed from m_activeJobs, disconnected and destroyed
       signal jobRemoved is emitted
 
+   4) Job is removed by removeJobs(), e.g. because the tile left the view
+      Job is taken from whatever state it is in, aborted if it is active,
+      and destroyed
+      signal jobRemoved is emitted
+
    so we can conclude following rules:
    - Job is only connected to signals when in "active" state
+   - Job is in exactly one of the job queues, m_activeJobs and m_retryJobs,
+     all of which are looked up by destination file name
 
 
    questions:
@@ -86,6 +95,18 @@ class DownloadQueueSet: public QObject
                        const QString& destinationFileName ) const;
     void addJob( HttpJob * const job );
 
+    /**
+     * Changes the priority of the waiting jobs for the destination file names
+     * in @p priorities. Other destination file names are ignored.
+     */
+    void setJobPriorities( const QHash<QString, int> &priorities );
+
+    /**
+     * Removes the jobs for @p destinationFileNames, whether they are waiting,
+     * being downloaded or waiting for a retry.
+     */
+    void removeJobs( const QStringList &destinationFileNames );
+
     void activateJobs();
     void retryJobs();
     void purgeJobs();
@@ -108,6 +129,8 @@ class DownloadQueueSet: public QObject
  private:
     void activateJob( HttpJob * const job );
     void deactivateJob( HttpJob * const job );
+    HttpJob * takeJob( const QString& destinationFileName );
+    bool hostIsBusy( const QString& hostName ) const;
     bool jobIsActive( const QString& destinationFileName ) const;
     bool jobIsQueued( const QString& destinationFileName ) const;
     bool jobIsWaitingForRetry( const QString& destinationFileName ) const;
@@ -117,28 +140,61 @@ class DownloadQueueSet: public QObject
 
     /** This is the first stage a job enters, from this queue it will get
      *  into the activatedJobs container.
+     *
+     *  The queue is a binary heap ordered by priority and, for the same
+     *  priority, by the sequence number of the job, so that the most recently
+     *  requested job is downloaded first. Jobs which are taken out of order or
+     *  change their priority leave their old entry behind in the heap, which
+     *  is skipped when it reaches the top.
      */
-    class JobStack
+    class JobQueue
     {
     public:
-        bool contains( const QString& destinationFileName ) const;
-        int count() const;
+        struct Entry
+        {
+            int priority;
+            quint64 sequence;
+            HttpJob * job;
+        };
+
+        JobQueue();
         bool isEmpty() const;
+        int count() const;
+        const Entry & top() const;
         HttpJob * pop();
-        void push( HttpJob * const );
+        void push( HttpJob * const, quint64 sequence );
+        void remove( HttpJob * const );
+        void setPriority( HttpJob * const, int priority, quint64 sequence );
+        QList<HttpJob*> jobs() const;
+        void clear();
+        static bool isLessUrgent( const Entry& lhs, const Entry& rhs );
     private:
-        QStack<HttpJob*> m_jobs;
-        QSet<QString> m_jobsContent;
+        bool isValid( const Entry& entry ) const;
+        void removeStaleEntries();
+        QVector<Entry> m_heap;
+        /// the sequence number of the current heap entry of each job
+        QHash<HttpJob*, quint64> m_sequences;
     };
-    JobStack m_jobs;
+
+    /// Contains the waiting jobs by host name.
+    QHash<QString, JobQueue> m_jobQueues;
+
+    /// Contains the waiting jobs by destination file name.
+    QHash<QString, HttpJob*> m_queuedJobs;
+
+    /// Counts the jobs added to a queue, for ordering jobs of the same priority.
+    quint64 m_sequence;
 
     /// Contains the jobs which are currently being downloaded.
-    QList<HttpJob*> m_activeJobs;
+    QHash<QString, HttpJob*> m_activeJobs;
+
+    /// Contains the number of jobs being downloaded by host name.
+    QHash<QString, int> m_activeJobsPerHost;
 
     /** Contains jobs which failed to download and which are scheduled for
      *  retry according to retry settings.
      */
-    QQueue<HttpJob*> m_retryQueue;
+    QHash<QString, HttpJob*> m_retryJobs;
 
     /// Contains the blacklisted source urls
     QSet<QString> m_jobBlackList;
@@ -25,6 +25,7 @@
 #include <QScrollArea>
 #include <QSet>
 
+#include "BulkTileDownloader.h"
 #include "GeoDataLatLonAltBox.h"
 #include "MarbleDebug.h"
 #include "MarbleModel.h"
@@ -58,6 +59,7 @@ public:
     Private( MarbleWidget *const widget, QDialog * const dialog );
     QWidget * createSelectionMethodBox();
     QLayout * createTilesCounter();
+    QLayout * createDownloadProgress();
     QWidget * createOkCancelButtonBox();
 
     bool hasRoute() const;
@@ -72,6 +74,8 @@ public:
     QDoubleSpinBox *m_routeOffsetSpinBox;
     QLabel * m_tilesCountLabel;
     QLabel * m_tileSizeInfo;
+    QLabel * m_downloadProgressLabel;
+    QPushButton * m_stopButton;
     QPushButton * m_okButton;
     QPushButton * m_applyButton;
     TextureLayer const * m_textureLayer;
@@ -96,6 +100,8 @@ DownloadRegionDialog::Private::Private( MarbleWidget * const widget,
       m_routeOffsetSpinBox( nullptr ),
       m_tilesCountLabel( nullptr ),
       m_tileSizeInfo( nullptr ),
+      m_downloadProgressLabel( nullptr ),
+      m_stopButton( nullptr ),
       m_okButton( nullptr ),
       m_applyButton( nullptr ),
       m_textureLayer( widget->textureLayer() ),
@@ -192,6 +198,19 @@ QLayout * DownloadRegionDialog::Private::createTilesCounter()
     return layout;
 }
 
+QLayout * DownloadRegionDialog::Private::createDownloadProgress()
+{
+    m_downloadProgressLabel = new QLabel;
+    m_stopButton = new QPushButton( tr( "Stop" ) );
+    m_stopButton->setToolTip( tr( "Stop downloading, the download continues when the same region is downloaded again" ) );
+    connect( m_stopButton, SIGNAL(clicked()), m_widget->bulkTileDownloader(), SLOT(stop()) );
+
+    QHBoxLayout * const layout = new QHBoxLayout;
+    layout->addWidget( m_downloadProgressLabel, 1 );
+    layout->addWidget( m_stopButton );
+    return layout;
+}
+
 QWidget * DownloadRegionDialog::Private::createOkCancelButtonBox()
 {
     QDialogButtonBox * const buttonBox = new QDialogButtonBox;
@@ -228,6 +247,7 @@ DownloadRegionDialog::DownloadRegionDialog( MarbleWidget *const widget, QWidget
     layout->addWidget( d->createSelectionMethodBox() );
     layout->addWidget( d->m_tileLevelRangeWidget );
     layout->addLayout( d->createTilesCounter() );
+    layout->addLayout( d->createDownloadProgress() );
 
     if ( MarbleGlobal::getInstance()->profiles() & MarbleGlobal::SmallScreen ) {
         QWidget* widget = new QWidget( this );
@@ -252,6 +272,9 @@ DownloadRegionDialog::DownloadRegionDialog( MarbleWidget *const widget, QWidget
     connect( d->m_routeOffsetSpinBox, SIGNAL(valueChanged(double)), SLOT(updateTilesCount()) );
     connect( d->m_routeOffsetSpinBox, SIGNAL(valueChanged(double)), SLOT(setOffsetUnit()) );
     connect( d->m_model, SIGNAL(themeChanged(QString)), SLOT(updateTilesCount()) );
+    connect( widget->bulkTileDownloader(), SIGNAL(progressChanged()), SLOT(updateDownloadProgress()) );
+    connect( widget->bulkTileDownloader(), SIGNAL(finished()), SLOT(updateDownloadProgress()) );
+    updateDownloadProgress();
 }
 
 DownloadRegionDialog::~DownloadRegionDialog()
@@ -508,6 +531,37 @@ void DownloadRegionDialog::setOffsetUnit()
     }
 }
 
+void DownloadRegionDialog::updateDownloadProgress()
+{
+    const BulkTileDownloader *const downloader = d->m_widget->bulkTileDownloader();
+    d->m_stopButton->setVisible( downloader->isRunning() );
+
+    if ( !downloader->isRunning() && downloader->processedTiles() == 0 ) {
+        d->m_downloadProgressLabel->clear();
+        return;
+    }
+
+    QString text = tr( "%1 of %2 tiles, %3 downloaded (%4 kB/s)" )
+            .arg( downloader->processedTiles() )
+            .arg( downloader->totalTiles() )
+            .arg( downloader->downloadedTiles() )
+            .arg( downloader->bytesPerSecond() / 1024, 0, 'f', 1 );
+    if ( downloader->failedTiles() > 0 ) {
+        text += QLatin1String( ", " ) + tr( "%n failed", "", downloader->failedTiles() );
+    }
+
+    const qint64 remaining = downloader->estimatedTimeRemaining();
+    if ( downloader->isRunning() && remaining >= 0 ) {
+        text += QLatin1String( ", " ) + tr( "%1:%2 remaining" )
+                .arg( remaining / 60 )
+                .arg( remaining % 60, 2, 10, QLatin1Char( '0' ) );
+    } else if ( !downloader->isRunning() && downloader->processedTiles() < downloader->totalTiles() ) {
+        text += QLatin1String( ", " ) + tr( "stopped" );
+    }
+
+    d->m_downloadProgressLabel->setText( text );
+}
+
 }
 
 #include "moc_DownloadRegionDialog.cpp"
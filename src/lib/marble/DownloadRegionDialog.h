@@ -67,6 +67,8 @@ class MARBLE_EXPORT DownloadRegionDialog: public QDialog
     void updateRouteDialog();
     /// This slot sets the unit of the offset(m or km) in the spinbox
     void setOffsetUnit();
+    /// This slot shows the progress of the region download
+    void updateDownloadProgress();
 
  private:
     Q_DISABLE_COPY( DownloadRegionDialog )
@@ -9,6 +9,7 @@
 //
 
 #include "ElevationModel.h"
+#include "GeoDataLineString.h"
 #include "GeoSceneHead.h"
 #include "GeoSceneLayer.h"
 #include "GeoSceneMap.h"
@@ -24,12 +25,66 @@
 #include "PluginManager.h"
 
 #include <QCache>
+#include <QHash>
 #include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include <qmath.h>
 
 namespace Marble
 {
 
+/**
+ * Decoded elevation tile: one signed 16 bit sample per pixel. The
+ * samples are implicitly shared, so copies are cheap and can be handed
+ * between threads.
+ */
+class ElevationTile
+{
+public:
+    ElevationTile()
+        : m_width( 0 )
+    {
+    }
+
+    explicit ElevationTile( const QImage &image )
+        : m_width( image.width() ),
+          m_samples( image.width() * image.height() )
+    {
+        const QImage rgbImage = ( image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32 )
+                                ? image
+                                : image.convertToFormat( QImage::Format_ARGB32 );
+        qint16 *sample = m_samples.data();
+        for ( int y = 0; y < rgbImage.height(); ++y ) {
+            const QRgb *line = reinterpret_cast<const QRgb *>( rgbImage.constScanLine( y ) );
+            for ( int x = 0; x < m_width; ++x ) {
+                // 16 valid bits of a signed type, so just cast it
+                *sample++ = static_cast<qint16>( line[x] & 0xffff );
+            }
+        }
+    }
+
+    bool isNull() const
+    {
+        return m_samples.isEmpty();
+    }
+
+    qint16 sample( int x, int y ) const
+    {
+        return m_samples.at( y * m_width + x );
+    }
+
+private:
+    int m_width;
+    QVector<qint16> m_samples;
+};
+
+/* invalidElevationData stored in a signed 16 bit sample */
+static const qint16 noElevationSample = static_cast<qint16>( invalidElevationData );
+
 class ElevationModelPrivate
 {
 public:
@@ -37,9 +92,17 @@ public:
         : q( _q ),
           m_tileLoader( downloadManager, pluginManager ),
           m_textureLayer( nullptr ),
-          m_srtmTheme(nullptr)
+          m_srtmTheme( nullptr ),
+          m_tileZoomLevel( 0 ),
+          m_tileWidth( 0 ),
+          m_tileHeight( 0 ),
+          m_numTilesX( 0 ),
+          m_numTilesY( 0 )
     {
-        m_cache.setMaxCost( 10 ); //keep 10 tiles in memory (~17MB)
+        m_cache.setMaxCost( 20 ); //keep 20 tiles in memory (~17MB)
+
+        // batch queries are serialized; each of them loads its tiles in parallel
+        m_threadPool.setMaxThreadCount( 1 );
 
         m_srtmTheme = MapThemeManager::loadMapTheme( "earth/srtm2/srtm2.dgml" );
         if ( !m_srtmTheme ) {
@@ -58,26 +121,208 @@ public:
 
         m_textureLayer = dynamic_cast<GeoSceneTextureTileDataset*>( sceneLayer->datasets().first() );
         Q_ASSERT( m_textureLayer );
+
+        // determine the tile geometry once, it is needed by every query and
+        // lazily computed (thus not thread-safe) by the dataset
+        m_tileZoomLevel = TileLoader::maximumTileLevel( *m_textureLayer );
+        Q_ASSERT( m_tileZoomLevel == 9 );
+
+        m_tileWidth = m_textureLayer->tileSize().width();
+        m_tileHeight = m_textureLayer->tileSize().height();
+
+        m_numTilesX = TileLoaderHelper::levelToColumn( m_textureLayer->levelZeroColumns(), m_tileZoomLevel );
+        m_numTilesY = TileLoaderHelper::levelToRow( m_textureLayer->levelZeroRows(), m_tileZoomLevel );
+        Q_ASSERT( m_numTilesX > 0 );
+        Q_ASSERT( m_numTilesY > 0 );
     }
 
     ~ElevationModelPrivate()
     {
-       delete m_srtmTheme;
+        m_threadPool.waitForDone();
+        delete m_srtmTheme;
     }
 
     void tileCompleted( const TileId & tileId, const QImage &image )
     {
-        m_cache.insert( tileId, new QImage( image ) );
+        {
+            QMutexLocker locker( &m_cacheMutex );
+            m_cache.insert( tileId, new ElevationTile( image ) );
+        }
         emit q->updateAvailable();
     }
 
+    /**
+     * Returns the texture coordinates of the given position, in pixels of the whole map.
+     */
+    void textureCoordinates( qreal lon, qreal lat, qreal &textureX, qreal &textureY ) const
+    {
+        textureX = 180 + lon;
+        textureX *= m_numTilesX * m_tileWidth / 360;
+
+        textureY = 90 - lat;
+        textureY *= m_numTilesY * m_tileHeight / 180;
+    }
+
+    /**
+     * Returns the tile containing the texture pixel (x, y).
+     */
+    TileId tileId( int x, int y ) const
+    {
+        return TileId( 0, m_tileZoomLevel,
+                       ( x % ( m_numTilesX * m_tileWidth ) ) / m_tileWidth,
+                       ( y % ( m_numTilesY * m_tileHeight ) ) / m_tileHeight );
+    }
+
+    /**
+     * Returns the decoded tile @p id, loading it if it is not cached.
+     * Can be called from any thread.
+     */
+    ElevationTile tile( const TileId &id )
+    {
+        {
+            QMutexLocker locker( &m_cacheMutex );
+            const ElevationTile *cached = m_cache[id];
+            if ( cached ) {
+                return *cached;
+            }
+        }
+
+        QImage image;
+        {
+            // the tile loader and the dataset's download url rotation are not thread-safe
+            QMutexLocker locker( &m_tileLoaderMutex );
+            image = m_tileLoader.loadTileImage( m_textureLayer, id, DownloadBrowse );
+        }
+        Q_ASSERT( !image.isNull() );
+        Q_ASSERT( m_tileWidth == image.width() );
+        Q_ASSERT( m_tileHeight == image.height() );
+
+        const ElevationTile result( image );
+
+        QMutexLocker locker( &m_cacheMutex );
+        m_cache.insert( id, new ElevationTile( result ) );
+        return result;
+    }
+
+    /**
+     * Bilinearly interpolates the elevation at ( @p lon, @p lat ), in degrees.
+     * @p tileForId is called for each of the up to four tiles involved.
+     */
+    template<class TileForId>
+    qreal height( qreal lon, qreal lat, TileForId tileForId ) const
+    {
+        qreal textureX;
+        qreal textureY;
+        textureCoordinates( lon, lat, textureX, textureY );
+
+        qreal ret = 0;
+        bool hasHeight = false;
+        qreal noData = 0;
+
+        for ( int i = 0; i < 4; ++i ) {
+            const int x = static_cast<int>( textureX + ( i % 2 ) );
+            const int y = static_cast<int>( textureY + ( i / 2 ) );
+
+            const ElevationTile tile = tileForId( tileId( x, y ) );
+            Q_ASSERT( !tile.isNull() );
+
+            const qreal dx = ( textureX > ( qreal )x ) ? textureX - ( qreal )x : ( qreal )x - textureX;
+            const qreal dy = ( textureY > ( qreal )y ) ? textureY - ( qreal )y : ( qreal )y - textureY;
+
+            Q_ASSERT( 0 <= dx && dx <= 1 );
+            Q_ASSERT( 0 <= dy && dy <= 1 );
+            const qint16 elevation = tile.sample( x % m_tileWidth, y % m_tileHeight );
+            if ( elevation != noElevationSample ) { //no data?
+                ret += ( qreal )elevation * ( 1 - dx ) * ( 1 - dy );
+                hasHeight = true;
+            } else {
+                noData += ( 1 - dx ) * ( 1 - dy );
+            }
+        }
+
+        if ( !hasHeight ) {
+            ret = invalidElevationData; //no data
+        } else {
+            if ( noData ) {
+                ret += ( ret / ( 1 - noData ) ) * noData;
+            }
+        }
+
+        return ret;
+    }
+
+    /**
+     * Worker of ElevationModel::heights(), runs in m_threadPool.
+     */
+    QVector<qreal> heights( const QVector<GeoDataCoordinates> &coordinates )
+    {
+        QVector<qreal> result;
+        if ( !m_textureLayer ) {
+            result.fill( invalidElevationData, coordinates.size() );
+            return result;
+        }
+
+        // collect the tiles needed for all positions first, so that each one
+        // is loaded only once and independently of the cache size
+        QHash<TileId, ElevationTile> tiles;
+        for ( const GeoDataCoordinates &coordinate: coordinates ) {
+            qreal textureX;
+            qreal textureY;
+            textureCoordinates( coordinate.longitude( GeoDataCoordinates::Degree ),
+                                coordinate.latitude( GeoDataCoordinates::Degree ),
+                                textureX, textureY );
+            for ( int i = 0; i < 4; ++i ) {
+                const int x = static_cast<int>( textureX + ( i % 2 ) );
+                const int y = static_cast<int>( textureY + ( i / 2 ) );
+                tiles.insert( tileId( x, y ), ElevationTile() );
+            }
+        }
+
+        QVector<TileId> ids;
+        ids.reserve( tiles.size() );
+        for ( auto it = tiles.constBegin(); it != tiles.constEnd(); ++it ) {
+            ids << it.key();
+        }
+
+        QVector<ElevationTile> decoded( ids.size() );
+        QVector<int> indices( ids.size() );
+        for ( int i = 0; i < indices.size(); ++i ) {
+            indices[i] = i;
+        }
+        QtConcurrent::blockingMap( indices, [&]( int index ) {
+            decoded[index] = tile( ids[index] );
+        } );
+        for ( int i = 0; i < ids.size(); ++i ) {
+            tiles[ids[i]] = decoded[i];
+        }
+
+        result.reserve( coordinates.size() );
+        for ( const GeoDataCoordinates &coordinate: coordinates ) {
+            result << height( coordinate.longitude( GeoDataCoordinates::Degree ),
+                              coordinate.latitude( GeoDataCoordinates::Degree ),
+                              [&tiles]( const TileId &id ) { return tiles.value( id ); } );
+        }
+
+        return result;
+    }
+
 public:
     ElevationModel *q;
 
     TileLoader m_tileLoader;
     const GeoSceneTextureTileDataset *m_textureLayer;
-    QCache<TileId, const QImage> m_cache;
+    QCache<TileId, const ElevationTile> m_cache;
     GeoSceneDocument *m_srtmTheme;
+
+    int m_tileZoomLevel;
+    int m_tileWidth;
+    int m_tileHeight;
+    int m_numTilesX;
+    int m_numTilesY;
+
+    QMutex m_cacheMutex;
+    QMutex m_tileLoaderMutex;
+    QThreadPool m_threadPool;
 };
 
 ElevationModel::ElevationModel( HttpDownloadManager *downloadManager, PluginManager* pluginManager, QObject *parent ) :
@@ -100,76 +345,35 @@ qreal ElevationModel::height( qreal lon, qreal lat ) const
         return invalidElevationData;
     }
 
-    const int tileZoomLevel = TileLoader::maximumTileLevel( *( d->m_textureLayer ) );
-    Q_ASSERT( tileZoomLevel == 9 );
-
-    const int width = d->m_textureLayer->tileSize().width();
-    const int height = d->m_textureLayer->tileSize().height();
-
-    const int numTilesX = TileLoaderHelper::levelToColumn( d->m_textureLayer->levelZeroColumns(), tileZoomLevel );
-    const int numTilesY = TileLoaderHelper::levelToRow( d->m_textureLayer->levelZeroRows(), tileZoomLevel );
-    Q_ASSERT( numTilesX > 0 );
-    Q_ASSERT( numTilesY > 0 );
-
-    qreal textureX = 180 + lon;
-    textureX *= numTilesX * width / 360;
-
-    qreal textureY = 90 - lat;
-    textureY *= numTilesY * height / 180;
-
-    qreal ret = 0;
-    bool hasHeight = false;
-    qreal noData = 0;
-
-    for ( int i = 0; i < 4; ++i ) {
-        const int x = static_cast<int>( textureX + ( i % 2 ) );
-        const int y = static_cast<int>( textureY + ( i / 2 ) );
-
-        //mDebug() << "x" << x << ( x / width );
-        //mDebug() << "y" << y << ( y / height );
+    return d->height( lon, lat, [this]( const TileId &id ) { return d->tile( id ); } );
+}
 
-        const TileId id( 0, tileZoomLevel, ( x % ( numTilesX * width ) ) / width, ( y % ( numTilesY * height ) ) / height );
-        //mDebug() << "LAT" << lat << "LON" << lon << "tile" << ( x % ( numTilesX * width ) ) / width << ( y % ( numTilesY * height ) ) / height;
+QFuture<QVector<qreal> > ElevationModel::heights( const QVector<GeoDataCoordinates> &coordinates ) const
+{
+    return QtConcurrent::run( &d->m_threadPool, d, &ElevationModelPrivate::heights, coordinates );
+}
 
-        const QImage *image = d->m_cache[id];
-        if ( image == nullptr ) {
-            image = new QImage( d->m_tileLoader.loadTileImage( d->m_textureLayer, id, DownloadBrowse ) );
-            d->m_cache.insert( id, image );
-        }
-        Q_ASSERT( image );
-        Q_ASSERT( !image->isNull() );
-        Q_ASSERT( width == image->width() );
-        Q_ASSERT( height == image->height() );
-
-        const qreal dx = ( textureX > ( qreal )x ) ? textureX - ( qreal )x : ( qreal )x - textureX;
-        const qreal dy = ( textureY > ( qreal )y ) ? textureY - ( qreal )y : ( qreal )y - textureY;
-
-        Q_ASSERT( 0 <= dx && dx <= 1 );
-        Q_ASSERT( 0 <= dy && dy <= 1 );
-        unsigned int pixel = image->pixel( x % width, y % height ) & 0xffff; // 16 valid bits
-        short int elevation = (short int) pixel; // and signed type, so just cast it
-        //mDebug() << "(1-dx)" << (1-dx) << "(1-dy)" << (1-dy);
-        if ( pixel != invalidElevationData ) { //no data?
-            //mDebug() << "got at x" << x % width << "y" << y % height << "a height of" << pixel << "** RGB" << qRed(pixel) << qGreen(pixel) << qBlue(pixel);
-            ret += ( qreal )elevation * ( 1 - dx ) * ( 1 - dy );
-            hasHeight = true;
-        } else {
-            //mDebug() << "no data at" <<  x % width << "y" << y % height;
-            noData += ( 1 - dx ) * ( 1 - dy );
-        }
+QFuture<QVector<qreal> > ElevationModel::heights( const GeoDataLineString &lineString ) const
+{
+    QVector<GeoDataCoordinates> coordinates;
+    coordinates.reserve( lineString.size() );
+    for ( const GeoDataCoordinates &coordinate: lineString ) {
+        coordinates << coordinate;
     }
 
-    if ( !hasHeight ) {
-        ret = invalidElevationData; //no data
-    } else {
-        if ( noData ) {
-            //mDebug() << "NO DATA" << noData;
-            ret += ( ret / ( 1 - noData ) ) * noData;
-        }
-    }
+    return heights( coordinates );
+}
 
-    //mDebug() << ">>>" << lat << lon << "returning an elevation of" << ret;
-    return ret;
+void ElevationModel::setCacheSize( int tiles )
+{
+    QMutexLocker locker( &d->m_cacheMutex );
+    d->m_cache.setMaxCost( tiles );
+}
+
+int ElevationModel::cacheSize() const
+{
+    QMutexLocker locker( &d->m_cacheMutex );
+    return d->m_cache.maxCost();
 }
 
 QVector<GeoDataCoordinates> ElevationModel::heightProfile( qreal fromLon, qreal fromLat, qreal toLon, qreal toLat ) const
@@ -14,13 +14,16 @@
 
 #include "marble_export.h"
 
+#include <QFuture>
 #include <QObject>
+#include <QVector>
 
 class QImage;
 
 namespace Marble
 {
 class GeoDataCoordinates;
+class GeoDataLineString;
 
 namespace {
     unsigned int const invalidElevationData = 32768;
@@ -41,6 +44,28 @@ public:
     qreal height( qreal lon, qreal lat ) const;
     QVector<GeoDataCoordinates> heightProfile( qreal fromLon, qreal fromLat, qreal toLon, qreal toLat ) const;
 
+    /**
+     * Returns the elevation of all @p coordinates, in the same order.
+     * Positions without elevation data yield invalidElevationData.
+     *
+     * The query runs in the background and loads the required elevation
+     * tiles in parallel, so it does not block the calling thread unless
+     * the result of the returned future is accessed before it finished.
+     */
+    QFuture<QVector<qreal> > heights( const QVector<GeoDataCoordinates> &coordinates ) const;
+
+    /**
+     * Convenience overload returning the elevation of all nodes of @p lineString.
+     */
+    QFuture<QVector<qreal> > heights( const GeoDataLineString &lineString ) const;
+
+    /**
+     * Sets the number of decoded elevation tiles kept in memory.
+     * Each tile takes two bytes per elevation sample (about 0.9 MB for SRTM tiles).
+     */
+    void setCacheSize( int tiles );
+    int cacheSize() const;
+
 Q_SIGNALS:
     /**
      * Elevation tiles loaded. You will get more accurate results when querying height
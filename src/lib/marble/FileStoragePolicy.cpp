@@ -22,12 +22,23 @@
 #include "MarbleDebug.h"
 #include "MarbleGlobal.h"
 #include "MarbleDirs.h"
+#include "TileStore.h"
 
 using namespace Marble;
 
+static bool isImageFileName( const QString &fileName )
+{
+    const QString lowerCase = fileName.toLower();
+    return lowerCase.endsWith( QLatin1String( ".jpg" ) )
+        || lowerCase.endsWith( QLatin1String( ".png" ) )
+        || lowerCase.endsWith( QLatin1String( ".gif" ) )
+        || lowerCase.endsWith( QLatin1String( ".svg" ) );
+}
+
 FileStoragePolicy::FileStoragePolicy( const QString &dataDirectory, QObject *parent )
     : StoragePolicy( parent ),
-      m_dataDirectory( dataDirectory )
+      m_dataDirectory( dataDirectory ),
+      m_tileStore( nullptr )
 {
     if ( m_dataDirectory.isEmpty() )
         m_dataDirectory = MarbleDirs::localPath() + QLatin1String("/cache/");
@@ -40,8 +51,17 @@ FileStoragePolicy::~FileStoragePolicy()
 {
 }
 
+void FileStoragePolicy::setTileStore( TileStore *tileStore )
+{
+    m_tileStore = tileStore;
+}
+
 bool FileStoragePolicy::fileExists( const QString &fileName ) const
 {
+    if ( m_tileStore && m_tileStore->contains( fileName ) ) {
+        return true;
+    }
+
     const QString fullName = m_dataDirectory + QLatin1Char('/') + fileName;
     return QFile::exists( fullName );
 }
@@ -51,6 +71,19 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
     QFileInfo const dirInfo( fileName );
     QString const fullName = dirInfo.isAbsolute() ? fileName : m_dataDirectory + QLatin1Char('/') + fileName;
 
+    if ( m_tileStore && !dirInfo.isAbsolute() && isImageFileName( fileName ) ) {
+        if ( m_tileStore->insert( fileName, data ) ) {
+            // The tile store takes precedence, so a previously downloaded file is obsolete
+            if ( QFile::exists( fullName ) ) {
+                emit sizeChanged( -QFileInfo( fullName ).size() );
+                QFile::remove( fullName );
+            }
+            return true;
+        }
+
+        mDebug() << "Cannot insert" << fileName << "into the tile store, writing it to a file instead";
+    }
+
     // Create directory if it doesn't exist yet...
     QFileInfo info( fullName );
 
@@ -91,6 +124,18 @@ void FileStoragePolicy::clearCache()
         return;
     }
 
+    if ( m_tileStore ) {
+        QStringList obsoleteTiles;
+        for ( const QString &key: m_tileStore->keys() ) {
+            // maps/<planet>/<theme>/<level>/...
+            const QStringList path = key.split( QLatin1Char( '/' ) );
+            if ( path.size() > 4 && path[0] == QLatin1String( "maps" ) && path[3].toInt() > maxBaseTileLevel ) {
+                obsoleteTiles << key;
+            }
+        }
+        m_tileStore->remove( obsoleteTiles );
+    }
+
     const QString cachedMapsDirectory = m_dataDirectory + QLatin1String("/maps");
 
     QDirIterator it( cachedMapsDirectory, QDir::NoDotAndDotDot | QDir::Dirs );
@@ -115,16 +160,11 @@ void FileStoragePolicy::clearCache()
                 while (itTile.hasNext()) {
                     itTile.next();
                     QString filePath = itTile.filePath();
-                    QString lowerCase = filePath.toLower();
 
                     // We try to be very careful and just delete images
                     // FIXME, when vectortiling I suppose also vector tiles will have
                     // to be deleted
-                    if ( lowerCase.endsWith( QLatin1String( ".jpg" ) ) 
-                      || lowerCase.endsWith( QLatin1String( ".png" ) )
-                      || lowerCase.endsWith( QLatin1String( ".gif" ) )
-                      || lowerCase.endsWith( QLatin1String( ".svg" ) )
-                    )
+                    if ( isImageFileName( filePath ) )
                     {
                         // We cannot emit clear, because we don't make a full clear
                         QFile file( filePath );
@@ -16,6 +16,8 @@
 namespace Marble
 {
 
+class TileStore;
+
 class FileStoragePolicy : public StoragePolicy
 {
     Q_OBJECT
@@ -34,6 +36,12 @@ class FileStoragePolicy : public StoragePolicy
          */
         ~FileStoragePolicy() override;
 
+        /**
+         * Keeps tile images in @p tileStore instead of one file per tile.
+         * Other files and files with an absolute path are still written to disk.
+         */
+        void setTileStore( TileStore *tileStore );
+
         /**
          * Returns whether the @p fileName exists already.
          */
@@ -59,6 +67,7 @@ class FileStoragePolicy : public StoragePolicy
 	
         QString m_dataDirectory;
         QString m_errorMsg;
+        TileStore *m_tileStore;
 };
 
 }
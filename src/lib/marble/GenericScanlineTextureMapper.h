@@ -36,6 +36,8 @@ class GenericScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer ) override;
 
+    LoadStatistics loadStatistics() const override;
+
  private:
     class RenderJob;
 
@@ -45,6 +47,7 @@ class GenericScanlineTextureMapper : public TextureMapperInterface
     int m_radius;
     QImage m_canvasImage;
     QThreadPool m_threadPool;
+    LoadStatistics m_loadStatistics;
 };
 
 }
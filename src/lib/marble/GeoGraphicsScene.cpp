@@ -17,16 +17,316 @@
 #include "GeoDataPlacemark.h"
 #include "GeoDataDocument.h"
 #include "GeoGraphicsItem.h"
-#include "TileId.h"
-#include "TileCoordsPyramid.h"
 #include "MarbleDebug.h"
 
-#include <QMap>
-#include <QRect>
+#include <QHash>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <algorithm>
 
 namespace Marble
 {
 
+/**
+ * A packed R-tree of graphics items. The tree is bulk loaded from the items
+ * sorted along a Hilbert curve through the centers of their bounding boxes,
+ * which keeps nearby items in the same nodes. Items added after the tree has
+ * been built are scanned linearly until there are enough of them to make
+ * rebuilding the tree worthwhile, so adding a batch of items only costs a
+ * single rebuild on the next query.
+ */
+class PackedItemTree
+{
+public:
+    struct Box
+    {
+        qreal west;
+        qreal south;
+        qreal east;
+        qreal north;
+
+        bool intersects(const Box &other) const
+        {
+            return west <= other.east && other.west <= east && south <= other.north && other.south <= north;
+        }
+
+        void unite(const Box &other)
+        {
+            west = qMin(west, other.west);
+            south = qMin(south, other.south);
+            east = qMax(east, other.east);
+            north = qMax(north, other.north);
+        }
+    };
+
+    struct Query
+    {
+        Query(qreal west, qreal south, qreal east, qreal north);
+
+        Box box;
+        GeoDataLatLonBox latLonBox;
+    };
+
+    PackedItemTree();
+
+    void insert(GeoGraphicsItem *item);
+    void remove(GeoGraphicsItem *item);
+    bool isEmpty() const;
+
+    /**
+     * Calls @p visitor for each item intersecting @p query, except for those
+     * which also intersect one of @p excluded, e.g. the other half of a query
+     * box split at the date line.
+     */
+    template<typename Visitor>
+    void visit(const Query &query, const QVector<Query> &excluded, Visitor visitor);
+
+    /**
+     * Returns the queries covering @p box, two of them if it crosses the date line.
+     */
+    static QVector<Query> queries(const GeoDataLatLonBox &box);
+
+private:
+    struct Entry
+    {
+        Box box;
+        quint64 hilbertIndex;
+        GeoGraphicsItem *item;
+        bool crossesDateLine;
+    };
+
+    static quint64 hilbertIndex(qreal lon, qreal lat);
+    static bool matches(const Entry &entry, const Query &query);
+    bool needsBuild() const;
+    void build();
+    int levelSize(int level) const;
+
+    /// entries [0, m_indexedCount) are covered by the tree, the rest are scanned linearly
+    QVector<Entry> m_entries;
+    int m_indexedCount;
+    int m_removedCount;
+    QHash<GeoGraphicsItem *, int> m_positions;
+
+    /// node boxes of all tree levels, starting with the level above the entries
+    QVector<Box> m_nodes;
+    QVector<int> m_levelOffsets;
+};
+
+// Number of children of a tree node
+static const int nodeSize = 16;
+// Side length of the Hilbert curve grid
+static const quint32 hilbertSize = 1 << 16;
+
+PackedItemTree::Query::Query(qreal west, qreal south, qreal east, qreal north) :
+    latLonBox(north, south, east, west)
+{
+    box.west = west;
+    box.south = south;
+    box.east = east;
+    box.north = north;
+}
+
+PackedItemTree::PackedItemTree() :
+    m_indexedCount(0),
+    m_removedCount(0)
+{
+}
+
+void PackedItemTree::insert(GeoGraphicsItem *item)
+{
+    Entry entry;
+    qreal north, south, east, west;
+    item->latLonAltBox().boundaries(north, south, east, west);
+    entry.crossesDateLine = GeoDataLatLonBox::crossesDateLine(east, west);
+    if (entry.crossesDateLine) {
+        // such items are checked against their actual box once this one matches
+        west = -M_PI;
+        east = M_PI;
+    }
+    entry.box.west = west;
+    entry.box.south = south;
+    entry.box.east = east;
+    entry.box.north = north;
+    entry.hilbertIndex = hilbertIndex((west + east) / 2, (south + north) / 2);
+    entry.item = item;
+
+    m_positions.insert(item, m_entries.size());
+    m_entries.append(entry);
+}
+
+void PackedItemTree::remove(GeoGraphicsItem *item)
+{
+    auto const position = m_positions.find(item);
+    if (position != m_positions.end()) {
+        m_entries[*position].item = nullptr;
+        m_positions.erase(position);
+        ++m_removedCount;
+    }
+}
+
+bool PackedItemTree::isEmpty() const
+{
+    return m_positions.isEmpty();
+}
+
+quint64 PackedItemTree::hilbertIndex(qreal lon, qreal lat)
+{
+    quint32 x = quint32(qBound<qreal>(0.0, (lon + M_PI) / (2 * M_PI), 1.0) * (hilbertSize - 1));
+    quint32 y = quint32(qBound<qreal>(0.0, (lat + M_PI / 2) / M_PI, 1.0) * (hilbertSize - 1));
+
+    quint64 result = 0;
+    for (quint32 s = hilbertSize / 2; s > 0; s /= 2) {
+        quint32 const rx = (x & s) ? 1 : 0;
+        quint32 const ry = (y & s) ? 1 : 0;
+        result += quint64(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = hilbertSize - 1 - x;
+                y = hilbertSize - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return result;
+}
+
+bool PackedItemTree::matches(const Entry &entry, const Query &query)
+{
+    return entry.item && entry.box.intersects(query.box)
+            && (!entry.crossesDateLine || entry.item->latLonAltBox().intersects(query.latLonBox));
+}
+
+bool PackedItemTree::needsBuild() const
+{
+    int const pending = m_entries.size() - m_indexedCount;
+    return pending > qMax(256, m_indexedCount / 4) || m_removedCount > m_entries.size() / 2;
+}
+
+int PackedItemTree::levelSize(int level) const
+{
+    int const end = level + 1 < m_levelOffsets.size() ? m_levelOffsets[level + 1] : m_nodes.size();
+    return end - m_levelOffsets[level];
+}
+
+void PackedItemTree::build()
+{
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                   [](const Entry &entry) { return entry.item == nullptr; }),
+                    m_entries.end());
+    std::sort(m_entries.begin(), m_entries.end(),
+              [](const Entry &a, const Entry &b) { return a.hilbertIndex < b.hilbertIndex; });
+    m_removedCount = 0;
+    m_indexedCount = m_entries.size();
+
+    m_positions.clear();
+    m_positions.reserve(m_entries.size());
+    for (int i = 0; i < m_entries.size(); ++i) {
+        m_positions.insert(m_entries[i].item, i);
+    }
+
+    m_nodes.clear();
+    m_levelOffsets.clear();
+    if (m_entries.isEmpty()) {
+        return;
+    }
+
+    // the lowest level groups the entries, each further level the nodes below
+    m_levelOffsets << 0;
+    for (int i = 0; i < m_entries.size(); i += nodeSize) {
+        Box box = m_entries[i].box;
+        for (int j = i + 1; j < qMin(i + nodeSize, m_entries.size()); ++j) {
+            box.unite(m_entries[j].box);
+        }
+        m_nodes << box;
+    }
+
+    while (levelSize(m_levelOffsets.size() - 1) > 1) {
+        int const offset = m_levelOffsets.last();
+        int const size = levelSize(m_levelOffsets.size() - 1);
+        m_levelOffsets << m_nodes.size();
+        for (int i = 0; i < size; i += nodeSize) {
+            Box box = m_nodes[offset + i];
+            for (int j = i + 1; j < qMin(i + nodeSize, size); ++j) {
+                box.unite(m_nodes[offset + j]);
+            }
+            m_nodes << box;
+        }
+    }
+}
+
+QVector<PackedItemTree::Query> PackedItemTree::queries(const GeoDataLatLonBox &box)
+{
+    QVector<Query> result;
+    if (box.isEmpty()) {
+        return result;
+    }
+
+    qreal north, south, east, west;
+    box.boundaries(north, south, east, west);
+    if (west > east) {
+        // Handle boxes crossing the IDL by splitting it into two separate boxes.
+        result << Query(-M_PI, south, east, north) << Query(west, south, M_PI, north);
+    } else {
+        result << Query(west, south, east, north);
+    }
+    return result;
+}
+
+template<typename Visitor>
+void PackedItemTree::visit(const Query &query, const QVector<Query> &excluded, Visitor visitor)
+{
+    if (needsBuild()) {
+        build();
+    }
+
+    auto const visitEntry = [&](const Entry &entry) {
+        if (!matches(entry, query)) {
+            return;
+        }
+        for (const Query &other: excluded) {
+            if (matches(entry, other)) {
+                return;
+            }
+        }
+        visitor(entry.item);
+    };
+
+    if (!m_levelOffsets.isEmpty()) {
+        // pairs of level and node index within the level
+        QVarLengthArray<QPair<int, int>, 128> stack;
+        int const topLevel = m_levelOffsets.size() - 1;
+        for (int i = 0; i < levelSize(topLevel); ++i) {
+            stack.append(qMakePair(topLevel, i));
+        }
+
+        while (!stack.isEmpty()) {
+            auto const node = stack.last();
+            stack.removeLast();
+            if (!m_nodes[m_levelOffsets[node.first] + node.second].intersects(query.box)) {
+                continue;
+            }
+
+            int const first = node.second * nodeSize;
+            if (node.first == 0) {
+                int const last = qMin(first + nodeSize, m_indexedCount);
+                for (int i = first; i < last; ++i) {
+                    visitEntry(m_entries[i]);
+                }
+            } else {
+                int const last = qMin(first + nodeSize, levelSize(node.first - 1));
+                for (int i = first; i < last; ++i) {
+                    stack.append(qMakePair(node.first - 1, i));
+                }
+            }
+        }
+    }
+
+    for (int i = m_indexedCount; i < m_entries.size(); ++i) {
+        visitEntry(m_entries[i]);
+    }
+}
+
 class GeoGraphicsScenePrivate
 {
 public:
@@ -41,9 +341,11 @@ public:
         q->clear();
     }
 
-    typedef QHash<const GeoDataFeature*,GeoGraphicsItem*> FeatureItemMap;
-    QHash<TileId, FeatureItemMap> m_tiledItems;
-    QMultiHash<const GeoDataFeature*, TileId> m_features; // multi hash because multi track and multi geometry insert multiple items
+    // One tree per minimum zoom level, so that queries skip the trees of the items not shown yet
+    QVector<PackedItemTree> m_trees;
+    QMultiHash<const GeoDataFeature*, GeoGraphicsItem*> m_features; // multi hash because multi track and multi geometry insert multiple items
+    // The tree each item has been inserted into, the minimum zoom level of the item may change later on
+    QHash<GeoGraphicsItem*, int> m_itemTrees;
 
     // Stores the items which have been clicked;
     QList<GeoGraphicsItem*> m_selectedItems;
@@ -94,61 +396,42 @@ GeoGraphicsScene::~GeoGraphicsScene()
 
 QList< GeoGraphicsItem* > GeoGraphicsScene::items( const GeoDataLatLonBox &box, int zoomLevel ) const
 {
-    if ( box.west() > box.east() ) {
-        // Handle boxes crossing the IDL by splitting it into two separate boxes
-        GeoDataLatLonBox left;
-        left.setWest( -M_PI );
-        left.setEast( box.east() );
-        left.setNorth( box.north() );
-        left.setSouth( box.south() );
-
-        GeoDataLatLonBox right;
-        right.setWest( box.west() );
-        right.setEast( M_PI );
-        right.setNorth( box.north() );
-        right.setSouth( box.south() );
-
-        return items(left, zoomLevel) + items(right, zoomLevel);
-    }
-
     QList< GeoGraphicsItem* > result;
-    QRect rect;
-    qreal north, south, east, west;
-    box.boundaries( north, south, east, west );
-    TileId key;
-
-    key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel );
-    rect.setLeft( key.x() );
-    rect.setTop( key.y() );
-
-    key = TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel );
-    rect.setRight( key.x() );
-    rect.setBottom( key.y() );
-    
-    TileCoordsPyramid pyramid( 0, zoomLevel );
-    pyramid.setBottomLevelCoords( rect );
-
-    for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
-        QRect const coords = pyramid.coords( level );
-        int x1, y1, x2, y2;
-        coords.getCoords( &x1, &y1, &x2, &y2 );
-        for ( int x = x1; x <= x2; ++x ) {
-            bool const isBorderX = x == x1 || x == x2;
-            for ( int y = y1; y <= y2; ++y ) {
-                bool const isBorder = isBorderX || y == y1 || y == y2;
-                const TileId tileId = TileId( 0, level, x, y );
-                for(GeoGraphicsItem *object: d->m_tiledItems.value( tileId )) {
-                    if (object->minZoomLevel() <= zoomLevel && object->visible()) {
-                        if (!isBorder || object->latLonAltBox().intersects(box)) {
-                            result.push_back(object);
-                        }
-                    }
-                }
-            }
+    visitItems(box, zoomLevel, [&result](GeoGraphicsItem *item) {
+        result.push_back(item);
+    });
+    return result;
+}
+
+void GeoGraphicsScene::visitItems(const GeoDataLatLonBox &box, int zoomLevel,
+                                  const std::function<void(GeoGraphicsItem *)> &visitor) const
+{
+    visitItems(box, GeoDataLatLonBox(), zoomLevel, visitor);
+}
+
+void GeoGraphicsScene::visitItems(const GeoDataLatLonBox &box, const GeoDataLatLonBox &excluded, int zoomLevel,
+                                  const std::function<void(GeoGraphicsItem *)> &visitor) const
+{
+    auto const visitVisible = [&visitor, zoomLevel](GeoGraphicsItem *item) {
+        if (item->minZoomLevel() <= zoomLevel && item->visible()) {
+            visitor(item);
+        }
+    };
+
+    QVector<PackedItemTree::Query> excludedQueries = PackedItemTree::queries(excluded);
+    int const lastTree = qMin(zoomLevel, d->m_trees.size() - 1);
+    for (const PackedItemTree::Query &query: PackedItemTree::queries(box)) {
+        for (int i = 0; i <= lastTree; ++i) {
+            d->m_trees[i].visit(query, excludedQueries, visitVisible);
         }
+        // Items intersecting both halves of a box crossing the IDL are visited with the left one only.
+        excludedQueries << query;
     }
+}
 
-    return result;
+QList<GeoGraphicsItem *> GeoGraphicsScene::items(const GeoDataFeature *feature) const
+{
+    return d->m_features.values(feature);
 }
 
 QList< GeoGraphicsItem* > GeoGraphicsScene::selectedItems() const
@@ -158,10 +441,8 @@ QList< GeoGraphicsItem* > GeoGraphicsScene::selectedItems() const
 
 void GeoGraphicsScene::resetStyle()
 {
-    for (auto const & items: d->m_tiledItems) {
-        for (auto item: items) {
-            item->resetStyle();
-        }
+    for (auto item: d->m_features) {
+        item->resetStyle();
     }
     emit repaintNeeded();
 }
@@ -185,42 +466,35 @@ void GeoGraphicsScene::applyHighlight( const QVector< GeoDataPlacemark* > &selec
      * items to use highlight style
      */
     for( const GeoDataPlacemark *placemark: selectedPlacemarks ) {
-        for (auto tileIter = d->m_features.find(placemark); tileIter != d->m_features.end() && tileIter.key() == placemark; ++tileIter) {
-            auto const & clickedItemsList = d->m_tiledItems.values(*tileIter);
-            for (auto const & clickedItems: clickedItemsList) { //iterate through FeatureItemMap clickedItems (QHash)
-                for (auto iter = clickedItems.find(placemark); iter != clickedItems.end(); ++iter) {
-                    if ( iter.key() == placemark ) {
-                const GeoDataObject *parent = placemark->parent();
-                if ( parent ) {
-                    auto item = *iter;
-                    if (const GeoDataDocument *doc = geodata_cast<GeoDataDocument>(parent)) {
-                        QString styleUrl = placemark->styleUrl();
-                        styleUrl.remove(QLatin1Char('#'));
-                        if ( !styleUrl.isEmpty() ) {
-                            GeoDataStyleMap const &styleMap = doc->styleMap( styleUrl );
+        for (auto iter = d->m_features.find(placemark); iter != d->m_features.end() && iter.key() == placemark; ++iter) {
+            const GeoDataObject *parent = placemark->parent();
+            if ( parent ) {
+                auto item = *iter;
+                if (const GeoDataDocument *doc = geodata_cast<GeoDataDocument>(parent)) {
+                    QString styleUrl = placemark->styleUrl();
+                    styleUrl.remove(QLatin1Char('#'));
+                    if ( !styleUrl.isEmpty() ) {
+                        GeoDataStyleMap const &styleMap = doc->styleMap( styleUrl );
+                        GeoDataStyle::Ptr style = d->highlightStyle( doc, styleMap );
+                        if ( style ) {
+                            d->selectItem( item );
+                            d->applyHighlightStyle( item, style );
+                        }
+                    }
+
+                    /**
+                     * If a placemark is using an inline style instead of a shared
+                     * style ( e.g in case when theme file specifies the colorMap
+                     * attribute ) then highlight it if any of the style maps have a
+                     * highlight styleId
+                     */
+                    else {
+                        for ( const GeoDataStyleMap &styleMap: doc->styleMaps() ) {
                             GeoDataStyle::Ptr style = d->highlightStyle( doc, styleMap );
                             if ( style ) {
                                 d->selectItem( item );
                                 d->applyHighlightStyle( item, style );
-                            }
-                        }
-
-                        /**
-                            * If a placemark is using an inline style instead of a shared
-                            * style ( e.g in case when theme file specifies the colorMap
-                            * attribute ) then highlight it if any of the style maps have a
-                            * highlight styleId
-                            */
-                        else {
-                            for ( const GeoDataStyleMap &styleMap: doc->styleMaps() ) {
-                                GeoDataStyle::Ptr style = d->highlightStyle( doc, styleMap );
-                                if ( style ) {
-                                    d->selectItem( item );
-                                    d->applyHighlightStyle( item, style );
-                                    break;
-                                }
-                            }
-                        }
+                                break;
                             }
                         }
                     }
@@ -233,48 +507,33 @@ void GeoGraphicsScene::applyHighlight( const QVector< GeoDataPlacemark* > &selec
 
 void GeoGraphicsScene::removeItem( const GeoDataFeature* feature )
 {
-    for (auto tileIter = d->m_features.find(feature), end = d->m_features.end(); tileIter != end && tileIter.key() == feature;) {
-        auto & tileList = d->m_tiledItems[*tileIter];
-        auto iter = tileList.find(feature);
-        if (iter != tileList.end()) {
-            auto item = iter.value();
-            tileIter = d->m_features.erase(tileIter);
-            tileList.erase(iter);
-            delete item;
-        } else {
-            ++tileIter;
-        }
+    for (auto iter = d->m_features.find(feature); iter != d->m_features.end() && iter.key() == feature;) {
+        auto item = iter.value();
+        d->m_trees[d->m_itemTrees.take(item)].remove(item);
+        d->m_selectedItems.removeAll(item);
+        iter = d->m_features.erase(iter);
+        delete item;
     }
 }
 
 void GeoGraphicsScene::clear()
 {
-    for(auto const &list: d->m_tiledItems.values()) {
-        qDeleteAll(list.values());
-    }
-    d->m_tiledItems.clear();
+    qDeleteAll(d->m_features);
+    d->m_trees.clear();
     d->m_features.clear();
+    d->m_itemTrees.clear();
+    d->m_selectedItems.clear();
 }
 
 void GeoGraphicsScene::addItem( GeoGraphicsItem* item )
 {
-    // Select zoom level so that the object fit in single tile
-    int zoomLevel;
-    qreal north, south, east, west;
-    item->latLonAltBox().boundaries( north, south, east, west );
-    for(zoomLevel = item->minZoomLevel(); zoomLevel >= 0; zoomLevel--)
-    {
-        if( TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ) ==
-            TileId::fromCoordinates( GeoDataCoordinates(east, south, 0), zoomLevel ) )
-            break;
+    int const tree = qMax(0, item->minZoomLevel());
+    if (tree >= d->m_trees.size()) {
+        d->m_trees.resize(tree + 1);
     }
-
-    const TileId key = TileId::fromCoordinates( GeoDataCoordinates(west, north, 0), zoomLevel ); // same as GeoDataCoordinates(east, south, 0), see above
-
-    auto & tileList = d->m_tiledItems[key];
-    auto feature = item->feature();
-    tileList.insertMulti(feature, item);
-    d->m_features.insert(feature, key );
+    d->m_trees[tree].insert(item);
+    d->m_itemTrees.insert(item, tree);
+    d->m_features.insert(item->feature(), item);
 }
 
 }
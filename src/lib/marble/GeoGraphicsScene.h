@@ -18,6 +18,8 @@
 #include <QObject>
 #include <QList>
 
+#include <functional>
+
 namespace Marble
 {
 
@@ -68,6 +70,39 @@ public:
      */
     QList<GeoGraphicsItem *> items( const GeoDataLatLonBox &box, int maxZoomLevel ) const;
 
+    /**
+     * @brief Call a function for each item in the specified box
+     *
+     * Visits the same items as items() without building a list of them.
+     * Each item is visited once, even if the box crosses the date line.
+     *
+     * @param box The box around the items.
+     * @param maxZoomLevel The max zoom level of tiling
+     * @param visitor The function to call for each item.
+     */
+    void visitItems( const GeoDataLatLonBox &box, int maxZoomLevel,
+                     const std::function<void(GeoGraphicsItem *)> &visitor ) const;
+
+    /**
+     * @brief Call a function for each item in a box which is not in another one
+     *
+     * Visits the items which visitItems() visits for @p box, but not for
+     * @p excluded. Together with a query of @p excluded excluding @p box,
+     * this yields the items entering and leaving a view that moved.
+     *
+     * @param box The box around the items.
+     * @param excluded The box around the items not to visit.
+     * @param maxZoomLevel The max zoom level of tiling
+     * @param visitor The function to call for each item.
+     */
+    void visitItems( const GeoDataLatLonBox &box, const GeoDataLatLonBox &excluded, int maxZoomLevel,
+                     const std::function<void(GeoGraphicsItem *)> &visitor ) const;
+
+    /**
+     * @brief Get the items which belong to @p feature
+     */
+    QList<GeoGraphicsItem *> items( const GeoDataFeature *feature ) const;
+
     /**
      * @brief Get the list of items which belong to a placemark
      * that has been clicked.
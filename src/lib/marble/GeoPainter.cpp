@@ -848,8 +848,6 @@ void GeoPainter::drawPolygon ( const GeoDataPolygon & polygon,
     QVector<QPolygonF*> innerPolygons;
     d->m_viewport->screenCoordinates( polygon.outerBoundary(), outerPolygons );
 
-    QPen const currentPen = pen();
-
     bool const hasInnerBoundaries = !polygon.innerBoundaries().isEmpty();
     bool innerBoundariesOnScreen = false;
 
@@ -876,34 +874,47 @@ void GeoPainter::drawPolygon ( const GeoDataPolygon & polygon,
                     innerPolygons << innerPolygonPerBoundary;
                 }
             }
+        }
+    }
 
-            setPen(Qt::NoPen);
-            QVector<QPolygonF*> fillPolygons = createFillPolygons( outerPolygons,
-                                                                   innerPolygons );
+    // Without inner boundaries on screen only the outer polygons are drawn
+    drawScreenPolygons( outerPolygons, innerPolygons, fillRule );
 
-            for( const QPolygonF* fillPolygon: fillPolygons ) {
-                ClipPainter::drawPolygon(*fillPolygon, fillRule);
-            }
+    qDeleteAll(outerPolygons);
+    qDeleteAll(innerPolygons);
+}
+
+void GeoPainter::drawScreenPolygons( const QVector<QPolygonF*> & outerPolygons,
+                                     const QVector<QPolygonF*> & innerPolygons,
+                                     Qt::FillRule fillRule )
+{
+    if ( innerPolygons.isEmpty() ) {
+        for( const QPolygonF* outerPolygon: outerPolygons ) {
+            ClipPainter::drawPolygon( *outerPolygon, fillRule );
+        }
+        return;
+    }
 
-            setPen(currentPen);
+    QPen const currentPen = pen();
 
-            for( const QPolygonF* outerPolygon: outerPolygons ) {
-                ClipPainter::drawPolyline( *outerPolygon );
-            }
-            for( const QPolygonF* innerPolygon: innerPolygons ) {
-                ClipPainter::drawPolyline( *innerPolygon );
-            }
+    setPen(Qt::NoPen);
+    QVector<QPolygonF*> fillPolygons = createFillPolygons( outerPolygons,
+                                                           innerPolygons );
 
-            qDeleteAll(fillPolygons);
-        }
+    for( const QPolygonF* fillPolygon: fillPolygons ) {
+        ClipPainter::drawPolygon(*fillPolygon, fillRule);
     }
 
-    if ( !hasInnerBoundaries || !innerBoundariesOnScreen ) {
-        drawPolygon( polygon.outerBoundary(), fillRule );
+    setPen(currentPen);
+
+    for( const QPolygonF* outerPolygon: outerPolygons ) {
+        ClipPainter::drawPolyline( *outerPolygon );
+    }
+    for( const QPolygonF* innerPolygon: innerPolygons ) {
+        ClipPainter::drawPolyline( *innerPolygon );
     }
 
-    qDeleteAll(outerPolygons);
-    qDeleteAll(innerPolygons);
+    qDeleteAll(fillPolygons);
 }
 
 QVector<QPolygonF*> GeoPainter::createFillPolygons( const QVector<QPolygonF*> & outerPolygons,
@@ -434,6 +434,20 @@ class MARBLE_EXPORT GeoPainter : public ClipPainter
 
     QVector<QPolygonF*> createFillPolygons( const QVector<QPolygonF*> & outerPolygons,
                                             const QVector<QPolygonF*> & innerPolygons ) const;
+
+/*!
+    \brief Draws a polygon given by its screen polygons.
+
+    Paints like drawPolygon( GeoDataPolygon ), but for the screen polygons of
+    the outer boundary and the inner boundaries. This allows items to keep
+    the projected polygons across frames. If \a innerPolygons is empty, the
+    \a outerPolygons are drawn like drawPolygon( GeoDataLinearRing ) does.
+
+    \see ViewportParams::screenCoordinates()
+*/
+    void drawScreenPolygons( const QVector<QPolygonF*> & outerPolygons,
+                             const QVector<QPolygonF*> & innerPolygons,
+                             Qt::FillRule fillRule = Qt::OddEvenFill );
     
 /*!
     \brief Draws a rectangle at the given position.
@@ -42,6 +42,7 @@ class Q_DECL_HIDDEN HttpDownloadManager::Private
     void startRetryTimer();
 
     DownloadQueueSet *findQueues( const QString& hostName, const DownloadUsage usage );
+    QList<DownloadQueueSet *> queueSets( const DownloadUsage usage ) const;
 
     HttpDownloadManager* m_downloadManager;
     QTimer m_requeueTimer;
@@ -68,6 +69,9 @@ HttpDownloadManager::Private::Private(HttpDownloadManager *parent, StoragePolicy
     // setup default download policy and associated queue set
     DownloadPolicy defaultBrowsePolicy;
     defaultBrowsePolicy.setMaximumConnections( 20 );
+    // QNetworkAccessManager opens at most 6 connections per host, further requests
+    // would wait in its queue where they cannot be reordered anymore
+    defaultBrowsePolicy.setMaximumConnectionsPerHost( 6 );
     m_defaultQueueSets[ DownloadBrowse ] = new DownloadQueueSet( defaultBrowsePolicy );
     DownloadPolicy defaultBulkDownloadPolicy;
     defaultBulkDownloadPolicy.setMaximumConnections( 2 );
@@ -102,6 +106,20 @@ DownloadQueueSet *HttpDownloadManager::Private::findQueues( const QString& hostN
     return result;
 }
 
+QList<DownloadQueueSet *> HttpDownloadManager::Private::queueSets( const DownloadUsage usage ) const
+{
+    QList<DownloadQueueSet *> result;
+    QList<QPair<DownloadPolicyKey, DownloadQueueSet*> >::const_iterator pos = m_queueSets.constBegin();
+    QList<QPair<DownloadPolicyKey, DownloadQueueSet*> >::const_iterator const end = m_queueSets.constEnd();
+    for (; pos != end; ++pos ) {
+        if ( (*pos).first.usage() == usage ) {
+            result << (*pos).second;
+        }
+    }
+    result << m_defaultQueueSets.value( usage );
+    return result;
+}
+
 
 HttpDownloadManager::HttpDownloadManager( StoragePolicy *policy )
     : d( new Private( this, policy ) )
@@ -138,8 +156,22 @@ void HttpDownloadManager::addDownloadPolicy( const DownloadPolicy& policy )
                            ( queueSet->downloadPolicy().key(), queueSet ));
 }
 
+void HttpDownloadManager::setJobPriorities( const QHash<QString, int> &priorities, const DownloadUsage usage )
+{
+    for ( DownloadQueueSet * const queueSet: d->queueSets( usage ) ) {
+        queueSet->setJobPriorities( priorities );
+    }
+}
+
+void HttpDownloadManager::removeJobs( const QStringList &destinationFileNames, const DownloadUsage usage )
+{
+    for ( DownloadQueueSet * const queueSet: d->queueSets( usage ) ) {
+        queueSet->removeJobs( destinationFileNames );
+    }
+}
+
 void HttpDownloadManager::addJob( const QUrl& sourceUrl, const QString& destFileName,
-                                  const QString &id, const DownloadUsage usage )
+                                  const QString &id, const DownloadUsage usage, int priority )
 {
     if ( !d->m_acceptJobs ) {
         mDebug() << Q_FUNC_INFO << "Working offline, not adding job";
@@ -151,9 +183,15 @@ void HttpDownloadManager::addJob( const QUrl& sourceUrl, const QString& destFile
         HttpJob * const job = new HttpJob( sourceUrl, destFileName, id, &d->m_networkAccessManager );
         job->setUserAgentPluginId( "QNamNetworkPlugin" );
         job->setDownloadUsage( usage );
+        job->setPriority( priority );
         mDebug() << "adding job " << sourceUrl;
         queueSet->addJob( job );
     }
+    else {
+        QHash<QString, int> priorities;
+        priorities.insert( destFileName, priority );
+        queueSet->setJobPriorities( priorities );
+    }
 }
 
 void HttpDownloadManager::Private::finishJob( const QByteArray& data, const QString& destinationFileName,
@@ -17,11 +17,13 @@
 #ifndef MARBLE_HTTPDOWNLOADMANAGER_H
 #define MARBLE_HTTPDOWNLOADMANAGER_H
 
+#include <QHash>
 #include <QObject>
 
 #include "MarbleGlobal.h"
 #include "marble_export.h"
 
+class QStringList;
 class QUrl;
 
 namespace Marble
@@ -37,6 +39,11 @@ class StoragePolicy;
  * limit for pending jobs.  it also takes care that the job queue
  * won't be polluted by jobs that timed out already.
  *
+ * Waiting jobs are downloaded in the order of their priority, so
+ * that e.g. the tiles in the center of the view come first. Jobs
+ * which are not needed anymore can be removed before or while they
+ * are downloaded.
+ *
  * @author Torsten Rahn
  */
 
@@ -67,13 +74,27 @@ class MARBLE_EXPORT HttpDownloadManager : public QObject
 
     static QByteArray userAgent(const QString &platform, const QString &plugin);
 
+    /**
+     * Changes the priority of the waiting jobs of @p usage for the destination
+     * file names in @p priorities.
+     */
+    void setJobPriorities( const QHash<QString, int> &priorities, const DownloadUsage usage );
+
+    /**
+     * Removes the jobs of @p usage for @p destinationFileNames, whether they are
+     * waiting or being downloaded already.
+     */
+    void removeJobs( const QStringList &destinationFileNames, const DownloadUsage usage );
+
  public Q_SLOTS:
 
     /**
      * Adds a new job with a sourceUrl, destination file name and given id.
+     * Jobs with a lower @p priority value are downloaded first. If there
+     * is a job for @p destFilename waiting already, its priority is updated.
      */
     void addJob( const QUrl& sourceUrl, const QString& destFilename, const QString &id,
-                 const DownloadUsage usage );
+                 const DownloadUsage usage, int priority = 0 );
 
 
  Q_SIGNALS:
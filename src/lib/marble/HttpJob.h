@@ -52,6 +52,12 @@ class MARBLE_EXPORT HttpJob: public QObject
     DownloadUsage downloadUsage() const;
     void setDownloadUsage( const DownloadUsage );
 
+    /**
+     * Jobs with a lower priority value are downloaded first. The default is 0.
+     */
+    int priority() const;
+    void setPriority( int priority );
+
     void setUserAgentPluginId( const QString & pluginId ) const;
 
     QByteArray userAgent() const;
@@ -72,6 +78,11 @@ class MARBLE_EXPORT HttpJob: public QObject
  public Q_SLOTS:
     void execute();
 
+    /**
+     * Cancels a running download. The job does not emit any signals afterwards.
+     */
+    void abort();
+
 private Q_SLOTS:
    void downloadProgress( qint64 bytesReceived, qint64 bytesTotal );
    void error( QNetworkReply::NetworkError code );
@@ -21,9 +21,10 @@
 #include "GeoPainter.h"
 #include "RenderPlugin.h"
 #include "LayerInterface.h"
+#include "RenderProfiler.h"
 #include "RenderState.h"
 
-#include <QTime>
+#include <QElapsedTimer>
 
 namespace Marble
 {
@@ -43,6 +44,7 @@ class Q_DECL_HIDDEN LayerManager::Private
     QList<LayerInterface *> m_internalLayers;
 
     RenderState m_renderState;
+    RenderProfiler m_profiler;
 
     bool m_showBackground;
     bool m_showRuntimeTrace;
@@ -123,7 +125,9 @@ QList<AbstractDataPluginItem *> LayerManager::whichItemAt( const QPoint& curpos
 void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
 {
     d->m_renderState = RenderState(QStringLiteral("Marble"));
-    const QTime totalTime = QTime::currentTime();
+    d->m_profiler.beginFrame();
+    QElapsedTimer totalTime;
+    totalTime.start();
 
     QStringList renderPositions;
 
@@ -175,17 +179,26 @@ void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
         } );
 
         // render the layers of the current renderPosition
-        QTime timer;
+        d->m_profiler.beginRenderPosition( renderPosition );
+        QElapsedTimer timer;
         for( auto *layer: layers ) {
             timer.start();
+            d->m_profiler.beginLayer();
             layer->render( painter, viewport, renderPosition, nullptr );
-            d->m_renderState.addChild( layer->renderState() );
-            traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+            const RenderState layerState = layer->renderState();
+            d->m_profiler.endLayer( layerState );
+            d->m_renderState.addChild( layerState );
+            if ( d->m_showRuntimeTrace ) {
+                traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+            }
         }
+        d->m_profiler.endRenderPosition();
     }
 
+    d->m_profiler.endFrame( d->m_renderState );
+
     if ( d->m_showRuntimeTrace ) {
-        const int totalElapsed = totalTime.elapsed();
+        const int totalElapsed = qMax<int>( 1, totalTime.elapsed() );
         const int fps = 1000.0/totalElapsed;
         traceList.append( QString( "Total: %1 ms (%2 fps)" ).arg( totalElapsed, 3 ).arg( fps ) );
 
@@ -240,6 +253,11 @@ RenderState LayerManager::renderState() const
     return d->m_renderState;
 }
 
+RenderProfiler *LayerManager::renderProfiler()
+{
+    return &d->m_profiler;
+}
+
 }
 
 #include "moc_LayerManager.cpp"
@@ -28,6 +28,7 @@ class AbstractDataPluginItem;
 class GeoPainter;
 class ViewportParams;
 class RenderPlugin;
+class RenderProfiler;
 class RenderState;
 class LayerInterface;
 
@@ -77,6 +78,11 @@ class LayerManager : public QObject
 
     RenderState renderState() const;
 
+    /**
+     * @brief Returns the profiler recording the rendering times of the layers
+     */
+    RenderProfiler *renderProfiler();
+
  Q_SIGNALS:
     /**
      * @brief Signal that a render item has been initialized
@@ -35,6 +35,7 @@
 #include "layers/TextureLayer.h"
 #include "layers/VectorTileLayer.h"
 #include "AbstractFloatItem.h"
+#include "BulkTileDownloader.h"
 #include "DgmlAuxillaryDictionary.h"
 #include "FileManager.h"
 #include "GeoDataTreeModel.h"
@@ -127,6 +128,8 @@ public:
 
     void updateTileLevel();
 
+    void updateWorkOffline();
+
     void addPlugins();
 
     MarbleMap *const q;
@@ -156,6 +159,7 @@ public:
     TextureLayer     m_textureLayer;
     PlacemarkLayer   m_placemarkLayer;
     VectorTileLayer  m_vectorTileLayer;
+    BulkTileDownloader m_bulkTileDownloader;
 
     bool m_isLockedToSubSolarPoint;
     bool m_isSubSolarPointIconVisible;
@@ -188,6 +192,9 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
     m_layerManager.addLayer( &m_placemarkLayer );
     m_layerManager.addLayer( &m_customPaintLayer );
 
+    m_bulkTileDownloader.setJournalFileName( MarbleDirs::localPath() + QLatin1String( "/cache/region-download.journal" ) );
+    m_bulkTileDownloader.setDownloadEnabled( !m_model->workOffline() );
+
     m_model->bookmarkManager()->setStyleBuilder(&m_styleBuilder);
 
     QObject::connect( m_model, SIGNAL(themeChanged(QString)),
@@ -241,6 +248,11 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
 
     QObject::connect( &m_textureLayer, SIGNAL(repaintNeeded()),
                       parent, SIGNAL(repaintNeeded()) );
+
+    QObject::connect( m_model, SIGNAL(workOfflineChanged()),
+                      parent, SLOT(updateWorkOffline()) );
+    QObject::connect( &m_bulkTileDownloader, SIGNAL(tileDownloaded(TileId,QByteArray)),
+                      &m_textureLayer, SLOT(updateDownloadedTile(TileId,QByteArray)) );
     QObject::connect( parent, SIGNAL(visibleLatLonAltBoxChanged(GeoDataLatLonAltBox)),
                       parent, SIGNAL(repaintNeeded()) );
 
@@ -530,48 +542,23 @@ void MarbleMap::downloadRegion( QVector<TileCoordsPyramid> const & pyramid )
 {
     Q_ASSERT( textureLayer() );
     Q_ASSERT( !pyramid.isEmpty() );
-    QTime t;
-    t.start();
 
-    // When downloading a region (the author of these lines thinks) most users probably expect
-    // the download to begin with the low resolution tiles and then procede level-wise to
-    // higher resolution tiles. In order to achieve this, we start requesting downloads of
-    // high resolution tiles and request the low resolution tiles at the end because
-    // DownloadQueueSet (silly name) is implemented as stack.
-
-
-    int const first = 0;
-    int tilesCount = 0;
-
-    for ( int level = pyramid[first].bottomLevel(); level >= pyramid[first].topLevel(); --level ) {
-        QSet<TileId> tileIdSet;
-        for( int i = 0; i < pyramid.size(); ++i ) {
-            QRect const coords = pyramid[i].coords( level );
-            mDebug() << "MarbleMap::downloadRegion level:" << level << "tile coords:" << coords;
-            int x1, y1, x2, y2;
-            coords.getCoords( &x1, &y1, &x2, &y2 );
-            for ( int x = x1; x <= x2; ++x ) {
-                for ( int y = y1; y <= y2; ++y ) {
-                    TileId const stackedTileId( 0, level, x, y );
-                    tileIdSet.insert( stackedTileId );
-                    // FIXME: use lazy evaluation to not generate up to 100k tiles in one go
-                    // this can take considerable time even on very fast systems
-                    // in contrast generating the TileIds on the fly when they are needed
-                    // does not seem to affect download speed.
-                }
-            }
-        }
-        QSetIterator<TileId> i( tileIdSet );
-        while( i.hasNext() ) {
-            TileId const tileId = i.next();
-            d->m_textureLayer.downloadStackedTile( tileId );
-        }
-        tilesCount += tileIdSet.count();
+    // the downloader enumerates the tiles lazily, level by level starting with
+    // the low resolution tiles, and resumes an interrupted download of the same region
+    d->m_bulkTileDownloader.stop();
+
+    QVector<const GeoSceneTileDataset *> datasets;
+    for ( const GeoSceneTextureTileDataset *texture: d->m_textureLayer.textureLayers() ) {
+        datasets << texture;
     }
-    // Needed for downloading unique tiles only. Much faster than if tiles for each level is downloaded separately
+    d->m_bulkTileDownloader.setTileDatasets( datasets );
+    d->m_bulkTileDownloader.setRegion( pyramid );
+    d->m_bulkTileDownloader.start();
+}
 
-    int const elapsedMs = t.elapsed();
-    mDebug() << "MarbleMap::downloadRegion:" << tilesCount << "tiles, " << elapsedMs << "ms";
+BulkTileDownloader *MarbleMap::bulkTileDownloader() const
+{
+    return &d->m_bulkTileDownloader;
 }
 
 void MarbleMap::highlightRouteRelation(qint64 osmId, bool enabled)
@@ -834,6 +821,11 @@ void MarbleMapPrivate::updateTileLevel()
     emit q->tileLevelChanged(tileZoomLevel);
 }
 
+void MarbleMapPrivate::updateWorkOffline()
+{
+    m_bulkTileDownloader.setDownloadEnabled( !m_model->workOffline() );
+}
+
 // Used to be paintEvent()
 void MarbleMap::paint( GeoPainter &painter, const QRect &dirtyRect )
 {
@@ -895,6 +887,8 @@ void MarbleMap::setMapThemeId( const QString& mapThemeId )
 
 void MarbleMapPrivate::updateMapTheme()
 {
+    // the downloader refers to the datasets of the old theme
+    m_bulkTileDownloader.stop();
     m_layerManager.removeLayer( &m_textureLayer );
     // FIXME Find a better way to do this reset. Maybe connect to themeChanged SIGNAL?
     m_vectorTileLayer.reset();
@@ -1453,6 +1447,11 @@ RenderState MarbleMap::renderState() const
     return d->m_layerManager.renderState();
 }
 
+RenderProfiler *MarbleMap::renderProfiler() const
+{
+    return d->m_layerManager.renderProfiler();
+}
+
 QString MarbleMap::addTextureLayer(GeoSceneTextureTileDataset *texture)
 {
     return textureLayer()->addTextureLayer(texture);
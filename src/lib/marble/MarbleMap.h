@@ -47,10 +47,12 @@ class ViewportParams;
 class GeoPainter;
 class LayerInterface;
 class RenderPlugin;
+class RenderProfiler;
 class RenderState;
 class AbstractDataPlugin;
 class AbstractDataPluginItem;
 class AbstractFloatItem;
+class BulkTileDownloader;
 class TextureLayer;
 class TileCoordsPyramid;
 class GeoSceneTextureTileDataset;
@@ -402,6 +404,12 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     TextureLayer *textureLayer() const;
 
+    /**
+     * @brief Returns the downloader used by downloadRegion(), e.g. for
+     * reporting its progress or stopping it.
+     */
+    BulkTileDownloader *bulkTileDownloader() const;
+
     /**
      * @brief Add a layer to be included in rendering.
      */
@@ -428,6 +436,12 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     RenderState renderState() const;
 
+    /**
+     * @brief Returns the profiler of the layer rendering times. It has
+     * to be enabled before frames are recorded.
+     */
+    RenderProfiler *renderProfiler() const;
+
     /**
      * @since 0.26.0
      */
@@ -795,6 +809,7 @@ class MARBLE_EXPORT MarbleMap : public QObject
     Q_PRIVATE_SLOT( d, void updateProperty( const QString &, bool ) )
     Q_PRIVATE_SLOT( d, void setDocument(QString) )
     Q_PRIVATE_SLOT( d, void updateTileLevel() )
+    Q_PRIVATE_SLOT( d, void updateWorkOffline() )
     Q_PRIVATE_SLOT(d, void addPlugins())
 
  private:
@@ -68,6 +68,7 @@
 #include "TileCreator.h"
 #include "TileCreatorDialog.h"
 #include "TileLoader.h"
+#include "TileStore.h"
 #include "routing/RoutingManager.h"
 #include "RouteSimulationPositionProviderPlugin.h"
 #include "BookmarkManager.h"
@@ -90,6 +91,7 @@ class MarbleModelPrivate
           m_storagePolicy( MarbleDirs::localPath() ),
           m_downloadManager( &m_storagePolicy ),
           m_storageWatcher( MarbleDirs::localPath() ),
+          m_persistentTileCacheLimit( 0 ),
           m_treeModel(),
           m_descendantProxy(),
           m_placemarkProxyModel(),
@@ -150,6 +152,7 @@ class MarbleModelPrivate
 
     // Cache related
     FileStorageWatcher       m_storageWatcher;
+    quint64                  m_persistentTileCacheLimit;
 
     // Places on the map
     GeoDataTreeModel         m_treeModel;
@@ -180,6 +183,8 @@ MarbleModel::MarbleModel( QObject *parent )
     : QObject( parent ),
       d( new MarbleModelPrivate() )
 {
+    d->m_storagePolicy.setTileStore( TileLoader::tileStore() );
+
     // connect the StoragePolicy used by the download manager to the FileStorageWatcher
     connect( &d->m_storagePolicy, SIGNAL(cleared()),
              &d->m_storageWatcher, SLOT(resetCurrentSize()) );
@@ -554,7 +559,7 @@ const SunLocator *MarbleModel::sunLocator() const
 
 quint64 MarbleModel::persistentTileCacheLimit() const
 {
-    return d->m_storageWatcher.cacheLimit() / 1024;
+    return d->m_persistentTileCacheLimit;
 }
 
 void MarbleModel::clearPersistentTileCache()
@@ -604,7 +609,13 @@ void MarbleModel::clearPersistentTileCache()
 
 void MarbleModel::setPersistentTileCacheLimit(quint64 kiloBytes)
 {
-    d->m_storageWatcher.setCacheLimit( kiloBytes * 1024 );
+    d->m_persistentTileCacheLimit = kiloBytes;
+
+    // New tiles are kept in the tile store, the files are mostly left over from
+    // older versions and shrink as their tiles are downloaded again
+    const quint64 fileCacheLimit = kiloBytes * 1024 / 4;
+    d->m_storageWatcher.setCacheLimit( fileCacheLimit );
+    TileLoader::tileStore()->setSizeLimit( kiloBytes * 1024 - fileCacheLimit );
 
     if( kiloBytes != 0 )
     {
@@ -383,6 +383,11 @@ Marble::TextureLayer* MarbleWidget::textureLayer() const
     return d->m_map.textureLayer();
 }
 
+BulkTileDownloader *MarbleWidget::bulkTileDownloader() const
+{
+    return d->m_map.bulkTileDownloader();
+}
+
 QPixmap MarbleWidget::mapScreenShot()
 {
     return QPixmap::grabWidget( this );
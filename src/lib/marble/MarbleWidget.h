@@ -35,6 +35,7 @@ namespace Marble
 
 class AbstractDataPluginItem;
 class AbstractFloatItem;
+class BulkTileDownloader;
 class GeoDataLatLonAltBox;
 class GeoDataLatLonBox;
 class GeoDataFeature;
@@ -1067,6 +1068,11 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
 
     TextureLayer *textureLayer() const;
 
+    /**
+     * @brief Returns the downloader used by downloadRegion().
+     */
+    BulkTileDownloader *bulkTileDownloader() const;
+
     //@}
 
  Q_SIGNALS:
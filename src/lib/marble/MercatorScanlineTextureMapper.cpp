@@ -23,6 +23,7 @@
 // Marble
 #include "GeoPainter.h"
 #include "MarbleDebug.h"
+#include "ScanlineRowScheduler.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "TextureColorizer.h"
@@ -35,7 +36,7 @@ using namespace Marble;
 class MercatorScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, qreal centerLon, int xLeft, int xRight, ScanlineRowScheduler *scheduler );
 
     void run() override;
 
@@ -45,18 +46,22 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    const int m_yPaintedTop;
-    const int m_yPaintedBottom;
+    const qreal m_centerLon;
+    const int m_xLeft;
+    const int m_xRight;
+    ScanlineRowScheduler *const m_scheduler;
 };
 
-MercatorScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+MercatorScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, qreal centerLon, int xLeft, int xRight, ScanlineRowScheduler *scheduler )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yPaintedTop( yTop ),
-      m_yPaintedBottom( yBottom )
+      m_centerLon( centerLon ),
+      m_xLeft( xLeft ),
+      m_xRight( xRight ),
+      m_scheduler( scheduler )
 {
 }
 
@@ -64,10 +69,36 @@ MercatorScanlineTextureMapper::MercatorScanlineTextureMapper( StackedTileLoader
     : TextureMapperInterface(),
       m_tileLoader( tileLoader ),
       m_radius( 0 ),
-      m_oldYPaintedTop( 0 )
+      m_oldYPaintedTop( 0 ),
+      m_incrementalRepaint( true ),
+      m_centerChanged( false ),
+      m_canvasTileLevel( -1 ),
+      m_canvasMapQuality( NormalQuality ),
+      m_canvasCenterLon( 0.0 ),
+      m_canvasYCenterOffset( 0 )
 {
 }
 
+void MercatorScanlineTextureMapper::setIncrementalRepaintEnabled( bool enabled )
+{
+    m_incrementalRepaint = enabled;
+}
+
+bool MercatorScanlineTextureMapper::isIncrementalRepaintEnabled() const
+{
+    return m_incrementalRepaint;
+}
+
+void MercatorScanlineTextureMapper::setCenterChanged()
+{
+    if ( m_incrementalRepaint ) {
+        m_centerChanged = true;
+    }
+    else {
+        setRepaintNeeded();
+    }
+}
+
 void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
                                                 const ViewportParams *viewport,
                                                 int tileZoomLevel,
@@ -89,11 +120,18 @@ void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
         m_repaintNeeded = true;
     }
 
+    // The colorizer works on the whole canvas, so it can't be combined
+    // with partial updates.
+    if ( m_centerChanged && !m_repaintNeeded ) {
+        m_repaintNeeded = texColorizer || !scrollTexture( viewport, tileZoomLevel, painter->mapQuality() );
+    }
+    m_centerChanged = false;
+
     if ( m_repaintNeeded ) {
         mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
 
         if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
+            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality(), &m_threadPool );
         }
 
         m_repaintNeeded = false;
@@ -102,39 +140,20 @@ void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
     painter->drawImage( dirtyRect, m_canvasImage, dirtyRect );
 }
 
+TextureMapperInterface::LoadStatistics MercatorScanlineTextureMapper::loadStatistics() const
+{
+    return m_loadStatistics;
+}
+
 void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
     // Reset backend
     m_tileLoader->resetTilehash();
 
-    // Initialize needed constants:
-
     const int imageHeight = m_canvasImage.height();
 
-    // Calculate y-range the represented by the center point, yTop and
-    // what actually can be painted
-
-    qreal realYTop, realYBottom, dummyX;
-    GeoDataCoordinates yNorth(0, viewport->currentProjection()->maxLat(), 0);
-    GeoDataCoordinates ySouth(0, viewport->currentProjection()->minLat(), 0);
-    viewport->screenCoordinates(yNorth, dummyX, realYTop );
-    viewport->screenCoordinates(ySouth, dummyX, realYBottom );
-
-    const int yTop     = qBound(qreal(0.0), realYTop, qreal(imageHeight));
-    int yPaintedTop    = yTop;
-    int yPaintedBottom = qBound(qreal(0.0), realYBottom, qreal(imageHeight));
- 
-    yPaintedTop = qBound(0, yPaintedTop, imageHeight);
-    yPaintedBottom = qBound(0, yPaintedBottom, imageHeight);
-
-    const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = ( yPaintedBottom - yPaintedTop ) / numThreads;
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yPaintedTop +  i      * yStep;
-        const int yEnd   = yPaintedTop + (i + 1) * yStep;
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
-        m_threadPool.start( job );
-    }
+    int yTop, yPaintedTop, yPaintedBottom;
+    paintedRange( viewport, yTop, yPaintedTop, yPaintedBottom );
 
     // Remove unused lines
     const int clearStart = ( yPaintedTop - m_oldYPaintedTop <= 0 ) ? yPaintedBottom : 0;
@@ -147,11 +166,112 @@ void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
         *(it) = 0;
     }
 
+    m_loadStatistics = mapTexture( viewport, tileZoomLevel, mapQuality, viewport->centerLongitude(),
+                                   QRect( 0, yPaintedTop, m_canvasImage.width(), yPaintedBottom - yPaintedTop ) );
+
+    m_oldYPaintedTop = yPaintedTop;
+
+    m_canvasTileLevel = tileZoomLevel;
+    m_canvasMapQuality = mapQuality;
+    m_canvasCenterLon = viewport->centerLongitude();
+    m_canvasYCenterOffset = yCenterOffset( viewport );
+
+    m_tileLoader->cleanupTilehash();
+}
+
+TextureMapperInterface::LoadStatistics MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality, qreal centerLon, const QRect &rect )
+{
+    if ( rect.isEmpty() ) {
+        return LoadStatistics();
+    }
+
+    // Let one job per thread pull small blocks of rows, so the threads stay
+    // busy even if some parts of the canvas are more expensive than others
+    const int numThreads = m_threadPool.maxThreadCount();
+    ScanlineRowScheduler scheduler( rect.top(), rect.bottom() + 1, numThreads );
+    for ( int i = 0; i < numThreads; ++i ) {
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, centerLon, rect.left(), rect.right() + 1, &scheduler );
+        m_threadPool.start( job );
+    }
+
     m_threadPool.waitForDone();
 
+    return scheduler.statistics();
+}
+
+bool MercatorScanlineTextureMapper::scrollTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
+{
+    if ( tileZoomLevel != m_canvasTileLevel || mapQuality != m_canvasMapQuality ) {
+        return false;
+    }
+
+    // Same pixel size as in RenderJob::run()
+    const float rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
+    const qreal pixel2Rad = 1.0/rad2Pixel;
+    qreal deltaLon = viewport->centerLongitude() - m_canvasCenterLon;
+    if ( deltaLon < -M_PI ) deltaLon += 2 * M_PI;
+    if ( deltaLon >  M_PI ) deltaLon -= 2 * M_PI;
+
+    const int dy = yCenterOffset( viewport ) - m_canvasYCenterOffset;
+
+    int dx = 0;
+    QRect rowStrip;
+    QRect columnStrip;
+    if ( !ScanlineTextureMapperContext::scrollFlatCanvas( &m_canvasImage, deltaLon / pixel2Rad, dy, dx, rowStrip, columnStrip ) ) {
+        return false;
+    }
+
+    // The canvas now shows the map for a center that is off by less than
+    // half a pixel from the one of the viewport. Map the exposed strips for
+    // that center as well, and measure the next move from it, so the
+    // fractions of a pixel don't add up while panning.
+    m_canvasCenterLon += dx * pixel2Rad;
+    if ( m_canvasCenterLon < -M_PI ) m_canvasCenterLon += 2 * M_PI;
+    if ( m_canvasCenterLon >  M_PI ) m_canvasCenterLon -= 2 * M_PI;
+    m_canvasYCenterOffset += dy;
+
+    m_tileLoader->resetTilehash();
+
+    int yTop, yPaintedTop, yPaintedBottom;
+    paintedRange( viewport, yTop, yPaintedTop, yPaintedBottom );
+    const QRect paintedRect( 0, yPaintedTop, m_canvasImage.width(), yPaintedBottom - yPaintedTop );
+
+    m_loadStatistics = mapTexture( viewport, tileZoomLevel, mapQuality, m_canvasCenterLon, rowStrip.intersected( paintedRect ) );
+    m_loadStatistics += mapTexture( viewport, tileZoomLevel, mapQuality, m_canvasCenterLon, columnStrip.intersected( paintedRect ) );
+
     m_oldYPaintedTop = yPaintedTop;
 
     m_tileLoader->cleanupTilehash();
+
+    return true;
+}
+
+void MercatorScanlineTextureMapper::paintedRange( const ViewportParams *viewport, int &yTop, int &yPaintedTop, int &yPaintedBottom ) const
+{
+    const int imageHeight = m_canvasImage.height();
+
+    // Calculate y-range the represented by the center point, yTop and
+    // what actually can be painted
+
+    qreal realYTop, realYBottom, dummyX;
+    GeoDataCoordinates yNorth(0, viewport->currentProjection()->maxLat(), 0);
+    GeoDataCoordinates ySouth(0, viewport->currentProjection()->minLat(), 0);
+    viewport->screenCoordinates(yNorth, dummyX, realYTop );
+    viewport->screenCoordinates(ySouth, dummyX, realYBottom );
+
+    yTop           = qBound(qreal(0.0), realYTop, qreal(imageHeight));
+    yPaintedTop    = yTop;
+    yPaintedBottom = qBound(qreal(0.0), realYBottom, qreal(imageHeight));
+ 
+    yPaintedTop = qBound(0, yPaintedTop, imageHeight);
+    yPaintedBottom = qBound(0, yPaintedBottom, imageHeight);
+}
+
+int MercatorScanlineTextureMapper::yCenterOffset( const ViewportParams *viewport )
+{
+    // Has to match the calculation in RenderJob::run()
+    const float rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
+    return (int)( asinh( tan( viewport->centerLatitude() ) ) * rad2Pixel );
 }
 
 
@@ -175,7 +295,7 @@ void MercatorScanlineTextureMapper::RenderJob::run()
     const int n = ScanlineTextureMapperContext::interpolationStep( m_viewport, m_mapQuality );
 
     // Calculate translation of center point
-    const qreal centerLon = m_viewport->centerLongitude();
+    const qreal centerLon = m_centerLon;
     const qreal centerLat = m_viewport->centerLatitude();
 
     const int yCenterOffset = (int)( asinh( tan( centerLat ) ) * rad2Pixel  );
@@ -184,7 +304,11 @@ void MercatorScanlineTextureMapper::RenderJob::run()
     while ( leftLon < -M_PI ) leftLon += 2 * M_PI;
     while ( leftLon >  M_PI ) leftLon -= 2 * M_PI;
 
-    const int maxInterpolationPointX = n * (int)( imageWidth / n - 1 ) + 1;
+    const int maxInterpolationPointX = m_xLeft + n * (int)( ( m_xRight - m_xLeft ) / n - 1 ) + 1;
+
+    // Longitude of the first pixel of the painted column range
+    qreal xLeftLon = leftLon + m_xLeft * pixel2Rad;
+    while ( xLeftLon >  M_PI ) xLeftLon -= 2 * M_PI;
 
 
     // initialize needed variables that are modified during texture mapping:
@@ -194,58 +318,64 @@ void MercatorScanlineTextureMapper::RenderJob::run()
 
     // Scanline based algorithm to do texture mapping
 
-    for ( int y = m_yPaintedTop; y < m_yPaintedBottom; ++y ) {
-
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) );
-
-        qreal lon = leftLon;
-        const qreal lat = gd ( ( (imageHeight / 2 + yCenterOffset) - y )
-                    * pixel2Rad );
-
-        for ( int x = 0; x < imageWidth; ++x ) {
-            // Prepare for interpolation
-            bool interpolate = false;
-            if ( x > 0 && x <= maxInterpolationPointX ) {
-                x += n - 1;
-                lon += (n - 1) * pixel2Rad;
-                interpolate = !printQuality;
-            }
-            else {
-                interpolate = false;
+    ScanlineRowScheduler::Worker worker( m_scheduler );
+    int yStart = 0;
+    int yEnd = 0;
+
+    while ( worker.nextRows( yStart, yEnd ) ) {
+        for ( int y = yStart; y < yEnd; ++y ) {
+
+            QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + m_xLeft;
+
+            qreal lon = xLeftLon;
+            const qreal lat = gd ( ( (imageHeight / 2 + yCenterOffset) - y )
+                        * pixel2Rad );
+
+            for ( int x = m_xLeft; x < m_xRight; ++x ) {
+                // Prepare for interpolation
+                bool interpolate = false;
+                if ( x > m_xLeft && x <= maxInterpolationPointX ) {
+                    x += n - 1;
+                    lon += (n - 1) * pixel2Rad;
+                    interpolate = !printQuality;
+                }
+                else {
+                    interpolate = false;
+                }
+
+                if ( lon < -M_PI ) lon += 2 * M_PI;
+                if ( lon >  M_PI ) lon -= 2 * M_PI;
+
+                if ( interpolate ) {
+                    if (highQuality)
+                        context.pixelValueApproxF( lon, lat, scanLine, n );
+                    else
+                        context.pixelValueApprox( lon, lat, scanLine, n );
+
+                    scanLine += ( n - 1 );
+                }
+
+                if ( x < m_xRight ) {
+                    if ( highQuality )
+                        context.pixelValueF( lon, lat, scanLine );
+                    else
+                        context.pixelValue( lon, lat, scanLine );
+                }
+
+                ++scanLine;
+                lon += pixel2Rad;
             }
 
-            if ( lon < -M_PI ) lon += 2 * M_PI;
-            if ( lon >  M_PI ) lon -= 2 * M_PI;
-
-            if ( interpolate ) {
-                if (highQuality)
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
-                else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
+            // copy scanline to improve performance
+            if ( interlaced && y + 1 < yEnd ) { 
 
-                scanLine += ( n - 1 );
-            }
+                const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
-            if ( x < imageWidth ) {
-                if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
-                else
-                    context.pixelValue( lon, lat, scanLine );
+                memcpy( m_canvasImage->scanLine( y + 1 ) + m_xLeft * pixelByteSize,
+                        m_canvasImage->scanLine( y     ) + m_xLeft * pixelByteSize,
+                        ( m_xRight - m_xLeft ) * pixelByteSize );
+                ++y;
             }
-
-            ++scanLine;
-            lon += pixel2Rad;
-        }
-
-        // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yPaintedBottom ) { 
-
-            const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
-
-            memcpy( m_canvasImage->scanLine( y + 1 ),
-                    m_canvasImage->scanLine( y     ),
-                    imageWidth * pixelByteSize );
-            ++y;
         }
     }
 }
@@ -38,8 +38,28 @@ class MercatorScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer ) override;
 
+    LoadStatistics loadStatistics() const override;
+
+    void setCenterChanged() override;
+
+    /**
+     * @brief Enables or disables incremental repaints while panning.
+     *
+     * If enabled (the default), a change of the center only scrolls the
+     * previous canvas by whole pixels and maps the newly exposed strips.
+     * The texture may then lag up to half a pixel behind the center.
+     * Any other change (zoom, map theme, sun shading, new tiles) still
+     * triggers a full repaint.
+     */
+    void setIncrementalRepaintEnabled( bool enabled );
+    bool isIncrementalRepaintEnabled() const;
+
  private:
     void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
+    LoadStatistics mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality, qreal centerLon, const QRect &rect );
+    bool scrollTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
+    void paintedRange( const ViewportParams *viewport, int &yTop, int &yPaintedTop, int &yPaintedBottom ) const;
+    static int yCenterOffset( const ViewportParams *viewport );
 
  private:
     class RenderJob;
@@ -49,6 +69,16 @@ class MercatorScanlineTextureMapper : public TextureMapperInterface
     QImage m_canvasImage;
     int    m_oldYPaintedTop;
     QThreadPool m_threadPool;
+    LoadStatistics m_loadStatistics;
+
+    bool m_incrementalRepaint;
+    bool m_centerChanged;
+
+    // State of the last full or incremental repaint
+    int m_canvasTileLevel;
+    MapQuality m_canvasMapQuality;
+    qreal m_canvasCenterLon;
+    int m_canvasYCenterOffset;
 };
 
 }
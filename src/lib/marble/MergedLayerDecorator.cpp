@@ -34,45 +34,63 @@
 
 #include "GeoDataCoordinates.h"
 
+#include <QMutex>
 #include <QPointer>
 #include <QPainter>
+#include <QSharedPointer>
 
 using namespace Marble;
 
 class Q_DECL_HIDDEN MergedLayerDecorator::Private
 {
 public:
-    Private( TileLoader *tileLoader, const SunLocator *sunLocator );
+    /**
+     * The settings tiles are created with. It is never modified once shared:
+     * background jobs keep using the snapshot they started with while changes
+     * replace it by a modified copy.
+     */
+    class State
+    {
+    public:
+        State();
+
+        StackedTile *createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const;
+
+        void renderGroundOverlays( QImage *tileImage, const QVector<QSharedPointer<TextureTile> > &tiles ) const;
+        void paintTileId( QImage *tileImage, const TileId &id ) const;
+
+        void detectMaxTileLevel();
+        QVector<const GeoSceneTextureTileDataset *> findRelevantTextureLayers( const TileId &stackedTileId ) const;
 
-    static int maxDivisor( int maximum, int fullLength );
+        QVector<const GeoSceneTextureTileDataset *> m_textureLayers;
+        QList<const GeoDataGroundOverlay *> m_groundOverlays;
+        int m_maxTileLevel;
+        QString m_themeId;
+        int m_levelZeroColumns;
+        int m_levelZeroRows;
+        bool m_showSunShading;
+        bool m_showCityLights;
+        bool m_showTileId;
+    };
 
-    StackedTile *createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const;
+    Private( TileLoader *tileLoader, const SunLocator *sunLocator );
 
-    void renderGroundOverlays( QImage *tileImage, const QVector<QSharedPointer<TextureTile> > &tiles ) const;
-    void paintSunShading( QImage *tileImage, const TileId &id ) const;
-    void paintTileId( QImage *tileImage, const TileId &id ) const;
+    QSharedPointer<const State> state() const;
 
-    void detectMaxTileLevel();
-    QVector<const GeoSceneTextureTileDataset *> findRelevantTextureLayers( const TileId &stackedTileId ) const;
+    /** Replaces the state by a copy modified by @p modify, called on the GUI thread */
+    template<class Function>
+    void modifyState( Function modify );
 
     TileLoader *const m_tileLoader;
-    const SunLocator *const m_sunLocator;
     BlendingFactory m_blendingFactory;
-    QVector<const GeoSceneTextureTileDataset *> m_textureLayers;
-    QList<const GeoDataGroundOverlay *> m_groundOverlays;
-    int m_maxTileLevel;
-    QString m_themeId;
-    int m_levelZeroColumns;
-    int m_levelZeroRows;
-    bool m_showSunShading;
-    bool m_showCityLights;
-    bool m_showTileId;
+
+private:
+    QSharedPointer<const State> m_state;
+    // only held to copy or replace m_state, never while tiles are created
+    mutable QMutex m_stateMutex;
 };
 
-MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator *sunLocator ) :
-    m_tileLoader( tileLoader ),
-    m_sunLocator( sunLocator ),
-    m_blendingFactory( sunLocator ),
+MergedLayerDecorator::Private::State::State() :
     m_textureLayers(),
     m_maxTileLevel( 0 ),
     m_themeId(),
@@ -84,6 +102,29 @@ MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator
 {
 }
 
+MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator *sunLocator ) :
+    m_tileLoader( tileLoader ),
+    m_blendingFactory( sunLocator ),
+    m_state( new State )
+{
+}
+
+QSharedPointer<const MergedLayerDecorator::Private::State> MergedLayerDecorator::Private::state() const
+{
+    QMutexLocker locker( &m_stateMutex );
+    return m_state;
+}
+
+template<class Function>
+void MergedLayerDecorator::Private::modifyState( Function modify )
+{
+    QSharedPointer<State> state( new State( *this->state() ) );
+    modify( *state );
+
+    QMutexLocker locker( &m_stateMutex );
+    m_state = state;
+}
+
 MergedLayerDecorator::MergedLayerDecorator( TileLoader * const tileLoader,
                                             const SunLocator* sunLocator )
     : d( new Private( tileLoader, sunLocator ) )
@@ -99,66 +140,83 @@ void MergedLayerDecorator::setTextureLayers( const QVector<const GeoSceneTexture
 {
     if ( textureLayers.count() > 0 ) {
         const GeoSceneTileDataset *const firstTexture = textureLayers.at( 0 );
-        d->m_levelZeroColumns = firstTexture->levelZeroColumns();
-        d->m_levelZeroRows = firstTexture->levelZeroRows();
-        d->m_blendingFactory.setLevelZeroLayout( d->m_levelZeroColumns, d->m_levelZeroRows );
-        d->m_themeId = QLatin1String("maps/") + firstTexture->sourceDir();
+        d->m_blendingFactory.setLevelZeroLayout( firstTexture->levelZeroColumns(), firstTexture->levelZeroRows() );
     }
 
-    d->m_textureLayers = textureLayers;
+    d->modifyState( [&]( Private::State &state ) {
+        if ( textureLayers.count() > 0 ) {
+            const GeoSceneTileDataset *const firstTexture = textureLayers.at( 0 );
+            state.m_levelZeroColumns = firstTexture->levelZeroColumns();
+            state.m_levelZeroRows = firstTexture->levelZeroRows();
+            state.m_themeId = QLatin1String("maps/") + firstTexture->sourceDir();
+        }
+
+        state.m_textureLayers = textureLayers;
 
-    d->detectMaxTileLevel();
+        state.detectMaxTileLevel();
+    } );
 }
 
 void MergedLayerDecorator::updateGroundOverlays(const QList<const GeoDataGroundOverlay *> &groundOverlays )
 {
-    d->m_groundOverlays = groundOverlays;
+    d->modifyState( [&]( Private::State &state ) {
+        state.m_groundOverlays = groundOverlays;
+    } );
 }
 
 
 int MergedLayerDecorator::textureLayersSize() const
 {
-    return d->m_textureLayers.size();
+    return d->state()->m_textureLayers.size();
+}
+
+QVector<const GeoSceneTextureTileDataset *> MergedLayerDecorator::textureLayers() const
+{
+    return d->state()->m_textureLayers;
 }
 
 int MergedLayerDecorator::maximumTileLevel() const
 {
-    return d->m_maxTileLevel;
+    return d->state()->m_maxTileLevel;
 }
 
 int MergedLayerDecorator::tileColumnCount( int level ) const
 {
-    Q_ASSERT( !d->m_textureLayers.isEmpty() );
+    const QSharedPointer<const Private::State> state = d->state();
+    Q_ASSERT( !state->m_textureLayers.isEmpty() );
 
-    const int levelZeroColumns = d->m_textureLayers.at( 0 )->levelZeroColumns();
+    const int levelZeroColumns = state->m_textureLayers.at( 0 )->levelZeroColumns();
 
     return TileLoaderHelper::levelToColumn( levelZeroColumns, level );
 }
 
 int MergedLayerDecorator::tileRowCount( int level ) const
 {
-    Q_ASSERT( !d->m_textureLayers.isEmpty() );
+    const QSharedPointer<const Private::State> state = d->state();
+    Q_ASSERT( !state->m_textureLayers.isEmpty() );
 
-    const int levelZeroRows = d->m_textureLayers.at( 0 )->levelZeroRows();
+    const int levelZeroRows = state->m_textureLayers.at( 0 )->levelZeroRows();
 
     return TileLoaderHelper::levelToRow( levelZeroRows, level );
 }
 
 const GeoSceneAbstractTileProjection *MergedLayerDecorator::tileProjection() const
 {
-    Q_ASSERT( !d->m_textureLayers.isEmpty() );
+    const QSharedPointer<const Private::State> state = d->state();
+    Q_ASSERT( !state->m_textureLayers.isEmpty() );
 
-    return d->m_textureLayers.at(0)->tileProjection();
+    return state->m_textureLayers.at(0)->tileProjection();
 }
 
 QSize MergedLayerDecorator::tileSize() const
 {
-    Q_ASSERT( !d->m_textureLayers.isEmpty() );
+    const QSharedPointer<const Private::State> state = d->state();
+    Q_ASSERT( !state->m_textureLayers.isEmpty() );
 
-    return d->m_textureLayers.at( 0 )->tileSize();
+    return state->m_textureLayers.at( 0 )->tileSize();
 }
 
-StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const
+StackedTile *MergedLayerDecorator::Private::State::createTile( const QVector<QSharedPointer<TextureTile> > &tiles ) const
 {
     Q_ASSERT( !tiles.isEmpty() );
 
@@ -170,21 +228,19 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
 
     // if there are more than one active texture layers, we have to convert the
     // result tile into QImage::Format_ARGB32_Premultiplied to make blending possible
-    const bool withConversion = tiles.count() > 1 || m_showSunShading || m_showTileId || !m_groundOverlays.isEmpty();
+    const bool withConversion = tiles.count() > 1 || m_showTileId || !m_groundOverlays.isEmpty();
     for ( const QSharedPointer<TextureTile> &tile: tiles ) {
 
         // Image blending. If there are several images in the same tile (like clouds
         // or hillshading images over the map) blend them all into only one image
 
+        // The bottom tile has nothing to be blended onto, e.g. the night texture
+        // which TextureLayer maps on its own.
         const Blending *const blending =  tile->blending();
-        if ( blending ) {
+        if ( blending && !resultImage.isNull() ) {
 
             mDebug() << Q_FUNC_INFO << "blending";
 
-            if ( resultImage.isNull() ) {
-                resultImage = QImage( tile->image()->size(), QImage::Format_ARGB32_Premultiplied );
-            }
-
             blending->blend( &resultImage, tile.data() );
         }
         else {
@@ -199,10 +255,6 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
 
     renderGroundOverlays( &resultImage, tiles );
 
-    if ( m_showSunShading && !m_showCityLights ) {
-        paintSunShading( &resultImage, id );
-    }
-
     if ( m_showTileId ) {
         paintTileId( &resultImage, id );
     }
@@ -210,7 +262,7 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
     return new StackedTile( id, resultImage, tiles );
 }
 
-void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, const QVector<QSharedPointer<TextureTile> > &tiles ) const
+void MergedLayerDecorator::Private::State::renderGroundOverlays( QImage *tileImage, const QVector<QSharedPointer<TextureTile> > &tiles ) const
 {
 
     /* All tiles are covering the same area. Pick one. */
@@ -298,7 +350,9 @@ void MergedLayerDecorator::Private::renderGroundOverlays( QImage *tileImage, con
 
 StackedTile *MergedLayerDecorator::loadTile( const TileId &stackedTileId )
 {
-    const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->findRelevantTextureLayers( stackedTileId );
+    const QSharedPointer<const Private::State> state = d->state();
+
+    const QVector<const GeoSceneTextureTileDataset *> textureLayers = state->findRelevantTextureLayers( stackedTileId );
     QVector<QSharedPointer<TextureTile> > tiles;
     tiles.reserve(textureLayers.size());
 
@@ -323,7 +377,26 @@ StackedTile *MergedLayerDecorator::loadTile( const TileId &stackedTileId )
 
     Q_ASSERT( !tiles.isEmpty() );
 
-    return d->createTile( tiles );
+    return state->createTile( tiles );
+}
+
+StackedTile *MergedLayerDecorator::loadPlaceholderTile( const TileId &stackedTileId, const StackedTile &lowerLevelTile ) const
+{
+    const int deltaLevel = stackedTileId.zoomLevel() - lowerLevelTile.id().zoomLevel();
+    Q_ASSERT( deltaLevel > 0 );
+
+    QVector<QSharedPointer<TextureTile> > tiles;
+    tiles.reserve( lowerLevelTile.tiles().size() );
+    for ( const QSharedPointer<TextureTile> &lowerLevelTexture: lowerLevelTile.tiles() ) {
+        const TileId tileId( lowerLevelTexture->id().mapThemeIdHash(), stackedTileId.zoomLevel(),
+                             stackedTileId.x(), stackedTileId.y() );
+        const QImage tileImage = TileLoader::scaledTilePart( *lowerLevelTexture->image(), tileId, deltaLevel );
+        tiles.append( QSharedPointer<TextureTile>( new TextureTile( tileId, tileImage, lowerLevelTexture->blending() ) ) );
+    }
+
+    Q_ASSERT( !tiles.isEmpty() );
+
+    return d->state()->createTile( tiles );
 }
 
 RenderState MergedLayerDecorator::renderState( const TileId &stackedTileId ) const
@@ -332,7 +405,7 @@ RenderState MergedLayerDecorator::renderState( const TileId &stackedTileId ) con
     RenderState state( nameTemplate.arg( stackedTileId.zoomLevel() )
                        .arg( stackedTileId.x() )
                        .arg( stackedTileId.y() ) );
-    const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->findRelevantTextureLayers( stackedTileId );
+    const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->state()->findRelevantTextureLayers( stackedTileId );
     for ( const GeoSceneTextureTileDataset *layer: textureLayers ) {
         const TileId tileId( layer->sourceDir(), stackedTileId.zoomLevel(),
                              stackedTileId.x(), stackedTileId.y() );
@@ -357,14 +430,19 @@ RenderState MergedLayerDecorator::renderState( const TileId &stackedTileId ) con
 
 bool MergedLayerDecorator::hasTextureLayer() const
 {
-    return !d->m_textureLayers.isEmpty();
+    return !d->state()->m_textureLayers.isEmpty();
 }
 
 StackedTile *MergedLayerDecorator::updateTile( const StackedTile &stackedTile, const TileId &tileId, const QImage &tileImage )
 {
     Q_ASSERT( !tileImage.isNull() );
 
-    d->detectMaxTileLevel();
+    // a download can only raise the highest level available on disk
+    if ( tileId.zoomLevel() > d->state()->m_maxTileLevel ) {
+        d->modifyState( []( Private::State &state ) {
+            state.detectMaxTileLevel();
+        } );
+    }
 
     QVector<QSharedPointer<TextureTile> > tiles = stackedTile.tiles();
 
@@ -376,12 +454,12 @@ StackedTile *MergedLayerDecorator::updateTile( const StackedTile &stackedTile, c
         }
     }
 
-    return d->createTile( tiles );
+    return d->state()->createTile( tiles );
 }
 
 void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage usage )
 {
-    const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->findRelevantTextureLayers( id );
+    const QVector<const GeoSceneTextureTileDataset *> textureLayers = d->state()->findRelevantTextureLayers( id );
 
     for ( const GeoSceneTextureTileDataset *textureLayer: textureLayers ) {
         if ( TileLoader::tileStatus( textureLayer, id ) != TileLoader::Available || usage == DownloadBrowse ) {
@@ -392,111 +470,36 @@ void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage
 
 void MergedLayerDecorator::setShowSunShading( bool show )
 {
-    d->m_showSunShading = show;
+    d->modifyState( [show]( Private::State &state ) {
+        state.m_showSunShading = show;
+    } );
 }
 
 bool MergedLayerDecorator::showSunShading() const
 {
-    return d->m_showSunShading;
+    return d->state()->m_showSunShading;
 }
 
 void MergedLayerDecorator::setShowCityLights( bool show )
 {
-    d->m_showCityLights = show;
+    d->modifyState( [show]( Private::State &state ) {
+        state.m_showCityLights = show;
+    } );
 }
 
 bool MergedLayerDecorator::showCityLights() const
 {
-    return d->m_showCityLights;
+    return d->state()->m_showCityLights;
 }
 
 void MergedLayerDecorator::setShowTileId( bool visible )
 {
-    d->m_showTileId = visible;
+    d->modifyState( [visible]( Private::State &state ) {
+        state.m_showTileId = visible;
+    } );
 }
 
-void MergedLayerDecorator::Private::paintSunShading( QImage *tileImage, const TileId &id ) const
-{
-    if ( tileImage->depth() != 32 )
-        return;
-
-    // TODO add support for 8-bit maps?
-    // add sun shading
-    const qreal  global_width  = tileImage->width()
-            * TileLoaderHelper::levelToColumn( m_levelZeroColumns, id.zoomLevel() );
-    const qreal  global_height = tileImage->height()
-            * TileLoaderHelper::levelToRow( m_levelZeroRows, id.zoomLevel() );
-    const qreal lon_scale = 2*M_PI / global_width;
-    const qreal lat_scale = -M_PI / global_height;
-    const int tileHeight = tileImage->height();
-    const int tileWidth = tileImage->width();
-
-    // First we determine the supporting point interval for the interpolation.
-    const int n = maxDivisor( 30, tileWidth );
-    const int ipRight = n * (int)( tileWidth / n );
-
-    for ( int cur_y = 0; cur_y < tileHeight; ++cur_y ) {
-        const qreal lat = lat_scale * ( id.y() * tileHeight + cur_y ) - 0.5*M_PI;
-        const qreal a = sin( (lat+DEG2RAD * m_sunLocator->getLat() )/2.0 );
-        const qreal c = cos(lat)*cos( -DEG2RAD * m_sunLocator->getLat() );
-
-        QRgb* scanline = (QRgb*)tileImage->scanLine( cur_y );
-
-        qreal lastShade = -10.0;
-
-        int cur_x = 0;
-
-        while ( cur_x < tileWidth ) {
-
-            const bool interpolate = ( cur_x != 0 && cur_x < ipRight && cur_x + n < tileWidth );
-
-            qreal shade = 0;
-
-            if ( interpolate ) {
-                const int check = cur_x + n;
-                const qreal checklon   = lon_scale * ( id.x() * tileWidth + check );
-                shade = m_sunLocator->shading( checklon, a, c );
-
-                // if the shading didn't change across the interpolation
-                // interval move on and don't change anything.
-                if ( shade == lastShade && shade == 1.0 ) {
-                    scanline += n;
-                    cur_x += n;
-                    continue;
-                }
-                if ( shade == lastShade && shade == 0.0 ) {
-                    for ( int t = 0; t < n; ++t ) {
-                        SunLocator::shadePixel(*scanline, shade);
-                        ++scanline;
-                    }
-                    cur_x += n;
-                    continue;
-                }
-                for ( int t = 0; t < n ; ++t ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    SunLocator::shadePixel(*scanline, shade);
-                    ++scanline;
-                    ++cur_x;
-                }
-            }
-
-            else {
-                // Make sure we don't exceed the image memory
-                if ( cur_x < tileWidth ) {
-                    const qreal lon   = lon_scale * ( id.x() * tileWidth + cur_x );
-                    shade = m_sunLocator->shading( lon, a, c );
-                    SunLocator::shadePixel(*scanline, shade);
-                    ++scanline;
-                    ++cur_x;
-                }
-            }
-            lastShade = shade;
-        }
-    }
-}
-
-void MergedLayerDecorator::Private::paintTileId( QImage *tileImage, const TileId &id ) const
+void MergedLayerDecorator::Private::State::paintTileId( QImage *tileImage, const TileId &id ) const
 {
     QString filename = QString( "%1_%2.jpg" )
             .arg(id.x(), tileDigits, 10, QLatin1Char('0'))
@@ -558,7 +561,7 @@ void MergedLayerDecorator::Private::paintTileId( QImage *tileImage, const TileId
     painter.drawPath( outlinepath );
 }
 
-void MergedLayerDecorator::Private::detectMaxTileLevel()
+void MergedLayerDecorator::Private::State::detectMaxTileLevel()
 {
     if ( m_textureLayers.isEmpty() ) {
         m_maxTileLevel = -1;
@@ -568,7 +571,7 @@ void MergedLayerDecorator::Private::detectMaxTileLevel()
     m_maxTileLevel = TileLoader::maximumTileLevel( *m_textureLayers.at( 0 ) );
 }
 
-QVector<const GeoSceneTextureTileDataset *> MergedLayerDecorator::Private::findRelevantTextureLayers( const TileId &stackedTileId ) const
+QVector<const GeoSceneTextureTileDataset *> MergedLayerDecorator::Private::State::findRelevantTextureLayers( const TileId &stackedTileId ) const
 {
     QVector<const GeoSceneTextureTileDataset *> result;
 
@@ -594,24 +597,3 @@ QVector<const GeoSceneTextureTileDataset *> MergedLayerDecorator::Private::findR
     return result;
 }
 
-// TODO: This should likely go into a math class in the future ...
-
-int MergedLayerDecorator::Private::maxDivisor( int maximum, int fullLength )
-{
-    // Find the optimal interpolation interval n for the
-    // current image canvas width
-    int best = 2;
-
-    int  nEvalMin = fullLength;
-    for ( int it = 1; it <= maximum; ++it ) {
-        // The optimum is the interval which results in the least amount
-        // supporting points taking into account the rest which can't
-        // get used for interpolation.
-        int nEval = fullLength / it + fullLength % it;
-        if ( nEval < nEvalMin ) {
-            nEvalMin = nEval;
-            best = it;
-        }
-    }
-    return best;
-}
@@ -49,6 +49,11 @@ class MergedLayerDecorator
 
     int textureLayersSize() const;
 
+    /**
+     * Returns the texture layers which are currently shown.
+     */
+    QVector<const GeoSceneTextureTileDataset *> textureLayers() const;
+
     /**
      * Returns the highest level in which some tiles are theoretically
      * available for the current texture layers.
@@ -65,6 +70,12 @@ class MergedLayerDecorator
 
     StackedTile *loadTile( const TileId &id );
 
+    /**
+     * Returns a tile for @p id scaled up from the part of @p lowerLevelTile it
+     * covers. Unlike loadTile() this does not access the file system.
+     */
+    StackedTile *loadPlaceholderTile( const TileId &id, const StackedTile &lowerLevelTile ) const;
+
     StackedTile *updateTile( const StackedTile &stackedTile, const TileId &tileId, const QImage &tileImage );
 
     void downloadStackedTile( const TileId &id, DownloadUsage usage );
@@ -13,6 +13,7 @@
 #include "PlacemarkLayout.h"
 
 #include <QAbstractItemModel>
+#include <QDateTime>
 #include <QList>
 #include <QPoint>
 #include <QVectorIterator>
@@ -40,25 +41,9 @@
 #include "TileCoordsPyramid.h"
 #include "VisiblePlacemark.h"
 #include "MathHelper.h"
+#include "AbstractProjection.h"
 #include <StyleBuilder.h>
 
-namespace
-{   //Helper function that checks for available room for the label
-    bool hasRoomFor(const QVector<Marble::VisiblePlacemark*> & placemarks, const QRectF &boundingBox)
-    {
-        // Check if there is another label or symbol that overlaps.
-        QVector<Marble::VisiblePlacemark*>::const_iterator beforeItEnd = placemarks.constEnd();
-        for ( QVector<Marble::VisiblePlacemark*>::ConstIterator beforeIt = placemarks.constBegin();
-              beforeIt != beforeItEnd; ++beforeIt )
-        {
-            if ( boundingBox.intersects( (*beforeIt)->boundingBox() ) ) {
-                return false;
-            }
-        }
-        return true;
-    }
-}
-
 namespace Marble
 {
 
@@ -124,7 +109,14 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
       m_maxLabelHeight(maxLabelHeight()),
       m_styleResetRequested( true ),
       m_styleBuilder(styleBuilder),
-      m_lastPlacemarkAvailable(false)
+      m_lastPlacemarkAvailable(false),
+      m_gridColumns( 0 ),
+      m_gridRows( 0 ),
+      m_gridCellSize( 1 ),
+      m_layoutReusable( false ),
+      m_lastTileLevel( -1 ),
+      m_lastProjection( Spherical ),
+      m_lastRadius( 0 )
 {
     Q_ASSERT(m_placemarkModel);
 
@@ -150,42 +142,50 @@ PlacemarkLayout::~PlacemarkLayout()
 void PlacemarkLayout::setShowPlaces( bool show )
 {
     m_showPlaces = show;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::setShowCities( bool show )
 {
     m_showCities = show;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::setShowTerrain( bool show )
 {
     m_showTerrain = show;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::setShowOtherPlaces( bool show )
 {
     m_showOtherPlaces = show;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::setShowLandingSites( bool show )
 {
     m_showLandingSites = show;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::setShowCraters( bool show )
 {
     m_showCraters = show;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::setShowMaria( bool show )
 {
     m_showMaria = show;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::requestStyleReset()
 {
     mDebug() << "Style reset requested.";
     m_styleResetRequested = true;
+    m_layoutReusable = false;
 }
 
 void PlacemarkLayout::styleReset()
@@ -202,6 +202,7 @@ void PlacemarkLayout::clearCache()
     m_lastPlacemarkLabelRect = QRectF();
     m_lastPlacemarkSymbolRect = QRectF();
     m_labelArea = 0;
+    m_layoutReusable = false;
     qDeleteAll( m_visiblePlacemarks );
     m_visiblePlacemarks.clear();
 }
@@ -259,6 +260,7 @@ void PlacemarkLayout::addPlacemarks( const QModelIndex& parent, int first, int l
             m_placemarkCache[key].append( placemark );
         }
     }
+    m_layoutReusable = false;
     emit repaintNeeded();
 }
 
@@ -277,8 +279,9 @@ void PlacemarkLayout::removePlacemarks( const QModelIndex& parent, int first, in
 
         int zoomLevel = placemark->zoomLevel();
         TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
-        delete m_visiblePlacemarks[placemark];
-        m_visiblePlacemarks.remove(placemark);
+        VisiblePlacemark *mark = m_visiblePlacemarks.take(placemark);
+        m_paintOrder.removeOne(mark);
+        delete mark;
         m_placemarkCache[key].removeAll( placemark );
         if (placemark->hasOsmData()) {
             qint64 const osmId = placemark->osmData().id();
@@ -287,6 +290,7 @@ void PlacemarkLayout::removePlacemarks( const QModelIndex& parent, int first, in
             }
         }
     }
+    m_layoutReusable = false;
     emit repaintNeeded();
 }
 
@@ -371,164 +375,271 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
         return QVector<VisiblePlacemark *>();
     }
 
-    QList<const GeoDataPlacemark*> placemarkList;
-    int currentMaxLabelHeight;
-    do {
-        currentMaxLabelHeight = m_maxLabelHeight;
-        const int secnumber = viewport->height() / m_maxLabelHeight + 1;
-        m_rowsection.clear();
-        m_rowsection.resize(secnumber);
-
+    if ( !translateLayout( viewport, tileLevel ) ) {
+        resetGrid( viewport->size() );
         m_paintOrder.clear();
         m_lastPlacemarkAvailable = false;
         m_lastPlacemarkLabelRect = QRectF();
         m_lastPlacemarkSymbolRect = QRectF();
         m_labelArea = 0;
+        m_layoutShift = QPointF();
 
-        // First handle the selected placemarks as they have the highest priority.
-
-        const QModelIndexList selectedIndexes = m_selectionModel->selection().indexes();
-        auto const viewLatLonAltBox = viewport->viewLatLonAltBox();
-
-        for ( int i = 0; i < selectedIndexes.count(); ++i ) {
-            const QModelIndex index = selectedIndexes.at( i );
-            const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
-            const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
+        const int candidates = layoutPlacemarks( viewport, tileLevel, QRectF(), QSet<const GeoDataPlacemark*>() );
+        m_runtimeTrace = QStringLiteral("Placemarks: %1 Drawn: %2").arg(candidates).arg(m_paintOrder.size());
+    }
 
-            if ( !coordinates.isValid() ) {
-                continue;
+    if (m_visiblePlacemarks.size() > qMax(100, 4 * m_paintOrder.size())) {
+        auto const extendedBox = viewport->viewLatLonAltBox().scaled(2.0, 2.0);
+        QVector<VisiblePlacemark*> outdated;
+        for (auto placemark: m_visiblePlacemarks) {
+            if (!extendedBox.contains(placemark->coordinates())) {
+                outdated << placemark;
             }
+        }
+        for (auto placemark: outdated) {
+            delete m_visiblePlacemarks.take(placemark->placemark());
+        }
+    }
 
-            qreal x = 0;
-            qreal y = 0;
+    m_layoutReusable = true;
+    m_lastTileLevel = tileLevel;
+    m_lastProjection = viewport->projection();
+    m_lastRadius = viewport->radius();
+    m_lastSize = viewport->size();
 
-            if ( !viewLatLonAltBox.contains( coordinates ) ||
-                 ! viewport->screenCoordinates( coordinates, x, y ))
-                {
-                    continue;
-                }
+    return m_paintOrder;
+}
 
-            if( layoutPlacemark( placemark, coordinates, x, y, true) ) {
-                // Make sure not to draw more placemarks on the screen than
-                // specified by placemarksOnScreenLimit().
-                if ( placemarksOnScreenLimit( viewport->size() ) )
-                    break;
-            }
+bool PlacemarkLayout::translateLayout( const ViewportParams *viewport, int tileLevel )
+{
+    // Panning a cylindrical map moves all placemarks by the same offset. Other
+    // projections rotate the globe instead.
+    if ( !m_layoutReusable || m_paintOrder.isEmpty()
+         || tileLevel != m_lastTileLevel
+         || viewport->projection() != m_lastProjection
+         || viewport->radius() != m_lastRadius
+         || viewport->size() != m_lastSize
+         || viewport->currentProjection()->surfaceType() != AbstractProjection::Cylindrical ) {
+        return false;
+    }
 
+    // Find the offset and make sure all placemarks still on the screen moved by
+    // it. They do not if the map wrapped around at the date line or if the
+    // placemarks moved in time.
+    const QDateTime dateTime = m_clock->dateTime();
+    QVector<VisiblePlacemark*> remaining;
+    QVector<QPointF> positions;
+    QPointF shift;
+    for ( VisiblePlacemark *mark: m_paintOrder ) {
+        qreal x = 0;
+        qreal y = 0;
+        if ( !viewport->screenCoordinates( mark->placemark()->coordinate( dateTime ), x, y ) ) {
+            continue;
+        }
+
+        const QPointF position = QPointF( x, y ) - mark->hotSpot();
+        const QPointF offset = position - mark->symbolPosition();
+        if ( remaining.isEmpty() ) {
+            shift = offset;
+        } else if ( ( offset - shift ).manhattanLength() > 0.5 ) {
+            return false;
         }
+        remaining << mark;
+        positions << position;
+    }
+
+    // The placemarks entering the view are laid out in batches, which takes
+    // their priority into account less than laying out all placemarks at once.
+    // Start over once the map has been panned by half a screen.
+    m_layoutShift += shift;
+    if ( remaining.isEmpty()
+         || qAbs( m_layoutShift.x() ) > viewport->width() / 2
+         || qAbs( m_layoutShift.y() ) > viewport->height() / 2 ) {
+        return false;
+    }
+
+    resetGrid( viewport->size() );
+    m_paintOrder.clear();
+    m_lastPlacemarkAvailable = false;
+    m_lastPlacemarkLabelRect = QRectF();
+    m_lastPlacemarkSymbolRect = QRectF();
+    m_labelArea = 0;
 
-        // Now handle all other placemarks...
+    QSet<const GeoDataPlacemark*> laidOut;
+    for ( int i = 0; i < remaining.size(); ++i ) {
+        VisiblePlacemark *mark = remaining[i];
+        mark->setSymbolPosition( positions[i] );
+        mark->setLabelRect( mark->labelRect().translated( shift ) );
+        addToGrid( mark );
+        m_paintOrder.append( mark );
+        laidOut.insert( mark->placemark() );
+        QRectF const boundingBox = mark->boundingBox();
+        m_labelArea += boundingBox.width() * boundingBox.height();
+    }
 
-        const QItemSelection selection = m_selectionModel->selection();
+    int candidates = 0;
+    if ( !shift.isNull() && !placemarksOnScreenLimit( viewport->size() ) ) {
+        const QRectF previousView = QRectF( QPointF( 0, 0 ), viewport->size() ).translated( shift );
+        candidates = layoutPlacemarks( viewport, tileLevel, previousView, laidOut );
+    }
 
-        placemarkList.clear();
-        for (const TileId &tileId: visibleTiles(*viewport, tileLevel)) {
-            placemarkList += m_placemarkCache.value( tileId );
+    m_runtimeTrace = QStringLiteral("Placemarks: %1 Drawn: %2 Moved: %3").arg(candidates).arg(m_paintOrder.size()).arg(remaining.size());
+    return true;
+}
+
+int PlacemarkLayout::layoutPlacemarks( const ViewportParams *viewport, int tileLevel,
+                                       const QRectF &previousView,
+                                       const QSet<const GeoDataPlacemark*> &laidOut )
+{
+    const QDateTime dateTime = m_clock->dateTime();
+    auto const viewLatLonAltBox = viewport->viewLatLonAltBox();
+
+    // Placemarks at a position which was visible before have been laid out already.
+    auto const isLaidOut = [&]( const GeoDataPlacemark *placemark ) {
+        if ( laidOut.contains( placemark ) ) {
+            return true;
+        }
+        if ( previousView.isEmpty() ) {
+            return false;
+        }
+        qreal x = 0;
+        qreal y = 0;
+        return viewport->screenCoordinates( placemark->coordinate( dateTime ), x, y )
+                && previousView.contains( x, y );
+    };
+
+    // First handle the selected placemarks as they have the highest priority.
+
+    QSet<const GeoDataPlacemark*> selectedPlacemarks;
+    const QModelIndexList selectedIndexes = m_selectionModel->selection().indexes();
+    for ( int i = 0; i < selectedIndexes.count(); ++i ) {
+        const QModelIndex index = selectedIndexes.at( i );
+        const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
+        selectedPlacemarks.insert( placemark );
+        if ( isLaidOut( placemark ) ) {
+            continue;
         }
-        std::sort(placemarkList.begin(), placemarkList.end(), GeoDataPlacemark::placemarkLayoutOrderCompare);
 
-        for ( const GeoDataPlacemark *placemark: placemarkList ) {
-            const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
-            if ( !coordinates.isValid() ) {
+        const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
+
+        if ( !coordinates.isValid() ) {
+            continue;
+        }
+
+        qreal x = 0;
+        qreal y = 0;
+
+        if ( !viewLatLonAltBox.contains( coordinates ) ||
+             ! viewport->screenCoordinates( coordinates, x, y ))
+            {
                 continue;
             }
 
-            int zoomLevel = placemark->zoomLevel();
-            if ( zoomLevel > 20 ) {
+        if( layoutPlacemark( placemark, coordinates, x, y, true) ) {
+            // Make sure not to draw more placemarks on the screen than
+            // specified by placemarksOnScreenLimit().
+            if ( placemarksOnScreenLimit( viewport->size() ) )
                 break;
-            }
+        }
 
-            qreal x = 0;
-            qreal y = 0;
+    }
 
-            if ( !viewLatLonAltBox.contains( coordinates ) ||
-                 ! viewport->screenCoordinates( coordinates, x, y )) {
-                    continue;
-                }
+    // Now handle all other placemarks...
 
-            if ( !placemark->isGloballyVisible() ) {
+    QList<const GeoDataPlacemark*> placemarkList;
+    for (const TileId &tileId: visibleTiles(*viewport, tileLevel)) {
+        placemarkList += m_placemarkCache.value( tileId );
+    }
+    if ( !previousView.isEmpty() || !laidOut.isEmpty() ) {
+        placemarkList.erase( std::remove_if( placemarkList.begin(), placemarkList.end(), isLaidOut ),
+                             placemarkList.end() );
+    }
+    std::sort(placemarkList.begin(), placemarkList.end(), GeoDataPlacemark::placemarkLayoutOrderCompare);
+
+    for ( const GeoDataPlacemark *placemark: placemarkList ) {
+        const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
+        if ( !coordinates.isValid() ) {
+            continue;
+        }
+
+        int zoomLevel = placemark->zoomLevel();
+        if ( zoomLevel > 20 ) {
+            break;
+        }
+
+        qreal x = 0;
+        qreal y = 0;
+
+        if ( !viewLatLonAltBox.contains( coordinates ) ||
+             ! viewport->screenCoordinates( coordinates, x, y )) {
                 continue;
             }
 
-            const GeoDataPlacemark::GeoDataVisualCategory visualCategory = placemark->visualCategory();
+        if ( !placemark->isGloballyVisible() || !isShown( placemark ) ) {
+            continue;
+        }
 
-            // Skip city marks if we're not showing cities.
-            if ( !m_showCities
-                 && visualCategory >= GeoDataPlacemark::SmallCity
-                 && visualCategory <= GeoDataPlacemark::Nation )
-                continue;
+        // We handled selected placemarks already, so we skip them here...
+        // Assuming that only a small amount of places is selected
+        // we check for the selected state after all other filters
+        if ( selectedPlacemarks.contains( placemark ) )
+            continue;
 
-            // Skip terrain marks if we're not showing terrain.
-            if ( !m_showTerrain
-                 && visualCategory >= GeoDataPlacemark::Mountain
-                 && visualCategory <= GeoDataPlacemark::OtherTerrain )
-                continue;
+        if( layoutPlacemark( placemark, coordinates, x, y, false ) ) {
+            // Make sure not to draw more placemarks on the screen than
+            // specified by placemarksOnScreenLimit().
+            if ( placemarksOnScreenLimit( viewport->size() ) )
+                break;
+        }
+    }
 
-            // Skip other places if we're not showing other places.
-            if ( !m_showOtherPlaces
-                 && visualCategory >= GeoDataPlacemark::GeographicPole
-                 && visualCategory <= GeoDataPlacemark::Observatory )
-                continue;
+    return placemarkList.count();
+}
 
-            // Skip landing sites if we're not showing landing sites.
-            if ( !m_showLandingSites
-                 && visualCategory >= GeoDataPlacemark::MannedLandingSite
-                 && visualCategory <= GeoDataPlacemark::UnmannedHardLandingSite )
-                continue;
+bool PlacemarkLayout::isShown( const GeoDataPlacemark *placemark ) const
+{
+    const GeoDataPlacemark::GeoDataVisualCategory visualCategory = placemark->visualCategory();
 
-            // Skip craters if we're not showing craters.
-            if ( !m_showCraters
-                 && visualCategory == GeoDataPlacemark::Crater )
-                continue;
+    // Skip city marks if we're not showing cities.
+    if ( !m_showCities
+         && visualCategory >= GeoDataPlacemark::SmallCity
+         && visualCategory <= GeoDataPlacemark::Nation )
+        return false;
 
-            // Skip maria if we're not showing maria.
-            if ( !m_showMaria
-                 && visualCategory == GeoDataPlacemark::Mare )
-                continue;
+    // Skip terrain marks if we're not showing terrain.
+    if ( !m_showTerrain
+         && visualCategory >= GeoDataPlacemark::Mountain
+         && visualCategory <= GeoDataPlacemark::OtherTerrain )
+        return false;
 
-            if ( !m_showPlaces
-                 && visualCategory >= GeoDataPlacemark::GeographicPole
-                 && visualCategory <= GeoDataPlacemark::Observatory )
-                continue;
+    // Skip other places if we're not showing other places.
+    if ( !m_showOtherPlaces
+         && visualCategory >= GeoDataPlacemark::GeographicPole
+         && visualCategory <= GeoDataPlacemark::Observatory )
+        return false;
 
-            // We handled selected placemarks already, so we skip them here...
-            // Assuming that only a small amount of places is selected
-            // we check for the selected state after all other filters
-            bool isSelected = false;
-            for ( const QModelIndex &index: selection.indexes() ) {
-                const GeoDataPlacemark *mark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
-                if (mark == placemark ) {
-                    isSelected = true;
-                    break;
-                }
-            }
-            if ( isSelected )
-                continue;
+    // Skip landing sites if we're not showing landing sites.
+    if ( !m_showLandingSites
+         && visualCategory >= GeoDataPlacemark::MannedLandingSite
+         && visualCategory <= GeoDataPlacemark::UnmannedHardLandingSite )
+        return false;
 
-            if( layoutPlacemark( placemark, coordinates, x, y, isSelected ) ) {
-                // Make sure not to draw more placemarks on the screen than
-                // specified by placemarksOnScreenLimit().
-                if ( placemarksOnScreenLimit( viewport->size() ) )
-                    break;
-            }
-        }
+    // Skip craters if we're not showing craters.
+    if ( !m_showCraters
+         && visualCategory == GeoDataPlacemark::Crater )
+        return false;
 
-        if (m_visiblePlacemarks.size() > qMax(100, 4 * m_paintOrder.size())) {
-            auto const extendedBox = viewLatLonAltBox.scaled(2.0, 2.0);
-            QVector<VisiblePlacemark*> outdated;
-            for (auto placemark: m_visiblePlacemarks) {
-                if (!extendedBox.contains(placemark->coordinates())) {
-                    outdated << placemark;
-                }
-            }
-            for (auto placemark: outdated) {
-                delete m_visiblePlacemarks.take(placemark->placemark());
-            }
-        }
-    } while (currentMaxLabelHeight != m_maxLabelHeight);
+    // Skip maria if we're not showing maria.
+    if ( !m_showMaria
+         && visualCategory == GeoDataPlacemark::Mare )
+        return false;
 
-    m_runtimeTrace = QStringLiteral("Placemarks: %1 Drawn: %2").arg(placemarkList.count()).arg(m_paintOrder.size());
-    return m_paintOrder;
+    if ( !m_showPlaces
+         && visualCategory >= GeoDataPlacemark::GeographicPole
+         && visualCategory <= GeoDataPlacemark::Observatory )
+        return false;
+
+    return true;
 }
 
 QString PlacemarkLayout::runtimeTrace() const
@@ -599,22 +710,12 @@ bool PlacemarkLayout::layoutPlacemark( const GeoDataPlacemark *placemark, const
     if (labelRect.isEmpty() && mark->symbolPixmap().isNull()) {
         return false;
     }
-    if (!mark->symbolPixmap().isNull() && !hasRoomForPixmap(y, mark)) {
+    if (!mark->symbolPixmap().isNull() && !hasRoomForPixmap(mark)) {
         return false;
     }
 
     mark->setLabelRect( labelRect );
-
-    // Add the current placemark to the matching row and its
-    // direct neighbors.
-    int idx = y / m_maxLabelHeight;
-    if ( idx - 1 >= 0 ) {
-        m_rowsection[ idx - 1 ].append( mark );
-    }
-    m_rowsection[ idx ].append( mark );
-    if ( idx + 1 < m_rowsection.size() ) {
-        m_rowsection[ idx + 1 ].append( mark );
-    }
+    addToGrid( mark );
 
     m_paintOrder.append( mark );
     QRectF const boundingBox = mark->boundingBox();
@@ -656,7 +757,6 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
         textWidth = ( QFontMetrics( labelFont ).width( labelText ) );
     }
 
-    const QVector<VisiblePlacemark*> currentsec = m_rowsection.at( y / m_maxLabelHeight );
     QRectF const symbolRect = placemark->symbolRect();
 
     if ( style->labelStyle().alignment() == GeoDataLabelStyle::Corner ) {
@@ -670,7 +770,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
                                               y - textHeight;
             const QRectF labelRect = QRectF( xPos, yPos, textWidth, textHeight );
 
-            if (hasRoomFor(currentsec, labelRect.united(symbolRect))) {
+            if (hasRoomFor(labelRect.united(symbolRect))) {
                 // claim the place immediately if it hasn't been used yet
                 return labelRect;
             }
@@ -681,7 +781,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
         QRectF  labelRect = QRectF( x - textWidth / 2, y - offsetY - textHeight,
                           textWidth, textHeight );
 
-        if (hasRoomFor(currentsec, labelRect.united(symbolRect))) {
+        if (hasRoomFor(labelRect.united(symbolRect))) {
             // claim the place immediately if it hasn't been used yet 
             return labelRect;
         }
@@ -701,7 +801,7 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
 
             const QRectF labelRect = QRectF(xPos, yPos, textWidth, textHeight);
 
-            if (hasRoomFor(currentsec, labelRect.united(symbolRect)))
+            if (hasRoomFor(labelRect.united(symbolRect)))
             {
                 return labelRect;
             }
@@ -712,10 +812,58 @@ QRectF PlacemarkLayout::roomForLabel( const GeoDataStyle::ConstPtr &style,
     return QRectF();
 }
 
-bool PlacemarkLayout::hasRoomForPixmap(const qreal y, const VisiblePlacemark *placemark) const
+void PlacemarkLayout::resetGrid( const QSize &size )
+{
+    // Cells several labels high keep the number of cells to look up small
+    // while holding only few placemarks each.
+    m_gridCellSize = 4 * m_maxLabelHeight;
+    m_gridColumns = size.width() / m_gridCellSize + 1;
+    m_gridRows = size.height() / m_gridCellSize + 1;
+    m_grid.resize( m_gridColumns * m_gridRows );
+    for ( QVector<VisiblePlacemark*> &cell: m_grid ) {
+        cell.clear();
+    }
+}
+
+QRect PlacemarkLayout::gridCells( const QRectF &boundingBox ) const
+{
+    // Parts of the bounding box outside of the screen fall into the border cells.
+    const int left = qBound( 0, qFloor( boundingBox.left() / m_gridCellSize ), m_gridColumns - 1 );
+    const int right = qBound( 0, qFloor( boundingBox.right() / m_gridCellSize ), m_gridColumns - 1 );
+    const int top = qBound( 0, qFloor( boundingBox.top() / m_gridCellSize ), m_gridRows - 1 );
+    const int bottom = qBound( 0, qFloor( boundingBox.bottom() / m_gridCellSize ), m_gridRows - 1 );
+    return QRect( QPoint( left, top ), QPoint( right, bottom ) );
+}
+
+void PlacemarkLayout::addToGrid( VisiblePlacemark *placemark )
+{
+    const QRect cells = gridCells( placemark->boundingBox() );
+    for ( int row = cells.top(); row <= cells.bottom(); ++row ) {
+        for ( int column = cells.left(); column <= cells.right(); ++column ) {
+            m_grid[row * m_gridColumns + column].append( placemark );
+        }
+    }
+}
+
+bool PlacemarkLayout::hasRoomFor( const QRectF &boundingBox ) const
+{
+    // Check if there is another label or symbol that overlaps.
+    const QRect cells = gridCells( boundingBox );
+    for ( int row = cells.top(); row <= cells.bottom(); ++row ) {
+        for ( int column = cells.left(); column <= cells.right(); ++column ) {
+            for ( const VisiblePlacemark *placemark: m_grid.at( row * m_gridColumns + column ) ) {
+                if ( boundingBox.intersects( placemark->boundingBox() ) ) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool PlacemarkLayout::hasRoomForPixmap( const VisiblePlacemark *placemark ) const
 {
-    const QVector<VisiblePlacemark*> currentsec = m_rowsection.at(y / m_maxLabelHeight);
-    return hasRoomFor(currentsec, placemark->symbolRect());
+    return hasRoomFor( placemark->symbolRect() );
 }
 
 bool PlacemarkLayout::placemarksOnScreenLimit( const QSize &screenSize ) const
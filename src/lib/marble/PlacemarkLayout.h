@@ -26,6 +26,7 @@
 
 #include "GeoDataPlacemark.h"
 #include <GeoDataStyle.h>
+#include "MarbleGlobal.h"
 
 class QAbstractItemModel;
 class QItemSelectionModel;
@@ -120,7 +121,29 @@ class PlacemarkLayout : public QObject
     void clearCache();
 
     static QSet<TileId> visibleTiles(const ViewportParams &viewport, int tileLevel);
+
+    /**
+     * Moves the placemarks laid out last time along with the map if the map was
+     * panned since, and lays out the placemarks which entered the view.
+     * Returns false if the last layout cannot be re-used.
+     */
+    bool translateLayout( const ViewportParams *viewport, int tileLevel );
+
+    /**
+     * Lays out the placemarks of the visible tiles in the order of their priority,
+     * skipping those at a screen position within @p previousView and those in
+     * @p laidOut. Returns the number of candidate placemarks.
+     */
+    int layoutPlacemarks( const ViewportParams *viewport, int tileLevel,
+                          const QRectF &previousView,
+                          const QSet<const GeoDataPlacemark*> &laidOut );
+
     bool layoutPlacemark(const GeoDataPlacemark *placemark, const GeoDataCoordinates &coordinates, qreal x, qreal y, bool selected );
+    bool isShown( const GeoDataPlacemark *placemark ) const;
+
+    void resetGrid( const QSize &size );
+    void addToGrid( VisiblePlacemark *placemark );
+    QRect gridCells( const QRectF &boundingBox ) const;
 
     /**
      * Returns the coordinates at which an icon should be drawn for the @p placemark.
@@ -132,7 +155,8 @@ class PlacemarkLayout : public QObject
     QRectF  roomForLabel(const GeoDataStyle::ConstPtr &style,
                          const qreal x, const qreal y,
                          const QString &labelText , const VisiblePlacemark *placemark) const;
-    bool    hasRoomForPixmap(const qreal y, const VisiblePlacemark *placemark) const;
+    bool    hasRoomFor( const QRectF &boundingBox ) const;
+    bool    hasRoomForPixmap( const VisiblePlacemark *placemark ) const;
 
     bool    placemarksOnScreenLimit( const QSize &screenSize ) const;
 
@@ -146,7 +170,13 @@ class PlacemarkLayout : public QObject
     QString m_runtimeTrace;
     int m_labelArea;
     QHash<const GeoDataPlacemark*, VisiblePlacemark*> m_visiblePlacemarks;
-    QVector< QVector< VisiblePlacemark* > >  m_rowsection;
+
+    /// laid out placemarks in the cells of a uniform grid covering the screen,
+    /// each in all cells overlapped by its bounding box
+    QVector< QVector< VisiblePlacemark* > >  m_grid;
+    int m_gridColumns;
+    int m_gridRows;
+    int m_gridCellSize;
 
     /// map providing the list of placemark belonging in TileId as key
     QMap<TileId, QList<const GeoDataPlacemark*> > m_placemarkCache;
@@ -173,6 +203,14 @@ class PlacemarkLayout : public QObject
     bool m_lastPlacemarkAvailable;
     QRectF m_lastPlacemarkLabelRect;
     QRectF m_lastPlacemarkSymbolRect;
+
+    // viewport of the last layout, to re-use the layout when the map is panned
+    bool m_layoutReusable;
+    int m_lastTileLevel;
+    Projection m_lastProjection;
+    int m_lastRadius;
+    QSize m_lastSize;
+    QPointF m_layoutShift;
 };
 
 }
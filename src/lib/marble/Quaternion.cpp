@@ -13,11 +13,23 @@
 #include "Quaternion.h"
 
 #include <cmath>
+#include <limits>
 using namespace std;
 
 #include <QString>
 #include <QDebug>
 
+// Vectorized paths of rotateToSpherical(): SSE2 is part of every x86-64 CPU,
+// AVX2 is picked at runtime if the CPU supports it
+#if !defined(QT_COORD_TYPE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define MARBLE_BATCH_SSE2
+#  include <emmintrin.h>
+#  if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define MARBLE_BATCH_AVX2
+#    include <immintrin.h>
+#  endif
+#endif
+
 
 using namespace Marble;
 
@@ -281,3 +293,228 @@ void Quaternion::rotateAroundAxis(const matrix &m)
     v[Q_Y] = y;
     v[Q_Z] = z;
 }
+
+namespace
+{
+
+// atan() is evaluated for arguments of at most tan(pi / 8) after reduction
+const qreal tanPi8 = 0.41421356237309504880;
+
+// Taylor series of atan(u) / u in s = u * u up to u^22, in Horner order.
+// The truncation error for |u| <= tan(pi / 8) is below 1.1e-11 radians.
+const qreal atanCoefficients[] = {
+    -1.0 / 23, 1.0 / 21, -1.0 / 19, 1.0 / 17, -1.0 / 15, 1.0 / 13,
+    -1.0 / 11, 1.0 / 9, -1.0 / 7, 1.0 / 5, -1.0 / 3, 1.0
+};
+const int atanCoefficientCount = sizeof(atanCoefficients) / sizeof(atanCoefficients[0]);
+
+// Same as getSpherical(): no longitude for vectors close to the poles
+const qreal minimumHorizontalLength = 0.00005;
+
+inline qreal approxAtan2(qreal y, qreal x)
+{
+    const qreal ax = fabs(x);
+    const qreal ay = fabs(y);
+    const qreal t = qMin(ax, ay) / qMax(qMax(ax, ay), std::numeric_limits<qreal>::min());
+
+    // atan(t) = pi / 4 + atan((t - 1) / (t + 1))
+    const bool reduced = t > tanPi8;
+    const qreal u = reduced ? (t - 1.0) / (t + 1.0) : t;
+    const qreal s = u * u;
+
+    qreal p = atanCoefficients[0];
+    for (int i = 1; i < atanCoefficientCount; ++i) {
+        p = p * s + atanCoefficients[i];
+    }
+
+    qreal a = u * p + (reduced ? M_PI / 4 : 0.0);
+    a = ay > ax ? M_PI / 2 - a : a;
+    a = x < 0 ? M_PI - a : a;
+    return y < 0 ? -a : a;
+}
+
+void rotateToSphericalScalar(const matrix &m,
+                             const qreal *x, const qreal *y, const qreal *z,
+                             int count, qreal *lon, qreal *lat)
+{
+    for (int i = 0; i < count; ++i) {
+        const qreal rx = m[0][0] * x[i] + m[1][0] * y[i] + m[2][0] * z[i];
+        const qreal ry = m[0][1] * x[i] + m[1][1] * y[i] + m[2][1] * z[i];
+        const qreal rz = m[0][2] * x[i] + m[1][2] * y[i] + m[2][2] * z[i];
+
+        const qreal horizontal = rx * rx + rz * rz;
+        lat[i] = approxAtan2(ry, sqrt(horizontal));
+        lon[i] = horizontal > minimumHorizontalLength ? approxAtan2(rx, rz) : 0.0;
+    }
+}
+
+#ifdef MARBLE_BATCH_SSE2
+
+inline __m128d selectSse2(__m128d mask, __m128d a, __m128d b)
+{
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+inline __m128d approxAtan2Sse2(__m128d y, __m128d x)
+{
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+
+    const __m128d ax = _mm_andnot_pd(signMask, x);
+    const __m128d ay = _mm_andnot_pd(signMask, y);
+    const __m128d t = _mm_div_pd(_mm_min_pd(ax, ay),
+                                 _mm_max_pd(_mm_max_pd(ax, ay), _mm_set1_pd(std::numeric_limits<qreal>::min())));
+
+    const __m128d reduced = _mm_cmpgt_pd(t, _mm_set1_pd(tanPi8));
+    const __m128d u = selectSse2(reduced, _mm_div_pd(_mm_sub_pd(t, one), _mm_add_pd(t, one)), t);
+    const __m128d s = _mm_mul_pd(u, u);
+
+    __m128d p = _mm_set1_pd(atanCoefficients[0]);
+    for (int i = 1; i < atanCoefficientCount; ++i) {
+        p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(atanCoefficients[i]));
+    }
+
+    __m128d a = _mm_add_pd(_mm_mul_pd(u, p), _mm_and_pd(reduced, _mm_set1_pd(M_PI / 4)));
+    a = selectSse2(_mm_cmpgt_pd(ay, ax), _mm_sub_pd(_mm_set1_pd(M_PI / 2), a), a);
+    a = selectSse2(_mm_cmplt_pd(x, zero), _mm_sub_pd(_mm_set1_pd(M_PI), a), a);
+    return _mm_xor_pd(a, _mm_and_pd(_mm_cmplt_pd(y, zero), signMask));
+}
+
+void rotateToSphericalSse2(const matrix &m,
+                           const qreal *x, const qreal *y, const qreal *z,
+                           int count, qreal *lon, qreal *lat)
+{
+    const __m128d m00 = _mm_set1_pd(m[0][0]), m10 = _mm_set1_pd(m[1][0]), m20 = _mm_set1_pd(m[2][0]);
+    const __m128d m01 = _mm_set1_pd(m[0][1]), m11 = _mm_set1_pd(m[1][1]), m21 = _mm_set1_pd(m[2][1]);
+    const __m128d m02 = _mm_set1_pd(m[0][2]), m12 = _mm_set1_pd(m[1][2]), m22 = _mm_set1_pd(m[2][2]);
+    const __m128d minimumHorizontal = _mm_set1_pd(minimumHorizontalLength);
+
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d vx = _mm_loadu_pd(x + i);
+        const __m128d vy = _mm_loadu_pd(y + i);
+        const __m128d vz = _mm_loadu_pd(z + i);
+
+        const __m128d rx = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m00, vx), _mm_mul_pd(m10, vy)), _mm_mul_pd(m20, vz));
+        const __m128d ry = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m01, vx), _mm_mul_pd(m11, vy)), _mm_mul_pd(m21, vz));
+        const __m128d rz = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m02, vx), _mm_mul_pd(m12, vy)), _mm_mul_pd(m22, vz));
+
+        const __m128d horizontal = _mm_add_pd(_mm_mul_pd(rx, rx), _mm_mul_pd(rz, rz));
+        _mm_storeu_pd(lat + i, approxAtan2Sse2(ry, _mm_sqrt_pd(horizontal)));
+        _mm_storeu_pd(lon + i, _mm_and_pd(_mm_cmpgt_pd(horizontal, minimumHorizontal), approxAtan2Sse2(rx, rz)));
+    }
+
+    rotateToSphericalScalar(m, x + i, y + i, z + i, count - i, lon + i, lat + i);
+}
+
+#endif
+
+#ifdef MARBLE_BATCH_AVX2
+
+__attribute__((target("avx2")))
+inline __m256d approxAtan2Avx2(__m256d y, __m256d x)
+{
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    const __m256d ax = _mm256_andnot_pd(signMask, x);
+    const __m256d ay = _mm256_andnot_pd(signMask, y);
+    const __m256d t = _mm256_div_pd(_mm256_min_pd(ax, ay),
+                                    _mm256_max_pd(_mm256_max_pd(ax, ay), _mm256_set1_pd(std::numeric_limits<qreal>::min())));
+
+    const __m256d reduced = _mm256_cmp_pd(t, _mm256_set1_pd(tanPi8), _CMP_GT_OQ);
+    const __m256d u = _mm256_blendv_pd(t, _mm256_div_pd(_mm256_sub_pd(t, one), _mm256_add_pd(t, one)), reduced);
+    const __m256d s = _mm256_mul_pd(u, u);
+
+    __m256d p = _mm256_set1_pd(atanCoefficients[0]);
+    for (int i = 1; i < atanCoefficientCount; ++i) {
+        p = _mm256_add_pd(_mm256_mul_pd(p, s), _mm256_set1_pd(atanCoefficients[i]));
+    }
+
+    __m256d a = _mm256_add_pd(_mm256_mul_pd(u, p), _mm256_and_pd(reduced, _mm256_set1_pd(M_PI / 4)));
+    a = _mm256_blendv_pd(a, _mm256_sub_pd(_mm256_set1_pd(M_PI / 2), a), _mm256_cmp_pd(ay, ax, _CMP_GT_OQ));
+    a = _mm256_blendv_pd(a, _mm256_sub_pd(_mm256_set1_pd(M_PI), a), _mm256_cmp_pd(x, zero, _CMP_LT_OQ));
+    return _mm256_xor_pd(a, _mm256_and_pd(_mm256_cmp_pd(y, zero, _CMP_LT_OQ), signMask));
+}
+
+__attribute__((target("avx2")))
+void rotateToSphericalAvx2(const matrix &m,
+                           const qreal *x, const qreal *y, const qreal *z,
+                           int count, qreal *lon, qreal *lat)
+{
+    const __m256d m00 = _mm256_set1_pd(m[0][0]), m10 = _mm256_set1_pd(m[1][0]), m20 = _mm256_set1_pd(m[2][0]);
+    const __m256d m01 = _mm256_set1_pd(m[0][1]), m11 = _mm256_set1_pd(m[1][1]), m21 = _mm256_set1_pd(m[2][1]);
+    const __m256d m02 = _mm256_set1_pd(m[0][2]), m12 = _mm256_set1_pd(m[1][2]), m22 = _mm256_set1_pd(m[2][2]);
+    const __m256d minimumHorizontal = _mm256_set1_pd(minimumHorizontalLength);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d vx = _mm256_loadu_pd(x + i);
+        const __m256d vy = _mm256_loadu_pd(y + i);
+        const __m256d vz = _mm256_loadu_pd(z + i);
+
+        const __m256d rx = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m00, vx), _mm256_mul_pd(m10, vy)), _mm256_mul_pd(m20, vz));
+        const __m256d ry = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m01, vx), _mm256_mul_pd(m11, vy)), _mm256_mul_pd(m21, vz));
+        const __m256d rz = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m02, vx), _mm256_mul_pd(m12, vy)), _mm256_mul_pd(m22, vz));
+
+        const __m256d horizontal = _mm256_add_pd(_mm256_mul_pd(rx, rx), _mm256_mul_pd(rz, rz));
+        _mm256_storeu_pd(lat + i, approxAtan2Avx2(ry, _mm256_sqrt_pd(horizontal)));
+        _mm256_storeu_pd(lon + i, _mm256_and_pd(_mm256_cmp_pd(horizontal, minimumHorizontal, _CMP_GT_OQ),
+                                                approxAtan2Avx2(rx, rz)));
+    }
+
+    rotateToSphericalScalar(m, x + i, y + i, z + i, count - i, lon + i, lat + i);
+}
+
+#endif
+
+}
+
+Quaternion::BatchInstructionSet Quaternion::batchInstructionSet()
+{
+    static const BatchInstructionSet instructionSet = []() {
+#ifdef MARBLE_BATCH_AVX2
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return Avx2Instructions;
+        }
+#endif
+#ifdef MARBLE_BATCH_SSE2
+        return Sse2Instructions;
+#else
+        return ScalarInstructions;
+#endif
+    }();
+
+    return instructionSet;
+}
+
+void Quaternion::rotateToSpherical(const matrix &m,
+                                   const qreal *x, const qreal *y, const qreal *z,
+                                   int count, qreal *lon, qreal *lat)
+{
+    rotateToSpherical(batchInstructionSet(), m, x, y, z, count, lon, lat);
+}
+
+void Quaternion::rotateToSpherical(BatchInstructionSet instructionSet, const matrix &m,
+                                   const qreal *x, const qreal *y, const qreal *z,
+                                   int count, qreal *lon, qreal *lat)
+{
+    switch (qMin(instructionSet, batchInstructionSet())) {
+#ifdef MARBLE_BATCH_AVX2
+    case Avx2Instructions:
+        rotateToSphericalAvx2(m, x, y, z, count, lon, lat);
+        return;
+#endif
+#ifdef MARBLE_BATCH_SSE2
+    case Sse2Instructions:
+        rotateToSphericalSse2(m, x, y, z, count, lon, lat);
+        return;
+#endif
+    default:
+        rotateToSphericalScalar(m, x, y, z, count, lon, lat);
+        return;
+    }
+}
@@ -84,6 +84,39 @@ class MARBLE_EXPORT Quaternion
     void        toMatrix(matrix &m) const;
     void        rotateAroundAxis(const matrix &m);
 
+    /*!\brief instruction sets used by rotateToSpherical()
+     */
+    enum BatchInstructionSet {
+        ScalarInstructions,
+        Sse2Instructions,
+        Avx2Instructions
+    };
+
+    /*!\brief the fastest instruction set rotateToSpherical() can use on this CPU
+     */
+    static BatchInstructionSet batchInstructionSet();
+
+    /*!\brief rotates a batch of vectors and converts them to spherical coordinates
+     *
+     * Equivalent to calling rotateAroundAxis(m) followed by getSpherical()
+     * for each of the @p count unit vectors (x[i], y[i], z[i]), but processes
+     * two (SSE2) or four (AVX2) vectors at once, using the fastest instruction
+     * set of the CPU. atan2() and asin() are replaced by a polynomial
+     * approximation that deviates by less than 1e-10 radians from them.
+     *
+     * \param lon receives @p count longitudes
+     * \param lat receives @p count latitudes
+     */
+    static void rotateToSpherical(const matrix &m,
+                                  const qreal *x, const qreal *y, const qreal *z,
+                                  int count, qreal *lon, qreal *lat);
+
+    /*!\brief same as above, using at most the given @p instructionSet
+     */
+    static void rotateToSpherical(BatchInstructionSet instructionSet, const matrix &m,
+                                  const qreal *x, const qreal *y, const qreal *z,
+                                  int count, qreal *lon, qreal *lat);
+
     // TODO: Better add accessors...
     xmmfloat    v;
 };
@@ -0,0 +1,399 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "RenderProfiler.h"
+
+#include "RenderState.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QVector>
+
+#include <algorithm>
+
+namespace Marble
+{
+
+class Q_DECL_HIDDEN RenderProfiler::Private
+{
+public:
+    struct Event
+    {
+        QString m_name;
+        QString m_renderPosition;
+        qint64 m_start;
+        qint64 m_duration;
+        RenderStatus m_status;
+    };
+
+    struct Frame
+    {
+        int m_number;
+        qint64 m_start;
+        qint64 m_duration;
+        RenderStatus m_status;
+        QVector<Event> m_renderPositions;
+        QVector<Event> m_layers;
+    };
+
+    Private();
+
+    void trimHistory();
+
+    static Statistics statistics( QVector<qint64> &durations, const QVector<RenderStatus> &states );
+    static QString statusName( RenderStatus status );
+    static QJsonObject traceEvent( const QString &name, const QString &category, qint64 start, qint64 duration,
+                                   const QJsonObject &args );
+
+    bool m_enabled;
+    int m_historySize;
+    int m_frameNumber;
+    bool m_inFrame;
+    QElapsedTimer m_clock;
+    QList<Frame> m_frames;
+    Frame m_frame;
+    Event m_renderPosition;
+    qint64 m_layerStart;
+};
+
+RenderProfiler::Statistics::Statistics() :
+    frames( 0 ),
+    minimum( 0 ),
+    median( 0 ),
+    percentile95( 0 ),
+    percentile99( 0 ),
+    maximum( 0 ),
+    total( 0 ),
+    complete( 0 ),
+    waitingForUpdate( 0 ),
+    waitingForData( 0 ),
+    incomplete( 0 )
+{
+    // nothing to do
+}
+
+RenderProfiler::Private::Private() :
+    m_enabled( false ),
+    m_historySize( 300 ),
+    m_frameNumber( 0 ),
+    m_inFrame( false ),
+    m_layerStart( 0 )
+{
+    m_clock.start();
+}
+
+void RenderProfiler::Private::trimHistory()
+{
+    while ( m_frames.size() > m_historySize ) {
+        m_frames.removeFirst();
+    }
+}
+
+RenderProfiler::Statistics RenderProfiler::Private::statistics( QVector<qint64> &durations, const QVector<RenderStatus> &states )
+{
+    Statistics result;
+    result.frames = durations.size();
+    if ( durations.isEmpty() ) {
+        return result;
+    }
+
+    std::sort( durations.begin(), durations.end() );
+    // nearest rank percentiles
+    auto const percentile = [&durations]( int percent ) {
+        int const rank = ( percent * durations.size() + 99 ) / 100;
+        return durations[qBound( 0, rank - 1, durations.size() - 1 )];
+    };
+    result.minimum = durations.first();
+    result.median = percentile( 50 );
+    result.percentile95 = percentile( 95 );
+    result.percentile99 = percentile( 99 );
+    result.maximum = durations.last();
+    for ( qint64 duration: durations ) {
+        result.total += duration;
+    }
+
+    for ( RenderStatus status: states ) {
+        switch ( status ) {
+        case Complete:         ++result.complete;         break;
+        case WaitingForUpdate: ++result.waitingForUpdate; break;
+        case WaitingForData:   ++result.waitingForData;   break;
+        case Incomplete:       ++result.incomplete;       break;
+        }
+    }
+
+    return result;
+}
+
+QString RenderProfiler::Private::statusName( RenderStatus status )
+{
+    switch ( status ) {
+    case Complete:         return QStringLiteral( "Complete" );
+    case WaitingForUpdate: return QStringLiteral( "WaitingForUpdate" );
+    case WaitingForData:   return QStringLiteral( "WaitingForData" );
+    case Incomplete:       return QStringLiteral( "Incomplete" );
+    }
+
+    return QString();
+}
+
+QJsonObject RenderProfiler::Private::traceEvent( const QString &name, const QString &category, qint64 start, qint64 duration,
+                                                  const QJsonObject &args )
+{
+    // complete events, timestamps are given in microseconds
+    QJsonObject event;
+    event.insert( QStringLiteral( "name" ), name );
+    event.insert( QStringLiteral( "cat" ), category );
+    event.insert( QStringLiteral( "ph" ), QStringLiteral( "X" ) );
+    event.insert( QStringLiteral( "ts" ), start / 1000.0 );
+    event.insert( QStringLiteral( "dur" ), duration / 1000.0 );
+    event.insert( QStringLiteral( "pid" ), 1 );
+    event.insert( QStringLiteral( "tid" ), 1 );
+    event.insert( QStringLiteral( "args" ), args );
+    return event;
+}
+
+RenderProfiler::RenderProfiler() :
+    d( new Private )
+{
+    // nothing to do
+}
+
+RenderProfiler::~RenderProfiler()
+{
+    delete d;
+}
+
+void RenderProfiler::setEnabled( bool enabled )
+{
+    d->m_enabled = enabled;
+    d->m_inFrame = false;
+}
+
+bool RenderProfiler::isEnabled() const
+{
+    return d->m_enabled;
+}
+
+void RenderProfiler::setHistorySize( int frames )
+{
+    d->m_historySize = qMax( 1, frames );
+    d->trimHistory();
+}
+
+int RenderProfiler::historySize() const
+{
+    return d->m_historySize;
+}
+
+void RenderProfiler::clear()
+{
+    d->m_frames.clear();
+    d->m_inFrame = false;
+}
+
+int RenderProfiler::frameCount() const
+{
+    return d->m_frames.size();
+}
+
+QStringList RenderProfiler::layers() const
+{
+    QStringList result;
+    for ( const Private::Frame &frame: d->m_frames ) {
+        for ( const Private::Event &event: frame.m_layers ) {
+            if ( !result.contains( event.m_name ) ) {
+                result << event.m_name;
+            }
+        }
+    }
+    return result;
+}
+
+QStringList RenderProfiler::renderPositions() const
+{
+    QStringList result;
+    for ( const Private::Frame &frame: d->m_frames ) {
+        for ( const Private::Event &event: frame.m_renderPositions ) {
+            if ( !result.contains( event.m_name ) ) {
+                result << event.m_name;
+            }
+        }
+    }
+    return result;
+}
+
+RenderProfiler::Statistics RenderProfiler::frameStatistics() const
+{
+    QVector<qint64> durations;
+    QVector<RenderStatus> states;
+    for ( const Private::Frame &frame: d->m_frames ) {
+        durations << frame.m_duration;
+        states << frame.m_status;
+    }
+    return Private::statistics( durations, states );
+}
+
+RenderProfiler::Statistics RenderProfiler::layerStatistics( const QString &layer ) const
+{
+    // A layer may be rendered at several render positions, sum them up per frame
+    QVector<qint64> durations;
+    QVector<RenderStatus> states;
+    for ( const Private::Frame &frame: d->m_frames ) {
+        qint64 duration = -1;
+        RenderStatus status = Complete;
+        for ( const Private::Event &event: frame.m_layers ) {
+            if ( event.m_name == layer ) {
+                duration = qMax<qint64>( duration, 0 ) + event.m_duration;
+                status = event.m_status;
+            }
+        }
+        if ( duration >= 0 ) {
+            durations << duration;
+            states << status;
+        }
+    }
+    return Private::statistics( durations, states );
+}
+
+RenderProfiler::Statistics RenderProfiler::renderPositionStatistics( const QString &renderPosition ) const
+{
+    QVector<qint64> durations;
+    QVector<RenderStatus> states;
+    for ( const Private::Frame &frame: d->m_frames ) {
+        for ( const Private::Event &event: frame.m_renderPositions ) {
+            if ( event.m_name == renderPosition ) {
+                durations << event.m_duration;
+                states << event.m_status;
+            }
+        }
+    }
+    return Private::statistics( durations, states );
+}
+
+QByteArray RenderProfiler::toChromeTrace() const
+{
+    QJsonArray events;
+    for ( const Private::Frame &frame: d->m_frames ) {
+        QJsonObject args;
+        args.insert( QStringLiteral( "frame" ), frame.m_number );
+        args.insert( QStringLiteral( "status" ), Private::statusName( frame.m_status ) );
+        events.append( Private::traceEvent( QStringLiteral( "Frame" ), QStringLiteral( "frame" ),
+                                            frame.m_start, frame.m_duration, args ) );
+
+        for ( const Private::Event &event: frame.m_renderPositions ) {
+            events.append( Private::traceEvent( event.m_name, QStringLiteral( "renderPosition" ),
+                                                event.m_start, event.m_duration, args ) );
+        }
+
+        for ( const Private::Event &event: frame.m_layers ) {
+            QJsonObject layerArgs;
+            layerArgs.insert( QStringLiteral( "frame" ), frame.m_number );
+            layerArgs.insert( QStringLiteral( "renderPosition" ), event.m_renderPosition );
+            layerArgs.insert( QStringLiteral( "status" ), Private::statusName( event.m_status ) );
+            events.append( Private::traceEvent( event.m_name, QStringLiteral( "layer" ),
+                                                event.m_start, event.m_duration, layerArgs ) );
+        }
+    }
+
+    QJsonObject trace;
+    trace.insert( QStringLiteral( "traceEvents" ), events );
+    trace.insert( QStringLiteral( "displayTimeUnit" ), QStringLiteral( "ns" ) );
+    return QJsonDocument( trace ).toJson( QJsonDocument::Compact );
+}
+
+bool RenderProfiler::writeChromeTrace( const QString &fileName ) const
+{
+    QFile file( fileName );
+    if ( !file.open( QFile::WriteOnly | QFile::Truncate ) ) {
+        return false;
+    }
+
+    QByteArray const trace = toChromeTrace();
+    return file.write( trace ) == trace.size();
+}
+
+void RenderProfiler::beginFrame()
+{
+    if ( !d->m_enabled ) {
+        return;
+    }
+
+    d->m_frame = Private::Frame();
+    d->m_frame.m_number = d->m_frameNumber++;
+    d->m_frame.m_start = d->m_clock.nsecsElapsed();
+    d->m_frame.m_duration = 0;
+    d->m_frame.m_status = Complete;
+    d->m_inFrame = true;
+}
+
+void RenderProfiler::beginRenderPosition( const QString &renderPosition )
+{
+    if ( !d->m_inFrame ) {
+        return;
+    }
+
+    d->m_renderPosition.m_name = renderPosition;
+    d->m_renderPosition.m_start = d->m_clock.nsecsElapsed();
+    d->m_renderPosition.m_status = Complete;
+}
+
+void RenderProfiler::beginLayer()
+{
+    if ( !d->m_inFrame ) {
+        return;
+    }
+
+    d->m_layerStart = d->m_clock.nsecsElapsed();
+}
+
+void RenderProfiler::endLayer( const RenderState &state )
+{
+    if ( !d->m_inFrame ) {
+        return;
+    }
+
+    Private::Event event;
+    event.m_name = state.name().isEmpty() ? QStringLiteral( "Unnamed" ) : state.name();
+    event.m_renderPosition = d->m_renderPosition.m_name;
+    event.m_start = d->m_layerStart;
+    event.m_duration = d->m_clock.nsecsElapsed() - d->m_layerStart;
+    event.m_status = state.status();
+    d->m_frame.m_layers << event;
+
+    // a render position is only as complete as its least complete layer
+    d->m_renderPosition.m_status = qMax( d->m_renderPosition.m_status, event.m_status );
+}
+
+void RenderProfiler::endRenderPosition()
+{
+    if ( !d->m_inFrame ) {
+        return;
+    }
+
+    d->m_renderPosition.m_duration = d->m_clock.nsecsElapsed() - d->m_renderPosition.m_start;
+    d->m_frame.m_renderPositions << d->m_renderPosition;
+}
+
+void RenderProfiler::endFrame( const RenderState &state )
+{
+    if ( !d->m_inFrame ) {
+        return;
+    }
+
+    d->m_frame.m_duration = d->m_clock.nsecsElapsed() - d->m_frame.m_start;
+    d->m_frame.m_status = state.status();
+    d->m_frames << d->m_frame;
+    d->m_inFrame = false;
+    d->trimHistory();
+}
+
+}
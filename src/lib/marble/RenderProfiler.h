@@ -0,0 +1,125 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_RENDERPROFILER_H
+#define MARBLE_RENDERPROFILER_H
+
+#include "marble_export.h"
+#include "MarbleGlobal.h"
+
+#include <QStringList>
+
+namespace Marble
+{
+
+class RenderState;
+
+/**
+ * @short Collects frame timings of the layers rendered by a MarbleMap.
+ *
+ * When enabled, each rendered frame is timed as a whole, per render position
+ * and per layer with nanosecond resolution. The last historySize() frames are
+ * kept to derive percentiles and render status counts, and can be exported
+ * in the Chrome trace event format (chrome://tracing, Perfetto) to compare
+ * rendering sessions.
+ *
+ * Layers are identified by the name of their RenderState.
+ */
+class MARBLE_EXPORT RenderProfiler
+{
+public:
+    struct Statistics
+    {
+        Statistics();
+
+        /** Number of frames the layer or render position was rendered in */
+        int frames;
+
+        /** Rendering times per frame in nanoseconds */
+        qint64 minimum;
+        qint64 median;
+        qint64 percentile95;
+        qint64 percentile99;
+        qint64 maximum;
+        qint64 total;
+
+        /** Number of frames that ended in the respective RenderStatus */
+        int complete;
+        int waitingForUpdate;
+        int waitingForData;
+        int incomplete;
+    };
+
+    RenderProfiler();
+    ~RenderProfiler();
+
+    /**
+     * @brief Enables or disables recording. Disabled by default.
+     */
+    void setEnabled( bool enabled );
+    bool isEnabled() const;
+
+    /**
+     * @brief Sets the number of most recent frames to keep. Defaults to 300.
+     */
+    void setHistorySize( int frames );
+    int historySize() const;
+
+    /**
+     * @brief Discards all recorded frames
+     */
+    void clear();
+
+    /** Number of frames currently recorded */
+    int frameCount() const;
+
+    /** Names of the layers in the recorded frames */
+    QStringList layers() const;
+
+    /** Render positions in the recorded frames */
+    QStringList renderPositions() const;
+
+    Statistics frameStatistics() const;
+    Statistics layerStatistics( const QString &layer ) const;
+    Statistics renderPositionStatistics( const QString &renderPosition ) const;
+
+    /**
+     * @brief Returns the recorded frames as Chrome trace event JSON
+     */
+    QByteArray toChromeTrace() const;
+
+    /**
+     * @brief Writes the Chrome trace event JSON to @p fileName
+     * @return true on success
+     */
+    bool writeChromeTrace( const QString &fileName ) const;
+
+    /**
+     * @name Recording
+     * Called by the layer manager around the rendering of each frame. Calls
+     * are ignored while the profiler is disabled.
+     */
+    //@{
+    void beginFrame();
+    void beginRenderPosition( const QString &renderPosition );
+    void beginLayer();
+    void endLayer( const RenderState &state );
+    void endRenderPosition();
+    void endFrame( const RenderState &state );
+    //@}
+
+private:
+    Q_DISABLE_COPY( RenderProfiler )
+
+    class Private;
+    Private * const d;
+};
+
+}
+
+#endif
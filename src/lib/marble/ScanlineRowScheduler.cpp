@@ -0,0 +1,93 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ScanlineRowScheduler.h"
+
+#include <QMutexLocker>
+
+using namespace Marble;
+
+// Aim for this many blocks per thread, so a slow block can be compensated
+// by the other threads while keeping the atomic counter contention low.
+static const int BlocksPerThread = 8;
+
+static int evenRowsPerBlock( int rowCount, int threadCount )
+{
+    const int rows = rowCount / ( qMax( 1, threadCount ) * BlocksPerThread );
+    return qMax( 2, rows & ~1 );
+}
+
+ScanlineRowScheduler::Worker::Worker( ScanlineRowScheduler *scheduler )
+    : m_scheduler( scheduler ),
+      m_blockCount( 0 ),
+      m_rowCount( 0 )
+{
+    m_timer.start();
+}
+
+ScanlineRowScheduler::Worker::~Worker()
+{
+    m_scheduler->addWorkerStatistics( m_timer.nsecsElapsed(), m_blockCount, m_rowCount );
+}
+
+bool ScanlineRowScheduler::Worker::nextRows( int &yStart, int &yEnd )
+{
+    if ( !m_scheduler->fetchRows( yStart, yEnd ) ) {
+        return false;
+    }
+
+    ++m_blockCount;
+    m_rowCount += yEnd - yStart;
+
+    return true;
+}
+
+ScanlineRowScheduler::ScanlineRowScheduler( int yTop, int yBottom, int threadCount )
+    : m_yTop( yTop ),
+      m_yBottom( qMax( yTop, yBottom ) ),
+      m_rowsPerBlock( evenRowsPerBlock( m_yBottom - m_yTop, threadCount ) ),
+      m_nextBlock( 0 )
+{
+}
+
+int ScanlineRowScheduler::rowsPerBlock() const
+{
+    return m_rowsPerBlock;
+}
+
+TextureMapperInterface::LoadStatistics ScanlineRowScheduler::statistics() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_statistics;
+}
+
+bool ScanlineRowScheduler::fetchRows( int &yStart, int &yEnd )
+{
+    const int block = m_nextBlock.fetchAndAddRelaxed( 1 );
+    const qint64 start = m_yTop + qint64( block ) * m_rowsPerBlock;
+
+    if ( start >= m_yBottom ) {
+        return false;
+    }
+
+    yStart = start;
+    yEnd = qMin<qint64>( m_yBottom, start + m_rowsPerBlock );
+
+    return true;
+}
+
+void ScanlineRowScheduler::addWorkerStatistics( qint64 busyTime, int blockCount, int rowCount )
+{
+    QMutexLocker locker( &m_mutex );
+
+    ++m_statistics.workerCount;
+    m_statistics.blockCount += blockCount;
+    m_statistics.rowCount += rowCount;
+    m_statistics.totalBusyTime += busyTime;
+    m_statistics.maxBusyTime = qMax( m_statistics.maxBusyTime, busyTime );
+}
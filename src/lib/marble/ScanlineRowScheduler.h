@@ -0,0 +1,89 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_SCANLINEROWSCHEDULER_H
+#define MARBLE_SCANLINEROWSCHEDULER_H
+
+#include "TextureMapperInterface.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+
+namespace Marble
+{
+
+/**
+ * @short Hands out small blocks of scanlines to the render jobs of a texture mapper.
+ *
+ * Instead of splitting the canvas into one static band per thread, the
+ * scanline texture mappers start one job per thread and let each job pull
+ * blocks of rows until the canvas is done. Cheap rows (e.g. near the limb of
+ * the globe) and uneven tile cache misses therefore no longer leave threads
+ * idle while a single band finishes.
+ *
+ * Blocks always contain an even number of rows (except for the last one) so
+ * that interlaced rendering, which paints rows in pairs, keeps working.
+ */
+class ScanlineRowScheduler
+{
+public:
+    /**
+     * @short Per-job handle, to be created on the stack inside QRunnable::run().
+     *
+     * Records the time the job spends rendering and reports it back to the
+     * scheduler on destruction.
+     */
+    class Worker
+    {
+    public:
+        explicit Worker( ScanlineRowScheduler *scheduler );
+        ~Worker();
+
+        /**
+         * Fetches the next block of rows [@p yStart, @p yEnd).
+         * @return false if all rows have been handed out
+         */
+        bool nextRows( int &yStart, int &yEnd );
+
+    private:
+        Q_DISABLE_COPY( Worker )
+
+        ScanlineRowScheduler *const m_scheduler;
+        QElapsedTimer m_timer;
+        int m_blockCount;
+        int m_rowCount;
+    };
+
+    ScanlineRowScheduler( int yTop, int yBottom, int threadCount );
+
+    int rowsPerBlock() const;
+
+    /**
+     * Returns the statistics gathered from all workers that have finished so far.
+     */
+    TextureMapperInterface::LoadStatistics statistics() const;
+
+private:
+    Q_DISABLE_COPY( ScanlineRowScheduler )
+
+    bool fetchRows( int &yStart, int &yEnd );
+    void addWorkerStatistics( qint64 busyTime, int blockCount, int rowCount );
+
+    const int m_yTop;
+    const int m_yBottom;
+    const int m_rowsPerBlock;
+    QAtomicInt m_nextBlock;
+
+    mutable QMutex m_mutex;
+    TextureMapperInterface::LoadStatistics m_statistics;
+};
+
+}
+
+#endif
@@ -21,6 +21,8 @@
 
 #include <QImage>
 
+#include <cstring>
+
 using namespace Marble;
 
 ScanlineTextureMapperContext::ScanlineTextureMapperContext( StackedTileLoader * const tileLoader, int tileLevel )
@@ -428,6 +430,73 @@ QImage::Format ScanlineTextureMapperContext::optimalCanvasImageFormat( const Vie
 }
 
 
+void ScanlineTextureMapperContext::scrollCanvas( QImage *canvasImage, int dx, int dy )
+{
+    const int width = canvasImage->width();
+    const int height = canvasImage->height();
+
+    if ( qAbs( dx ) >= width || qAbs( dy ) >= height ) {
+        return;
+    }
+
+    const int xDestination = qMax( 0, dx );
+    const int xSource = qMax( 0, -dx );
+    const int pixelCount = width - qAbs( dx );
+
+    // Walk against the direction of the move so that no row gets
+    // overwritten before it has been copied.
+    const int yFirst = ( dy > 0 ) ? height - 1 : 0;
+    const int yLast  = ( dy > 0 ) ? dy - 1 : height + dy;
+    const int yStep  = ( dy > 0 ) ? -1 : 1;
+
+    for ( int y = yFirst; y != yLast; y += yStep ) {
+        QRgb *const destination = (QRgb*)( canvasImage->scanLine( y ) ) + xDestination;
+        const QRgb *const source = (const QRgb*)( canvasImage->constScanLine( y - dy ) ) + xSource;
+        memmove( destination, source, pixelCount * sizeof( QRgb ) );
+    }
+}
+
+
+void ScanlineTextureMapperContext::clearCanvas( QImage *canvasImage, const QRect &rect )
+{
+    const QRect clearRect = rect.intersected( canvasImage->rect() );
+
+    for ( int y = clearRect.top(); y <= clearRect.bottom(); ++y ) {
+        QRgb *const scanLine = (QRgb*)( canvasImage->scanLine( y ) ) + clearRect.left();
+        memset( scanLine, 0, clearRect.width() * sizeof( QRgb ) );
+    }
+}
+
+
+bool ScanlineTextureMapperContext::scrollFlatCanvas( QImage *canvasImage, qreal dxF, int dy,
+                                                     int &dx, QRect &rowStrip, QRect &columnStrip )
+{
+    const int imageWidth  = canvasImage->width();
+    const int imageHeight = canvasImage->height();
+
+    dx = qRound( dxF );
+    if ( qAbs( dx ) >= imageWidth / 2 || qAbs( dy ) >= imageHeight / 2 ) {
+        return false;
+    }
+
+    // Moving the center east moves the map content to the left,
+    // moving it north moves the content down.
+    scrollCanvas( canvasImage, -dx, dy );
+
+    rowStrip = ( dy > 0 ) ? QRect( 0, 0, imageWidth, dy )
+                          : QRect( 0, imageHeight + dy, imageWidth, -dy );
+    const int columnTop = ( dy > 0 ) ? dy : 0;
+    const int columnHeight = imageHeight - qAbs( dy );
+    columnStrip = ( dx < 0 ) ? QRect( 0, columnTop, -dx, columnHeight )
+                             : QRect( imageWidth - dx, columnTop, dx, columnHeight );
+
+    clearCanvas( canvasImage, rowStrip );
+    clearCanvas( canvasImage, columnStrip );
+
+    return true;
+}
+
+
 void ScanlineTextureMapperContext::nextTile( int &posX, int &posY )
 {
     // Move from tile coordinates to global texture coordinates 
@@ -46,6 +46,31 @@ public:
 
     static QImage::Format optimalCanvasImageFormat( const ViewportParams *viewport );
 
+    /**
+     * Moves the content of the 32 bit @p canvasImage by ( @p dx, @p dy ) pixels.
+     * The pixels exposed by the move keep their previous values.
+     */
+    static void scrollCanvas( QImage *canvasImage, int dx, int dy );
+
+    /**
+     * Sets all pixels of @p canvasImage within @p rect to zero.
+     */
+    static void clearCanvas( QImage *canvasImage, const QRect &rect );
+
+    /**
+     * Scrolls the canvas of a flat map after the map center moved @p dxF
+     * pixels to the east and @p dy pixels to the north, and clears the
+     * @p rowStrip and @p columnStrip exposed by the move.
+     *
+     * The canvas moves by @p dx, the horizontal move rounded to whole pixels.
+     * The caller has to keep track of the remaining fraction of a pixel so
+     * that it doesn't add up over a long pan.
+     *
+     * @return false if the move is too large to be worth scrolling
+     */
+    static bool scrollFlatCanvas( QImage *canvasImage, qreal dxF, int dy,
+                                  int &dx, QRect &rowStrip, QRect &columnStrip );
+
     int globalWidth() const;
     int globalHeight() const;
 
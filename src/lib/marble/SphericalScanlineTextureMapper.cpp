@@ -16,12 +16,14 @@
 
 #include <qmath.h>
 #include <QRunnable>
+#include <QVector>
 
 #include "MarbleGlobal.h"
 #include "GeoPainter.h"
 #include "GeoDataPolygon.h"
 #include "MarbleDebug.h"
 #include "Quaternion.h"
+#include "ScanlineRowScheduler.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "StackedTile.h"
@@ -35,7 +37,7 @@ using namespace Marble;
 class SphericalScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, bool batchProcessing, ScanlineRowScheduler *scheduler );
 
     void run() override;
 
@@ -45,18 +47,18 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    int const m_yTop;
-    int const m_yBottom;
+    const bool m_batchProcessing;
+    ScanlineRowScheduler *const m_scheduler;
 };
 
-SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, bool batchProcessing, ScanlineRowScheduler *scheduler )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_batchProcessing( batchProcessing ),
+      m_scheduler( scheduler )
 {
 }
 
@@ -64,10 +66,24 @@ SphericalScanlineTextureMapper::SphericalScanlineTextureMapper( StackedTileLoade
     : TextureMapperInterface()
     , m_tileLoader( tileLoader )
     , m_radius( 0 )
+    , m_batchProcessing( true )
     , m_threadPool()
 {
 }
 
+void SphericalScanlineTextureMapper::setBatchProcessingEnabled( bool enabled )
+{
+    if ( m_batchProcessing != enabled ) {
+        m_batchProcessing = enabled;
+        m_repaintNeeded = true;
+    }
+}
+
+bool SphericalScanlineTextureMapper::isBatchProcessingEnabled() const
+{
+    return m_batchProcessing;
+}
+
 void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
                                                  const ViewportParams *viewport,
                                                  int tileZoomLevel,
@@ -93,7 +109,7 @@ void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
         mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
 
         if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
+            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality(), &m_threadPool );
         }
 
         m_repaintNeeded = false;
@@ -107,6 +123,11 @@ void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
     painter->drawImage( rect, m_canvasImage, rect );
 }
 
+TextureMapperInterface::LoadStatistics SphericalScanlineTextureMapper::loadStatistics() const
+{
+    return m_loadStatistics;
+}
+
 void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
     // Reset backend
@@ -125,17 +146,19 @@ void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
     const int yBottom = ( yTop == 0 ) ? imageHeight - skip
                                       : yTop + radius + radius - skip;
 
+    // Let one job per thread pull small blocks of rows, so the threads stay
+    // busy even if some parts of the canvas are more expensive than others
     const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = qCeil(qreal( yBottom - yTop ) / qreal(numThreads));
+    ScanlineRowScheduler scheduler( yTop, yBottom, numThreads );
     for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = qMin(yBottom, yTop + (i + 1) * yStep);
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, m_batchProcessing, &scheduler );
         m_threadPool.start( job );
     }
 
     m_threadPool.waitForDone();
 
+    m_loadStatistics = scheduler.statistics();
+
     m_tileLoader->cleanupTilehash();
 }
 
@@ -167,133 +190,165 @@ void SphericalScanlineTextureMapper::RenderJob::run()
     // initialize needed variables that are modified during texture mapping:
 
     ScanlineTextureMapperContext context( m_tileLoader, m_tileLevel );
-    qreal  lon = 0.0;
-    qreal  lat = 0.0;
 
-    // Scanline based algorithm to texture map a sphere
-    for ( int y = m_yTop; y < m_yBottom ; ++y ) {
-
-        // Evaluate coordinates for the 3D position vector of the current pixel
-        const qreal qy = inverseRadius * (qreal)( imageHeight / 2 - y );
-        const qreal qr = 1.0 - qy * qy;
-
-        // rx is the radius component in x direction
-        const int rx = (int)sqrt( (qreal)( radius * radius
-                                      - ( ( y - imageHeight / 2 )
-                                          * ( y - imageHeight / 2 ) ) ) );
-
-        // Calculate the actual x-range of the map within the current scanline.
-        // 
-        // If the circular border of the earth disk is still visible then xLeft
-        // equals the scanline position of the most left pixel that gets covered
-        // by the earth disk. In terms of math this equals the half image width minus 
-        // the radius component on the current scanline in x direction ("rx").
-        //
-        // If the zoom factor is high enough then the whole screen gets covered
-        // by the earth and the border of the earth disk isn't visible anymore.
-        // In that situation xLeft equals zero.
-        // For xRight the situation is similar.
-
-        const int xLeft  = ( imageWidth / 2 - rx > 0 ) ? imageWidth / 2 - rx
-                                                       : 0;
-        const int xRight = ( imageWidth / 2 - rx > 0 ) ? xLeft + rx + rx
-                                                       : imageWidth;
-
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xLeft;
-
-        const int xIpLeft  = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xLeft / n + 1 )
-                                                         : 1;
-        const int xIpRight = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xRight / n - 1 )
-                                                         : n * (int)( xRight / n - 1 ) + 1; 
-
-        // Decrease pole distortion due to linear approximation ( y-axis )
-        bool crossingPoleArea = false;
-        if ( northPole.v[Q_Z] > 0
-             && northPoleY - ( n * 0.75 ) <= y
-             && northPoleY + ( n * 0.75 ) >= y ) 
-        {
-            crossingPoleArea = true;
-        }
-
-        int ncount = 0;
+    // Per-scanline sample buffers. A scanline never has more samples
+    // than pixels, so they are allocated once for the whole job.
+    QVector<int>   sampleX( imageWidth );
+    QVector<bool>  sampleInterpolate( imageWidth );
+    QVector<qreal> vx( imageWidth );
+    QVector<qreal> vy( imageWidth );
+    QVector<qreal> vz( imageWidth );
+    QVector<qreal> lon( imageWidth );
+    QVector<qreal> lat( imageWidth );
 
-        for ( int x = xLeft; x < xRight; ++x ) {
-            // Prepare for interpolation
+    // Scanline based algorithm to texture map a sphere
+    ScanlineRowScheduler::Worker worker( m_scheduler );
+    int yStart = 0;
+    int yEnd = 0;
+
+    while ( worker.nextRows( yStart, yEnd ) ) {
+        for ( int y = yStart; y < yEnd ; ++y ) {
+
+            // Evaluate coordinates for the 3D position vector of the current pixel
+            const qreal qy = inverseRadius * (qreal)( imageHeight / 2 - y );
+            const qreal qr = 1.0 - qy * qy;
+
+            // rx is the radius component in x direction
+            const int rx = (int)sqrt( (qreal)( radius * radius
+                                          - ( ( y - imageHeight / 2 )
+                                              * ( y - imageHeight / 2 ) ) ) );
+
+            // Calculate the actual x-range of the map within the current scanline.
+            // 
+            // If the circular border of the earth disk is still visible then xLeft
+            // equals the scanline position of the most left pixel that gets covered
+            // by the earth disk. In terms of math this equals the half image width minus 
+            // the radius component on the current scanline in x direction ("rx").
+            //
+            // If the zoom factor is high enough then the whole screen gets covered
+            // by the earth and the border of the earth disk isn't visible anymore.
+            // In that situation xLeft equals zero.
+            // For xRight the situation is similar.
+
+            const int xLeft  = ( imageWidth / 2 - rx > 0 ) ? imageWidth / 2 - rx
+                                                           : 0;
+            const int xRight = ( imageWidth / 2 - rx > 0 ) ? xLeft + rx + rx
+                                                           : imageWidth;
+
+            const int xIpLeft  = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xLeft / n + 1 )
+                                                             : 1;
+            const int xIpRight = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xRight / n - 1 )
+                                                             : n * (int)( xRight / n - 1 ) + 1; 
+
+            // Decrease pole distortion due to linear approximation ( y-axis )
+            bool crossingPoleArea = false;
+            if ( northPole.v[Q_Z] > 0
+                 && northPoleY - ( n * 0.75 ) <= y
+                 && northPoleY + ( n * 0.75 ) >= y ) 
+            {
+                crossingPoleArea = true;
+            }
 
-            const int leftInterval = xIpLeft + ncount * n;
+            // First pass: determine the sample positions along the scanline and
+            // their 3D position vectors.
+            int sampleCount = 0;
+            int ncount = 0;
+
+            for ( int x = xLeft; x < xRight; ++x ) {
+                // Prepare for interpolation
+
+                const int leftInterval = xIpLeft + ncount * n;
+
+                bool interpolate = false;
+                if ( x >= xIpLeft && x <= xIpRight ) {
+
+                    // Decrease pole distortion due to linear approximation ( x-axis )
+                    if ( crossingPoleArea
+                         && northPoleX >= leftInterval + n
+                         && northPoleX < leftInterval + 2 * n
+                         && x < leftInterval + 3 * n )
+                    {
+                        interpolate = false;
+                    }
+                    else {
+                        x += n - 1;
+                        interpolate = !printQuality;
+                        ++ncount;
+                    } 
+                }
+                else
+                    interpolate = false;
 
-            bool interpolate = false;
-            if ( x >= xIpLeft && x <= xIpRight ) {
+                // Evaluate more coordinates for the 3D position vector of
+                // the current pixel.
+                const qreal qx = (qreal)( x - imageWidth / 2 ) * inverseRadius;
+                const qreal qr2z = qr - qx * qx;
+
+                sampleX[sampleCount] = x;
+                sampleInterpolate[sampleCount] = interpolate;
+                vx[sampleCount] = qx;
+                vy[sampleCount] = qy;
+                vz[sampleCount] = ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0;
+                ++sampleCount;
+            }
 
-                // Decrease pole distortion due to linear approximation ( x-axis )
-//                mDebug() << QString("NorthPole X: %1, LeftInterval: %2").arg( northPoleX ).arg( leftInterval );
-                if ( crossingPoleArea
-                     && northPoleX >= leftInterval + n
-                     && northPoleX < leftInterval + 2 * n
-                     && x < leftInterval + 3 * n )
-                {
-                    interpolate = false;
+            // Second pass: rotate the position vectors around the globe axis
+            // and convert them to longitude and latitude.
+            if ( m_batchProcessing ) {
+                Quaternion::rotateToSpherical( planetAxisMatrix,
+                                               vx.constData(), vy.constData(), vz.constData(),
+                                               sampleCount, lon.data(), lat.data() );
+            }
+            else {
+                for ( int i = 0; i < sampleCount; ++i ) {
+                    Quaternion qpos( 0.0, vx[i], vy[i], vz[i] );
+                    qpos.rotateAroundAxis( planetAxisMatrix );
+                    qpos.getSpherical( lon[i], lat[i] );
                 }
-                else {
-                    x += n - 1;
-                    interpolate = !printQuality;
-                    ++ncount;
-                } 
             }
-            else
-                interpolate = false;
-
-            // Evaluate more coordinates for the 3D position vector of
-            // the current pixel.
-            const qreal qx = (qreal)( x - imageWidth / 2 ) * inverseRadius;
-            const qreal qr2z = qr - qx * qx;
-            const qreal qz = ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0;
-
-            // Create Quaternion from vector coordinates and rotate it
-            // around globe axis
-            Quaternion qpos( 0.0, qx, qy, qz );
-            qpos.rotateAroundAxis( planetAxisMatrix );
-
-            qpos.getSpherical( lon, lat );
-//            mDebug() << QString("lon: %1 lat: %2").arg(lon).arg(lat);
-            // Approx for n-1 out of n pixels within the boundary of
-            // xIpLeft to xIpRight
-
-            if ( interpolate ) {
-                if (highQuality)
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
-                else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
 
-                scanLine += ( n - 1 );
-            }
+            // Third pass: fetch the texels.
+            QRgb *const scanLineStart = (QRgb*)( m_canvasImage->scanLine( y ) );
 
-//          Comment out the pixelValue line and run Marble if you want
-//          to understand the interpolation:
+            for ( int i = 0; i < sampleCount; ++i ) {
+                const int x = sampleX[i];
 
-//          Uncomment the crossingPoleArea line to check precise 
-//          rendering around north pole:
+                // Approx for n-1 out of n pixels within the boundary of
+                // xIpLeft to xIpRight
 
-//            if ( !crossingPoleArea )
-            if ( x < imageWidth ) {
-                if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
-                else
-                    context.pixelValue( lon, lat, scanLine );
-            }
+                if ( sampleInterpolate[i] ) {
+                    QRgb *const scanLine = scanLineStart + x - ( n - 1 );
+                    if ( highQuality )
+                        context.pixelValueApproxF( lon[i], lat[i], scanLine, n );
+                    else
+                        context.pixelValueApprox( lon[i], lat[i], scanLine, n );
+                }
 
-            ++scanLine;
-        }
+                // Comment out the pixelValue line and run Marble if you want
+                // to understand the interpolation:
+
+                // Uncomment the crossingPoleArea line to check precise
+                // rendering around north pole:
 
-        // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) { 
+                // if ( !crossingPoleArea )
+                if ( x < imageWidth ) {
+                    if ( highQuality )
+                        context.pixelValueF( lon[i], lat[i], scanLineStart + x );
+                    else
+                        context.pixelValue( lon[i], lat[i], scanLineStart + x );
+                }
+            }
 
-            const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
+            // copy scanline to improve performance
+            if ( interlaced && y + 1 < yEnd ) { 
 
-            memcpy( m_canvasImage->scanLine( y + 1 ) + xLeft * pixelByteSize, 
-                    m_canvasImage->scanLine( y ) + xLeft * pixelByteSize, 
-                    ( xRight - xLeft ) * pixelByteSize );
-            ++y;
+                const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
+
+                memcpy( m_canvasImage->scanLine( y + 1 ) + xLeft * pixelByteSize, 
+                        m_canvasImage->scanLine( y ) + xLeft * pixelByteSize, 
+                        ( xRight - xLeft ) * pixelByteSize );
+                ++y;
+            }
         }
     }
 }
@@ -32,9 +32,13 @@
 #include "MarbleGlobal.h"
 
 #include <QCache>
+#include <QCoreApplication>
 #include <QHash>
 #include <QReadWriteLock>
 #include <QImage>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
 
 
 namespace Marble
@@ -44,25 +48,97 @@ class StackedTileLoaderPrivate
 {
 public:
     explicit StackedTileLoaderPrivate( MergedLayerDecorator *mergedLayerDecorator )
-        : m_layerDecorator( mergedLayerDecorator )
+        : m_layerDecorator( mergedLayerDecorator ),
+          m_cacheHits( 0 ),
+          m_cacheMisses( 0 ),
+          m_lastRequest( 0 )
     {
         m_tileCache.setMaxCost( 20000 * 1024 ); // Cache size measured in bytes
+        // decoding is mostly CPU bound, but leave room for the texture mapping threads
+        m_loaderPool.setMaxThreadCount( qMax( 2, QThread::idealThreadCount() / 2 ) );
     }
 
+    StackedTile *findLowerLevelTile( const TileId &stackedTileId );
+
+    /**
+     * Loads the tile @p stackedTileId in the background, replacing a pending
+     * load of it. Needs the write lock on m_cacheLock.
+     */
+    void loadInBackground( StackedTileLoader *loader, const TileId &stackedTileId );
+
     MergedLayerDecorator *const m_layerDecorator;
     QHash <TileId, StackedTile*>  m_tilesOnDisplay;
     QCache <TileId, StackedTile>  m_tileCache;
     QReadWriteLock m_cacheLock;
+    int m_cacheHits;
+    int m_cacheMisses;
+
+    QThreadPool m_loaderPool;
+    // placeholder tiles waiting for their StackedTileRunner, and the request
+    // number of that runner: results of other requests are outdated
+    QHash<TileId, int> m_pendingTiles;
+    int m_lastRequest;
+    // tiles on display which are deleted instead of cached once they went out of view
+    QSet<TileId> m_droppedTiles;
 };
 
+StackedTile *StackedTileLoaderPrivate::findLowerLevelTile( const TileId &stackedTileId )
+{
+    for ( int level = stackedTileId.zoomLevel() - 1; level >= 0; --level ) {
+        const int deltaLevel = stackedTileId.zoomLevel() - level;
+        const TileId lowerLevelId( 0, level, stackedTileId.x() >> deltaLevel, stackedTileId.y() >> deltaLevel );
+        StackedTile *const lowerLevelTile = m_tilesOnDisplay.value( lowerLevelId, nullptr );
+        if ( lowerLevelTile ) {
+            return lowerLevelTile;
+        }
+        if ( m_tileCache.contains( lowerLevelId ) ) {
+            return m_tileCache.object( lowerLevelId );
+        }
+    }
+
+    return nullptr;
+}
+
+void StackedTileLoaderPrivate::loadInBackground( StackedTileLoader *loader, const TileId &stackedTileId )
+{
+    const int request = ++m_lastRequest;
+    m_pendingTiles.insert( stackedTileId, request );
+
+    StackedTileRunner *const runner = new StackedTileRunner( m_layerDecorator, stackedTileId, request );
+    QObject::connect( runner, SIGNAL(tileLoaded(TileId,StackedTile*,int)),
+                      loader, SLOT(replacePlaceholderTile(TileId,StackedTile*,int)), Qt::QueuedConnection );
+    m_loaderPool.start( runner );
+}
+
+StackedTileRunner::StackedTileRunner( MergedLayerDecorator *decorator, const TileId &id, int request ) :
+    m_decorator( decorator ),
+    m_id( id ),
+    m_request( request )
+{
+}
+
+void StackedTileRunner::run()
+{
+    StackedTile *const stackedTile = m_decorator->loadTile( m_id );
+
+    emit tileLoaded( m_id, stackedTile, m_request );
+}
+
 StackedTileLoader::StackedTileLoader( MergedLayerDecorator *mergedLayerDecorator, QObject *parent )
     : QObject( parent ),
       d( new StackedTileLoaderPrivate( mergedLayerDecorator ) )
 {
+    qRegisterMetaType<TileId>( "TileId" );
+    qRegisterMetaType<StackedTile*>( "StackedTile*" );
 }
 
 StackedTileLoader::~StackedTileLoader()
 {
+    d->m_loaderPool.clear();
+    d->m_loaderPool.waitForDone();
+    // take over the tiles of finished runners to not leak them
+    QCoreApplication::sendPostedEvents( this, QEvent::MetaCall );
+
     qDeleteAll( d->m_tilesOnDisplay );
     delete d;
 }
@@ -106,10 +182,14 @@ void StackedTileLoader::cleanupTilehash()
     while ( it.hasNext() ) {
         it.next();
         if ( !it.value()->used() ) {
-            // If insert call result is false then the cache is too small to store the tile
-            // but the item will get deleted nevertheless and the pointer we have
-            // doesn't get set to zero (so don't delete it in this case or it will crash!)
-            d->m_tileCache.insert( it.key(), it.value(), it.value()->byteCount() );
+            if ( d->m_droppedTiles.remove( it.key() ) ) {
+                delete it.value();
+            } else {
+                // If insert call result is false then the cache is too small to store the tile
+                // but the item will get deleted nevertheless and the pointer we have
+                // doesn't get set to zero (so don't delete it in this case or it will crash!)
+                d->m_tileCache.insert( it.key(), it.value(), it.value()->byteCount() );
+            }
             d->m_tilesOnDisplay.remove( it.key() );
         }
     }
@@ -143,13 +223,32 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
         Q_ASSERT( !stackedTile->used() && "tiles in m_tileCache are invisible and should thus be marked as unused" );
         stackedTile->setUsed( true );
         d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+        ++d->m_cacheHits;
         d->m_cacheLock.unlock();
         return stackedTile;
     }
 
     // tile (valid) has not been found in hash or cache, so load it from disk
-    // and place it in the hash from where it will get transferred to the cache
+    // in the background and place a scaled lower level tile in the hash meanwhile,
+    // from where it will get transferred to the cache
+
+    ++d->m_cacheMisses;
+    StackedTile *const lowerLevelTile = d->findLowerLevelTile( stackedTileId );
+    if ( lowerLevelTile ) {
+        mDebug() << "schedule loading tile from disk:" << stackedTileId;
 
+        stackedTile = d->m_layerDecorator->loadPlaceholderTile( stackedTileId, *lowerLevelTile );
+        Q_ASSERT( stackedTile );
+        stackedTile->setUsed( true );
+
+        d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+        d->loadInBackground( this, stackedTileId );
+        d->m_cacheLock.unlock();
+
+        return stackedTile;
+    }
+
+    // nothing to show meanwhile, e.g. for the base tiles of the first frame
     mDebug() << "load tile from disk:" << stackedTileId;
 
     stackedTile = d->m_layerDecorator->loadTile( stackedTileId );
@@ -164,6 +263,39 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
     return stackedTile;
 }
 
+void StackedTileLoader::replacePlaceholderTile( const TileId &stackedTileId, StackedTile *stackedTile, int request )
+{
+    Q_ASSERT( stackedTile );
+
+    QWriteLocker locker( &d->m_cacheLock );
+
+    if ( d->m_pendingTiles.value( stackedTileId, 0 ) != request ) {
+        // loaded before the tiles were cleared, or before a download updated the tile
+        delete stackedTile;
+        return;
+    }
+    d->m_pendingTiles.remove( stackedTileId );
+
+    StackedTile *const placeholderTile = d->m_tilesOnDisplay.value( stackedTileId, nullptr );
+    if ( placeholderTile ) {
+        stackedTile->setUsed( placeholderTile->used() );
+        d->m_tilesOnDisplay[ stackedTileId ] = stackedTile;
+        delete placeholderTile;
+    } else if ( d->m_tileCache.contains( stackedTileId ) ) {
+        // replaces and deletes the placeholder
+        d->m_tileCache.insert( stackedTileId, stackedTile, stackedTile->byteCount() );
+    } else {
+        // the placeholder was dropped from the cache already
+        delete stackedTile;
+        return;
+    }
+
+    locker.unlock();
+
+    emit tileLoaded( stackedTileId );
+    emit placeholderReplaced( stackedTileId );
+}
+
 quint64 StackedTileLoader::volatileCacheLimit() const
 {
     return d->m_tileCache.maxCost() / 1024;
@@ -179,6 +311,25 @@ int StackedTileLoader::tileCount() const
     return d->m_tileCache.count() + d->m_tilesOnDisplay.count();
 }
 
+int StackedTileLoader::cacheHits() const
+{
+    QReadLocker locker( &d->m_cacheLock );
+    return d->m_cacheHits;
+}
+
+int StackedTileLoader::cacheMisses() const
+{
+    QReadLocker locker( &d->m_cacheLock );
+    return d->m_cacheMisses;
+}
+
+void StackedTileLoader::resetCacheStatistics()
+{
+    QWriteLocker locker( &d->m_cacheLock );
+    d->m_cacheHits = 0;
+    d->m_cacheMisses = 0;
+}
+
 void StackedTileLoader::setVolatileCacheLimit( quint64 kiloBytes )
 {
     mDebug() << QString("Setting tile cache to %1 kilobytes.").arg( kiloBytes );
@@ -189,6 +340,8 @@ void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImag
 {
     const TileId stackedTileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() );
 
+    QWriteLocker locker( &d->m_cacheLock );
+
     StackedTile * displayedTile = d->m_tilesOnDisplay.take( stackedTileId );
     if ( displayedTile ) {
         Q_ASSERT( !d->m_tileCache.contains( stackedTileId ) );
@@ -199,9 +352,34 @@ void StackedTileLoader::updateTile( TileId const &tileId, QImage const &tileImag
 
         delete displayedTile;
         displayedTile = nullptr;
+        d->m_droppedTiles.remove( stackedTileId );
+
+        if ( d->m_pendingTiles.contains( stackedTileId ) ) {
+            // The runner may have read the tile before the download was stored and
+            // would bring back the old image; load the other layers again instead
+            d->loadInBackground( this, stackedTileId );
+        }
+
+        locker.unlock();
 
         emit tileLoaded( stackedTileId );
     } else {
+        d->m_pendingTiles.remove( stackedTileId );
+        d->m_tileCache.remove( stackedTileId );
+    }
+}
+
+void StackedTileLoader::dropTile( TileId const &tileId )
+{
+    const TileId stackedTileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() );
+
+    QWriteLocker locker( &d->m_cacheLock );
+
+    if ( d->m_tilesOnDisplay.contains( stackedTileId ) ) {
+        // the texture mapper may still use it
+        d->m_droppedTiles.insert( stackedTileId );
+    } else {
+        // a pending runner finds neither the tile nor its placeholder and discards its result
         d->m_tileCache.remove( stackedTileId );
     }
 }
@@ -212,13 +390,22 @@ RenderState StackedTileLoader::renderState() const
     QHash<TileId, StackedTile*>::const_iterator it = d->m_tilesOnDisplay.constBegin();
     QHash<TileId, StackedTile*>::const_iterator const end = d->m_tilesOnDisplay.constEnd();
     for (; it != end; ++it ) {
-        renderState.addChild( d->m_layerDecorator->renderState( it.key() ) );
+        RenderState tileState = d->m_layerDecorator->renderState( it.key() );
+        if ( d->m_pendingTiles.contains( it.key() ) ) {
+            tileState.addChild( RenderState( QStringLiteral( "Placeholder" ), WaitingForData ) );
+        }
+        renderState.addChild( tileState );
     }
     return renderState;
 }
 
 void StackedTileLoader::clear()
 {
+    // tiles of runners still in progress are discarded when they arrive
+    d->m_loaderPool.clear();
+    d->m_pendingTiles.clear();
+    d->m_droppedTiles.clear();
+
     qDeleteAll( d->m_tilesOnDisplay );
     d->m_tilesOnDisplay.clear();
     d->m_tileCache.clear(); // clear the tile cache in physical memory
@@ -26,8 +26,10 @@
 #define MARBLE_STACKEDTILELOADER_H
 
 #include <QObject>
+#include <QRunnable>
 
 #include "RenderState.h"
+#include "TileId.h"
 
 class QImage;
 class QString;
@@ -39,10 +41,29 @@ namespace Marble
 class GeoSceneAbstractTileProjection;
 class MergedLayerDecorator;
 class StackedTile;
-class TileId;
 
 class StackedTileLoaderPrivate;
 
+/**
+ * Loads a stacked tile from disk in a background thread
+ */
+class StackedTileRunner : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    StackedTileRunner( MergedLayerDecorator *decorator, const TileId &id, int request );
+    void run() override;
+
+Q_SIGNALS:
+    void tileLoaded( const TileId &id, StackedTile *tile, int request );
+
+private:
+    MergedLayerDecorator *const m_decorator;
+    const TileId m_id;
+    const int m_request;
+};
+
 /**
  * @short Tile loading from a quad tree
  *
@@ -82,6 +103,10 @@ class StackedTileLoader : public QObject
         /**
          * Loads a tile and returns it.
          *
+         * Tiles which are not in memory yet are loaded from disk in the background.
+         * Until then, the part of a lower level tile in memory is returned scaled up,
+         * and tileLoaded() is emitted once the tile has been replaced.
+         *
          * @param stackedTileId The Id of the requested tile, containing the x and y coordinate
          *                      and the zoom level.
          */
@@ -116,6 +141,22 @@ class StackedTileLoader : public QObject
          */
         int tileCount() const;
 
+        /**
+         * @brief Returns how often a tile that went out of view was taken
+         * from the volatile cache again instead of being loaded.
+         */
+        int cacheHits() const;
+
+        /**
+         * @brief Returns how often a tile had to be loaded by the tile loader.
+         */
+        int cacheMisses() const;
+
+        /**
+         * @brief Sets the cache hit and miss counts back to zero.
+         */
+        void resetCacheStatistics();
+
         /**
          * @brief Set the limit of the volatile (in RAM) cache.
          * @param kiloBytes The limit in kilobytes.
@@ -132,12 +173,29 @@ class StackedTileLoader : public QObject
          */
         void updateTile(TileId const & tileId, QImage const &tileImage );
 
+        /**
+         * Drops the tile which contains @p tileId, so that it is loaded again when it is
+         * requested next. Used when the download of @p tileId has been cancelled, as the
+         * tile then keeps showing the scaled lower level tile used until the download is done.
+         * A tile which is shown still is dropped once it went out of view.
+         */
+        void dropTile( TileId const &tileId );
+
         RenderState renderState() const;
 
     Q_SIGNALS:
         void tileLoaded( TileId const &tileId );
+
+        /**
+         * Emitted when a tile loaded in the background replaced the placeholder
+         * that has been returned by loadTile() before.
+         */
+        void placeholderReplaced( TileId const &tileId );
         void cleared();
 
+    private Q_SLOTS:
+        void replacePlaceholderTile( const TileId &stackedTileId, StackedTile *stackedTile, int request );
+
     private:
         Q_DISABLE_COPY( StackedTileLoader )
 
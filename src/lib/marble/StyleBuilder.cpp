@@ -94,8 +94,11 @@ public:
 
     static QString createPaintLayerItem(const QString &itemType, GeoDataPlacemark::GeoDataVisualCategory visualCategory, const QString &subType = QString());
 
-    static void initializeOsmVisualCategories();
-    static void initializeMinimumZoomLevels();
+    // The static tables are used by file parsers in worker threads as well,
+    // they are built once on first use
+    static const QHash<OsmTag, GeoDataPlacemark::GeoDataVisualCategory> &osmVisualCategories();
+    static const QVector<int> &defaultMinZoomLevels();
+    static const QHash<GeoDataPlacemark::GeoDataVisualCategory, qint64> &popularities();
 
     int m_maximumZoomLevel;
     QColor m_defaultLabelColor;
@@ -109,20 +112,10 @@ public:
     QHash<GeoDataPlacemark::GeoDataVisualCategory, GeoDataStyle::Ptr> m_buildingStyles;
     QSet<QLocale::Country> m_oceanianCountries;
 
-    /**
-     * @brief s_visualCategories contains osm tag mappings to GeoDataVisualCategories
-     */
-    static QHash<OsmTag, GeoDataPlacemark::GeoDataVisualCategory> s_visualCategories;
-    static int s_defaultMinZoomLevels[GeoDataPlacemark::LastIndex];
-    static bool s_defaultMinZoomLevelsInitialized;
-    static QHash<GeoDataPlacemark::GeoDataVisualCategory, qint64> s_popularities;
+    static const qint64 s_popularityDefaultValue = 100;
+    static const int s_popularityOffset = 10;
 };
 
-QHash<StyleBuilder::OsmTag, GeoDataPlacemark::GeoDataVisualCategory> StyleBuilder::Private::s_visualCategories;
-int StyleBuilder::Private::s_defaultMinZoomLevels[GeoDataPlacemark::LastIndex];
-bool StyleBuilder::Private::s_defaultMinZoomLevelsInitialized = false;
-QHash<GeoDataPlacemark::GeoDataVisualCategory, qint64> StyleBuilder::Private::s_popularities;
-
 StyleBuilder::Private::Private() :
     m_maximumZoomLevel(15),
     m_defaultLabelColor(Qt::black),
@@ -146,9 +139,8 @@ StyleBuilder::Private::Private() :
 #else
     m_oceanianCountries << QLocale::Tuvalu;
 #endif
-    initializeMinimumZoomLevels();
-    for (int i = 0; i < GeoDataPlacemark::LastIndex; ++i) {
-        m_maximumZoomLevel = qMax(m_maximumZoomLevel, s_defaultMinZoomLevels[i]);
+    for (int minZoomLevel: defaultMinZoomLevels()) {
+        m_maximumZoomLevel = qMax(m_maximumZoomLevel, minZoomLevel);
     }
 }
 
@@ -1332,701 +1324,702 @@ QString StyleBuilder::Private::createPaintLayerItem(const QString &itemType, Geo
     }
 }
 
-void StyleBuilder::Private::initializeOsmVisualCategories()
+const QHash<StyleBuilder::OsmTag, GeoDataPlacemark::GeoDataVisualCategory> &StyleBuilder::Private::osmVisualCategories()
 {
-    // Only initialize the map once
-    if (!s_visualCategories.isEmpty()) {
-        return;
-    }
+    static const QHash<OsmTag, GeoDataPlacemark::GeoDataVisualCategory> table = [] {
+        QHash<OsmTag, GeoDataPlacemark::GeoDataVisualCategory> visualCategories;
+
+        visualCategories[OsmTag("admin_level", "1")]              = GeoDataPlacemark::AdminLevel1;
+        visualCategories[OsmTag("admin_level", "2")]              = GeoDataPlacemark::AdminLevel2;
+        visualCategories[OsmTag("admin_level", "3")]              = GeoDataPlacemark::AdminLevel3;
+        visualCategories[OsmTag("admin_level", "4")]              = GeoDataPlacemark::AdminLevel4;
+        visualCategories[OsmTag("admin_level", "5")]              = GeoDataPlacemark::AdminLevel5;
+        visualCategories[OsmTag("admin_level", "6")]              = GeoDataPlacemark::AdminLevel6;
+        visualCategories[OsmTag("admin_level", "7")]              = GeoDataPlacemark::AdminLevel7;
+        visualCategories[OsmTag("admin_level", "8")]              = GeoDataPlacemark::AdminLevel8;
+        visualCategories[OsmTag("admin_level", "9")]              = GeoDataPlacemark::AdminLevel9;
+        visualCategories[OsmTag("admin_level", "10")]             = GeoDataPlacemark::AdminLevel10;
+        visualCategories[OsmTag("admin_level", "11")]             = GeoDataPlacemark::AdminLevel11;
+
+        visualCategories[OsmTag("boundary", "maritime")]          = GeoDataPlacemark::BoundaryMaritime;
+
+        visualCategories[OsmTag("amenity", "restaurant")]         = GeoDataPlacemark::FoodRestaurant;
+        visualCategories[OsmTag("amenity", "fast_food")]          = GeoDataPlacemark::FoodFastFood;
+        visualCategories[OsmTag("amenity", "pub")]                = GeoDataPlacemark::FoodPub;
+        visualCategories[OsmTag("amenity", "bar")]                = GeoDataPlacemark::FoodBar;
+        visualCategories[OsmTag("amenity", "cafe")]               = GeoDataPlacemark::FoodCafe;
+        visualCategories[OsmTag("amenity", "biergarten")]         = GeoDataPlacemark::FoodBiergarten;
+
+        visualCategories[OsmTag("amenity", "college")]            = GeoDataPlacemark::EducationCollege;
+        visualCategories[OsmTag("amenity", "school")]             = GeoDataPlacemark::EducationSchool;
+        visualCategories[OsmTag("amenity", "university")]         = GeoDataPlacemark::EducationUniversity;
+
+        visualCategories[OsmTag("amenity", "childcare")]          = GeoDataPlacemark::AmenityKindergarten;
+        visualCategories[OsmTag("amenity", "kindergarten")]       = GeoDataPlacemark::AmenityKindergarten;
+        visualCategories[OsmTag("amenity", "library")]            = GeoDataPlacemark::AmenityLibrary;
+
+        visualCategories[OsmTag("amenity", "bus_station")]        = GeoDataPlacemark::TransportBusStation;
+        visualCategories[OsmTag("amenity", "car_sharing")]        = GeoDataPlacemark::TransportCarShare;
+        visualCategories[OsmTag("amenity", "fuel")]               = GeoDataPlacemark::TransportFuel;
+        visualCategories[OsmTag("amenity", "parking")]            = GeoDataPlacemark::TransportParking;
+        visualCategories[OsmTag("amenity", "parking_space")]      = GeoDataPlacemark::TransportParkingSpace;
+
+        visualCategories[OsmTag("amenity", "atm")]                = GeoDataPlacemark::MoneyAtm;
+        visualCategories[OsmTag("amenity", "bank")]               = GeoDataPlacemark::MoneyBank;
+
+        visualCategories[OsmTag("historic", "archaeological_site")] = GeoDataPlacemark::HistoricArchaeologicalSite;
+        visualCategories[OsmTag("historic", "castle")]            = GeoDataPlacemark::HistoricCastle;
+        visualCategories[OsmTag("historic", "fort")]              = GeoDataPlacemark::HistoricCastle;
+        visualCategories[OsmTag("historic", "memorial")]          = GeoDataPlacemark::HistoricMemorial;
+        visualCategories[OsmTag("historic", "monument")]          = GeoDataPlacemark::HistoricMonument;
+        visualCategories[OsmTag("historic", "ruins")]             = GeoDataPlacemark::HistoricRuins;
+
+        visualCategories[OsmTag("amenity", "bench")]              = GeoDataPlacemark::AmenityBench;
+        visualCategories[OsmTag("amenity", "car_wash")]           = GeoDataPlacemark::AmenityCarWash;
+        visualCategories[OsmTag("amenity", "charging_station")]   = GeoDataPlacemark::AmenityChargingStation;
+        visualCategories[OsmTag("amenity", "cinema")]             = GeoDataPlacemark::AmenityCinema;
+        visualCategories[OsmTag("amenity", "community_centre")]   = GeoDataPlacemark::AmenityCommunityCentre;
+        visualCategories[OsmTag("amenity", "courthouse")]         = GeoDataPlacemark::AmenityCourtHouse;
+        visualCategories[OsmTag("amenity", "drinking_water")]     = GeoDataPlacemark::AmenityDrinkingWater;
+        visualCategories[OsmTag("amenity", "embassy")]            = GeoDataPlacemark::AmenityEmbassy;
+        visualCategories[OsmTag("amenity", "fire_station")]       = GeoDataPlacemark::AmenityFireStation;
+        visualCategories[OsmTag("amenity", "fountain")]           = GeoDataPlacemark::AmenityFountain;
+        visualCategories[OsmTag("amenity", "graveyard")]          = GeoDataPlacemark::AmenityGraveyard;
+        visualCategories[OsmTag("amenity", "hunting_stand")]      = GeoDataPlacemark::AmenityHuntingStand;
+        visualCategories[OsmTag("amenity", "nightclub")]          = GeoDataPlacemark::AmenityNightClub;
+        visualCategories[OsmTag("amenity", "police")]             = GeoDataPlacemark::AmenityPolice;
+        visualCategories[OsmTag("amenity", "post_box")]           = GeoDataPlacemark::AmenityPostBox;
+        visualCategories[OsmTag("amenity", "post_office")]        = GeoDataPlacemark::AmenityPostOffice;
+        visualCategories[OsmTag("amenity", "prison")]             = GeoDataPlacemark::AmenityPrison;
+        visualCategories[OsmTag("amenity", "recycling")]          = GeoDataPlacemark::AmenityRecycling;
+        visualCategories[OsmTag("amenity", "shelter")]            = GeoDataPlacemark::AmenityShelter;
+        visualCategories[OsmTag("amenity", "social_facility")]    = GeoDataPlacemark::AmenitySocialFacility;
+        visualCategories[OsmTag("amenity", "telephone")]          = GeoDataPlacemark::AmenityTelephone;
+        visualCategories[OsmTag("amenity", "theatre")]            = GeoDataPlacemark::AmenityTheatre;
+        visualCategories[OsmTag("amenity", "toilets")]            = GeoDataPlacemark::AmenityToilets;
+        visualCategories[OsmTag("amenity", "townhall")]           = GeoDataPlacemark::AmenityTownHall;
+        visualCategories[OsmTag("amenity", "waste_basket")]       = GeoDataPlacemark::AmenityWasteBasket;
+        visualCategories[OsmTag("emergency", "phone")]            = GeoDataPlacemark::AmenityEmergencyPhone;
+        visualCategories[OsmTag("amenity", "mountain_rescue")]    = GeoDataPlacemark::AmenityMountainRescue;
+        visualCategories[OsmTag("amenity", "dentist")]            = GeoDataPlacemark::HealthDentist;
+        visualCategories[OsmTag("amenity", "doctors")]            = GeoDataPlacemark::HealthDoctors;
+        visualCategories[OsmTag("amenity", "hospital")]           = GeoDataPlacemark::HealthHospital;
+        visualCategories[OsmTag("amenity", "pharmacy")]           = GeoDataPlacemark::HealthPharmacy;
+        visualCategories[OsmTag("amenity", "veterinary")]         = GeoDataPlacemark::HealthVeterinary;
+
+        visualCategories[OsmTag("amenity", "place_of_worship")]   = GeoDataPlacemark::ReligionPlaceOfWorship;
+
+        visualCategories[OsmTag("tourism", "information")]        = GeoDataPlacemark::TourismInformation;
+
+        visualCategories[OsmTag("natural", "cave_entrance")]      = GeoDataPlacemark::NaturalCave;
+        visualCategories[OsmTag("natural", "peak")]               = GeoDataPlacemark::NaturalPeak;
+        visualCategories[OsmTag("natural", "tree")]               = GeoDataPlacemark::NaturalTree;
+        visualCategories[OsmTag("natural", "volcano")]            = GeoDataPlacemark::NaturalVolcano;
+
+        visualCategories[OsmTag("shop", "alcohol")]               = GeoDataPlacemark::ShopAlcohol;
+        visualCategories[OsmTag("shop", "art")]                   = GeoDataPlacemark::ShopArt;
+        visualCategories[OsmTag("shop", "bag")]                   = GeoDataPlacemark::ShopBag;
+        visualCategories[OsmTag("shop", "bakery")]                = GeoDataPlacemark::ShopBakery;
+        visualCategories[OsmTag("shop", "beauty")]                = GeoDataPlacemark::ShopBeauty;
+        visualCategories[OsmTag("shop", "beverages")]             = GeoDataPlacemark::ShopBeverages;
+        visualCategories[OsmTag("shop", "bicycle")]               = GeoDataPlacemark::ShopBicycle;
+        visualCategories[OsmTag("shop", "books")]                 = GeoDataPlacemark::ShopBook;
+        visualCategories[OsmTag("shop", "butcher")]               = GeoDataPlacemark::ShopButcher;
+        visualCategories[OsmTag("shop", "car")]                   = GeoDataPlacemark::ShopCar;
+        visualCategories[OsmTag("shop", "car_parts")]             = GeoDataPlacemark::ShopCarParts;
+        visualCategories[OsmTag("shop", "car_repair")]            = GeoDataPlacemark::ShopCarRepair;
+        visualCategories[OsmTag("shop", "chemist")]               = GeoDataPlacemark::ShopChemist;
+        visualCategories[OsmTag("shop", "clothes")]               = GeoDataPlacemark::ShopClothes;
+        visualCategories[OsmTag("shop", "confectionery")]         = GeoDataPlacemark::ShopConfectionery;
+        visualCategories[OsmTag("shop", "convenience")]           = GeoDataPlacemark::ShopConvenience;
+        visualCategories[OsmTag("shop", "copy")]                  = GeoDataPlacemark::ShopCopy;
+        visualCategories[OsmTag("shop", "cosmetics")]             = GeoDataPlacemark::ShopCosmetics;
+        visualCategories[OsmTag("shop", "deli")]                  = GeoDataPlacemark::ShopDeli;
+        visualCategories[OsmTag("shop", "department_store")]      = GeoDataPlacemark::ShopDepartmentStore;
+        visualCategories[OsmTag("shop", "doityourself")]          = GeoDataPlacemark::ShopDoitYourself;
+        visualCategories[OsmTag("shop", "electronics")]           = GeoDataPlacemark::ShopElectronics;
+        visualCategories[OsmTag("shop", "fashion")]               = GeoDataPlacemark::ShopFashion;
+        visualCategories[OsmTag("shop", "florist")]               = GeoDataPlacemark::ShopFlorist;
+        visualCategories[OsmTag("shop", "furniture")]             = GeoDataPlacemark::ShopFurniture;
+        visualCategories[OsmTag("shop", "gift")]                  = GeoDataPlacemark::ShopGift;
+        visualCategories[OsmTag("shop", "greengrocer")]           = GeoDataPlacemark::ShopGreengrocer;
+        visualCategories[OsmTag("shop", "hairdresser")]           = GeoDataPlacemark::ShopHairdresser;
+        visualCategories[OsmTag("shop", "hardware")]              = GeoDataPlacemark::ShopHardware;
+        visualCategories[OsmTag("shop", "hifi")]                  = GeoDataPlacemark::ShopHifi;
+        visualCategories[OsmTag("shop", "jewelry")]               = GeoDataPlacemark::ShopJewelry;
+        visualCategories[OsmTag("shop", "kiosk")]                 = GeoDataPlacemark::ShopKiosk;
+        visualCategories[OsmTag("shop", "laundry")]               = GeoDataPlacemark::ShopLaundry;
+        visualCategories[OsmTag("shop", "mobile_phone")]          = GeoDataPlacemark::ShopMobilePhone;
+        visualCategories[OsmTag("shop", "motorcycle")]            = GeoDataPlacemark::ShopMotorcycle;
+        visualCategories[OsmTag("shop", "musical_instrument")]    = GeoDataPlacemark::ShopMusicalInstrument;
+        visualCategories[OsmTag("shop", "optician")]              = GeoDataPlacemark::ShopOptician;
+        visualCategories[OsmTag("shop", "outdoor")]               = GeoDataPlacemark::ShopOutdoor;
+        visualCategories[OsmTag("shop", "perfumery")]             = GeoDataPlacemark::ShopPerfumery;
+        visualCategories[OsmTag("shop", "pet")]                   = GeoDataPlacemark::ShopPet;
+        visualCategories[OsmTag("shop", "photo")]                 = GeoDataPlacemark::ShopPhoto;
+        visualCategories[OsmTag("shop", "seafood")]               = GeoDataPlacemark::ShopSeafood;
+        visualCategories[OsmTag("shop", "shoes")]                 = GeoDataPlacemark::ShopShoes;
+        visualCategories[OsmTag("shop", "sports")]                = GeoDataPlacemark::ShopSports;
+        visualCategories[OsmTag("shop", "stationery")]            = GeoDataPlacemark::ShopStationery;
+        visualCategories[OsmTag("shop", "supermarket")]           = GeoDataPlacemark::ShopSupermarket;
+        visualCategories[OsmTag("shop", "tea")]                   = GeoDataPlacemark::ShopTea;
+        visualCategories[OsmTag("shop", "computer")]              = GeoDataPlacemark::ShopComputer;
+        visualCategories[OsmTag("shop", "garden_centre")]         = GeoDataPlacemark::ShopGardenCentre;
+        visualCategories[OsmTag("shop", "tobacco")]               = GeoDataPlacemark::ShopTobacco;
+        visualCategories[OsmTag("shop", "toys")]                  = GeoDataPlacemark::ShopToys;
+        visualCategories[OsmTag("shop", "travel_agency")]         = GeoDataPlacemark::ShopTravelAgency;
+        visualCategories[OsmTag("shop", "variety_store")]         = GeoDataPlacemark::ShopVarietyStore;
+
+
+        // Default for all other shops
+        for (const QString &value: shopValues()) {
+            visualCategories[OsmTag("shop", value)]               = GeoDataPlacemark::Shop;
+        }
 
-    s_visualCategories[OsmTag("admin_level", "1")]              = GeoDataPlacemark::AdminLevel1;
-    s_visualCategories[OsmTag("admin_level", "2")]              = GeoDataPlacemark::AdminLevel2;
-    s_visualCategories[OsmTag("admin_level", "3")]              = GeoDataPlacemark::AdminLevel3;
-    s_visualCategories[OsmTag("admin_level", "4")]              = GeoDataPlacemark::AdminLevel4;
-    s_visualCategories[OsmTag("admin_level", "5")]              = GeoDataPlacemark::AdminLevel5;
-    s_visualCategories[OsmTag("admin_level", "6")]              = GeoDataPlacemark::AdminLevel6;
-    s_visualCategories[OsmTag("admin_level", "7")]              = GeoDataPlacemark::AdminLevel7;
-    s_visualCategories[OsmTag("admin_level", "8")]              = GeoDataPlacemark::AdminLevel8;
-    s_visualCategories[OsmTag("admin_level", "9")]              = GeoDataPlacemark::AdminLevel9;
-    s_visualCategories[OsmTag("admin_level", "10")]             = GeoDataPlacemark::AdminLevel10;
-    s_visualCategories[OsmTag("admin_level", "11")]             = GeoDataPlacemark::AdminLevel11;
-
-    s_visualCategories[OsmTag("boundary", "maritime")]          = GeoDataPlacemark::BoundaryMaritime;
-
-    s_visualCategories[OsmTag("amenity", "restaurant")]         = GeoDataPlacemark::FoodRestaurant;
-    s_visualCategories[OsmTag("amenity", "fast_food")]          = GeoDataPlacemark::FoodFastFood;
-    s_visualCategories[OsmTag("amenity", "pub")]                = GeoDataPlacemark::FoodPub;
-    s_visualCategories[OsmTag("amenity", "bar")]                = GeoDataPlacemark::FoodBar;
-    s_visualCategories[OsmTag("amenity", "cafe")]               = GeoDataPlacemark::FoodCafe;
-    s_visualCategories[OsmTag("amenity", "biergarten")]         = GeoDataPlacemark::FoodBiergarten;
-
-    s_visualCategories[OsmTag("amenity", "college")]            = GeoDataPlacemark::EducationCollege;
-    s_visualCategories[OsmTag("amenity", "school")]             = GeoDataPlacemark::EducationSchool;
-    s_visualCategories[OsmTag("amenity", "university")]         = GeoDataPlacemark::EducationUniversity;
-
-    s_visualCategories[OsmTag("amenity", "childcare")]          = GeoDataPlacemark::AmenityKindergarten;
-    s_visualCategories[OsmTag("amenity", "kindergarten")]       = GeoDataPlacemark::AmenityKindergarten;
-    s_visualCategories[OsmTag("amenity", "library")]            = GeoDataPlacemark::AmenityLibrary;
-
-    s_visualCategories[OsmTag("amenity", "bus_station")]        = GeoDataPlacemark::TransportBusStation;
-    s_visualCategories[OsmTag("amenity", "car_sharing")]        = GeoDataPlacemark::TransportCarShare;
-    s_visualCategories[OsmTag("amenity", "fuel")]               = GeoDataPlacemark::TransportFuel;
-    s_visualCategories[OsmTag("amenity", "parking")]            = GeoDataPlacemark::TransportParking;
-    s_visualCategories[OsmTag("amenity", "parking_space")]      = GeoDataPlacemark::TransportParkingSpace;
-
-    s_visualCategories[OsmTag("amenity", "atm")]                = GeoDataPlacemark::MoneyAtm;
-    s_visualCategories[OsmTag("amenity", "bank")]               = GeoDataPlacemark::MoneyBank;
-
-    s_visualCategories[OsmTag("historic", "archaeological_site")] = GeoDataPlacemark::HistoricArchaeologicalSite;
-    s_visualCategories[OsmTag("historic", "castle")]            = GeoDataPlacemark::HistoricCastle;
-    s_visualCategories[OsmTag("historic", "fort")]              = GeoDataPlacemark::HistoricCastle;
-    s_visualCategories[OsmTag("historic", "memorial")]          = GeoDataPlacemark::HistoricMemorial;
-    s_visualCategories[OsmTag("historic", "monument")]          = GeoDataPlacemark::HistoricMonument;
-    s_visualCategories[OsmTag("historic", "ruins")]             = GeoDataPlacemark::HistoricRuins;
-
-    s_visualCategories[OsmTag("amenity", "bench")]              = GeoDataPlacemark::AmenityBench;
-    s_visualCategories[OsmTag("amenity", "car_wash")]           = GeoDataPlacemark::AmenityCarWash;
-    s_visualCategories[OsmTag("amenity", "charging_station")]   = GeoDataPlacemark::AmenityChargingStation;
-    s_visualCategories[OsmTag("amenity", "cinema")]             = GeoDataPlacemark::AmenityCinema;
-    s_visualCategories[OsmTag("amenity", "community_centre")]   = GeoDataPlacemark::AmenityCommunityCentre;
-    s_visualCategories[OsmTag("amenity", "courthouse")]         = GeoDataPlacemark::AmenityCourtHouse;
-    s_visualCategories[OsmTag("amenity", "drinking_water")]     = GeoDataPlacemark::AmenityDrinkingWater;
-    s_visualCategories[OsmTag("amenity", "embassy")]            = GeoDataPlacemark::AmenityEmbassy;
-    s_visualCategories[OsmTag("amenity", "fire_station")]       = GeoDataPlacemark::AmenityFireStation;
-    s_visualCategories[OsmTag("amenity", "fountain")]           = GeoDataPlacemark::AmenityFountain;
-    s_visualCategories[OsmTag("amenity", "graveyard")]          = GeoDataPlacemark::AmenityGraveyard;
-    s_visualCategories[OsmTag("amenity", "hunting_stand")]      = GeoDataPlacemark::AmenityHuntingStand;
-    s_visualCategories[OsmTag("amenity", "nightclub")]          = GeoDataPlacemark::AmenityNightClub;
-    s_visualCategories[OsmTag("amenity", "police")]             = GeoDataPlacemark::AmenityPolice;
-    s_visualCategories[OsmTag("amenity", "post_box")]           = GeoDataPlacemark::AmenityPostBox;
-    s_visualCategories[OsmTag("amenity", "post_office")]        = GeoDataPlacemark::AmenityPostOffice;
-    s_visualCategories[OsmTag("amenity", "prison")]             = GeoDataPlacemark::AmenityPrison;
-    s_visualCategories[OsmTag("amenity", "recycling")]          = GeoDataPlacemark::AmenityRecycling;
-    s_visualCategories[OsmTag("amenity", "shelter")]            = GeoDataPlacemark::AmenityShelter;
-    s_visualCategories[OsmTag("amenity", "social_facility")]    = GeoDataPlacemark::AmenitySocialFacility;
-    s_visualCategories[OsmTag("amenity", "telephone")]          = GeoDataPlacemark::AmenityTelephone;
-    s_visualCategories[OsmTag("amenity", "theatre")]            = GeoDataPlacemark::AmenityTheatre;
-    s_visualCategories[OsmTag("amenity", "toilets")]            = GeoDataPlacemark::AmenityToilets;
-    s_visualCategories[OsmTag("amenity", "townhall")]           = GeoDataPlacemark::AmenityTownHall;
-    s_visualCategories[OsmTag("amenity", "waste_basket")]       = GeoDataPlacemark::AmenityWasteBasket;
-    s_visualCategories[OsmTag("emergency", "phone")]            = GeoDataPlacemark::AmenityEmergencyPhone;
-    s_visualCategories[OsmTag("amenity", "mountain_rescue")]    = GeoDataPlacemark::AmenityMountainRescue;
-    s_visualCategories[OsmTag("amenity", "dentist")]            = GeoDataPlacemark::HealthDentist;
-    s_visualCategories[OsmTag("amenity", "doctors")]            = GeoDataPlacemark::HealthDoctors;
-    s_visualCategories[OsmTag("amenity", "hospital")]           = GeoDataPlacemark::HealthHospital;
-    s_visualCategories[OsmTag("amenity", "pharmacy")]           = GeoDataPlacemark::HealthPharmacy;
-    s_visualCategories[OsmTag("amenity", "veterinary")]         = GeoDataPlacemark::HealthVeterinary;
-
-    s_visualCategories[OsmTag("amenity", "place_of_worship")]   = GeoDataPlacemark::ReligionPlaceOfWorship;
-
-    s_visualCategories[OsmTag("tourism", "information")]        = GeoDataPlacemark::TourismInformation;
-
-    s_visualCategories[OsmTag("natural", "cave_entrance")]      = GeoDataPlacemark::NaturalCave;
-    s_visualCategories[OsmTag("natural", "peak")]               = GeoDataPlacemark::NaturalPeak;
-    s_visualCategories[OsmTag("natural", "tree")]               = GeoDataPlacemark::NaturalTree;
-    s_visualCategories[OsmTag("natural", "volcano")]            = GeoDataPlacemark::NaturalVolcano;
-
-    s_visualCategories[OsmTag("shop", "alcohol")]               = GeoDataPlacemark::ShopAlcohol;
-    s_visualCategories[OsmTag("shop", "art")]                   = GeoDataPlacemark::ShopArt;
-    s_visualCategories[OsmTag("shop", "bag")]                   = GeoDataPlacemark::ShopBag;
-    s_visualCategories[OsmTag("shop", "bakery")]                = GeoDataPlacemark::ShopBakery;
-    s_visualCategories[OsmTag("shop", "beauty")]                = GeoDataPlacemark::ShopBeauty;
-    s_visualCategories[OsmTag("shop", "beverages")]             = GeoDataPlacemark::ShopBeverages;
-    s_visualCategories[OsmTag("shop", "bicycle")]               = GeoDataPlacemark::ShopBicycle;
-    s_visualCategories[OsmTag("shop", "books")]                 = GeoDataPlacemark::ShopBook;
-    s_visualCategories[OsmTag("shop", "butcher")]               = GeoDataPlacemark::ShopButcher;
-    s_visualCategories[OsmTag("shop", "car")]                   = GeoDataPlacemark::ShopCar;
-    s_visualCategories[OsmTag("shop", "car_parts")]             = GeoDataPlacemark::ShopCarParts;
-    s_visualCategories[OsmTag("shop", "car_repair")]            = GeoDataPlacemark::ShopCarRepair;
-    s_visualCategories[OsmTag("shop", "chemist")]               = GeoDataPlacemark::ShopChemist;
-    s_visualCategories[OsmTag("shop", "clothes")]               = GeoDataPlacemark::ShopClothes;
-    s_visualCategories[OsmTag("shop", "confectionery")]         = GeoDataPlacemark::ShopConfectionery;
-    s_visualCategories[OsmTag("shop", "convenience")]           = GeoDataPlacemark::ShopConvenience;
-    s_visualCategories[OsmTag("shop", "copy")]                  = GeoDataPlacemark::ShopCopy;
-    s_visualCategories[OsmTag("shop", "cosmetics")]             = GeoDataPlacemark::ShopCosmetics;
-    s_visualCategories[OsmTag("shop", "deli")]                  = GeoDataPlacemark::ShopDeli;
-    s_visualCategories[OsmTag("shop", "department_store")]      = GeoDataPlacemark::ShopDepartmentStore;
-    s_visualCategories[OsmTag("shop", "doityourself")]          = GeoDataPlacemark::ShopDoitYourself;
-    s_visualCategories[OsmTag("shop", "electronics")]           = GeoDataPlacemark::ShopElectronics;
-    s_visualCategories[OsmTag("shop", "fashion")]               = GeoDataPlacemark::ShopFashion;
-    s_visualCategories[OsmTag("shop", "florist")]               = GeoDataPlacemark::ShopFlorist;
-    s_visualCategories[OsmTag("shop", "furniture")]             = GeoDataPlacemark::ShopFurniture;
-    s_visualCategories[OsmTag("shop", "gift")]                  = GeoDataPlacemark::ShopGift;
-    s_visualCategories[OsmTag("shop", "greengrocer")]           = GeoDataPlacemark::ShopGreengrocer;
-    s_visualCategories[OsmTag("shop", "hairdresser")]           = GeoDataPlacemark::ShopHairdresser;
-    s_visualCategories[OsmTag("shop", "hardware")]              = GeoDataPlacemark::ShopHardware;
-    s_visualCategories[OsmTag("shop", "hifi")]                  = GeoDataPlacemark::ShopHifi;
-    s_visualCategories[OsmTag("shop", "jewelry")]               = GeoDataPlacemark::ShopJewelry;
-    s_visualCategories[OsmTag("shop", "kiosk")]                 = GeoDataPlacemark::ShopKiosk;
-    s_visualCategories[OsmTag("shop", "laundry")]               = GeoDataPlacemark::ShopLaundry;
-    s_visualCategories[OsmTag("shop", "mobile_phone")]          = GeoDataPlacemark::ShopMobilePhone;
-    s_visualCategories[OsmTag("shop", "motorcycle")]            = GeoDataPlacemark::ShopMotorcycle;
-    s_visualCategories[OsmTag("shop", "musical_instrument")]    = GeoDataPlacemark::ShopMusicalInstrument;
-    s_visualCategories[OsmTag("shop", "optician")]              = GeoDataPlacemark::ShopOptician;
-    s_visualCategories[OsmTag("shop", "outdoor")]               = GeoDataPlacemark::ShopOutdoor;
-    s_visualCategories[OsmTag("shop", "perfumery")]             = GeoDataPlacemark::ShopPerfumery;
-    s_visualCategories[OsmTag("shop", "pet")]                   = GeoDataPlacemark::ShopPet;
-    s_visualCategories[OsmTag("shop", "photo")]                 = GeoDataPlacemark::ShopPhoto;
-    s_visualCategories[OsmTag("shop", "seafood")]               = GeoDataPlacemark::ShopSeafood;
-    s_visualCategories[OsmTag("shop", "shoes")]                 = GeoDataPlacemark::ShopShoes;
-    s_visualCategories[OsmTag("shop", "sports")]                = GeoDataPlacemark::ShopSports;
-    s_visualCategories[OsmTag("shop", "stationery")]            = GeoDataPlacemark::ShopStationery;
-    s_visualCategories[OsmTag("shop", "supermarket")]           = GeoDataPlacemark::ShopSupermarket;
-    s_visualCategories[OsmTag("shop", "tea")]                   = GeoDataPlacemark::ShopTea;
-    s_visualCategories[OsmTag("shop", "computer")]              = GeoDataPlacemark::ShopComputer;
-    s_visualCategories[OsmTag("shop", "garden_centre")]         = GeoDataPlacemark::ShopGardenCentre;
-    s_visualCategories[OsmTag("shop", "tobacco")]               = GeoDataPlacemark::ShopTobacco;
-    s_visualCategories[OsmTag("shop", "toys")]                  = GeoDataPlacemark::ShopToys;
-    s_visualCategories[OsmTag("shop", "travel_agency")]         = GeoDataPlacemark::ShopTravelAgency;
-    s_visualCategories[OsmTag("shop", "variety_store")]         = GeoDataPlacemark::ShopVarietyStore;
-
-
-    // Default for all other shops
-    for (const QString &value: shopValues()) {
-        s_visualCategories[OsmTag("shop", value)]               = GeoDataPlacemark::Shop;
-    }
+        visualCategories[OsmTag("man_made", "bridge")]            = GeoDataPlacemark::ManmadeBridge;
+        visualCategories[OsmTag("man_made", "lighthouse")]        = GeoDataPlacemark::ManmadeLighthouse;
+        visualCategories[OsmTag("man_made", "pier")]              = GeoDataPlacemark::ManmadePier;
+        visualCategories[OsmTag("man_made", "water_tower")]       = GeoDataPlacemark::ManmadeWaterTower;
+        visualCategories[OsmTag("man_made", "windmill")]          = GeoDataPlacemark::ManmadeWindMill;
+        visualCategories[OsmTag("man_made", "communications_tower")] = GeoDataPlacemark::ManmadeCommunicationsTower;
+        visualCategories[OsmTag("tower:type", "communication")]   = GeoDataPlacemark::ManmadeCommunicationsTower;
+
+        visualCategories[OsmTag("religion", "")]                  = GeoDataPlacemark::ReligionPlaceOfWorship;
+        visualCategories[OsmTag("religion", "bahai")]             = GeoDataPlacemark::ReligionBahai;
+        visualCategories[OsmTag("religion", "buddhist")]          = GeoDataPlacemark::ReligionBuddhist;
+        visualCategories[OsmTag("religion", "christian")]         = GeoDataPlacemark::ReligionChristian;
+        visualCategories[OsmTag("religion", "hindu")]             = GeoDataPlacemark::ReligionHindu;
+        visualCategories[OsmTag("religion", "jain")]              = GeoDataPlacemark::ReligionJain;
+        visualCategories[OsmTag("religion", "jewish")]            = GeoDataPlacemark::ReligionJewish;
+        visualCategories[OsmTag("religion", "muslim")]            = GeoDataPlacemark::ReligionMuslim;
+        visualCategories[OsmTag("religion", "shinto")]            = GeoDataPlacemark::ReligionShinto;
+        visualCategories[OsmTag("religion", "sikh")]              = GeoDataPlacemark::ReligionSikh;
+        visualCategories[OsmTag("religion", "taoist")]            = GeoDataPlacemark::ReligionTaoist;
+
+        visualCategories[OsmTag("tourism", "camp_site")]          = GeoDataPlacemark::AccomodationCamping;
+        visualCategories[OsmTag("tourism", "guest_house")]        = GeoDataPlacemark::AccomodationGuestHouse;
+        visualCategories[OsmTag("tourism", "hostel")]             = GeoDataPlacemark::AccomodationHostel;
+        visualCategories[OsmTag("tourism", "hotel")]              = GeoDataPlacemark::AccomodationHotel;
+        visualCategories[OsmTag("tourism", "motel")]              = GeoDataPlacemark::AccomodationMotel;
+
+        visualCategories[OsmTag("tourism", "alpine_hut")]         = GeoDataPlacemark::TourismAlpineHut;
+        visualCategories[OsmTag("tourism", "artwork")]            = GeoDataPlacemark::TourismArtwork;
+        visualCategories[OsmTag("tourism", "attraction")]         = GeoDataPlacemark::TourismAttraction;
+        visualCategories[OsmTag("tourism", "museum")]             = GeoDataPlacemark::TourismMuseum;
+        visualCategories[OsmTag("tourism", "theme_park")]         = GeoDataPlacemark::TourismThemePark;
+        visualCategories[OsmTag("tourism", "viewpoint")]          = GeoDataPlacemark::TourismViewPoint;
+        visualCategories[OsmTag("tourism", "wilderness_hut")]     = GeoDataPlacemark::TourismWildernessHut;
+        visualCategories[OsmTag("tourism", "zoo")]                = GeoDataPlacemark::TourismZoo;
+
+        visualCategories[OsmTag("barrier", "city_wall")]          = GeoDataPlacemark::BarrierCityWall;
+        visualCategories[OsmTag("barrier", "gate")]               = GeoDataPlacemark::BarrierGate;
+        visualCategories[OsmTag("barrier", "lift_gate")]          = GeoDataPlacemark::BarrierLiftGate;
+        visualCategories[OsmTag("barrier", "wall")]               = GeoDataPlacemark::BarrierWall;
+
+        visualCategories[OsmTag("highway", "traffic_signals")]    = GeoDataPlacemark::HighwayTrafficSignals;
+        visualCategories[OsmTag("highway", "elevator")]           = GeoDataPlacemark::HighwayElevator;
+
+        visualCategories[OsmTag("highway", "cycleway")]           = GeoDataPlacemark::HighwayCycleway;
+        visualCategories[OsmTag("highway", "footway")]            = GeoDataPlacemark::HighwayFootway;
+        visualCategories[OsmTag("highway", "living_street")]      = GeoDataPlacemark::HighwayLivingStreet;
+        visualCategories[OsmTag("highway", "motorway")]           = GeoDataPlacemark::HighwayMotorway;
+        visualCategories[OsmTag("highway", "motorway_link")]      = GeoDataPlacemark::HighwayMotorwayLink;
+        visualCategories[OsmTag("highway", "path")]               = GeoDataPlacemark::HighwayPath;
+        visualCategories[OsmTag("highway", "pedestrian")]         = GeoDataPlacemark::HighwayPedestrian;
+        visualCategories[OsmTag("highway", "primary")]            = GeoDataPlacemark::HighwayPrimary;
+        visualCategories[OsmTag("highway", "primary_link")]       = GeoDataPlacemark::HighwayPrimaryLink;
+        visualCategories[OsmTag("highway", "raceway")]            = GeoDataPlacemark::HighwayRaceway;
+        visualCategories[OsmTag("highway", "residential")]        = GeoDataPlacemark::HighwayResidential;
+        visualCategories[OsmTag("highway", "road")]               = GeoDataPlacemark::HighwayRoad;
+        visualCategories[OsmTag("highway", "secondary")]          = GeoDataPlacemark::HighwaySecondary;
+        visualCategories[OsmTag("highway", "secondary_link")]     = GeoDataPlacemark::HighwaySecondaryLink;
+        visualCategories[OsmTag("highway", "service")]            = GeoDataPlacemark::HighwayService;
+        visualCategories[OsmTag("highway", "steps")]              = GeoDataPlacemark::HighwaySteps;
+        visualCategories[OsmTag("highway", "tertiary")]           = GeoDataPlacemark::HighwayTertiary;
+        visualCategories[OsmTag("highway", "tertiary_link")]      = GeoDataPlacemark::HighwayTertiaryLink;
+        visualCategories[OsmTag("highway", "track")]              = GeoDataPlacemark::HighwayTrack;
+        visualCategories[OsmTag("highway", "trunk")]              = GeoDataPlacemark::HighwayTrunk;
+        visualCategories[OsmTag("highway", "trunk_link")]         = GeoDataPlacemark::HighwayTrunkLink;
+        visualCategories[OsmTag("highway", "unclassified")]       = GeoDataPlacemark::HighwayUnclassified;
+        visualCategories[OsmTag("highway", "unknown")]            = GeoDataPlacemark::HighwayUnknown;
+        visualCategories[OsmTag("highway", "corridor")]           = GeoDataPlacemark::HighwayCorridor;
+
+        visualCategories[OsmTag("natural", "bay")]                = GeoDataPlacemark::NaturalWater;
+        visualCategories[OsmTag("natural", "coastline")]          = GeoDataPlacemark::NaturalWater;
+        visualCategories[OsmTag("natural", "reef")]               = GeoDataPlacemark::NaturalReef;
+        visualCategories[OsmTag("natural", "water")]              = GeoDataPlacemark::NaturalWater;
+
+        visualCategories[OsmTag("waterway", "canal")]             = GeoDataPlacemark::WaterwayCanal;
+        visualCategories[OsmTag("waterway", "ditch")]             = GeoDataPlacemark::WaterwayDitch;
+        visualCategories[OsmTag("waterway", "drain")]             = GeoDataPlacemark::WaterwayDrain;
+        visualCategories[OsmTag("waterway", "river")]             = GeoDataPlacemark::WaterwayRiver;
+        visualCategories[OsmTag("waterway", "riverbank")]         = GeoDataPlacemark::NaturalWater;
+        visualCategories[OsmTag("waterway", "weir")]              = GeoDataPlacemark::WaterwayWeir;
+        visualCategories[OsmTag("waterway", "stream")]            = GeoDataPlacemark::WaterwayStream;
+
+        visualCategories[OsmTag("natural", "beach")]              = GeoDataPlacemark::NaturalBeach;
+        visualCategories[OsmTag("natural", "cliff")]              = GeoDataPlacemark::NaturalCliff;
+        visualCategories[OsmTag("natural", "glacier")]            = GeoDataPlacemark::NaturalGlacier;
+        visualCategories[OsmTag("glacier:type", "shelf")]         = GeoDataPlacemark::NaturalIceShelf;
+        visualCategories[OsmTag("natural", "scrub")]              = GeoDataPlacemark::NaturalScrub;
+        visualCategories[OsmTag("natural", "wetland")]            = GeoDataPlacemark::NaturalWetland;
+        visualCategories[OsmTag("natural", "wood")]               = GeoDataPlacemark::NaturalWood;
+
+        visualCategories[OsmTag("military", "danger_area")]       = GeoDataPlacemark::MilitaryDangerArea;
+
+        visualCategories[OsmTag("landuse", "allotments")]         = GeoDataPlacemark::LanduseAllotments;
+        visualCategories[OsmTag("landuse", "basin")]              = GeoDataPlacemark::LanduseBasin;
+        visualCategories[OsmTag("landuse", "brownfield")]         = GeoDataPlacemark::LanduseConstruction;
+        visualCategories[OsmTag("landuse", "cemetery")]           = GeoDataPlacemark::LanduseCemetery;
+        visualCategories[OsmTag("landuse", "commercial")]         = GeoDataPlacemark::LanduseCommercial;
+        visualCategories[OsmTag("landuse", "construction")]       = GeoDataPlacemark::LanduseConstruction;
+        visualCategories[OsmTag("landuse", "farm")]               = GeoDataPlacemark::LanduseFarmland;
+        visualCategories[OsmTag("landuse", "farmland")]           = GeoDataPlacemark::LanduseFarmland;
+        visualCategories[OsmTag("landuse", "farmyard")]           = GeoDataPlacemark::LanduseFarmland;
+        visualCategories[OsmTag("landuse", "forest")]             = GeoDataPlacemark::NaturalWood;
+        visualCategories[OsmTag("landuse", "garages")]            = GeoDataPlacemark::LanduseGarages;
+        visualCategories[OsmTag("landuse", "grass")]              = GeoDataPlacemark::LanduseGrass;
+        visualCategories[OsmTag("landuse", "greenfield")]         = GeoDataPlacemark::LanduseConstruction;
+        visualCategories[OsmTag("landuse", "greenhouse_horticulture")] = GeoDataPlacemark::LanduseFarmland;
+        visualCategories[OsmTag("landuse", "industrial")]         = GeoDataPlacemark::LanduseIndustrial;
+        visualCategories[OsmTag("landuse", "landfill")]           = GeoDataPlacemark::LanduseLandfill;
+        visualCategories[OsmTag("landuse", "meadow")]             = GeoDataPlacemark::LanduseMeadow;
+        visualCategories[OsmTag("landuse", "military")]           = GeoDataPlacemark::LanduseMilitary;
+        visualCategories[OsmTag("landuse", "orchard")]            = GeoDataPlacemark::LanduseFarmland;
+        visualCategories[OsmTag("landuse", "orchard")]            = GeoDataPlacemark::LanduseOrchard;
+        visualCategories[OsmTag("landuse", "quarry")]             = GeoDataPlacemark::LanduseQuarry;
+        visualCategories[OsmTag("landuse", "railway")]            = GeoDataPlacemark::LanduseRailway;
+        visualCategories[OsmTag("landuse", "recreation_ground")]  = GeoDataPlacemark::LeisurePark;
+        visualCategories[OsmTag("landuse", "reservoir")]          = GeoDataPlacemark::LanduseReservoir;
+        visualCategories[OsmTag("landuse", "residential")]        = GeoDataPlacemark::LanduseResidential;
+        visualCategories[OsmTag("landuse", "retail")]             = GeoDataPlacemark::LanduseRetail;
+        visualCategories[OsmTag("landuse", "village_green")]      = GeoDataPlacemark::LanduseGrass;
+        visualCategories[OsmTag("landuse", "vineyard")]           = GeoDataPlacemark::LanduseVineyard;
+
+        visualCategories[OsmTag("leisure", "common")]             = GeoDataPlacemark::LanduseGrass;
+        visualCategories[OsmTag("leisure", "garden")]             = GeoDataPlacemark::LanduseGrass;
+
+        visualCategories[OsmTag("leisure", "golf_course")]        = GeoDataPlacemark::LeisureGolfCourse;
+        visualCategories[OsmTag("leisure", "marina")]             = GeoDataPlacemark::LeisureMarina;
+        visualCategories[OsmTag("leisure", "miniature_golf")]     = GeoDataPlacemark::LeisureMinigolfCourse;
+        visualCategories[OsmTag("leisure", "park")]               = GeoDataPlacemark::LeisurePark;
+        visualCategories[OsmTag("leisure", "pitch")]              = GeoDataPlacemark::LeisurePitch;
+        visualCategories[OsmTag("leisure", "playground")]         = GeoDataPlacemark::LeisurePlayground;
+        visualCategories[OsmTag("leisure", "sports_centre")]      = GeoDataPlacemark::LeisureSportsCentre;
+        visualCategories[OsmTag("leisure", "stadium")]            = GeoDataPlacemark::LeisureStadium;
+        visualCategories[OsmTag("leisure", "swimming_pool")]      = GeoDataPlacemark::LeisureSwimmingPool;
+        visualCategories[OsmTag("leisure", "track")]              = GeoDataPlacemark::LeisureTrack;
+        visualCategories[OsmTag("leisure", "water_park")]         = GeoDataPlacemark::LeisureWaterPark;
+
+        visualCategories[OsmTag("railway", "abandoned")]          = GeoDataPlacemark::RailwayAbandoned;
+        visualCategories[OsmTag("railway", "construction")]       = GeoDataPlacemark::RailwayConstruction;
+        visualCategories[OsmTag("railway", "disused")]            = GeoDataPlacemark::RailwayAbandoned;
+        visualCategories[OsmTag("railway", "funicular")]          = GeoDataPlacemark::RailwayFunicular;
+        visualCategories[OsmTag("railway", "halt")]               = GeoDataPlacemark::TransportTrainStation;
+        visualCategories[OsmTag("railway", "light_rail")]         = GeoDataPlacemark::RailwayLightRail;
+        visualCategories[OsmTag("railway", "miniature")]          = GeoDataPlacemark::RailwayMiniature;
+        visualCategories[OsmTag("railway", "monorail")]           = GeoDataPlacemark::RailwayMonorail;
+        visualCategories[OsmTag("railway", "narrow_gauge")]       = GeoDataPlacemark::RailwayNarrowGauge;
+        visualCategories[OsmTag("railway", "platform")]           = GeoDataPlacemark::TransportPlatform;
+        visualCategories[OsmTag("railway", "preserved")]          = GeoDataPlacemark::RailwayPreserved;
+        visualCategories[OsmTag("railway", "rail")]               = GeoDataPlacemark::RailwayRail;
+        visualCategories[OsmTag("railway", "razed")]              = GeoDataPlacemark::RailwayAbandoned;
+        visualCategories[OsmTag("railway", "station")]            = GeoDataPlacemark::TransportTrainStation;
+        visualCategories[OsmTag("public_transport", "station")]   = GeoDataPlacemark::TransportTrainStation;
+        visualCategories[OsmTag("railway", "subway")]             = GeoDataPlacemark::RailwaySubway;
+        visualCategories[OsmTag("railway", "tram")]               = GeoDataPlacemark::RailwayTram;
+
+        visualCategories[OsmTag("power", "tower")]                = GeoDataPlacemark::PowerTower;
+
+        visualCategories[OsmTag("aeroway", "aerodrome")]          = GeoDataPlacemark::TransportAerodrome;
+        visualCategories[OsmTag("aeroway", "apron")]              = GeoDataPlacemark::TransportAirportApron;
+        visualCategories[OsmTag("aeroway", "gate")]               = GeoDataPlacemark::TransportAirportGate;
+        visualCategories[OsmTag("aeroway", "helipad")]            = GeoDataPlacemark::TransportHelipad;
+        visualCategories[OsmTag("aeroway", "runway")]             = GeoDataPlacemark::TransportAirportRunway;
+        visualCategories[OsmTag("aeroway", "taxiway")]            = GeoDataPlacemark::TransportAirportTaxiway;
+        visualCategories[OsmTag("aeroway", "terminal")]           = GeoDataPlacemark::TransportAirportTerminal;
+
+        visualCategories[OsmTag("piste:type", "downhill")]        = GeoDataPlacemark::PisteDownhill;
+        visualCategories[OsmTag("piste:type", "nordic")]          = GeoDataPlacemark::PisteNordic;
+        visualCategories[OsmTag("piste:type", "skitour")]         = GeoDataPlacemark::PisteSkitour;
+        visualCategories[OsmTag("piste:type", "sled")]            = GeoDataPlacemark::PisteSled;
+        visualCategories[OsmTag("piste:type", "hike")]            = GeoDataPlacemark::PisteHike;
+        visualCategories[OsmTag("piste:type", "sleigh")]          = GeoDataPlacemark::PisteSleigh;
+        visualCategories[OsmTag("piste:type", "ice_skate")]       = GeoDataPlacemark::PisteIceSkate;
+        visualCategories[OsmTag("piste:type", "snow_park")]       = GeoDataPlacemark::PisteSnowPark;
+        visualCategories[OsmTag("piste:type", "playground")]      = GeoDataPlacemark::PistePlayground;
+        visualCategories[OsmTag("piste:type", "ski_jump")]        = GeoDataPlacemark::PisteSkiJump;
+
+        visualCategories[OsmTag("amenity", "bicycle_parking")]    = GeoDataPlacemark::TransportBicycleParking;
+        visualCategories[OsmTag("amenity", "bicycle_rental")]     = GeoDataPlacemark::TransportRentalBicycle;
+        visualCategories[OsmTag("rental", "bicycle")]             = GeoDataPlacemark::TransportRentalBicycle;
+        visualCategories[OsmTag("amenity", "car_rental")]         = GeoDataPlacemark::TransportRentalCar;
+        visualCategories[OsmTag("rental", "car")]                 = GeoDataPlacemark::TransportRentalCar;
+        visualCategories[OsmTag("amenity", "ski_rental")]         = GeoDataPlacemark::TransportRentalSki;
+        visualCategories[OsmTag("rental", "ski")]                 = GeoDataPlacemark::TransportRentalSki;
+        visualCategories[OsmTag("amenity", "motorcycle_parking")] = GeoDataPlacemark::TransportMotorcycleParking;
+        visualCategories[OsmTag("amenity", "taxi")]               = GeoDataPlacemark::TransportTaxiRank;
+        visualCategories[OsmTag("highway", "bus_stop")]           = GeoDataPlacemark::TransportBusStop;
+        visualCategories[OsmTag("highway", "speed_camera")]       = GeoDataPlacemark::TransportSpeedCamera;
+        visualCategories[OsmTag("public_transport", "platform")]  = GeoDataPlacemark::TransportPlatform;
+        visualCategories[OsmTag("railway", "subway_entrance")]    = GeoDataPlacemark::TransportSubwayEntrance;
+        visualCategories[OsmTag("railway", "tram_stop")]          = GeoDataPlacemark::TransportTramStop;
+
+        visualCategories[OsmTag("place", "city")]                 = GeoDataPlacemark::PlaceCity;
+        visualCategories[OsmTag("place", "hamlet")]               = GeoDataPlacemark::PlaceHamlet;
+        visualCategories[OsmTag("place", "locality")]             = GeoDataPlacemark::PlaceLocality;
+        visualCategories[OsmTag("place", "suburb")]               = GeoDataPlacemark::PlaceSuburb;
+        visualCategories[OsmTag("place", "town")]                 = GeoDataPlacemark::PlaceTown;
+        visualCategories[OsmTag("place", "village")]              = GeoDataPlacemark::PlaceVillage;
+
+        visualCategories[OsmTag("aerialway", "station")]          = GeoDataPlacemark::AerialwayStation;
+        visualCategories[OsmTag("aerialway", "pylon")]            = GeoDataPlacemark::AerialwayPylon;
+        visualCategories[OsmTag("aerialway", "cable_car")]        = GeoDataPlacemark::AerialwayCableCar;
+        visualCategories[OsmTag("aerialway", "gondola")]          = GeoDataPlacemark::AerialwayGondola;
+        visualCategories[OsmTag("aerialway", "chair_lift")]       = GeoDataPlacemark::AerialwayChairLift;
+        visualCategories[OsmTag("aerialway", "mixed_lift")]       = GeoDataPlacemark::AerialwayMixedLift;
+        visualCategories[OsmTag("aerialway", "drag_lift")]        = GeoDataPlacemark::AerialwayDragLift;
+        visualCategories[OsmTag("aerialway", "t-bar")]            = GeoDataPlacemark::AerialwayTBar;
+        visualCategories[OsmTag("aerialway", "j-bar")]            = GeoDataPlacemark::AerialwayJBar;
+        visualCategories[OsmTag("aerialway", "platter")]          = GeoDataPlacemark::AerialwayPlatter;
+        visualCategories[OsmTag("aerialway", "rope_tow")]         = GeoDataPlacemark::AerialwayRopeTow;
+        visualCategories[OsmTag("aerialway", "magic_carpet")]     = GeoDataPlacemark::AerialwayMagicCarpet;
+        visualCategories[OsmTag("aerialway", "zip_line")]         = GeoDataPlacemark::AerialwayZipLine;
+        visualCategories[OsmTag("aerialway", "goods")]            = GeoDataPlacemark::AerialwayGoods;
+
+        visualCategories[OsmTag("indoor", "door")]                = GeoDataPlacemark::IndoorDoor;
+        visualCategories[OsmTag("indoor", "wall")]                = GeoDataPlacemark::IndoorWall;
+        visualCategories[OsmTag("indoor", "room")]                = GeoDataPlacemark::IndoorRoom;
+
+        //Custom Marble OSM Tags
+        visualCategories[OsmTag("marble_land", "landmass")]       = GeoDataPlacemark::Landmass;
+        visualCategories[OsmTag("settlement", "yes")]             = GeoDataPlacemark::UrbanArea;
+        visualCategories[OsmTag("marble_line", "date")]           = GeoDataPlacemark::InternationalDateLine;
+        visualCategories[OsmTag("marble:feature", "bathymetry")]  = GeoDataPlacemark::Bathymetry;
+
+        // Default for buildings
+        for (const auto &tag: buildingTags()) {
+            visualCategories[tag]                                 = GeoDataPlacemark::Building;
+        }
 
-    s_visualCategories[OsmTag("man_made", "bridge")]            = GeoDataPlacemark::ManmadeBridge;
-    s_visualCategories[OsmTag("man_made", "lighthouse")]        = GeoDataPlacemark::ManmadeLighthouse;
-    s_visualCategories[OsmTag("man_made", "pier")]              = GeoDataPlacemark::ManmadePier;
-    s_visualCategories[OsmTag("man_made", "water_tower")]       = GeoDataPlacemark::ManmadeWaterTower;
-    s_visualCategories[OsmTag("man_made", "windmill")]          = GeoDataPlacemark::ManmadeWindMill;
-    s_visualCategories[OsmTag("man_made", "communications_tower")] = GeoDataPlacemark::ManmadeCommunicationsTower;
-    s_visualCategories[OsmTag("tower:type", "communication")]   = GeoDataPlacemark::ManmadeCommunicationsTower;
-
-    s_visualCategories[OsmTag("religion", "")]                  = GeoDataPlacemark::ReligionPlaceOfWorship;
-    s_visualCategories[OsmTag("religion", "bahai")]             = GeoDataPlacemark::ReligionBahai;
-    s_visualCategories[OsmTag("religion", "buddhist")]          = GeoDataPlacemark::ReligionBuddhist;
-    s_visualCategories[OsmTag("religion", "christian")]         = GeoDataPlacemark::ReligionChristian;
-    s_visualCategories[OsmTag("religion", "hindu")]             = GeoDataPlacemark::ReligionHindu;
-    s_visualCategories[OsmTag("religion", "jain")]              = GeoDataPlacemark::ReligionJain;
-    s_visualCategories[OsmTag("religion", "jewish")]            = GeoDataPlacemark::ReligionJewish;
-    s_visualCategories[OsmTag("religion", "muslim")]            = GeoDataPlacemark::ReligionMuslim;
-    s_visualCategories[OsmTag("religion", "shinto")]            = GeoDataPlacemark::ReligionShinto;
-    s_visualCategories[OsmTag("religion", "sikh")]              = GeoDataPlacemark::ReligionSikh;
-    s_visualCategories[OsmTag("religion", "taoist")]            = GeoDataPlacemark::ReligionTaoist;
-
-    s_visualCategories[OsmTag("tourism", "camp_site")]          = GeoDataPlacemark::AccomodationCamping;
-    s_visualCategories[OsmTag("tourism", "guest_house")]        = GeoDataPlacemark::AccomodationGuestHouse;
-    s_visualCategories[OsmTag("tourism", "hostel")]             = GeoDataPlacemark::AccomodationHostel;
-    s_visualCategories[OsmTag("tourism", "hotel")]              = GeoDataPlacemark::AccomodationHotel;
-    s_visualCategories[OsmTag("tourism", "motel")]              = GeoDataPlacemark::AccomodationMotel;
-
-    s_visualCategories[OsmTag("tourism", "alpine_hut")]         = GeoDataPlacemark::TourismAlpineHut;
-    s_visualCategories[OsmTag("tourism", "artwork")]            = GeoDataPlacemark::TourismArtwork;
-    s_visualCategories[OsmTag("tourism", "attraction")]         = GeoDataPlacemark::TourismAttraction;
-    s_visualCategories[OsmTag("tourism", "museum")]             = GeoDataPlacemark::TourismMuseum;
-    s_visualCategories[OsmTag("tourism", "theme_park")]         = GeoDataPlacemark::TourismThemePark;
-    s_visualCategories[OsmTag("tourism", "viewpoint")]          = GeoDataPlacemark::TourismViewPoint;
-    s_visualCategories[OsmTag("tourism", "wilderness_hut")]     = GeoDataPlacemark::TourismWildernessHut;
-    s_visualCategories[OsmTag("tourism", "zoo")]                = GeoDataPlacemark::TourismZoo;
-
-    s_visualCategories[OsmTag("barrier", "city_wall")]          = GeoDataPlacemark::BarrierCityWall;
-    s_visualCategories[OsmTag("barrier", "gate")]               = GeoDataPlacemark::BarrierGate;
-    s_visualCategories[OsmTag("barrier", "lift_gate")]          = GeoDataPlacemark::BarrierLiftGate;
-    s_visualCategories[OsmTag("barrier", "wall")]               = GeoDataPlacemark::BarrierWall;
-
-    s_visualCategories[OsmTag("highway", "traffic_signals")]    = GeoDataPlacemark::HighwayTrafficSignals;
-    s_visualCategories[OsmTag("highway", "elevator")]           = GeoDataPlacemark::HighwayElevator;
-
-    s_visualCategories[OsmTag("highway", "cycleway")]           = GeoDataPlacemark::HighwayCycleway;
-    s_visualCategories[OsmTag("highway", "footway")]            = GeoDataPlacemark::HighwayFootway;
-    s_visualCategories[OsmTag("highway", "living_street")]      = GeoDataPlacemark::HighwayLivingStreet;
-    s_visualCategories[OsmTag("highway", "motorway")]           = GeoDataPlacemark::HighwayMotorway;
-    s_visualCategories[OsmTag("highway", "motorway_link")]      = GeoDataPlacemark::HighwayMotorwayLink;
-    s_visualCategories[OsmTag("highway", "path")]               = GeoDataPlacemark::HighwayPath;
-    s_visualCategories[OsmTag("highway", "pedestrian")]         = GeoDataPlacemark::HighwayPedestrian;
-    s_visualCategories[OsmTag("highway", "primary")]            = GeoDataPlacemark::HighwayPrimary;
-    s_visualCategories[OsmTag("highway", "primary_link")]       = GeoDataPlacemark::HighwayPrimaryLink;
-    s_visualCategories[OsmTag("highway", "raceway")]            = GeoDataPlacemark::HighwayRaceway;
-    s_visualCategories[OsmTag("highway", "residential")]        = GeoDataPlacemark::HighwayResidential;
-    s_visualCategories[OsmTag("highway", "road")]               = GeoDataPlacemark::HighwayRoad;
-    s_visualCategories[OsmTag("highway", "secondary")]          = GeoDataPlacemark::HighwaySecondary;
-    s_visualCategories[OsmTag("highway", "secondary_link")]     = GeoDataPlacemark::HighwaySecondaryLink;
-    s_visualCategories[OsmTag("highway", "service")]            = GeoDataPlacemark::HighwayService;
-    s_visualCategories[OsmTag("highway", "steps")]              = GeoDataPlacemark::HighwaySteps;
-    s_visualCategories[OsmTag("highway", "tertiary")]           = GeoDataPlacemark::HighwayTertiary;
-    s_visualCategories[OsmTag("highway", "tertiary_link")]      = GeoDataPlacemark::HighwayTertiaryLink;
-    s_visualCategories[OsmTag("highway", "track")]              = GeoDataPlacemark::HighwayTrack;
-    s_visualCategories[OsmTag("highway", "trunk")]              = GeoDataPlacemark::HighwayTrunk;
-    s_visualCategories[OsmTag("highway", "trunk_link")]         = GeoDataPlacemark::HighwayTrunkLink;
-    s_visualCategories[OsmTag("highway", "unclassified")]       = GeoDataPlacemark::HighwayUnclassified;
-    s_visualCategories[OsmTag("highway", "unknown")]            = GeoDataPlacemark::HighwayUnknown;
-    s_visualCategories[OsmTag("highway", "corridor")]           = GeoDataPlacemark::HighwayCorridor;
-
-    s_visualCategories[OsmTag("natural", "bay")]                = GeoDataPlacemark::NaturalWater;
-    s_visualCategories[OsmTag("natural", "coastline")]          = GeoDataPlacemark::NaturalWater;
-    s_visualCategories[OsmTag("natural", "reef")]               = GeoDataPlacemark::NaturalReef;
-    s_visualCategories[OsmTag("natural", "water")]              = GeoDataPlacemark::NaturalWater;
-
-    s_visualCategories[OsmTag("waterway", "canal")]             = GeoDataPlacemark::WaterwayCanal;
-    s_visualCategories[OsmTag("waterway", "ditch")]             = GeoDataPlacemark::WaterwayDitch;
-    s_visualCategories[OsmTag("waterway", "drain")]             = GeoDataPlacemark::WaterwayDrain;
-    s_visualCategories[OsmTag("waterway", "river")]             = GeoDataPlacemark::WaterwayRiver;
-    s_visualCategories[OsmTag("waterway", "riverbank")]         = GeoDataPlacemark::NaturalWater;
-    s_visualCategories[OsmTag("waterway", "weir")]              = GeoDataPlacemark::WaterwayWeir;
-    s_visualCategories[OsmTag("waterway", "stream")]            = GeoDataPlacemark::WaterwayStream;
-
-    s_visualCategories[OsmTag("natural", "beach")]              = GeoDataPlacemark::NaturalBeach;
-    s_visualCategories[OsmTag("natural", "cliff")]              = GeoDataPlacemark::NaturalCliff;
-    s_visualCategories[OsmTag("natural", "glacier")]            = GeoDataPlacemark::NaturalGlacier;
-    s_visualCategories[OsmTag("glacier:type", "shelf")]         = GeoDataPlacemark::NaturalIceShelf;
-    s_visualCategories[OsmTag("natural", "scrub")]              = GeoDataPlacemark::NaturalScrub;
-    s_visualCategories[OsmTag("natural", "wetland")]            = GeoDataPlacemark::NaturalWetland;
-    s_visualCategories[OsmTag("natural", "wood")]               = GeoDataPlacemark::NaturalWood;
-
-    s_visualCategories[OsmTag("military", "danger_area")]       = GeoDataPlacemark::MilitaryDangerArea;
-
-    s_visualCategories[OsmTag("landuse", "allotments")]         = GeoDataPlacemark::LanduseAllotments;
-    s_visualCategories[OsmTag("landuse", "basin")]              = GeoDataPlacemark::LanduseBasin;
-    s_visualCategories[OsmTag("landuse", "brownfield")]         = GeoDataPlacemark::LanduseConstruction;
-    s_visualCategories[OsmTag("landuse", "cemetery")]           = GeoDataPlacemark::LanduseCemetery;
-    s_visualCategories[OsmTag("landuse", "commercial")]         = GeoDataPlacemark::LanduseCommercial;
-    s_visualCategories[OsmTag("landuse", "construction")]       = GeoDataPlacemark::LanduseConstruction;
-    s_visualCategories[OsmTag("landuse", "farm")]               = GeoDataPlacemark::LanduseFarmland;
-    s_visualCategories[OsmTag("landuse", "farmland")]           = GeoDataPlacemark::LanduseFarmland;
-    s_visualCategories[OsmTag("landuse", "farmyard")]           = GeoDataPlacemark::LanduseFarmland;
-    s_visualCategories[OsmTag("landuse", "forest")]             = GeoDataPlacemark::NaturalWood;
-    s_visualCategories[OsmTag("landuse", "garages")]            = GeoDataPlacemark::LanduseGarages;
-    s_visualCategories[OsmTag("landuse", "grass")]              = GeoDataPlacemark::LanduseGrass;
-    s_visualCategories[OsmTag("landuse", "greenfield")]         = GeoDataPlacemark::LanduseConstruction;
-    s_visualCategories[OsmTag("landuse", "greenhouse_horticulture")] = GeoDataPlacemark::LanduseFarmland;
-    s_visualCategories[OsmTag("landuse", "industrial")]         = GeoDataPlacemark::LanduseIndustrial;
-    s_visualCategories[OsmTag("landuse", "landfill")]           = GeoDataPlacemark::LanduseLandfill;
-    s_visualCategories[OsmTag("landuse", "meadow")]             = GeoDataPlacemark::LanduseMeadow;
-    s_visualCategories[OsmTag("landuse", "military")]           = GeoDataPlacemark::LanduseMilitary;
-    s_visualCategories[OsmTag("landuse", "orchard")]            = GeoDataPlacemark::LanduseFarmland;
-    s_visualCategories[OsmTag("landuse", "orchard")]            = GeoDataPlacemark::LanduseOrchard;
-    s_visualCategories[OsmTag("landuse", "quarry")]             = GeoDataPlacemark::LanduseQuarry;
-    s_visualCategories[OsmTag("landuse", "railway")]            = GeoDataPlacemark::LanduseRailway;
-    s_visualCategories[OsmTag("landuse", "recreation_ground")]  = GeoDataPlacemark::LeisurePark;
-    s_visualCategories[OsmTag("landuse", "reservoir")]          = GeoDataPlacemark::LanduseReservoir;
-    s_visualCategories[OsmTag("landuse", "residential")]        = GeoDataPlacemark::LanduseResidential;
-    s_visualCategories[OsmTag("landuse", "retail")]             = GeoDataPlacemark::LanduseRetail;
-    s_visualCategories[OsmTag("landuse", "village_green")]      = GeoDataPlacemark::LanduseGrass;
-    s_visualCategories[OsmTag("landuse", "vineyard")]           = GeoDataPlacemark::LanduseVineyard;
-
-    s_visualCategories[OsmTag("leisure", "common")]             = GeoDataPlacemark::LanduseGrass;
-    s_visualCategories[OsmTag("leisure", "garden")]             = GeoDataPlacemark::LanduseGrass;
-
-    s_visualCategories[OsmTag("leisure", "golf_course")]        = GeoDataPlacemark::LeisureGolfCourse;
-    s_visualCategories[OsmTag("leisure", "marina")]             = GeoDataPlacemark::LeisureMarina;
-    s_visualCategories[OsmTag("leisure", "miniature_golf")]     = GeoDataPlacemark::LeisureMinigolfCourse;
-    s_visualCategories[OsmTag("leisure", "park")]               = GeoDataPlacemark::LeisurePark;
-    s_visualCategories[OsmTag("leisure", "pitch")]              = GeoDataPlacemark::LeisurePitch;
-    s_visualCategories[OsmTag("leisure", "playground")]         = GeoDataPlacemark::LeisurePlayground;
-    s_visualCategories[OsmTag("leisure", "sports_centre")]      = GeoDataPlacemark::LeisureSportsCentre;
-    s_visualCategories[OsmTag("leisure", "stadium")]            = GeoDataPlacemark::LeisureStadium;
-    s_visualCategories[OsmTag("leisure", "swimming_pool")]      = GeoDataPlacemark::LeisureSwimmingPool;
-    s_visualCategories[OsmTag("leisure", "track")]              = GeoDataPlacemark::LeisureTrack;
-    s_visualCategories[OsmTag("leisure", "water_park")]         = GeoDataPlacemark::LeisureWaterPark;
-
-    s_visualCategories[OsmTag("railway", "abandoned")]          = GeoDataPlacemark::RailwayAbandoned;
-    s_visualCategories[OsmTag("railway", "construction")]       = GeoDataPlacemark::RailwayConstruction;
-    s_visualCategories[OsmTag("railway", "disused")]            = GeoDataPlacemark::RailwayAbandoned;
-    s_visualCategories[OsmTag("railway", "funicular")]          = GeoDataPlacemark::RailwayFunicular;
-    s_visualCategories[OsmTag("railway", "halt")]               = GeoDataPlacemark::TransportTrainStation;
-    s_visualCategories[OsmTag("railway", "light_rail")]         = GeoDataPlacemark::RailwayLightRail;
-    s_visualCategories[OsmTag("railway", "miniature")]          = GeoDataPlacemark::RailwayMiniature;
-    s_visualCategories[OsmTag("railway", "monorail")]           = GeoDataPlacemark::RailwayMonorail;
-    s_visualCategories[OsmTag("railway", "narrow_gauge")]       = GeoDataPlacemark::RailwayNarrowGauge;
-    s_visualCategories[OsmTag("railway", "platform")]           = GeoDataPlacemark::TransportPlatform;
-    s_visualCategories[OsmTag("railway", "preserved")]          = GeoDataPlacemark::RailwayPreserved;
-    s_visualCategories[OsmTag("railway", "rail")]               = GeoDataPlacemark::RailwayRail;
-    s_visualCategories[OsmTag("railway", "razed")]              = GeoDataPlacemark::RailwayAbandoned;
-    s_visualCategories[OsmTag("railway", "station")]            = GeoDataPlacemark::TransportTrainStation;
-    s_visualCategories[OsmTag("public_transport", "station")]   = GeoDataPlacemark::TransportTrainStation;
-    s_visualCategories[OsmTag("railway", "subway")]             = GeoDataPlacemark::RailwaySubway;
-    s_visualCategories[OsmTag("railway", "tram")]               = GeoDataPlacemark::RailwayTram;
-
-    s_visualCategories[OsmTag("power", "tower")]                = GeoDataPlacemark::PowerTower;
-
-    s_visualCategories[OsmTag("aeroway", "aerodrome")]          = GeoDataPlacemark::TransportAerodrome;
-    s_visualCategories[OsmTag("aeroway", "apron")]              = GeoDataPlacemark::TransportAirportApron;
-    s_visualCategories[OsmTag("aeroway", "gate")]               = GeoDataPlacemark::TransportAirportGate;
-    s_visualCategories[OsmTag("aeroway", "helipad")]            = GeoDataPlacemark::TransportHelipad;
-    s_visualCategories[OsmTag("aeroway", "runway")]             = GeoDataPlacemark::TransportAirportRunway;
-    s_visualCategories[OsmTag("aeroway", "taxiway")]            = GeoDataPlacemark::TransportAirportTaxiway;
-    s_visualCategories[OsmTag("aeroway", "terminal")]           = GeoDataPlacemark::TransportAirportTerminal;
-
-    s_visualCategories[OsmTag("piste:type", "downhill")]        = GeoDataPlacemark::PisteDownhill;
-    s_visualCategories[OsmTag("piste:type", "nordic")]          = GeoDataPlacemark::PisteNordic;
-    s_visualCategories[OsmTag("piste:type", "skitour")]         = GeoDataPlacemark::PisteSkitour;
-    s_visualCategories[OsmTag("piste:type", "sled")]            = GeoDataPlacemark::PisteSled;
-    s_visualCategories[OsmTag("piste:type", "hike")]            = GeoDataPlacemark::PisteHike;
-    s_visualCategories[OsmTag("piste:type", "sleigh")]          = GeoDataPlacemark::PisteSleigh;
-    s_visualCategories[OsmTag("piste:type", "ice_skate")]       = GeoDataPlacemark::PisteIceSkate;
-    s_visualCategories[OsmTag("piste:type", "snow_park")]       = GeoDataPlacemark::PisteSnowPark;
-    s_visualCategories[OsmTag("piste:type", "playground")]      = GeoDataPlacemark::PistePlayground;
-    s_visualCategories[OsmTag("piste:type", "ski_jump")]        = GeoDataPlacemark::PisteSkiJump;
-
-    s_visualCategories[OsmTag("amenity", "bicycle_parking")]    = GeoDataPlacemark::TransportBicycleParking;
-    s_visualCategories[OsmTag("amenity", "bicycle_rental")]     = GeoDataPlacemark::TransportRentalBicycle;
-    s_visualCategories[OsmTag("rental", "bicycle")]             = GeoDataPlacemark::TransportRentalBicycle;
-    s_visualCategories[OsmTag("amenity", "car_rental")]         = GeoDataPlacemark::TransportRentalCar;
-    s_visualCategories[OsmTag("rental", "car")]                 = GeoDataPlacemark::TransportRentalCar;
-    s_visualCategories[OsmTag("amenity", "ski_rental")]         = GeoDataPlacemark::TransportRentalSki;
-    s_visualCategories[OsmTag("rental", "ski")]                 = GeoDataPlacemark::TransportRentalSki;
-    s_visualCategories[OsmTag("amenity", "motorcycle_parking")] = GeoDataPlacemark::TransportMotorcycleParking;
-    s_visualCategories[OsmTag("amenity", "taxi")]               = GeoDataPlacemark::TransportTaxiRank;
-    s_visualCategories[OsmTag("highway", "bus_stop")]           = GeoDataPlacemark::TransportBusStop;
-    s_visualCategories[OsmTag("highway", "speed_camera")]       = GeoDataPlacemark::TransportSpeedCamera;
-    s_visualCategories[OsmTag("public_transport", "platform")]  = GeoDataPlacemark::TransportPlatform;
-    s_visualCategories[OsmTag("railway", "subway_entrance")]    = GeoDataPlacemark::TransportSubwayEntrance;
-    s_visualCategories[OsmTag("railway", "tram_stop")]          = GeoDataPlacemark::TransportTramStop;
-
-    s_visualCategories[OsmTag("place", "city")]                 = GeoDataPlacemark::PlaceCity;
-    s_visualCategories[OsmTag("place", "hamlet")]               = GeoDataPlacemark::PlaceHamlet;
-    s_visualCategories[OsmTag("place", "locality")]             = GeoDataPlacemark::PlaceLocality;
-    s_visualCategories[OsmTag("place", "suburb")]               = GeoDataPlacemark::PlaceSuburb;
-    s_visualCategories[OsmTag("place", "town")]                 = GeoDataPlacemark::PlaceTown;
-    s_visualCategories[OsmTag("place", "village")]              = GeoDataPlacemark::PlaceVillage;
-
-    s_visualCategories[OsmTag("aerialway", "station")]          = GeoDataPlacemark::AerialwayStation;
-    s_visualCategories[OsmTag("aerialway", "pylon")]            = GeoDataPlacemark::AerialwayPylon;
-    s_visualCategories[OsmTag("aerialway", "cable_car")]        = GeoDataPlacemark::AerialwayCableCar;
-    s_visualCategories[OsmTag("aerialway", "gondola")]          = GeoDataPlacemark::AerialwayGondola;
-    s_visualCategories[OsmTag("aerialway", "chair_lift")]       = GeoDataPlacemark::AerialwayChairLift;
-    s_visualCategories[OsmTag("aerialway", "mixed_lift")]       = GeoDataPlacemark::AerialwayMixedLift;
-    s_visualCategories[OsmTag("aerialway", "drag_lift")]        = GeoDataPlacemark::AerialwayDragLift;
-    s_visualCategories[OsmTag("aerialway", "t-bar")]            = GeoDataPlacemark::AerialwayTBar;
-    s_visualCategories[OsmTag("aerialway", "j-bar")]            = GeoDataPlacemark::AerialwayJBar;
-    s_visualCategories[OsmTag("aerialway", "platter")]          = GeoDataPlacemark::AerialwayPlatter;
-    s_visualCategories[OsmTag("aerialway", "rope_tow")]         = GeoDataPlacemark::AerialwayRopeTow;
-    s_visualCategories[OsmTag("aerialway", "magic_carpet")]     = GeoDataPlacemark::AerialwayMagicCarpet;
-    s_visualCategories[OsmTag("aerialway", "zip_line")]         = GeoDataPlacemark::AerialwayZipLine;
-    s_visualCategories[OsmTag("aerialway", "goods")]            = GeoDataPlacemark::AerialwayGoods;
-
-    s_visualCategories[OsmTag("indoor", "door")]                = GeoDataPlacemark::IndoorDoor;
-    s_visualCategories[OsmTag("indoor", "wall")]                = GeoDataPlacemark::IndoorWall;
-    s_visualCategories[OsmTag("indoor", "room")]                = GeoDataPlacemark::IndoorRoom;
-
-    //Custom Marble OSM Tags
-    s_visualCategories[OsmTag("marble_land", "landmass")]       = GeoDataPlacemark::Landmass;
-    s_visualCategories[OsmTag("settlement", "yes")]             = GeoDataPlacemark::UrbanArea;
-    s_visualCategories[OsmTag("marble_line", "date")]           = GeoDataPlacemark::InternationalDateLine;
-    s_visualCategories[OsmTag("marble:feature", "bathymetry")]  = GeoDataPlacemark::Bathymetry;
-
-    // Default for buildings
-    for (const auto &tag: buildingTags()) {
-        s_visualCategories[tag]                                 = GeoDataPlacemark::Building;
-    }
+        return visualCategories;
+    }();
+
+    return table;
 }
 
-void StyleBuilder::Private::initializeMinimumZoomLevels()
+const QVector<int> &StyleBuilder::Private::defaultMinZoomLevels()
 {
-    if (s_defaultMinZoomLevelsInitialized) {
-        return;
-    }
-
-    s_defaultMinZoomLevelsInitialized = true;
-    for (int i = 0; i < GeoDataPlacemark::LastIndex; i++) {
-        s_defaultMinZoomLevels[i] = -1;
-    }
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel10] = 8;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel11] = 8;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel1] = 0;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel2] = 1;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel3] = 1;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel4] = 2;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel5] = 4;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel6] = 5;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel7] = 5;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel8] = 7;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AdminLevel9] = 7;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::HistoricArchaeologicalSite] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityBench] = 19;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityFountain]     = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityGraveyard]    = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityTelephone]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityKindergarten]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityLibrary]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityWasteBasket]  = 19;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityToilets] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityTownHall] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureWaterPark]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityDrinkingWater] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityEmbassy] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityEmergencyPhone] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityMountainRescue] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityCommunityCentre] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityFountain] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityNightClub] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityCourtHouse] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityFireStation] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityHuntingStand] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityPolice] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityPostBox] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityPostOffice] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityPrison] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityRecycling] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityShelter] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityChargingStation] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityCarWash] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenitySocialFacility] = 17;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::BarrierCityWall] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::BarrierGate]     = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::BarrierLiftGate] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::BarrierWall]     = 17;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::Bathymetry]  = 1;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::BoundaryMaritime]    = 1;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::Building]    = 17;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::Default]     = 1;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::EducationCollege]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::EducationSchool]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::EducationUniversity]  = 15;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::FoodBar]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::FoodBiergarten]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::FoodCafe]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::FoodFastFood]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::FoodPub]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::FoodRestaurant]  = 16;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::HealthHospital]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HealthPharmacy]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HealthDentist]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HealthDoctors]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HealthVeterinary]  = 17;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::HistoricMemorial]    = 17;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayCycleway]     = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayFootway]      = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayLivingStreet] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayMotorwayLink] = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayMotorway]     = 6;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayPath] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayPedestrian]   = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayPrimaryLink]  = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayPrimary]      = 8;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayRaceway]      = 12;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayResidential]  = 14;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayRoad] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwaySecondaryLink] = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwaySecondary]    = 9;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayService]      = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwaySteps] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayTertiaryLink] = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayTertiary]     = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayTrack] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayTrunkLink]    = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayTrunk] = 7;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayUnknown]      = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayUnclassified] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayTrafficSignals]      = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayCorridor]     = 18;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HighwayElevator] = 17;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::AccomodationCamping] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AccomodationHostel] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AccomodationHotel] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AccomodationMotel] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AccomodationYouthHostel] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AccomodationGuestHouse] = 16;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::InternationalDateLine]      = 1;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::Landmass]    = 0;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseAllotments]   = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseBasin] = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseCemetery]     = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseCommercial]   = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseConstruction] = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseFarmland]     = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseFarmyard]     = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseGarages]      = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseGrass] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseIndustrial]   = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseLandfill]     = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseMeadow]       = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseMilitary]     = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseOrchard]      = 14;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseQuarry]       = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseRailway]      = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseReservoir]    = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseResidential]  = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseRetail]       = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LanduseVineyard]     = 14;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureGolfCourse]   = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureMarina]       = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisurePark] = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisurePlayground]   = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisurePitch]   = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureStadium]   = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureSwimmingPool]   = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureSportsCentre]   = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureTrack]   = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::LeisureMinigolfCourse] = 16;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::ManmadeBridge]       = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::ManmadeLighthouse]       = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::ManmadePier]       = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::ManmadeWaterTower]       = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::ManmadeWindMill]       = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::ManmadeCommunicationsTower]       = 15;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::MilitaryDangerArea]  = 11;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::MoneyAtm]    = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::MoneyBank]    = 16;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalBeach] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalCliff] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalGlacier]      = 3;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalHeath]      = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalIceShelf]     = 3;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalVolcano]      = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalPeak] = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalReef] = 3;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalScrub] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalTree] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalCave] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalWater] = 3;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalWetland]      = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::NaturalWood] = 8;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceCityNationalCapital] = 9;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceCityCapital]    = 9;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceCity]   = 9;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceHamlet] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceLocality]       = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceSuburb] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceTownNationalCapital] = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceTownCapital]    = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceTown]   = 11;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceVillageNationalCapital] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceVillageCapital] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PlaceVillage] = 13;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::PowerTower] = 18;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayAbandoned]    = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayConstruction] = 10;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayFunicular]    = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayLightRail]    = 12;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayMiniature]    = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayMonorail]     = 12;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayNarrowGauge]  = 6;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayPreserved]    = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayRail] = 6;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwaySubway]       = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::RailwayTram] = 14;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::Satellite]   = 0;
-
-    for (int shop = GeoDataPlacemark::ShopBeverages; shop <= GeoDataPlacemark::Shop; ++shop) {
-        s_defaultMinZoomLevels[shop] = 17;
-    }
-    s_defaultMinZoomLevels[GeoDataPlacemark::ShopSupermarket] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::ShopDepartmentStore] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::ShopDoitYourself] = 16;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismAlpineHut]  = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismWildernessHut] = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismAttraction]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismArtwork] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HistoricCastle]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityCinema]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismMuseum]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HistoricRuins]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AmenityTheatre]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismThemePark]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismViewPoint]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismZoo]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::HistoricMonument]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TourismInformation]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportAerodrome] = 9;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportAirportApron] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportAirportRunway] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportAirportTaxiway] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportBusStation]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportCarShare]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportFuel]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportHelipad] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportAirportTerminal] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportAirportGate] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportPlatform]   = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportSpeedCamera] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportRentalCar] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportRentalBicycle] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportRentalSki] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportTaxiRank]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportParking]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportBusStop]  = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportTrainStation]  = 13;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportTramStop]  = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportParkingSpace]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportBicycleParking]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportMotorcycleParking]  = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::TransportSubwayEntrance]  = 17;
-
-    for (int religion = GeoDataPlacemark::ReligionPlaceOfWorship; religion <= GeoDataPlacemark::ReligionTaoist; ++religion) {
-        s_defaultMinZoomLevels[religion] = 17;
-    }
+    static const QVector<int> table = [] {
+        QVector<int> minZoomLevels(GeoDataPlacemark::LastIndex, -1);
+
+        minZoomLevels[GeoDataPlacemark::AdminLevel10] = 8;
+        minZoomLevels[GeoDataPlacemark::AdminLevel11] = 8;
+        minZoomLevels[GeoDataPlacemark::AdminLevel1] = 0;
+        minZoomLevels[GeoDataPlacemark::AdminLevel2] = 1;
+        minZoomLevels[GeoDataPlacemark::AdminLevel3] = 1;
+        minZoomLevels[GeoDataPlacemark::AdminLevel4] = 2;
+        minZoomLevels[GeoDataPlacemark::AdminLevel5] = 4;
+        minZoomLevels[GeoDataPlacemark::AdminLevel6] = 5;
+        minZoomLevels[GeoDataPlacemark::AdminLevel7] = 5;
+        minZoomLevels[GeoDataPlacemark::AdminLevel8] = 7;
+        minZoomLevels[GeoDataPlacemark::AdminLevel9] = 7;
+
+        minZoomLevels[GeoDataPlacemark::HistoricArchaeologicalSite] = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityBench] = 19;
+        minZoomLevels[GeoDataPlacemark::AmenityFountain]     = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityGraveyard]    = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityTelephone]  = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityKindergarten]  = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityLibrary]  = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityWasteBasket]  = 19;
+        minZoomLevels[GeoDataPlacemark::AmenityToilets] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityTownHall] = 15;
+        minZoomLevels[GeoDataPlacemark::LeisureWaterPark]  = 15;
+        minZoomLevels[GeoDataPlacemark::AmenityDrinkingWater] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityEmbassy] = 15;
+        minZoomLevels[GeoDataPlacemark::AmenityEmergencyPhone] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityMountainRescue] = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityCommunityCentre] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityFountain] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityNightClub] = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityCourtHouse] = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityFireStation] = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityHuntingStand] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityPolice] = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityPostBox] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityPostOffice] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityPrison] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityRecycling] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityShelter] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityChargingStation] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenityCarWash] = 17;
+        minZoomLevels[GeoDataPlacemark::AmenitySocialFacility] = 17;
+
+        minZoomLevels[GeoDataPlacemark::BarrierCityWall] = 15;
+        minZoomLevels[GeoDataPlacemark::BarrierGate]     = 17;
+        minZoomLevels[GeoDataPlacemark::BarrierLiftGate] = 17;
+        minZoomLevels[GeoDataPlacemark::BarrierWall]     = 17;
+
+        minZoomLevels[GeoDataPlacemark::Bathymetry]  = 1;
+
+        minZoomLevels[GeoDataPlacemark::BoundaryMaritime]    = 1;
+
+        minZoomLevels[GeoDataPlacemark::Building]    = 17;
+
+        minZoomLevels[GeoDataPlacemark::Default]     = 1;
+
+        minZoomLevels[GeoDataPlacemark::EducationCollege]  = 15;
+        minZoomLevels[GeoDataPlacemark::EducationSchool]  = 15;
+        minZoomLevels[GeoDataPlacemark::EducationUniversity]  = 15;
+
+        minZoomLevels[GeoDataPlacemark::FoodBar]  = 16;
+        minZoomLevels[GeoDataPlacemark::FoodBiergarten]  = 16;
+        minZoomLevels[GeoDataPlacemark::FoodCafe]  = 16;
+        minZoomLevels[GeoDataPlacemark::FoodFastFood]  = 16;
+        minZoomLevels[GeoDataPlacemark::FoodPub]  = 16;
+        minZoomLevels[GeoDataPlacemark::FoodRestaurant]  = 16;
+
+        minZoomLevels[GeoDataPlacemark::HealthHospital]  = 15;
+        minZoomLevels[GeoDataPlacemark::HealthPharmacy]  = 17;
+        minZoomLevels[GeoDataPlacemark::HealthDentist]  = 17;
+        minZoomLevels[GeoDataPlacemark::HealthDoctors]  = 17;
+        minZoomLevels[GeoDataPlacemark::HealthVeterinary]  = 17;
+
+        minZoomLevels[GeoDataPlacemark::HistoricMemorial]    = 17;
+
+        minZoomLevels[GeoDataPlacemark::HighwayCycleway]     = 16;
+        minZoomLevels[GeoDataPlacemark::HighwayFootway]      = 17;
+        minZoomLevels[GeoDataPlacemark::HighwayLivingStreet] = 15;
+        minZoomLevels[GeoDataPlacemark::HighwayMotorwayLink] = 10;
+        minZoomLevels[GeoDataPlacemark::HighwayMotorway]     = 6;
+        minZoomLevels[GeoDataPlacemark::HighwayPath] = 13;
+        minZoomLevels[GeoDataPlacemark::HighwayPedestrian]   = 13;
+        minZoomLevels[GeoDataPlacemark::HighwayPrimaryLink]  = 10;
+        minZoomLevels[GeoDataPlacemark::HighwayPrimary]      = 8;
+        minZoomLevels[GeoDataPlacemark::HighwayRaceway]      = 12;
+        minZoomLevels[GeoDataPlacemark::HighwayResidential]  = 14;
+        minZoomLevels[GeoDataPlacemark::HighwayRoad] = 13;
+        minZoomLevels[GeoDataPlacemark::HighwaySecondaryLink] = 10;
+        minZoomLevels[GeoDataPlacemark::HighwaySecondary]    = 9;
+        minZoomLevels[GeoDataPlacemark::HighwayService]      = 15;
+        minZoomLevels[GeoDataPlacemark::HighwaySteps] = 15;
+        minZoomLevels[GeoDataPlacemark::HighwayTertiaryLink] = 10;
+        minZoomLevels[GeoDataPlacemark::HighwayTertiary]     = 10;
+        minZoomLevels[GeoDataPlacemark::HighwayTrack] = 15;
+        minZoomLevels[GeoDataPlacemark::HighwayTrunkLink]    = 10;
+        minZoomLevels[GeoDataPlacemark::HighwayTrunk] = 7;
+        minZoomLevels[GeoDataPlacemark::HighwayUnknown]      = 16;
+        minZoomLevels[GeoDataPlacemark::HighwayUnclassified] = 16;
+        minZoomLevels[GeoDataPlacemark::HighwayTrafficSignals]      = 17;
+        minZoomLevels[GeoDataPlacemark::HighwayCorridor]     = 18;
+        minZoomLevels[GeoDataPlacemark::HighwayElevator] = 17;
+
+        minZoomLevels[GeoDataPlacemark::AccomodationCamping] = 16;
+        minZoomLevels[GeoDataPlacemark::AccomodationHostel] = 16;
+        minZoomLevels[GeoDataPlacemark::AccomodationHotel] = 16;
+        minZoomLevels[GeoDataPlacemark::AccomodationMotel] = 16;
+        minZoomLevels[GeoDataPlacemark::AccomodationYouthHostel] = 16;
+        minZoomLevels[GeoDataPlacemark::AccomodationGuestHouse] = 16;
+
+        minZoomLevels[GeoDataPlacemark::InternationalDateLine]      = 1;
+
+        minZoomLevels[GeoDataPlacemark::Landmass]    = 0;
+
+        minZoomLevels[GeoDataPlacemark::LanduseAllotments]   = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseBasin] = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseCemetery]     = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseCommercial]   = 13;
+        minZoomLevels[GeoDataPlacemark::LanduseConstruction] = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseFarmland]     = 13;
+        minZoomLevels[GeoDataPlacemark::LanduseFarmyard]     = 13;
+        minZoomLevels[GeoDataPlacemark::LanduseGarages]      = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseGrass] = 13;
+        minZoomLevels[GeoDataPlacemark::LanduseIndustrial]   = 13;
+        minZoomLevels[GeoDataPlacemark::LanduseLandfill]     = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseMeadow]       = 13;
+        minZoomLevels[GeoDataPlacemark::LanduseMilitary]     = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseOrchard]      = 14;
+        minZoomLevels[GeoDataPlacemark::LanduseQuarry]       = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseRailway]      = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseReservoir]    = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseResidential]  = 11;
+        minZoomLevels[GeoDataPlacemark::LanduseRetail]       = 13;
+        minZoomLevels[GeoDataPlacemark::LanduseVineyard]     = 14;
+
+        minZoomLevels[GeoDataPlacemark::LeisureGolfCourse]   = 15;
+        minZoomLevels[GeoDataPlacemark::LeisureMarina]       = 13;
+        minZoomLevels[GeoDataPlacemark::LeisurePark] = 11;
+        minZoomLevels[GeoDataPlacemark::LeisurePlayground]   = 17;
+        minZoomLevels[GeoDataPlacemark::LeisurePitch]   = 15;
+        minZoomLevels[GeoDataPlacemark::LeisureStadium]   = 13;
+        minZoomLevels[GeoDataPlacemark::LeisureSwimmingPool]   = 17;
+        minZoomLevels[GeoDataPlacemark::LeisureSportsCentre]   = 15;
+        minZoomLevels[GeoDataPlacemark::LeisureTrack]   = 16;
+        minZoomLevels[GeoDataPlacemark::LeisureMinigolfCourse] = 16;
+
+        minZoomLevels[GeoDataPlacemark::ManmadeBridge]       = 15;
+        minZoomLevels[GeoDataPlacemark::ManmadeLighthouse]       = 15;
+        minZoomLevels[GeoDataPlacemark::ManmadePier]       = 15;
+        minZoomLevels[GeoDataPlacemark::ManmadeWaterTower]       = 15;
+        minZoomLevels[GeoDataPlacemark::ManmadeWindMill]       = 15;
+        minZoomLevels[GeoDataPlacemark::ManmadeCommunicationsTower]       = 15;
+
+        minZoomLevels[GeoDataPlacemark::MilitaryDangerArea]  = 11;
+
+        minZoomLevels[GeoDataPlacemark::MoneyAtm]    = 16;
+        minZoomLevels[GeoDataPlacemark::MoneyBank]    = 16;
+
+        minZoomLevels[GeoDataPlacemark::NaturalBeach] = 13;
+        minZoomLevels[GeoDataPlacemark::NaturalCliff] = 15;
+        minZoomLevels[GeoDataPlacemark::NaturalGlacier]      = 3;
+        minZoomLevels[GeoDataPlacemark::NaturalHeath]      = 13;
+        minZoomLevels[GeoDataPlacemark::NaturalIceShelf]     = 3;
+        minZoomLevels[GeoDataPlacemark::NaturalVolcano]      = 13;
+        minZoomLevels[GeoDataPlacemark::NaturalPeak] = 11;
+        minZoomLevels[GeoDataPlacemark::NaturalReef] = 3;
+        minZoomLevels[GeoDataPlacemark::NaturalScrub] = 13;
+        minZoomLevels[GeoDataPlacemark::NaturalTree] = 17;
+        minZoomLevels[GeoDataPlacemark::NaturalCave] = 16;
+        minZoomLevels[GeoDataPlacemark::NaturalWater] = 3;
+        minZoomLevels[GeoDataPlacemark::NaturalWetland]      = 10;
+        minZoomLevels[GeoDataPlacemark::NaturalWood] = 8;
+
+        minZoomLevels[GeoDataPlacemark::PlaceCityNationalCapital] = 9;
+        minZoomLevels[GeoDataPlacemark::PlaceCityCapital]    = 9;
+        minZoomLevels[GeoDataPlacemark::PlaceCity]   = 9;
+        minZoomLevels[GeoDataPlacemark::PlaceHamlet] = 15;
+        minZoomLevels[GeoDataPlacemark::PlaceLocality]       = 15;
+        minZoomLevels[GeoDataPlacemark::PlaceSuburb] = 13;
+        minZoomLevels[GeoDataPlacemark::PlaceTownNationalCapital] = 11;
+        minZoomLevels[GeoDataPlacemark::PlaceTownCapital]    = 11;
+        minZoomLevels[GeoDataPlacemark::PlaceTown]   = 11;
+        minZoomLevels[GeoDataPlacemark::PlaceVillageNationalCapital] = 13;
+        minZoomLevels[GeoDataPlacemark::PlaceVillageCapital] = 13;
+        minZoomLevels[GeoDataPlacemark::PlaceVillage] = 13;
+
+        minZoomLevels[GeoDataPlacemark::PowerTower] = 18;
+
+        minZoomLevels[GeoDataPlacemark::RailwayAbandoned]    = 10;
+        minZoomLevels[GeoDataPlacemark::RailwayConstruction] = 10;
+        minZoomLevels[GeoDataPlacemark::RailwayFunicular]    = 13;
+        minZoomLevels[GeoDataPlacemark::RailwayLightRail]    = 12;
+        minZoomLevels[GeoDataPlacemark::RailwayMiniature]    = 16;
+        minZoomLevels[GeoDataPlacemark::RailwayMonorail]     = 12;
+        minZoomLevels[GeoDataPlacemark::RailwayNarrowGauge]  = 6;
+        minZoomLevels[GeoDataPlacemark::RailwayPreserved]    = 13;
+        minZoomLevels[GeoDataPlacemark::RailwayRail] = 6;
+        minZoomLevels[GeoDataPlacemark::RailwaySubway]       = 13;
+        minZoomLevels[GeoDataPlacemark::RailwayTram] = 14;
+
+        minZoomLevels[GeoDataPlacemark::Satellite]   = 0;
+
+        for (int shop = GeoDataPlacemark::ShopBeverages; shop <= GeoDataPlacemark::Shop; ++shop) {
+            minZoomLevels[shop] = 17;
+        }
+        minZoomLevels[GeoDataPlacemark::ShopSupermarket] = 16;
+        minZoomLevels[GeoDataPlacemark::ShopDepartmentStore] = 16;
+        minZoomLevels[GeoDataPlacemark::ShopDoitYourself] = 16;
+
+        minZoomLevels[GeoDataPlacemark::TourismAlpineHut]  = 13;
+        minZoomLevels[GeoDataPlacemark::TourismWildernessHut] = 13;
+        minZoomLevels[GeoDataPlacemark::TourismAttraction]  = 17;
+        minZoomLevels[GeoDataPlacemark::TourismArtwork] = 17;
+        minZoomLevels[GeoDataPlacemark::HistoricCastle]  = 15;
+        minZoomLevels[GeoDataPlacemark::AmenityCinema]  = 16;
+        minZoomLevels[GeoDataPlacemark::TourismMuseum]  = 16;
+        minZoomLevels[GeoDataPlacemark::HistoricRuins]  = 16;
+        minZoomLevels[GeoDataPlacemark::AmenityTheatre]  = 16;
+        minZoomLevels[GeoDataPlacemark::TourismThemePark]  = 15;
+        minZoomLevels[GeoDataPlacemark::TourismViewPoint]  = 15;
+        minZoomLevels[GeoDataPlacemark::TourismZoo]  = 15;
+        minZoomLevels[GeoDataPlacemark::HistoricMonument]  = 16;
+        minZoomLevels[GeoDataPlacemark::TourismInformation]  = 17;
+        minZoomLevels[GeoDataPlacemark::TransportAerodrome] = 9;
+        minZoomLevels[GeoDataPlacemark::TransportAirportApron] = 15;
+        minZoomLevels[GeoDataPlacemark::TransportAirportRunway] = 15;
+        minZoomLevels[GeoDataPlacemark::TransportAirportTaxiway] = 15;
+        minZoomLevels[GeoDataPlacemark::TransportBusStation]  = 15;
+        minZoomLevels[GeoDataPlacemark::TransportCarShare]  = 16;
+        minZoomLevels[GeoDataPlacemark::TransportFuel]  = 16;
+        minZoomLevels[GeoDataPlacemark::TransportHelipad] = 16;
+        minZoomLevels[GeoDataPlacemark::TransportAirportTerminal] = 17;
+        minZoomLevels[GeoDataPlacemark::TransportAirportGate] = 17;
+        minZoomLevels[GeoDataPlacemark::TransportPlatform]   = 16;
+        minZoomLevels[GeoDataPlacemark::TransportSpeedCamera] = 16;
+        minZoomLevels[GeoDataPlacemark::TransportRentalCar] = 16;
+        minZoomLevels[GeoDataPlacemark::TransportRentalBicycle] = 17;
+        minZoomLevels[GeoDataPlacemark::TransportRentalSki] = 17;
+        minZoomLevels[GeoDataPlacemark::TransportTaxiRank]  = 16;
+        minZoomLevels[GeoDataPlacemark::TransportParking]  = 16;
+        minZoomLevels[GeoDataPlacemark::TransportBusStop]  = 16;
+        minZoomLevels[GeoDataPlacemark::TransportTrainStation]  = 13;
+        minZoomLevels[GeoDataPlacemark::TransportTramStop]  = 15;
+        minZoomLevels[GeoDataPlacemark::TransportParkingSpace]  = 17;
+        minZoomLevels[GeoDataPlacemark::TransportBicycleParking]  = 17;
+        minZoomLevels[GeoDataPlacemark::TransportMotorcycleParking]  = 17;
+        minZoomLevels[GeoDataPlacemark::TransportSubwayEntrance]  = 17;
+
+        for (int religion = GeoDataPlacemark::ReligionPlaceOfWorship; religion <= GeoDataPlacemark::ReligionTaoist; ++religion) {
+            minZoomLevels[religion] = 17;
+        }
 
-    s_defaultMinZoomLevels[GeoDataPlacemark::UrbanArea]   = 3;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::WaterwayCanal] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::WaterwayDitch] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::WaterwayDrain] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::WaterwayStream] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::WaterwayRiver] = 3;
-    s_defaultMinZoomLevels[GeoDataPlacemark::WaterwayWeir] = 17;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::CrossingIsland] = 18;
-    s_defaultMinZoomLevels[GeoDataPlacemark::CrossingRailway] = 18;
-    s_defaultMinZoomLevels[GeoDataPlacemark::CrossingSignals] = 18;
-    s_defaultMinZoomLevels[GeoDataPlacemark::CrossingZebra] = 18;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteDownhill] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteNordic] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteSkitour] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteSled] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteHike] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteSleigh] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteIceSkate] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteSnowPark] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PistePlayground] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::PisteSkiJump] = 15;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayStation] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayPylon] = 16;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayCableCar] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayGondola] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayChairLift] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayMixedLift] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayDragLift] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayTBar] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayJBar] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayPlatter] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayRopeTow] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayMagicCarpet] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayZipLine] = 15;
-    s_defaultMinZoomLevels[GeoDataPlacemark::AerialwayGoods] = 15;
-
-    s_defaultMinZoomLevels[GeoDataPlacemark::IndoorDoor] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::IndoorWall] = 17;
-    s_defaultMinZoomLevels[GeoDataPlacemark::IndoorRoom] = 17;
-
-    for (int i = GeoDataPlacemark::PlaceCity; i < GeoDataPlacemark::LastIndex; i++) {
-        if (s_defaultMinZoomLevels[i] < 0) {
-            qDebug() << "Missing default min zoom level for GeoDataPlacemark::GeoDataVisualCategory " << i;
-            Q_ASSERT(false && "StyleBuilder::Private::initializeMinimumZoomLevels is incomplete");
-            s_defaultMinZoomLevels[i] = 15;
+        minZoomLevels[GeoDataPlacemark::UrbanArea]   = 3;
+
+        minZoomLevels[GeoDataPlacemark::WaterwayCanal] = 15;
+        minZoomLevels[GeoDataPlacemark::WaterwayDitch] = 17;
+        minZoomLevels[GeoDataPlacemark::WaterwayDrain] = 17;
+        minZoomLevels[GeoDataPlacemark::WaterwayStream] = 15;
+        minZoomLevels[GeoDataPlacemark::WaterwayRiver] = 3;
+        minZoomLevels[GeoDataPlacemark::WaterwayWeir] = 17;
+
+        minZoomLevels[GeoDataPlacemark::CrossingIsland] = 18;
+        minZoomLevels[GeoDataPlacemark::CrossingRailway] = 18;
+        minZoomLevels[GeoDataPlacemark::CrossingSignals] = 18;
+        minZoomLevels[GeoDataPlacemark::CrossingZebra] = 18;
+
+        minZoomLevels[GeoDataPlacemark::PisteDownhill] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteNordic] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteSkitour] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteSled] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteHike] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteSleigh] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteIceSkate] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteSnowPark] = 15;
+        minZoomLevels[GeoDataPlacemark::PistePlayground] = 15;
+        minZoomLevels[GeoDataPlacemark::PisteSkiJump] = 15;
+
+        minZoomLevels[GeoDataPlacemark::AerialwayStation] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayPylon] = 16;
+        minZoomLevels[GeoDataPlacemark::AerialwayCableCar] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayGondola] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayChairLift] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayMixedLift] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayDragLift] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayTBar] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayJBar] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayPlatter] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayRopeTow] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayMagicCarpet] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayZipLine] = 15;
+        minZoomLevels[GeoDataPlacemark::AerialwayGoods] = 15;
+
+        minZoomLevels[GeoDataPlacemark::IndoorDoor] = 17;
+        minZoomLevels[GeoDataPlacemark::IndoorWall] = 17;
+        minZoomLevels[GeoDataPlacemark::IndoorRoom] = 17;
+
+        for (int i = GeoDataPlacemark::PlaceCity; i < GeoDataPlacemark::LastIndex; i++) {
+            if (minZoomLevels[i] < 0) {
+                qDebug() << "Missing default min zoom level for GeoDataPlacemark::GeoDataVisualCategory " << i;
+                Q_ASSERT(false && "StyleBuilder::Private::defaultMinZoomLevels is incomplete");
+                minZoomLevels[i] = 15;
+            }
         }
-    }
 
+        return minZoomLevels;
+    }();
+
+    return table;
 }
 
 StyleBuilder::StyleBuilder() :
@@ -2101,144 +2094,158 @@ GeoDataStyle::ConstPtr StyleBuilder::Private::presetStyle(GeoDataPlacemark::GeoD
 
 QStringList StyleBuilder::renderOrder() const
 {
-    static QStringList paintLayerOrder;
-
-    if (paintLayerOrder.isEmpty()) {
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::Landmass);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::UrbanArea);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseResidential);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseAllotments);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseBasin);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseCemetery);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseCommercial);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseConstruction);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseFarmland);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseFarmyard);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseGarages);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseIndustrial);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseLandfill);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseMeadow);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseMilitary);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseQuarry);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseRailway);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseReservoir);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseRetail);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseOrchard);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseVineyard);
-
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::Bathymetry);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureGolfCourse);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureMinigolfCourse);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalBeach);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalWetland);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalGlacier);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalIceShelf);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalVolcano);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalCliff);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalPeak);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::MilitaryDangerArea);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisurePark);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisurePitch);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureSportsCentre);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureStadium);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalWood);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseGrass);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::HighwayPedestrian);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisurePlayground);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalScrub);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureTrack);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportParking);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportParkingSpace);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::ManmadeBridge);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::BarrierCityWall);
-
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::AmenityGraveyard);
-
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::AmenityKindergarten);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::EducationCollege);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::EducationSchool);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::EducationUniversity);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::HealthHospital);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureSwimmingPool);
-
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::Landmass);
-
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalWater);
+    static const QStringList paintLayerOrder = [] {
+        QStringList result;
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::Landmass);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::UrbanArea);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseResidential);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseAllotments);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseBasin);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseCemetery);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseCommercial);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseConstruction);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseFarmland);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseFarmyard);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseGarages);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseIndustrial);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseLandfill);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseMeadow);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseMilitary);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseQuarry);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseRailway);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseReservoir);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseRetail);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseOrchard);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseVineyard);
+
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::Bathymetry);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureGolfCourse);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureMinigolfCourse);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalBeach);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalWetland);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalGlacier);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalIceShelf);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalVolcano);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalCliff);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalPeak);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::MilitaryDangerArea);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisurePark);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisurePitch);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureSportsCentre);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureStadium);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalWood);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LanduseGrass);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::HighwayPedestrian);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisurePlayground);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalScrub);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureTrack);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportParking);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportParkingSpace);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::ManmadeBridge);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::BarrierCityWall);
+
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::AmenityGraveyard);
+
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::AmenityKindergarten);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::EducationCollege);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::EducationSchool);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::EducationUniversity);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::HealthHospital);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureSwimmingPool);
+
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::Landmass);
+
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::NaturalWater);
         for (int i = GeoDataPlacemark::WaterwayCanal; i <= GeoDataPlacemark::WaterwayStream; ++i) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
         }
 
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::NaturalReef, "outline");
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::NaturalReef, "inline");
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::NaturalReef, "label");
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureMarina);
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::ManmadePier);
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::ManmadePier, "outline");
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::ManmadePier, "inline");
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::ManmadePier, "label");
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::NaturalReef, "outline");
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::NaturalReef, "inline");
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::NaturalReef, "label");
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::LeisureMarina);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::ManmadePier);
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::ManmadePier, "outline");
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::ManmadePier, "inline");
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::ManmadePier, "label");
 
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportAirportApron);
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportAirportApron);
 
         for (int i = GeoDataPlacemark::HighwaySteps; i <= GeoDataPlacemark::HighwayMotorway; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
         }
         for (int i = GeoDataPlacemark::HighwaySteps; i <= GeoDataPlacemark::HighwayMotorway; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
         }
         for (int i = GeoDataPlacemark::RailwayRail; i <= GeoDataPlacemark::RailwayFunicular; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
         }
         for (int i = GeoDataPlacemark::RailwayRail; i <= GeoDataPlacemark::RailwayFunicular; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
         }
         // Highway labels shall appear on top of railways, hence here and not already above
         for (int i = GeoDataPlacemark::HighwaySteps; i <= GeoDataPlacemark::HighwayMotorway; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
         }
         for (int i = GeoDataPlacemark::RailwayRail; i <= GeoDataPlacemark::RailwayFunicular; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
         }
 
-        paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportPlatform);
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::TransportPlatform, "outline");
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::TransportPlatform, "inline");
-        paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::TransportPlatform, "label");
+        result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::TransportPlatform);
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::TransportPlatform, "outline");
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::TransportPlatform, "inline");
+        result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::TransportPlatform, "label");
 
         for (int i = GeoDataPlacemark::PisteDownhill; i <= GeoDataPlacemark::PisteSkiJump; ++i) {
-            paintLayerOrder << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::GeoDataVisualCategory(i));
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
+            result << Private::createPaintLayerItem("Polygon", GeoDataPlacemark::GeoDataVisualCategory(i));
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
         }
         for (int i = GeoDataPlacemark::AerialwayCableCar; i <= GeoDataPlacemark::AerialwayGoods; ++i) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
         }
 
         for (int i = GeoDataPlacemark::AdminLevel1; i <= GeoDataPlacemark::AdminLevel11; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "outline");
         }
         for (int i = GeoDataPlacemark::AdminLevel1; i <= GeoDataPlacemark::AdminLevel11; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "inline");
         }
         for (int i = GeoDataPlacemark::AdminLevel1; i <= GeoDataPlacemark::AdminLevel11; i++) {
-            paintLayerOrder << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
+            result << Private::createPaintLayerItem("LineString", GeoDataPlacemark::GeoDataVisualCategory(i), "label");
         }
 
-        paintLayerOrder << QStringLiteral("Polygon/Building/frame");
-        paintLayerOrder << QStringLiteral("Polygon/Building/roof");
+        result << QStringLiteral("Polygon/Building/frame");
+        result << QStringLiteral("Polygon/Building/roof");
 
-        paintLayerOrder << QStringLiteral("Photo");
+        result << QStringLiteral("Photo");
 
-        Q_ASSERT(QSet<QString>::fromList(paintLayerOrder).size() == paintLayerOrder.size());
-    }
+        Q_ASSERT(QSet<QString>::fromList(result).size() == result.size());
+        return result;
+    }();
 
     return paintLayerOrder;
 }
 
+int StyleBuilder::paintLayerId(const QString &paintLayer) const
+{
+    static const QHash<QString, int> paintLayerIds = [this] {
+        QHash<QString, int> result;
+        QStringList const paintLayerOrder = renderOrder();
+        for (int i = paintLayerOrder.size() - 1; i >= 0; --i) {
+            result.insert(paintLayerOrder[i], i);
+        }
+        return result;
+    }();
+
+    return paintLayerIds.value(paintLayer, -1);
+}
+
 void StyleBuilder::reset()
 {
     d->m_defaultStyleInitialized = false;
@@ -2246,21 +2253,19 @@ void StyleBuilder::reset()
 
 int StyleBuilder::minimumZoomLevel(const GeoDataPlacemark &placemark) const
 {
-    Q_ASSERT(Private::s_defaultMinZoomLevelsInitialized);
-    return Private::s_defaultMinZoomLevels[placemark.visualCategory()];
+    return Private::defaultMinZoomLevels()[placemark.visualCategory()];
 }
 
 int StyleBuilder::minimumZoomLevel(const GeoDataPlacemark::GeoDataVisualCategory &visualCategory)
 {
-    Private::initializeMinimumZoomLevels();
-    return Private::s_defaultMinZoomLevels[visualCategory];
+    return Private::defaultMinZoomLevels()[visualCategory];
 }
 
-qint64 StyleBuilder::popularity(const GeoDataPlacemark *placemark)
+const QHash<GeoDataPlacemark::GeoDataVisualCategory, qint64> &StyleBuilder::Private::popularities()
 {
-    qint64 const defaultValue = 100;
-    int const offset = 10;
-    if (StyleBuilder::Private::s_popularities.isEmpty()) {
+    static const QHash<GeoDataPlacemark::GeoDataVisualCategory, qint64> table = [] {
+        QHash<GeoDataPlacemark::GeoDataVisualCategory, qint64> result;
+
         QVector<GeoDataPlacemark::GeoDataVisualCategory> popularities;
         popularities << GeoDataPlacemark::PlaceCityNationalCapital;
         popularities << GeoDataPlacemark::PlaceTownNationalCapital;
@@ -2459,16 +2464,26 @@ qint64 StyleBuilder::popularity(const GeoDataPlacemark *placemark)
         popularities << GeoDataPlacemark::AerialwayPylon;
         popularities << GeoDataPlacemark::PowerTower;
 
-        int value = defaultValue + offset * popularities.size();
+        int value = s_popularityDefaultValue + s_popularityOffset * popularities.size();
         for (auto popularity : popularities) {
-            StyleBuilder::Private::s_popularities[popularity] = value;
-            value -= offset;
+            result[popularity] = value;
+            value -= s_popularityOffset;
         }
-    }
+        return result;
+    }();
+
+    return table;
+}
+
+qint64 StyleBuilder::popularity(const GeoDataPlacemark *placemark)
+{
+    qint64 const defaultValue = Private::s_popularityDefaultValue;
+    int const offset = Private::s_popularityOffset;
+    auto const &popularities = Private::popularities();
 
     bool const isPrivate = placemark->osmData().containsTag(QStringLiteral("access"), QStringLiteral("private"));
-    int const base = defaultValue + (isPrivate ? 0 : offset * StyleBuilder::Private::s_popularities.size());
-    return base + StyleBuilder::Private::s_popularities.value(placemark->visualCategory(), defaultValue);
+    int const base = defaultValue + (isPrivate ? 0 : offset * popularities.size());
+    return base + popularities.value(placemark->visualCategory(), defaultValue);
 }
 
 int StyleBuilder::maximumZoomLevel() const
@@ -2846,8 +2861,7 @@ QString StyleBuilder::visualCategoryName(GeoDataPlacemark::GeoDataVisualCategory
 
 QHash<StyleBuilder::OsmTag, GeoDataPlacemark::GeoDataVisualCategory> StyleBuilder::osmTagMapping()
 {
-    Private::initializeOsmVisualCategories();
-    return Private::s_visualCategories;
+    return Private::osmVisualCategories();
 }
 
 QStringList StyleBuilder::shopValues()
@@ -2997,12 +3011,12 @@ GeoDataPlacemark::GeoDataVisualCategory StyleBuilder::determineVisualCategory(co
         return GeoDataPlacemark::CrossingRailway;
     }
 
-    Private::initializeOsmVisualCategories();
+    auto const &visualCategories = Private::osmVisualCategories();
 
     auto const pisteType = osmData.tagValue(QStringLiteral("piste:type"));
     if (!pisteType.isEmpty()) {
         auto const tag = OsmTag(QStringLiteral("piste:type"), pisteType);
-        auto category = Private::s_visualCategories.value(tag, GeoDataPlacemark::None);
+        auto category = visualCategories.value(tag, GeoDataPlacemark::None);
         if (category != GeoDataPlacemark::None) {
             return category;
         }
@@ -3016,7 +3030,7 @@ GeoDataPlacemark::GeoDataVisualCategory StyleBuilder::determineVisualCategory(co
 
     for (auto iter = osmData.tagsBegin(), end = osmData.tagsEnd(); iter != end; ++iter) {
         const auto tag = OsmTag(iter.key(), iter.value());
-        GeoDataPlacemark::GeoDataVisualCategory category = Private::s_visualCategories.value(tag, GeoDataPlacemark::None);
+        GeoDataPlacemark::GeoDataVisualCategory category = visualCategories.value(tag, GeoDataPlacemark::None);
         if (category != GeoDataPlacemark::None) {
             if (category == GeoDataPlacemark::PlaceCity && osmData.containsTag(admin_level, national_level)) {
                 category = GeoDataPlacemark::PlaceCityNationalCapital;
@@ -61,6 +61,13 @@ public:
      */
     QStringList renderOrder() const;
 
+    /**
+     * @brief Returns the position of the given paint layer in renderOrder().
+     * Paint layers can be compared and used as indexes by this id instead of their name.
+     * @return position in renderOrder(), or -1 if the paint layer is not part of it
+     */
+    int paintLayerId(const QString &paintLayer) const;
+
     void reset();
 
     /**
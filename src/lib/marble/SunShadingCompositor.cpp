@@ -0,0 +1,203 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "SunShadingCompositor.h"
+
+#include "GeoDataCoordinates.h"
+#include "GeoPainter.h"
+#include "MarbleMath.h"
+#include "SunLocator.h"
+#include "ViewportParams.h"
+
+#include <qmath.h>
+
+namespace Marble
+{
+
+// Size of the equirectangular shade map. The twilight zone is several
+// degrees wide, so half a degree per sample is plenty with interpolation.
+static const int shadeMapWidth = 720;
+static const int shadeMapHeight = 360;
+
+// Distance in pixels between the screen samples of the overlay
+static const int overlayStep = 8;
+
+SunShadingCompositor::SunShadingCompositor( const SunLocator *sunLocator ) :
+    m_sunLocator( sunLocator ),
+    m_sunLon( 0.0 ),
+    m_sunLat( 0.0 ),
+    m_shadeMapValid( false ),
+    m_overlayValid( false ),
+    m_projection( Spherical ),
+    m_radius( 0 ),
+    m_centerLon( 0.0 ),
+    m_centerLat( 0.0 ),
+    m_heading( 0.0 )
+{
+}
+
+void SunShadingCompositor::paint( GeoPainter *painter, const ViewportParams *viewport )
+{
+    update( viewport );
+
+    painter->save();
+    painter->setRenderHint( QPainter::SmoothPixmapTransform, true );
+    // SunLocator::shadePixel() scales the color down to 35% at night
+    painter->setOpacity( 0.65 );
+    painter->drawImage( overlayTarget(), m_overlay );
+    painter->restore();
+}
+
+void SunShadingCompositor::paintNightImage( GeoPainter *painter, const ViewportParams *viewport, QImage *nightImage )
+{
+    update( viewport );
+
+    // keep the night texture where it is dark, weighted like SunLocator::shadePixelComposite()
+    QPainter maskPainter( nightImage );
+    maskPainter.setRenderHint( QPainter::SmoothPixmapTransform, true );
+    maskPainter.setCompositionMode( QPainter::CompositionMode_DestinationIn );
+    maskPainter.drawImage( overlayTarget(), m_overlay );
+    maskPainter.end();
+
+    painter->drawImage( QPointF( 0, 0 ), *nightImage );
+}
+
+void SunShadingCompositor::update( const ViewportParams *viewport )
+{
+    if ( !m_shadeMapValid || m_sunLon != m_sunLocator->getLon() || m_sunLat != m_sunLocator->getLat() ) {
+        updateShadeMap();
+    }
+
+    if ( !m_overlayValid
+         || m_projection != viewport->projection()
+         || m_size != viewport->size()
+         || m_radius != viewport->radius()
+         || m_centerLon != viewport->centerLongitude()
+         || m_centerLat != viewport->centerLatitude()
+         || m_heading != viewport->heading() ) {
+        updateOverlay( viewport );
+    }
+}
+
+QRectF SunShadingCompositor::overlayTarget() const
+{
+    // Sample (i, j) of the overlay belongs to the screen position (i, j) * overlayStep
+    return QRectF( -0.5 * overlayStep, -0.5 * overlayStep,
+                   m_overlay.width() * overlayStep, m_overlay.height() * overlayStep );
+}
+
+void SunShadingCompositor::updateShadeMap()
+{
+    m_sunLon = m_sunLocator->getLon();
+    m_sunLat = m_sunLocator->getLat();
+
+    const qreal sunLat = DEG2RAD * m_sunLat;
+    m_shadeMap.resize( shadeMapWidth * shadeMapHeight );
+
+    for ( int y = 0; y < shadeMapHeight; ++y ) {
+        const qreal lat = 0.5 * M_PI - ( y + 0.5 ) * M_PI / shadeMapHeight;
+        // haversine terms which only depend on the latitude, see SunLocator::shading()
+        const qreal a = sin( ( lat - sunLat ) / 2.0 );
+        const qreal c = cos( lat ) * cos( sunLat );
+
+        uchar *row = m_shadeMap.data() + y * shadeMapWidth;
+        for ( int x = 0; x < shadeMapWidth; ++x ) {
+            const qreal lon = ( x + 0.5 ) * 2 * M_PI / shadeMapWidth - M_PI;
+            const qreal brightness = m_sunLocator->shading( lon, a, c );
+            row[x] = qRound( 255 * ( 1.0 - brightness ) );
+        }
+    }
+
+    m_shadeMapValid = true;
+    m_overlayValid = false;
+}
+
+int SunShadingCompositor::shadeAt( qreal lon, qreal lat ) const
+{
+    // bilinear interpolation between the sample centers, wrapping around the date line
+    const qreal x = ( lon + M_PI ) * shadeMapWidth / ( 2 * M_PI ) - 0.5;
+    const qreal y = qBound<qreal>( 0.0, ( 0.5 * M_PI - lat ) * shadeMapHeight / M_PI - 0.5, shadeMapHeight - 1 );
+
+    const int x0 = qFloor( x );
+    const int y0 = qFloor( y );
+    const qreal fx = x - x0;
+    const qreal fy = y - y0;
+
+    const int left = ( x0 % shadeMapWidth + shadeMapWidth ) % shadeMapWidth;
+    const int right = ( left + 1 ) % shadeMapWidth;
+    const int top = y0;
+    const int bottom = qMin( y0 + 1, shadeMapHeight - 1 );
+
+    const uchar *topRow = m_shadeMap.constData() + top * shadeMapWidth;
+    const uchar *bottomRow = m_shadeMap.constData() + bottom * shadeMapWidth;
+
+    const qreal upper = ( 1.0 - fx ) * topRow[left] + fx * topRow[right];
+    const qreal lower = ( 1.0 - fx ) * bottomRow[left] + fx * bottomRow[right];
+    return qRound( ( 1.0 - fy ) * upper + fy * lower );
+}
+
+void SunShadingCompositor::updateOverlay( const ViewportParams *viewport )
+{
+    const int columns = viewport->width() / overlayStep + 2;
+    const int rows = viewport->height() / overlayStep + 2;
+
+    if ( m_overlay.width() != columns || m_overlay.height() != rows ) {
+        m_overlay = QImage( columns, rows, QImage::Format_ARGB32_Premultiplied );
+    }
+
+    QVector<bool> onPlanet( columns * rows );
+    for ( int j = 0; j < rows; ++j ) {
+        QRgb *scanLine = reinterpret_cast<QRgb*>( m_overlay.scanLine( j ) );
+        for ( int i = 0; i < columns; ++i ) {
+            qreal lon;
+            qreal lat;
+            onPlanet[j * columns + i] = viewport->geoCoordinates( i * overlayStep, j * overlayStep,
+                                                                  lon, lat, GeoDataCoordinates::Radian );
+            // black with the darkness as opacity, premultiplied
+            scanLine[i] = onPlanet[j * columns + i] ? qRgba( 0, 0, 0, shadeAt( lon, lat ) ) : qRgba( 0, 0, 0, 0 );
+        }
+    }
+
+    // The overlay is stretched with interpolation, so samples off the planet
+    // next to the limb take the mean shade of their neighbors on the planet.
+    // Otherwise their zero opacity would lighten the night side along the limb.
+    for ( int j = 0; j < rows; ++j ) {
+        QRgb *scanLine = reinterpret_cast<QRgb*>( m_overlay.scanLine( j ) );
+        for ( int i = 0; i < columns; ++i ) {
+            if ( onPlanet[j * columns + i] ) {
+                continue;
+            }
+
+            int shade = 0;
+            int count = 0;
+            for ( int y = qMax( j - 1, 0 ); y <= qMin( j + 1, rows - 1 ); ++y ) {
+                const QRgb *neighbors = reinterpret_cast<const QRgb*>( m_overlay.constScanLine( y ) );
+                for ( int x = qMax( i - 1, 0 ); x <= qMin( i + 1, columns - 1 ); ++x ) {
+                    if ( onPlanet[y * columns + x] ) {
+                        shade += qAlpha( neighbors[x] );
+                        ++count;
+                    }
+                }
+            }
+
+            if ( count > 0 ) {
+                scanLine[i] = qRgba( 0, 0, 0, shade / count );
+            }
+        }
+    }
+
+    m_overlayValid = true;
+    m_projection = viewport->projection();
+    m_size = viewport->size();
+    m_radius = viewport->radius();
+    m_centerLon = viewport->centerLongitude();
+    m_centerLat = viewport->centerLatitude();
+    m_heading = viewport->heading();
+}
+
+}
@@ -0,0 +1,87 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_SUNSHADINGCOMPOSITOR_H
+#define MARBLE_SUNSHADINGCOMPOSITOR_H
+
+#include "MarbleGlobal.h"
+
+#include <QImage>
+#include <QSize>
+#include <QVector>
+
+namespace Marble
+{
+
+class GeoPainter;
+class SunLocator;
+class ViewportParams;
+
+/**
+ * @short Darkens the night side of the rendered map.
+ *
+ * Instead of shading each texture tile as it is created, the night side is
+ * darkened after the map has been painted. The brightness of the whole planet
+ * is kept in a low resolution equirectangular shade map, which is recomputed
+ * only when the sun moved. For each view, the shade map is sampled on a coarse
+ * screen grid, and the resulting overlay is painted smoothly scaled across the
+ * map.
+ *
+ * The same overlay serves as the mask of the night texture (the city lights),
+ * which is blended in with the weights of SunLocator::shadePixelComposite().
+ *
+ * The result matches SunLocator::shadePixel(), so tiles can stay in the cache
+ * when the time changes.
+ */
+class SunShadingCompositor
+{
+public:
+    explicit SunShadingCompositor( const SunLocator *sunLocator );
+
+    /**
+     * Paints the shading of the current sun position over the map shown in @p viewport.
+     */
+    void paint( GeoPainter *painter, const ViewportParams *viewport );
+
+    /**
+     * Paints @p nightImage, the night texture mapped to @p viewport, over the
+     * night side of the map. The image is masked in place.
+     */
+    void paintNightImage( GeoPainter *painter, const ViewportParams *viewport, QImage *nightImage );
+
+private:
+    Q_DISABLE_COPY( SunShadingCompositor )
+
+    void update( const ViewportParams *viewport );
+    void updateShadeMap();
+    void updateOverlay( const ViewportParams *viewport );
+    QRectF overlayTarget() const;
+    int shadeAt( qreal lon, qreal lat ) const;
+
+    const SunLocator *const m_sunLocator;
+
+    // darkness in the range 0 (day) to 255 (night) per sample, rows from north to south
+    QVector<uchar> m_shadeMap;
+    qreal m_sunLon;
+    qreal m_sunLat;
+    bool m_shadeMapValid;
+
+    QImage m_overlay;
+    bool m_overlayValid;
+    // the view m_overlay was computed for
+    Projection m_projection;
+    QSize m_size;
+    int m_radius;
+    qreal m_centerLon;
+    qreal m_centerLat;
+    qreal m_heading;
+};
+
+}
+
+#endif
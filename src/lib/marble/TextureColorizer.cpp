@@ -22,6 +22,9 @@
 #include <QColor>
 #include <QImage>
 #include <QPainter>
+#include <QRegion>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include "MarbleGlobal.h"
 #include "GeoPainter.h"
@@ -35,6 +38,7 @@
 #include "GeoDataPlacemark.h"
 #include "GeoDataDocument.h"
 #include "AbstractProjection.h"
+#include "ScanlineRowScheduler.h"
 
 namespace Marble
 {
@@ -43,10 +47,15 @@ namespace Marble
 class EmbossFifo
 {
 public:
-    EmbossFifo()
-        : data( 0 )
+    explicit EmbossFifo( quint32 initialData = 0 )
+        : data( initialData )
     {}
 
+    inline quint32 state() const
+    {
+        return data;
+    }
+
     inline uchar head() const
     {
         // return least significant byte as head of queue
@@ -65,10 +74,49 @@ private:
     quint32 data;
 };
 
+class TextureColorizer::ColorizeJob : public QRunnable
+{
+public:
+    ColorizeJob( const TextureColorizer *colorizer, QImage *image, const QVector<quint32> &embossSeeds,
+                 ScanlineRowScheduler *scheduler )
+        : m_colorizer( colorizer ),
+          m_image( image ),
+          m_embossSeeds( embossSeeds ),
+          m_scheduler( scheduler )
+    {}
+
+    void run() override
+    {
+        ScanlineRowScheduler::Worker worker( m_scheduler );
+        int yStart = 0;
+        int yEnd = 0;
+
+        while ( worker.nextRows( yStart, yEnd ) ) {
+            const int block = ( yStart - m_colorizer->m_yTop ) / m_scheduler->rowsPerBlock();
+            m_colorizer->colorizeRows( m_image, yStart, yEnd, m_embossSeeds[block] );
+        }
+    }
+
+private:
+    const TextureColorizer *const m_colorizer;
+    QImage *const m_image;
+    const QVector<quint32> &m_embossSeeds;
+    ScanlineRowScheduler *const m_scheduler;
+};
+
 
 TextureColorizer::TextureColorizer( const QString &seafile,
                                     const QString &landfile )
-    : m_showRelief( false ),
+    : m_coastImageValid( false ),
+      m_coastProjection( Spherical ),
+      m_coastRadius( 0 ),
+      m_coastMapQuality( NormalQuality ),
+      m_coastHeading( 0.0 ),
+      m_coastCenterLon( 0.0 ),
+      m_coastCenterLat( 0.0 ),
+      m_yTop( 0 ),
+      m_embossAcrossRows( false ),
+      m_showRelief( false ),
       m_landColor(qRgb( 255, 0, 0 ) ),
       m_seaColor( qRgb( 0, 255, 0 ) )
 {
@@ -149,11 +197,13 @@ TextureColorizer::TextureColorizer( const QString &seafile,
 void TextureColorizer::addSeaDocument( const GeoDataDocument *seaDocument )
 {
     m_seaDocuments.append( seaDocument );
+    m_coastImageValid = false;
 }
 
 void TextureColorizer::addLandDocument( const GeoDataDocument *landDocument )
 {
     m_landDocuments.append( landDocument );
+    m_coastImageValid = false;
 }
 
 void TextureColorizer::setShowRelief( bool show )
@@ -218,21 +268,105 @@ void TextureColorizer::drawTextureMap( GeoPainter *painter )
     }
 }
 
-void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality )
+void TextureColorizer::updateCoastImage( const ViewportParams *viewport, MapQuality mapQuality )
 {
+    QVector<bool> documentsVisible;
+    for( const GeoDataDocument *doc: m_seaDocuments ) {
+        documentsVisible << doc->isVisible();
+    }
+
+    const bool sameScale =    m_coastImageValid
+                           && m_coastImage.size() == viewport->size()
+                           && m_coastProjection == viewport->projection()
+                           && m_coastRadius == viewport->radius()
+                           && m_coastMapQuality == mapQuality
+                           && m_coastHeading == viewport->heading()
+                           && m_coastDocumentsVisible == documentsVisible;
+
+    if ( sameScale
+         && m_coastShift.isNull()
+         && m_coastCenterLon == viewport->centerLongitude()
+         && m_coastCenterLat == viewport->centerLatitude() ) {
+        // e.g. only tiles got loaded
+        return;
+    }
+
+    const QRect imageRect( QPoint( 0, 0 ), viewport->size() );
+    QRegion exposed( imageRect );
+    bool shifted = false;
+
+    if ( sameScale && ( viewport->projection() == Equirectangular || viewport->projection() == Mercator ) ) {
+        // Panning merely translates the map in these projections, so keep
+        // what is still in view and render the exposed parts only. The offset
+        // is measured from the center the image was fully rendered for, which
+        // keeps rounding errors of the single shifts from adding up.
+        const GeoDataCoordinates renderedCenter( m_coastCenterLon, m_coastCenterLat );
+        qreal x;
+        qreal y;
+        bool globeHidesPoint;
+        viewport->currentProjection()->screenCoordinates( renderedCenter, viewport, x, y, globeHidesPoint );
+        const qreal dx = x - viewport->width() / 2.0;
+        const qreal dy = y - viewport->height() / 2.0;
+        const QPoint offset( qRound( dx ), qRound( dy ) );
+
+        // Shifting by fractions of a pixel would blur the anti-aliased coast lines
+        if ( qAbs( dx - offset.x() ) < 0.01 && qAbs( dy - offset.y() ) < 0.01
+             && qAbs( offset.x() ) < viewport->width() && qAbs( offset.y() ) < viewport->height() ) {
+            const QPoint shift = offset - m_coastShift;
+            if ( !shift.isNull() ) {
+                QImage shiftedImage( viewport->size(), QImage::Format_RGB32 );
+                QPainter shiftPainter( &shiftedImage );
+                shiftPainter.setCompositionMode( QPainter::CompositionMode_Source );
+                shiftPainter.drawImage( shift, m_coastImage );
+                shiftPainter.end();
+                m_coastImage = shiftedImage;
+            }
+
+            exposed -= imageRect.translated( shift );
+            m_coastShift = offset;
+            shifted = true;
+        }
+    }
+
     if ( m_coastImage.size() != viewport->size() )
         m_coastImage = QImage( viewport->size(), QImage::Format_RGB32 );
 
-    // update coast image
-    m_coastImage.fill( QColor( 0, 0, 255, 0).rgb() );
-
     const bool antialiased =    mapQuality == HighQuality
                              || mapQuality == PrintQuality;
 
-    GeoPainter painter( &m_coastImage, viewport, mapQuality );
-    painter.setRenderHint( QPainter::Antialiasing, antialiased );
+    if ( !exposed.isEmpty() ) {
+        const bool repaintAll = exposed == QRegion( imageRect );
+        if ( repaintAll ) {
+            m_coastImage.fill( QColor( 0, 0, 255, 0).rgb() );
+        }
 
-    drawTextureMap( &painter );
+        GeoPainter painter( &m_coastImage, viewport, mapQuality );
+        painter.setRenderHint( QPainter::Antialiasing, antialiased );
+
+        if ( !repaintAll ) {
+            painter.setClipRegion( exposed );
+            painter.fillRect( imageRect, QColor( 0, 0, 255 ) );
+        }
+
+        drawTextureMap( &painter );
+    }
+
+    m_coastImageValid = true;
+    m_coastProjection = viewport->projection();
+    m_coastRadius = viewport->radius();
+    m_coastMapQuality = mapQuality;
+    m_coastHeading = viewport->heading();
+    if ( !shifted ) {
+        m_coastCenterLon = viewport->centerLongitude();
+        m_coastCenterLat = viewport->centerLatitude();
+        m_coastShift = QPoint();
+    }
+    m_coastDocumentsVisible = documentsVisible;
+}
+
+void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality, QThreadPool *threadPool )
+{
+    updateCoastImage( viewport, mapQuality );
 
     const qint64 radius = viewport->radius() * viewport->currentProjection()->clippingRadius();
 
@@ -243,14 +377,13 @@ void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport
     // This variable is not used anywhere..
     const int  imgradius = imgrx * imgrx + imgry * imgry;
 
-    int     bump = 8;
+    int yTop = 0;
+    int yBottom = imgheight;
+    m_rowSpans.clear();
 
     if ( radius * radius > imgradius
          || !viewport->currentProjection()->isClippedToSphere() )
     {
-        int yTop = 0;
-        int yBottom = imgheight;
-
         if( !viewport->currentProjection()->isClippedToSphere() && !viewport->currentProjection()->traversablePoles() )
         {
             qreal realYTop, realYBottom, dummyX;
@@ -262,107 +395,143 @@ void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport
             yBottom = qBound(qreal(0.0), realYBottom, qreal(imgheight));
         }
 
-        const int itEnd = yBottom;
+        m_embossAcrossRows = false;
+        const RowSpan span = { 0, imgwidth };
+        m_rowSpans.fill( span, qMax( 0, yBottom - yTop ) );
+    }
+    else {
+        yTop    = ( imgry-radius < 0 ) ? 0 : imgry-radius;
+        yBottom = ( yTop == 0 ) ? imgheight : imgry + radius;
 
-        for (int y = yTop; y < itEnd; ++y) {
+        m_embossAcrossRows = true;
+        m_rowSpans.reserve( yBottom - yTop );
+        for ( int y = yTop; y < yBottom; ++y ) {
+            const int  dy = imgry - y;
+            int  rx = (int)sqrt( (qreal)( radius * radius - dy * dy ) );
+            RowSpan span = { 0, imgwidth };
 
-            QRgb  *writeData         = (QRgb*)( origimg->scanLine( y ) );
-            const QRgb  *coastData   = (QRgb*)( m_coastImage.scanLine( y ) );
+            if ( imgrx-rx > 0 ) {
+                span.xLeft  = imgrx - rx;
+                span.xRight = imgrx + rx;
+            }
+            m_rowSpans << span;
+        }
+    }
+    m_yTop = yTop;
 
-            uchar *readDataStart     = origimg->scanLine( y );
-            const uchar *readDataEnd = readDataStart + imgwidth*4;
+    // detach before the image is accessed from several threads
+    origimg->bits();
 
-            EmbossFifo  emboss;
+    const int threadCount = threadPool ? threadPool->maxThreadCount() : 1;
+    ScanlineRowScheduler scheduler( yTop, yBottom, threadCount );
 
-            for ( uchar* readData = readDataStart; 
-                  readData < readDataEnd;
-                  readData += 4, ++writeData, ++coastData )
-            {
+    // The emboss state at the start of each block of rows depends on the
+    // rows above, which get overwritten while colorizing
+    QVector<quint32> embossSeeds;
+    for ( int y = yTop; y < yBottom; y += scheduler.rowsPerBlock() ) {
+        embossSeeds << embossSeed( origimg, y );
+    }
 
-                // Cheap Emboss / Bumpmapping
-                uchar&  grey = *readData; // qBlue(*data);
+    if ( threadCount > 1 ) {
+        for ( int i = 0; i < threadCount; ++i ) {
+            threadPool->start( new ColorizeJob( this, origimg, embossSeeds, &scheduler ) );
+        }
+        threadPool->waitForDone();
+    } else {
+        ColorizeJob job( this, origimg, embossSeeds, &scheduler );
+        job.run();
+    }
+}
 
-                if ( m_showRelief ) {
-                    emboss.enqueue(grey);
-                    bump = ( emboss.head() + 8 - grey );
-                    if (bump < 0) {
-                        bump = 0;
-                    } else if (bump > 15) {
-                        bump = 15;
-                    }
-                }
-                setPixel( coastData, writeData, bump, grey );
-            }
+quint32 TextureColorizer::embossSeed( const QImage *origimg, int y ) const
+{
+    if ( !m_embossAcrossRows ) {
+        return 0;
+    }
+
+    // Collect the last four grey values enqueued before row y, which may
+    // span several rows near the poles of the globe
+    uchar greys[4];
+    int count = 0;
+    for ( int row = y - 1; row >= m_yTop && count < 4; --row ) {
+        const RowSpan &span = m_rowSpans[row - m_yTop];
+        const uchar *rowData = origimg->constScanLine( row );
+        for ( int x = span.xRight - 1; x >= span.xLeft && count < 4; --x ) {
+            greys[count++] = rowData[x * 4];
         }
     }
-    else {
-        int yTop    = ( imgry-radius < 0 ) ? 0 : imgry-radius;
-        const int yBottom = ( yTop == 0 ) ? imgheight : imgry + radius;
 
-        EmbossFifo  emboss;
+    EmbossFifo emboss;
+    for ( int i = count - 1; i >= 0; --i ) {
+        emboss.enqueue( greys[i] );
+    }
+    return emboss.state();
+}
+
+void TextureColorizer::colorizeRows( QImage *origimg, int yStart, int yEnd, quint32 embossSeed ) const
+{
+    // The bump is stronger on flat maps
+    const int bumpOffset = m_embossAcrossRows ? 16 : 8;
+    const int bumpShift  = m_embossAcrossRows ? 1 : 0;
 
-        for ( int y = yTop; y < yBottom; ++y ) {
-            const int  dy = imgry - y;
-            int  rx = (int)sqrt( (qreal)( radius * radius - dy * dy ) );
-            int  xLeft  = 0; 
-            int  xRight = imgwidth;
+    int     bump = 8;
 
-            if ( imgrx-rx > 0 ) {
-                xLeft  = imgrx - rx; 
-                xRight = imgrx + rx;
-            }
+    EmbossFifo  emboss( embossSeed );
+
+    for ( int y = yStart; y < yEnd; ++y ) {
+        const RowSpan &span = m_rowSpans[y - m_yTop];
 
-            QRgb  *writeData         = (QRgb*)( origimg->scanLine( y ) )  + xLeft;
-            const QRgb *coastData    = (QRgb*)( m_coastImage.scanLine( y ) ) + xLeft;
-
-            uchar *readDataStart     = origimg->scanLine( y ) + xLeft * 4;
-            const uchar *readDataEnd = origimg->scanLine( y ) + xRight * 4;
-
- 
-            for ( uchar* readData = readDataStart;
-                  readData < readDataEnd;
-                  readData += 4, ++writeData, ++coastData )
-            {
-                // Cheap Emboss / Bumpmapping
-
-                uchar& grey = *readData; // qBlue(*data);
-
-                if ( m_showRelief ) {
-                    emboss.enqueue(grey);
-                    bump = ( emboss.head() + 16 - grey ) >> 1;
-                    if (bump < 0) {
-                        bump = 0;
-                    } else if (bump > 15) {
-                        bump = 15;
-                    }
+        QRgb  *writeData         = (QRgb*)( origimg->scanLine( y ) )  + span.xLeft;
+        const QRgb *coastData    = (const QRgb*)( m_coastImage.constScanLine( y ) ) + span.xLeft;
+
+        uchar *readDataStart     = origimg->scanLine( y ) + span.xLeft * 4;
+        const uchar *readDataEnd = origimg->scanLine( y ) + span.xRight * 4;
+
+        if ( !m_embossAcrossRows ) {
+            emboss = EmbossFifo();
+        }
+
+        for ( uchar* readData = readDataStart;
+              readData < readDataEnd;
+              readData += 4, ++writeData, ++coastData )
+        {
+            // Cheap Emboss / Bumpmapping
+
+            uchar& grey = *readData; // qBlue(*data);
+
+            if ( m_showRelief ) {
+                emboss.enqueue(grey);
+                bump = ( emboss.head() + bumpOffset - grey ) >> bumpShift;
+                if (bump < 0) {
+                    bump = 0;
+                } else if (bump > 15) {
+                    bump = 15;
                 }
-                setPixel( coastData, writeData, bump, grey );
             }
+            setPixel( coastData, writeData, bump, grey );
         }
     }
 }
 
-void TextureColorizer::setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey )
+void TextureColorizer::setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey ) const
 {
+    const uint *palette = texturepalette[bump];
+
     int alpha = qRed( *coastData );
     if ( alpha == 255 )
-        *writeData = texturepalette[bump][grey + 0x100];
+        *writeData = palette[grey + 0x100];
     else if( alpha == 0 ){
-        *writeData = texturepalette[bump][grey];
+        *writeData = palette[grey];
     }
     else {
-        qreal c = 1.0 / 255.0;
-
-        QRgb landcolor  = (QRgb)(texturepalette[bump][grey + 0x100]);
-        QRgb watercolor = (QRgb)(texturepalette[bump][grey]);
+        QRgb landcolor  = (QRgb)(palette[grey + 0x100]);
+        QRgb watercolor = (QRgb)(palette[grey]);
 
+        // integer arithmetic, the compiler turns the division into a multiplication
         *writeData = qRgb(
-                    (int) ( c * ( alpha * qRed( landcolor )
-                                  + ( 255 - alpha ) * qRed( watercolor ) ) ),
-                    (int) ( c * ( alpha * qGreen( landcolor )
-                                  + ( 255 - alpha ) * qGreen( watercolor ) ) ),
-                    (int) ( c * ( alpha * qBlue( landcolor )
-                                  + ( 255 - alpha ) * qBlue( watercolor ) ) )
+                    ( alpha * qRed( landcolor ) + ( 255 - alpha ) * qRed( watercolor ) ) / 255,
+                    ( alpha * qGreen( landcolor ) + ( 255 - alpha ) * qGreen( watercolor ) ) / 255,
+                    ( alpha * qBlue( landcolor ) + ( 255 - alpha ) * qBlue( watercolor ) ) / 255
                     );
     }
 }
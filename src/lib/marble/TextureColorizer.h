@@ -22,11 +22,16 @@
 #include <QString>
 #include <QImage>
 #include <QColor>
+#include <QPointF>
+#include <QVector>
+
+class QThreadPool;
 
 namespace Marble
 {
 
 class GeoPainter;
+class ScanlineRowScheduler;
 class ViewportParams;
 
 class TextureColorizer
@@ -47,16 +52,58 @@ class TextureColorizer
 
     void drawTextureMap( GeoPainter *painter );
 
-    void colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality );
+    /**
+     * Colorizes the grey scale image @p origimg.
+     *
+     * If @p threadPool is given, blocks of rows are colorized by all threads
+     * of the pool. The pool must not have any other jobs running.
+     */
+    void colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality, QThreadPool *threadPool = nullptr );
 
-    void setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey );
+    void setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey ) const;
 
  private:
+    class ColorizeJob;
+
+    struct RowSpan
+    {
+        int xLeft;
+        int xRight;
+    };
+
+    /**
+     * Renders the land and sea documents into m_coastImage. The image of the
+     * previous call is reused if the view did not change and shifted if the
+     * view was only panned by whole pixels in a cylindrical projection.
+     */
+    void updateCoastImage( const ViewportParams *viewport, MapQuality mapQuality );
+
+    void colorizeRows( QImage *origimg, int yStart, int yEnd, quint32 embossSeed ) const;
+    quint32 embossSeed( const QImage *origimg, int y ) const;
+
     QString m_seafile;
     QString m_landfile;
     QList<const GeoDataDocument*> m_seaDocuments;
     QList<const GeoDataDocument*> m_landDocuments;
     QImage m_coastImage;
+
+    // the view m_coastImage was rendered for, and the whole pixels it has been
+    // shifted by since, see updateCoastImage()
+    bool m_coastImageValid;
+    Projection m_coastProjection;
+    int m_coastRadius;
+    MapQuality m_coastMapQuality;
+    qreal m_coastHeading;
+    qreal m_coastCenterLon;
+    qreal m_coastCenterLat;
+    QPoint m_coastShift;
+    QVector<bool> m_coastDocumentsVisible;
+
+    // the part of each row of the canvas that gets colorized, starting at m_yTop
+    QVector<RowSpan> m_rowSpans;
+    int m_yTop;
+    // globe projections carry the emboss state from one row to the next
+    bool m_embossAcrossRows;
     uint texturepalette[16][512];
     bool m_showRelief;
     QRgb      m_landColor;
@@ -27,3 +27,43 @@ void TextureMapperInterface::setRepaintNeeded()
 {
     m_repaintNeeded = true;
 }
+
+void TextureMapperInterface::setCenterChanged()
+{
+    setRepaintNeeded();
+}
+
+TextureMapperInterface::LoadStatistics TextureMapperInterface::loadStatistics() const
+{
+    return LoadStatistics();
+}
+
+TextureMapperInterface::LoadStatistics::LoadStatistics() :
+    workerCount( 0 ),
+    blockCount( 0 ),
+    rowCount( 0 ),
+    maxBusyTime( 0 ),
+    totalBusyTime( 0 )
+{
+}
+
+qreal TextureMapperInterface::LoadStatistics::imbalance() const
+{
+    if ( workerCount == 0 || totalBusyTime == 0 ) {
+        return 0.0;
+    }
+
+    return qreal( maxBusyTime ) * workerCount / totalBusyTime;
+}
+
+TextureMapperInterface::LoadStatistics &TextureMapperInterface::LoadStatistics::operator+=( const LoadStatistics &other )
+{
+    // The slowest threads of both runs add up to the time the caller waited
+    workerCount = qMax( workerCount, other.workerCount );
+    blockCount += other.blockCount;
+    rowCount += other.rowCount;
+    maxBusyTime += other.maxBusyTime;
+    totalBusyTime += other.totalBusyTime;
+
+    return *this;
+}
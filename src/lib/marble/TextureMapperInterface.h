@@ -12,6 +12,8 @@
 #ifndef MARBLE_TEXTUREMAPPERINTERFACE_H
 #define MARBLE_TEXTUREMAPPERINTERFACE_H
 
+#include <QtGlobal>
+
 class QRect;
 
 namespace Marble
@@ -36,6 +38,46 @@ public:
 
     void setRepaintNeeded();
 
+    /**
+     * Notifies the mapper that the center of the viewport moved. By default
+     * this requests a full repaint; mappers which are able to reuse parts of
+     * the previous canvas override this.
+     */
+    virtual void setCenterChanged();
+
+    /**
+     * @short Distribution of the work of the last repaint across the render threads.
+     *
+     * Times are measured in nanoseconds.
+     */
+    struct LoadStatistics
+    {
+        LoadStatistics();
+
+        /**
+         * Ratio of the busy time of the slowest thread to the mean busy time.
+         * 1.0 means perfectly balanced, 0.0 means no statistics are available.
+         */
+        qreal imbalance() const;
+
+        /**
+         * Adds the statistics of a repaint that ran after this one on the same threads.
+         */
+        LoadStatistics &operator+=( const LoadStatistics &other );
+
+        int workerCount;
+        int blockCount;
+        int rowCount;
+        qint64 maxBusyTime;
+        qint64 totalBusyTime;
+    };
+
+    /**
+     * Returns the load statistics of the last repaint. Mappers which do not
+     * render in parallel return empty statistics.
+     */
+    virtual LoadStatistics loadStatistics() const;
+
 protected:
     bool m_repaintNeeded;
 };
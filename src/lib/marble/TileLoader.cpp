@@ -21,11 +21,15 @@
 #include "TileLoader.h"
 
 #include <QDateTime>
+#include <QDir>
 #include <QFileInfo>
 #include <QMetaType>
 #include <QImage>
 #include <QUrl>
 
+#include <qmath.h>
+
+#include "GeoSceneAbstractTileProjection.h"
 #include "GeoSceneTextureTileDataset.h"
 #include "GeoSceneTileDataset.h"
 #include "GeoSceneTypes.h"
@@ -36,6 +40,7 @@
 #include "MarbleDirs.h"
 #include "TileId.h"
 #include "TileLoaderHelper.h"
+#include "TileStore.h"
 #include "ParseRunnerPlugin.h"
 #include "ParsingRunner.h"
 
@@ -45,11 +50,12 @@ namespace Marble
 {
 
 TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const PluginManager *pluginManager) :
-    m_pluginManager(pluginManager)
+    m_pluginManager(pluginManager),
+    m_downloadManager(downloadManager)
 {
     qRegisterMetaType<DownloadUsage>( "DownloadUsage" );
-    connect( this, SIGNAL(downloadTile(QUrl,QString,QString,DownloadUsage)),
-             downloadManager, SLOT(addJob(QUrl,QString,QString,DownloadUsage)));
+    connect( this, SIGNAL(downloadTile(QUrl,QString,QString,DownloadUsage,int)),
+             downloadManager, SLOT(addJob(QUrl,QString,QString,DownloadUsage,int)));
     connect( downloadManager, SIGNAL(downloadComplete(QString,QString)),
              SLOT(updateTile(QString,QString)));
     connect( downloadManager, SIGNAL(downloadComplete(QByteArray,QString)),
@@ -66,8 +72,6 @@ TileLoader::~TileLoader()
 //     - if expired: create TextureTile, state is set to Expired by default, trigger dl,
 QImage TileLoader::loadTileImage( GeoSceneTextureTileDataset const *textureLayer, TileId const & tileId, DownloadUsage const usage )
 {
-    QString const fileName = tileFileName( textureLayer, tileId );
-
     TileStatus status = tileStatus( textureLayer, tileId );
     if ( status != Missing ) {
         // check if an update should be triggered
@@ -80,7 +84,7 @@ QImage TileLoader::loadTileImage( GeoSceneTextureTileDataset const *textureLayer
             triggerDownload( textureLayer, tileId, usage );
         }
 
-        QImage const image( fileName );
+        QImage const image = tileImage( textureLayer, tileId );
         if ( !image.isNull() ) {
             // file is there, so create and return a tile object in any case
             return image;
@@ -145,6 +149,56 @@ void TileLoader::downloadTile( GeoSceneTileDataset const *tileData, TileId const
     triggerDownload( tileData, tileId, usage );
 }
 
+void TileLoader::setViewport( GeoSceneTileDataset const *tileData, const GeoDataLatLonBox &latLonBox, int tileLevel )
+{
+    QHash<QString, int> priorities;
+    QStringList staleDownloads;
+    QVector<TileId> staleTiles;
+
+    {
+        QMutexLocker locker( &m_pendingDownloadsMutex );
+
+        Viewport &viewport = m_viewports[ tileData->sourceDir() ];
+        if ( viewport.tileLevel == tileLevel && viewport.latLonBox == latLonBox ) {
+            return;
+        }
+        viewport.latLonBox = latLonBox;
+        viewport.tileLevel = tileLevel;
+
+        // same margin as VectorTileModel uses for keeping tiles
+        const GeoDataLatLonBox extendedBox = latLonBox.scaled( 2.0, 2.0 );
+        const int level = downloadLevel( tileData, tileLevel );
+
+        QHash<TileId, PendingDownload> &pendingDownloads = m_pendingDownloads[ tileData->sourceDir() ];
+        QHash<TileId, PendingDownload>::iterator pos = pendingDownloads.begin();
+        while ( pos != pendingDownloads.end() ) {
+            // level 0 tiles are the fallback for everything else
+            const bool isStale = pos.key().zoomLevel() > 0
+                && ( pos.key().zoomLevel() != level || !extendedBox.intersects( pos.value().latLonBox ) );
+            if ( isStale ) {
+                staleDownloads << pos.value().destinationFileName;
+                staleTiles << TileId( tileData->sourceDir(), pos.key().zoomLevel(), pos.key().x(), pos.key().y() );
+                pos = pendingDownloads.erase( pos );
+            } else {
+                priorities.insert( pos.value().destinationFileName,
+                                   downloadPriority( viewport, pos.key(), pos.value().latLonBox ) );
+                ++pos;
+            }
+        }
+    }
+
+    if ( !staleDownloads.isEmpty() ) {
+        mDebug() << "Cancelling" << staleDownloads.size() << "downloads of tiles out of view";
+        m_downloadManager->removeJobs( staleDownloads, DownloadBrowse );
+        for ( const TileId &id: staleTiles ) {
+            emit downloadCancelled( id );
+        }
+    }
+    if ( !priorities.isEmpty() ) {
+        m_downloadManager->setJobPriorities( priorities, DownloadBrowse );
+    }
+}
+
 int TileLoader::maximumTileLevel( GeoSceneTileDataset const & tileData )
 {
     // if maximum tile level is configured in the DGML files,
@@ -187,8 +241,7 @@ bool TileLoader::baseTilesAvailable( GeoSceneTileDataset const & tileData )
     for ( int column = 0; result && column < levelZeroColumns; ++column ) {
         for ( int row = 0; result && row < levelZeroRows; ++row ) {
             const TileId id( 0, 0, column, row );
-            const QString tilepath = tileFileName( &tileData, id );
-            result &= QFile::exists( tilepath );
+            result &= tileExists( &tileData, id );
             if (!result) {
                 mDebug() << "Base tile " << tileData.relativeTileFileName( id ) << " is missing for source dir " << tileData.sourceDir();
             }
@@ -200,13 +253,21 @@ bool TileLoader::baseTilesAvailable( GeoSceneTileDataset const & tileData )
 
 TileLoader::TileStatus TileLoader::tileStatus( GeoSceneTileDataset const *tileData, const TileId &tileId )
 {
-    QString const fileName = tileFileName( tileData, tileId );
-    QFileInfo fileInfo( fileName );
-    if ( !fileInfo.exists() ) {
-        return Missing;
+    // Downloaded tiles are in the tile store, which needs no file system access
+    QString const relativeFileName = tileData->relativeTileFileName( tileId );
+    QDateTime lastModified;
+    if ( QDir::isRelativePath( relativeFileName ) ) {
+        lastModified = tileStore()->lastModified( relativeFileName );
+    }
+
+    if ( !lastModified.isValid() ) {
+        QFileInfo const fileInfo( tileFileName( tileData, tileId ) );
+        if ( !fileInfo.exists() ) {
+            return Missing;
+        }
+        lastModified = fileInfo.lastModified();
     }
 
-    const QDateTime lastModified = fileInfo.lastModified();
     const int expireSecs = tileData->expire();
     const bool isExpired = lastModified.secsTo( QDateTime::currentDateTime() ) >= expireSecs;
     return isExpired ? Expired : Available;
@@ -214,6 +275,8 @@ TileLoader::TileStatus TileLoader::tileStatus( GeoSceneTileDataset const *tileDa
 
 void TileLoader::updateTile( QByteArray const & data, QString const & idStr )
 {
+    removePendingDownload( idStr );
+
     QStringList const components = idStr.split(QLatin1Char(':'), QString::SkipEmptyParts);
     Q_ASSERT( components.size() == 5 );
 
@@ -236,6 +299,8 @@ void TileLoader::updateTile( QByteArray const & data, QString const & idStr )
 
 void TileLoader::updateTile(const QString &fileName, const QString &idStr)
 {
+    removePendingDownload( idStr );
+
     QStringList const components = idStr.split(QLatin1Char(':'), QString::SkipEmptyParts);
     Q_ASSERT( components.size() == 5 );
 
@@ -261,20 +326,102 @@ QString TileLoader::tileFileName( GeoSceneTileDataset const * tileData, TileId c
     return dirInfo.isAbsolute() ? fileName : MarbleDirs::path( fileName );
 }
 
-void TileLoader::triggerDownload( GeoSceneTileDataset const *tileData, TileId const &id, DownloadUsage const usage )
+QImage TileLoader::tileImage( GeoSceneTileDataset const * tileData, TileId const & tileId )
 {
-    if (id.zoomLevel() > 0) {
-        int minValue = tileData->maximumTileLevel() == -1 ? id.zoomLevel() : qMin( id.zoomLevel(), tileData->maximumTileLevel() );
-        if (id.zoomLevel() != qMax(tileData->minimumTileLevel(), minValue) ) {
-            // Download only level 0 tiles and tiles between minimum and maximum tile level
-            return;
+    QString const relativeFileName = tileData->relativeTileFileName( tileId );
+    if ( QDir::isRelativePath( relativeFileName ) ) {
+        QByteArray const data = tileStore()->data( relativeFileName );
+        if ( !data.isNull() ) {
+            return QImage::fromData( data );
         }
     }
 
+    QString const fileName = tileFileName( tileData, tileId );
+    return fileName.isEmpty() ? QImage() : QImage( fileName );
+}
+
+bool TileLoader::tileExists( GeoSceneTileDataset const * tileData, TileId const & tileId )
+{
+    QString const relativeFileName = tileData->relativeTileFileName( tileId );
+    if ( QDir::isRelativePath( relativeFileName ) && tileStore()->contains( relativeFileName ) ) {
+        return true;
+    }
+
+    return QFile::exists( tileFileName( tileData, tileId ) );
+}
+
+TileStore *TileLoader::tileStore()
+{
+    return TileStore::sharedStore( MarbleDirs::localPath() + QLatin1String( "/cache/tiles.mts" ) );
+}
+
+void TileLoader::triggerDownload( GeoSceneTileDataset const *tileData, TileId const &id, DownloadUsage const usage )
+{
+    if (id.zoomLevel() > 0 && id.zoomLevel() != downloadLevel( tileData, id.zoomLevel() )) {
+        // Download only level 0 tiles and tiles between minimum and maximum tile level
+        return;
+    }
+
     QUrl const sourceUrl = tileData->downloadUrl( id );
     QString const destFileName = tileData->relativeTileFileName( id );
     QString const idStr = QString( "%1:%2:%3:%4:%5" ).arg( tileData->nodeType(), tileData->sourceDir() ).arg( id.zoomLevel() ).arg( id.x() ).arg( id.y() );
-    emit downloadTile( sourceUrl, destFileName, idStr, usage );
+
+    int priority = 0;
+    if ( usage == DownloadBrowse ) {
+        PendingDownload download;
+        download.destinationFileName = destFileName;
+        download.latLonBox = tileData->tileProjection()->geoCoordinates( id );
+
+        QMutexLocker locker( &m_pendingDownloadsMutex );
+        QHash<QString, Viewport>::const_iterator const viewport = m_viewports.constFind( tileData->sourceDir() );
+        if ( viewport != m_viewports.constEnd() ) {
+            priority = downloadPriority( viewport.value(), id, download.latLonBox );
+        }
+        m_pendingDownloads[ tileData->sourceDir() ].insert( TileId( 0, id.zoomLevel(), id.x(), id.y() ), download );
+    }
+
+    emit downloadTile( sourceUrl, destFileName, idStr, usage, priority );
+}
+
+int TileLoader::downloadLevel( GeoSceneTileDataset const * tileData, int tileLevel )
+{
+    int const level = tileData->maximumTileLevel() == -1 ? tileLevel : qMin( tileLevel, tileData->maximumTileLevel() );
+    return qMax( tileData->minimumTileLevel(), level );
+}
+
+int TileLoader::downloadPriority( const Viewport &viewport, TileId const &id, const GeoDataLatLonBox &latLonBox )
+{
+    // tiles of other levels than the one shown come last, ordered by the level distance
+    int const levelDistance = id.zoomLevel() == 0 ? 0 : qAbs( id.zoomLevel() - viewport.tileLevel );
+
+    // the distance from the center of the view, in tiles
+    GeoDataCoordinates const center = viewport.latLonBox.center();
+    GeoDataCoordinates const tileCenter = latLonBox.center();
+    qreal deltaLon = qAbs( tileCenter.longitude() - center.longitude() );
+    if ( deltaLon > M_PI ) {
+        deltaLon = 2 * M_PI - deltaLon;
+    }
+    qreal const deltaLat = qAbs( tileCenter.latitude() - center.latitude() );
+    qreal const distance = qMax( deltaLon / qMax<qreal>( latLonBox.width(), 1e-9 ),
+                                 deltaLat / qMax<qreal>( latLonBox.height(), 1e-9 ) );
+
+    return levelDistance * 1000 + qMin( 999, qFloor( distance ) );
+}
+
+void TileLoader::removePendingDownload( QString const & idStr )
+{
+    QStringList const components = idStr.split(QLatin1Char(':'), QString::SkipEmptyParts);
+    if ( components.size() != 5 ) {
+        return;
+    }
+
+    TileId const id( 0, components[ 2 ].toInt(), components[ 3 ].toInt(), components[ 4 ].toInt() );
+
+    QMutexLocker locker( &m_pendingDownloadsMutex );
+    QHash<QString, QHash<TileId, PendingDownload> >::iterator const pos = m_pendingDownloads.find( components[ 1 ] );
+    if ( pos != m_pendingDownloads.end() ) {
+        pos.value().remove( id );
+    }
 }
 
 QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTileDataset * textureData, TileId const & id )
@@ -290,9 +437,8 @@ QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTileDataset * text
 
         TileId const replacementTileId( id.mapThemeIdHash(), level,
                                         id.x() >> deltaLevel, id.y() >> deltaLevel );
-        QString const fileName = tileFileName( textureData, replacementTileId );
-        mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << fileName;
-        QImage toScale = (!fileName.isEmpty() && QFile::exists(fileName)) ? QImage(fileName) : QImage();
+        mDebug() << "TileLoader::scaledLowerLevelTile" << "trying" << textureData->relativeTileFileName( replacementTileId );
+        QImage toScale = tileImage( textureData, replacementTileId );
 
         if ( level == 0 && toScale.isNull() ) {
             mDebug() << "No level zero tile installed in map theme dir. Falling back to a transparent image for now.";
@@ -303,17 +449,7 @@ QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTileDataset * text
         }
 
         if ( !toScale.isNull() ) {
-            // which rect to scale?
-            int const restTileX = id.x() % ( 1 << deltaLevel );
-            int const restTileY = id.y() % ( 1 << deltaLevel );
-            int const partWidth = qMax(1, toScale.width() >> deltaLevel);
-            int const partHeight = qMax(1, toScale.height() >> deltaLevel);
-            int const startX = restTileX * partWidth;
-            int const startY = restTileY * partHeight;
-            mDebug() << "QImage::copy:" << startX << startY << partWidth << partHeight;
-            QImage const part = toScale.copy( startX, startY, partWidth, partHeight );
-            mDebug() << "QImage::scaled:" << toScale.size();
-            return part.scaled( toScale.size() );
+            return scaledTilePart( toScale, id, deltaLevel );
         }
     }
 
@@ -321,6 +457,21 @@ QImage TileLoader::scaledLowerLevelTile( const GeoSceneTextureTileDataset * text
     return QImage();
 }
 
+QImage TileLoader::scaledTilePart( const QImage &lowerLevelTile, TileId const &id, int deltaLevel )
+{
+    // which rect to scale?
+    int const restTileX = id.x() % ( 1 << deltaLevel );
+    int const restTileY = id.y() % ( 1 << deltaLevel );
+    int const partWidth = qMax(1, lowerLevelTile.width() >> deltaLevel);
+    int const partHeight = qMax(1, lowerLevelTile.height() >> deltaLevel);
+    int const startX = restTileX * partWidth;
+    int const startY = restTileY * partHeight;
+    mDebug() << "QImage::copy:" << startX << startY << partWidth << partHeight;
+    QImage const part = lowerLevelTile.copy( startX, startY, partWidth, partHeight );
+    mDebug() << "QImage::scaled:" << lowerLevelTile.size();
+    return part.scaled( lowerLevelTile.size() );
+}
+
 GeoDataDocument *TileLoader::openVectorFile(const QString &fileName) const
 {
     QList<const ParseRunnerPlugin*> plugins = m_pluginManager->parsingRunnerPlugins();
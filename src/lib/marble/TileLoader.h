@@ -20,10 +20,14 @@
 #ifndef MARBLE_TILELOADER_H
 #define MARBLE_TILELOADER_H
 
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 
+#include "GeoDataLatLonBox.h"
 #include "PluginManager.h"
 #include "MarbleGlobal.h"
+#include "TileId.h"
 
 class QByteArray;
 class QImage;
@@ -32,12 +36,12 @@ class QString;
 
 namespace Marble
 {
-class TileId;
 class HttpDownloadManager;
 class GeoDataDocument;
 class GeoSceneTileDataset;
 class GeoSceneTextureTileDataset;
 class GeoSceneVectorTileDataset;
+class TileStore;
 
 class TileLoader: public QObject
 {
@@ -57,6 +61,13 @@ class TileLoader: public QObject
     GeoDataDocument* loadTileVectorData( GeoSceneVectorTileDataset const *vectorData, TileId const & tileId, DownloadUsage const usage );
     void downloadTile( GeoSceneTileDataset const *tileData, TileId const &, DownloadUsage const );
 
+    /**
+      * Tells which part of @p tileData is shown, at which @p tileLevel. Tiles which
+      * are closer to the center of @p latLonBox are downloaded first. Downloads of
+      * tiles of another level or far out of view are cancelled.
+      */
+    void setViewport( GeoSceneTileDataset const *tileData, const GeoDataLatLonBox &latLonBox, int tileLevel );
+
     static int maximumTileLevel( GeoSceneTileDataset const & tileData );
 
     /**
@@ -73,26 +84,72 @@ class TileLoader: public QObject
       */
     static TileStatus tileStatus( GeoSceneTileDataset const *tileData, const TileId &tileId );
 
+    /**
+      * Returns the part of @p lowerLevelTile covered by the tile @p id, which is
+      * @p deltaLevel levels above it, scaled up to the size of @p lowerLevelTile.
+      */
+    static QImage scaledTilePart( const QImage &lowerLevelTile, TileId const &id, int deltaLevel );
+
+    /**
+      * Returns the store downloaded tile images are kept in. Tiles which are not
+      * in the store are looked up in the file system.
+      */
+    static TileStore *tileStore();
+
  private Q_SLOTS:
     void updateTile( QByteArray const & imageData, QString const & tileId );
     void updateTile( QString const & fileName, QString const & idStr );
 
  Q_SIGNALS:
     void downloadTile( QUrl const & sourceUrl, QString const & destinationFileName,
-                       QString const & id, DownloadUsage );
+                       QString const & id, DownloadUsage, int priority );
 
     void tileCompleted( TileId const & tileId, QImage const & tileImage );
 
     void tileCompleted( TileId const & tileId, GeoDataDocument * document );
 
+    /**
+      * Emitted when the browse download of @p tileId has been cancelled by setViewport().
+      * Tiles which have been shown scaled from a lower level meanwhile stay that way
+      * unless they are loaded again.
+      */
+    void downloadCancelled( TileId const & tileId );
+
  private:
+    struct Viewport
+    {
+        Viewport() : tileLevel( -1 ) {}
+
+        GeoDataLatLonBox latLonBox;
+        int tileLevel;
+    };
+
+    struct PendingDownload
+    {
+        QString destinationFileName;
+        GeoDataLatLonBox latLonBox;
+    };
+
+    static int downloadLevel( GeoSceneTileDataset const * tileData, int tileLevel );
+    static int downloadPriority( const Viewport &viewport, TileId const &, const GeoDataLatLonBox &latLonBox );
+    void removePendingDownload( QString const & idStr );
     static QString tileFileName( GeoSceneTileDataset const * tileData, TileId const & );
+    static QImage tileImage( GeoSceneTileDataset const * tileData, TileId const & );
+    static bool tileExists( GeoSceneTileDataset const * tileData, TileId const & );
     void triggerDownload( GeoSceneTileDataset const *tileData, TileId const &, DownloadUsage const );
     static QImage scaledLowerLevelTile( GeoSceneTextureTileDataset const * textureData, TileId const & );
     GeoDataDocument* openVectorFile(const QString &filename) const;
 
     // For vectorTile parsing
     PluginManager const * m_pluginManager;
+
+    HttpDownloadManager *const m_downloadManager;
+
+    // Browse downloads by source dir, keyed by tile ids without map theme hash.
+    // Downloads are triggered from the threads loading tiles.
+    QMutex m_pendingDownloadsMutex;
+    QHash<QString, Viewport> m_viewports;
+    QHash<QString, QHash<TileId, PendingDownload> > m_pendingDownloads;
 };
 
 }
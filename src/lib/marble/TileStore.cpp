@@ -0,0 +1,1017 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "TileStore.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLockFile>
+#include <QMutex>
+#include <QPair>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#include "MarbleDebug.h"
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace Marble
+{
+
+namespace
+{
+
+const quint32 fileMagic = 0x5354414d;   // "MATS"
+const quint32 fileVersion = 1;
+const quint32 recordMagic = 0x44524352; // "RCRD"
+const quint32 indexMagic = 0x5844494d;  // "MIDX"
+
+struct FileHeader
+{
+    quint32 magic;
+    quint32 version;
+    // changes whenever the records are rewritten, so that an outdated index is not used
+    quint64 generation;
+};
+
+/**
+ * Each record starts at a multiple of 8 bytes with this header, followed by the
+ * UTF-8 encoded key and the data.
+ */
+struct RecordHeader
+{
+    quint32 magic;
+    // of the fields below and the payload
+    quint32 checksum;
+    quint32 keySize;
+    quint32 dataSize;
+    // milliseconds since the epoch
+    qint64 timestamp;
+    quint32 flags;
+    quint32 reserved;
+};
+
+enum RecordFlag {
+    // the record removes the key instead of storing data for it
+    Removed = 0x1
+};
+
+const qint64 minimumCapacity = 1024 * 1024;
+const qint64 maximumGrowth = 64 * 1024 * 1024;
+
+// The store is compacted when more than half of it is occupied by replaced and removed
+// entries, but not before it reaches this size
+const qint64 minimumCompactionSize = 16 * 1024 * 1024;
+
+qint64 recordSize( quint32 keySize, quint32 dataSize )
+{
+    const qint64 size = qint64( sizeof( RecordHeader ) ) + keySize + dataSize;
+    return ( size + 7 ) & ~qint64( 7 );
+}
+
+// FNV-1a, which is fast and good enough to detect interrupted writes
+quint32 fnv1a( quint32 hash, const uchar *data, qint64 size )
+{
+    for ( qint64 i = 0; i < size; ++i ) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+quint32 recordChecksum( const RecordHeader &header, const uchar *payload )
+{
+    const int checkedOffset = offsetof( RecordHeader, keySize );
+    quint32 hash = 2166136261u;
+    hash = fnv1a( hash, reinterpret_cast<const uchar *>( &header ) + checkedOffset, sizeof( RecordHeader ) - checkedOffset );
+    return fnv1a( hash, payload, qint64( header.keySize ) + header.dataSize );
+}
+
+/**
+ * Writes the record of @p keyData and @p data to @p record, which has room for
+ * recordSize() bytes, and returns its header.
+ */
+RecordHeader writeRecord( uchar *record, const QByteArray &keyData, const QByteArray &data, quint32 flags )
+{
+    uchar *payload = record + sizeof( RecordHeader );
+    memcpy( payload, keyData.constData(), keyData.size() );
+    memcpy( payload + keyData.size(), data.constData(), data.size() );
+
+    RecordHeader header;
+    header.keySize = keyData.size();
+    header.dataSize = data.size();
+    header.timestamp = QDateTime::currentMSecsSinceEpoch();
+    header.flags = flags;
+    header.reserved = 0;
+    header.checksum = recordChecksum( header, payload );
+    header.magic = recordMagic;
+    memcpy( record, &header, sizeof( header ) );
+
+    return header;
+}
+
+quint64 nextGeneration( quint64 generation )
+{
+    return qMax<quint64>( generation + 1, QDateTime::currentMSecsSinceEpoch() );
+}
+
+}
+
+
+class Q_DECL_HIDDEN TileStore::Private
+{
+public:
+    struct Entry
+    {
+        // a negative offset marks an entry which has been removed since Index::base was built
+        qint64 offset;
+        quint32 keySize;
+        quint32 dataSize;
+        qint64 timestamp;
+        // the value of m_clock when the entry has been accessed last
+        mutable QAtomicInt lastAccess;
+    };
+
+    /**
+     * A memory mapping of the store file. It stays valid while a reader uses it, also when
+     * the file has been replaced by a compaction or grown in the meantime.
+     */
+    class Mapping
+    {
+    public:
+        Mapping();
+        ~Mapping();
+
+        static QSharedPointer<Mapping> create( const QString &fileName, qint64 capacity );
+
+        QFile m_file;
+        uchar *m_data;
+        qint64 m_capacity;
+
+    private:
+        Q_DISABLE_COPY( Mapping )
+    };
+
+    /**
+     * An immutable snapshot of the entries. Writers build a modified copy and publish it.
+     * To keep copying cheap, the entries are split into a large shared base and the few
+     * entries which have changed since, which are merged into a new base now and then.
+     */
+    struct Index
+    {
+        Index();
+
+        const Entry *find( const QString &key ) const;
+
+        /** Calls @p function with the key and the entry of each entry */
+        template<class Function>
+        void forEach( Function function ) const;
+
+        void insert( const QString &key, const Entry &entry );
+        void remove( const QString &key );
+        void mergeIfNeeded();
+
+        QSharedPointer<Mapping> m_mapping;
+        QSharedPointer<const QHash<QString, Entry> > m_base;
+        QHash<QString, Entry> m_changes;
+        // end of the last record
+        qint64 m_end;
+        // size of the records of the entries
+        qint64 m_liveSize;
+        int m_count;
+        quint64 m_generation;
+    };
+
+    class CompactionJob : public QRunnable
+    {
+    public:
+        explicit CompactionJob( Private *store ) : m_store( store ) {}
+        void run() override { m_store->compact(); }
+
+    private:
+        Private *const m_store;
+    };
+
+    explicit Private( const QString &fileName );
+
+    QSharedPointer<const Index> index() const;
+    void setIndex( const QSharedPointer<const Index> &index );
+
+    bool open();
+    void close();
+    bool reset( quint64 generation );
+    qint64 loadIndex( QHash<QString, Entry> *entries, quint64 generation, qint64 capacity );
+    void saveIndex( const Index &index );
+    QString indexFileName() const;
+    void scan( Index *index, qint64 offset );
+    qint64 append( Index *index, const QString &key, const QByteArray &data, quint32 flags );
+    static QVector<QPair<QString, const Entry *> > entriesByRecency( const Index &index );
+    bool needsCompaction( const Index &index ) const;
+    void scheduleCompaction( bool force );
+    void compact();
+
+    const QString m_fileName;
+    QLockFile m_lockFile;
+    quint64 m_sizeLimit;
+    bool m_compactionScheduled;
+    bool m_compactionForced;
+
+    mutable QAtomicInt m_clock;
+    // serializes the writers and the end of a compaction
+    QMutex m_writeMutex;
+    QThreadPool m_compactionThread;
+
+private:
+    // only held to copy or to replace m_index, so readers never wait for writers
+    mutable QMutex m_indexMutex;
+    // null if the store is not open
+    QSharedPointer<const Index> m_index;
+};
+
+TileStore::Private::Mapping::Mapping() :
+    m_data( nullptr ),
+    m_capacity( 0 )
+{
+}
+
+TileStore::Private::Mapping::~Mapping()
+{
+    if ( m_data ) {
+        m_file.unmap( m_data );
+    }
+}
+
+QSharedPointer<TileStore::Private::Mapping> TileStore::Private::Mapping::create( const QString &fileName, qint64 capacity )
+{
+    QSharedPointer<Mapping> mapping( new Mapping );
+    mapping->m_file.setFileName( fileName );
+    if ( !mapping->m_file.open( QIODevice::ReadWrite ) ) {
+        qWarning() << "Cannot open tile store" << fileName << mapping->m_file.errorString();
+        return QSharedPointer<Mapping>();
+    }
+
+    if ( mapping->m_file.size() < capacity && !mapping->m_file.resize( capacity ) ) {
+        qWarning() << "Cannot resize tile store" << fileName << mapping->m_file.errorString();
+    }
+
+    mapping->m_capacity = mapping->m_file.size();
+    mapping->m_data = mapping->m_capacity > 0 ? mapping->m_file.map( 0, mapping->m_capacity ) : nullptr;
+    if ( !mapping->m_data ) {
+        qWarning() << "Cannot map tile store" << fileName << mapping->m_file.errorString();
+        return QSharedPointer<Mapping>();
+    }
+
+    return mapping;
+}
+
+TileStore::Private::Index::Index() :
+    m_base( new QHash<QString, Entry> ),
+    m_end( sizeof( FileHeader ) ),
+    m_liveSize( 0 ),
+    m_count( 0 ),
+    m_generation( 0 )
+{
+}
+
+const TileStore::Private::Entry *TileStore::Private::Index::find( const QString &key ) const
+{
+    auto it = m_changes.constFind( key );
+    if ( it == m_changes.constEnd() ) {
+        it = m_base->constFind( key );
+        if ( it == m_base->constEnd() ) {
+            return nullptr;
+        }
+    }
+
+    return it->offset < 0 ? nullptr : &*it;
+}
+
+template<class Function>
+void TileStore::Private::Index::forEach( Function function ) const
+{
+    for ( auto it = m_base->constBegin(); it != m_base->constEnd(); ++it ) {
+        if ( !m_changes.contains( it.key() ) ) {
+            function( it.key(), *it );
+        }
+    }
+    for ( auto it = m_changes.constBegin(); it != m_changes.constEnd(); ++it ) {
+        if ( it->offset >= 0 ) {
+            function( it.key(), *it );
+        }
+    }
+}
+
+void TileStore::Private::Index::insert( const QString &key, const Entry &entry )
+{
+    remove( key );
+    m_changes.insert( key, entry );
+    m_liveSize += recordSize( entry.keySize, entry.dataSize );
+    ++m_count;
+    mergeIfNeeded();
+}
+
+void TileStore::Private::Index::remove( const QString &key )
+{
+    const Entry *entry = find( key );
+    if ( !entry ) {
+        return;
+    }
+
+    m_liveSize -= recordSize( entry->keySize, entry->dataSize );
+    --m_count;
+
+    if ( m_base->contains( key ) ) {
+        Entry removed = *entry;
+        removed.offset = -1;
+        m_changes.insert( key, removed );
+    } else {
+        m_changes.remove( key );
+    }
+    mergeIfNeeded();
+}
+
+void TileStore::Private::Index::mergeIfNeeded()
+{
+    // Each change copies m_changes and each merge copies all entries,
+    // so both are kept at about the square root of the number of entries
+    if ( m_changes.size() * m_changes.size() <= qMax( m_base->size(), 4096 ) ) {
+        return;
+    }
+
+    QHash<QString, Entry> *base = new QHash<QString, Entry>( *m_base );
+    for ( auto it = m_changes.constBegin(); it != m_changes.constEnd(); ++it ) {
+        if ( it->offset < 0 ) {
+            base->remove( it.key() );
+        } else {
+            base->insert( it.key(), *it );
+        }
+    }
+
+    m_base.reset( base );
+    m_changes.clear();
+}
+
+TileStore::Private::Private( const QString &fileName ) :
+    m_fileName( fileName ),
+    m_lockFile( fileName + QLatin1String( ".lock" ) ),
+    m_sizeLimit( 0 ),
+    m_compactionScheduled( false ),
+    m_compactionForced( false ),
+    m_clock( 0 )
+{
+    // only consider the lock stale if the process holding it is gone
+    m_lockFile.setStaleLockTime( 0 );
+    m_compactionThread.setMaxThreadCount( 1 );
+}
+
+QSharedPointer<const TileStore::Private::Index> TileStore::Private::index() const
+{
+    QMutexLocker locker( &m_indexMutex );
+    return m_index;
+}
+
+void TileStore::Private::setIndex( const QSharedPointer<const Index> &index )
+{
+    QMutexLocker locker( &m_indexMutex );
+    m_index = index;
+}
+
+bool TileStore::Private::open()
+{
+    QDir::root().mkpath( QFileInfo( m_fileName ).absolutePath() );
+
+    if ( !m_lockFile.tryLock( 0 ) ) {
+        mDebug() << "Tile store" << m_fileName << "is in use by another process";
+        return false;
+    }
+
+    const QSharedPointer<Mapping> mapping = QFileInfo( m_fileName ).size() >= qint64( sizeof( FileHeader ) )
+                                            ? Mapping::create( m_fileName, 0 )
+                                            : QSharedPointer<Mapping>();
+
+    FileHeader header;
+    bool valid = !mapping.isNull();
+    if ( valid ) {
+        memcpy( &header, mapping->m_data, sizeof( header ) );
+        valid = header.magic == fileMagic && header.version == fileVersion;
+    }
+
+    if ( !valid ) {
+        if ( !reset( QDateTime::currentMSecsSinceEpoch() ) ) {
+            m_lockFile.unlock();
+            return false;
+        }
+        return true;
+    }
+
+    QSharedPointer<Index> index( new Index );
+    index->m_mapping = mapping;
+    index->m_generation = header.generation;
+
+    QHash<QString, Entry> *entries = new QHash<QString, Entry>;
+    const qint64 indexEnd = loadIndex( entries, header.generation, mapping->m_capacity );
+    index->m_base.reset( entries );
+    index->m_count = entries->size();
+    for ( const Entry &entry: *entries ) {
+        index->m_liveSize += recordSize( entry.keySize, entry.dataSize );
+    }
+
+    scan( index.data(), indexEnd );
+    if ( !index->m_mapping ) {
+        m_lockFile.unlock();
+        return false;
+    }
+
+    setIndex( index );
+    return true;
+}
+
+void TileStore::Private::close()
+{
+    m_compactionThread.waitForDone();
+
+    QMutexLocker locker( &m_writeMutex );
+    const QSharedPointer<const Index> current = index();
+    if ( current ) {
+        saveIndex( *current );
+        setIndex( QSharedPointer<const Index>() );
+        m_lockFile.unlock();
+    }
+}
+
+bool TileStore::Private::reset( quint64 generation )
+{
+    // The empty store replaces the file at once, as readers may still use the old one
+    QSaveFile file( m_fileName );
+    const FileHeader header = { fileMagic, fileVersion, generation };
+    if ( !file.open( QIODevice::WriteOnly )
+         || file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) ) != qint64( sizeof( header ) )
+         || !file.commit() ) {
+        qWarning() << "Cannot initialize tile store" << m_fileName << file.errorString();
+        return false;
+    }
+    QFile::remove( indexFileName() );
+
+    QSharedPointer<Index> index( new Index );
+    index->m_mapping = Mapping::create( m_fileName, minimumCapacity );
+    index->m_generation = generation;
+    if ( !index->m_mapping ) {
+        return false;
+    }
+
+    setIndex( index );
+    return true;
+}
+
+QString TileStore::Private::indexFileName() const
+{
+    return m_fileName + QLatin1String( ".idx" );
+}
+
+qint64 TileStore::Private::loadIndex( QHash<QString, Entry> *entries, quint64 generation, qint64 capacity )
+{
+    m_clock.store( 0 );
+
+    QFile file( indexFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return sizeof( FileHeader );
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_6 );
+
+    quint32 magic;
+    quint32 version;
+    quint64 indexGeneration;
+    qint64 end;
+    qint32 count;
+    stream >> magic >> version >> indexGeneration >> end >> count;
+    if ( stream.status() != QDataStream::Ok || magic != indexMagic || version != fileVersion
+         || indexGeneration != generation || end > capacity || count < 0 ) {
+        mDebug() << "Ignoring outdated index of tile store" << m_fileName;
+        return sizeof( FileHeader );
+    }
+
+    // the entries are ordered from the least to the most recently used one
+    entries->reserve( count );
+    int clock = 0;
+    for ( qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i ) {
+        QString key;
+        qint64 offset;
+        quint32 keySize;
+        quint32 dataSize;
+        qint64 timestamp;
+        stream >> key >> offset >> keySize >> dataSize >> timestamp;
+
+        const qint64 size = recordSize( keySize, dataSize );
+        if ( offset < qint64( sizeof( FileHeader ) ) || offset + size > end ) {
+            stream.setStatus( QDataStream::ReadCorruptData );
+            break;
+        }
+
+        Entry &entry = (*entries)[key];
+        entry.offset = offset;
+        entry.keySize = keySize;
+        entry.dataSize = dataSize;
+        entry.timestamp = timestamp;
+        entry.lastAccess.store( ++clock );
+    }
+
+    if ( stream.status() != QDataStream::Ok ) {
+        mDebug() << "Ignoring broken index of tile store" << m_fileName;
+        entries->clear();
+        return sizeof( FileHeader );
+    }
+
+    m_clock.store( clock );
+    return end;
+}
+
+void TileStore::Private::saveIndex( const Index &index )
+{
+    const QVector<QPair<QString, const Entry *> > entries = entriesByRecency( index );
+
+    QSaveFile file( indexFileName() );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_5_6 );
+    stream << indexMagic << fileVersion << index.m_generation << index.m_end << qint32( entries.size() );
+    for ( int i = entries.size() - 1; i >= 0; --i ) {
+        const Entry &entry = *entries[i].second;
+        stream << entries[i].first << entry.offset << entry.keySize << entry.dataSize << entry.timestamp;
+    }
+
+    file.commit();
+}
+
+QVector<QPair<QString, const TileStore::Private::Entry *> > TileStore::Private::entriesByRecency( const Index &index )
+{
+    typedef QPair<QString, const Entry *> KeyEntry;
+    QVector<KeyEntry> entries;
+    entries.reserve( index.m_count );
+    index.forEach( [&entries]( const QString &key, const Entry &entry ) {
+        entries << KeyEntry( key, &entry );
+    } );
+
+    // most recently used first
+    std::sort( entries.begin(), entries.end(), []( const KeyEntry &a, const KeyEntry &b ) {
+        return a.second->lastAccess.load() > b.second->lastAccess.load();
+    } );
+
+    return entries;
+}
+
+void TileStore::Private::scan( Index *index, qint64 offset )
+{
+    // Records behind the index have been written after the store has been closed properly
+    // the last time, so their checksums are verified in case the application crashed
+    const uchar *const data = index->m_mapping->m_data;
+    const qint64 capacity = index->m_mapping->m_capacity;
+    int clock = m_clock.load();
+    while ( offset + qint64( sizeof( RecordHeader ) ) <= capacity ) {
+        RecordHeader header;
+        memcpy( &header, data + offset, sizeof( header ) );
+        if ( header.magic != recordMagic ) {
+            break;
+        }
+
+        const qint64 size = recordSize( header.keySize, header.dataSize );
+        const uchar *payload = data + offset + sizeof( RecordHeader );
+        if ( offset + size > capacity || recordChecksum( header, payload ) != header.checksum ) {
+            mDebug() << "Tile store" << m_fileName << "was not closed properly, dropping the last write";
+            break;
+        }
+
+        const QString key = QString::fromUtf8( reinterpret_cast<const char *>( payload ), header.keySize );
+        if ( header.flags & Removed ) {
+            index->remove( key );
+        } else {
+            Entry entry;
+            entry.offset = offset;
+            entry.keySize = header.keySize;
+            entry.dataSize = header.dataSize;
+            entry.timestamp = header.timestamp;
+            entry.lastAccess.store( ++clock );
+            index->insert( key, entry );
+        }
+
+        offset += size;
+    }
+
+    index->m_end = offset;
+    m_clock.store( clock );
+
+    // Parts of an interrupted write must not be taken for a record when writing continues.
+    // The store is not shared with readers yet, so the file can be truncated in place.
+    if ( offset < capacity ) {
+        const qint64 checkSize = qMin<qint64>( sizeof( RecordHeader ), capacity - offset );
+        const uchar *tail = data + offset;
+        if ( std::any_of( tail, tail + checkSize, []( uchar byte ) { return byte != 0; } ) ) {
+            index->m_mapping.clear();
+            QFile file( m_fileName );
+            if ( !file.resize( offset ) ) {
+                qWarning() << "Cannot truncate tile store" << m_fileName << file.errorString();
+            }
+            index->m_mapping = Mapping::create( m_fileName, capacity );
+        }
+    }
+}
+
+qint64 TileStore::Private::append( Index *index, const QString &key, const QByteArray &data, quint32 flags )
+{
+    const QByteArray keyData = key.toUtf8();
+    const qint64 size = recordSize( keyData.size(), data.size() );
+
+    const qint64 capacity = index->m_mapping->m_capacity;
+    if ( index->m_end + size > capacity ) {
+        // Readers keep using the smaller mapping until they fetch the new index
+        const QSharedPointer<Mapping> mapping =
+            Mapping::create( m_fileName, qMax( index->m_end + size, capacity + qMin( capacity, maximumGrowth ) ) );
+        if ( !mapping || index->m_end + size > mapping->m_capacity ) {
+            // e.g. the disk is full
+            return -1;
+        }
+        index->m_mapping = mapping;
+    }
+
+    const qint64 offset = index->m_end;
+    writeRecord( index->m_mapping->m_data + offset, keyData, data, flags );
+    index->m_end += size;
+    return offset;
+}
+
+bool TileStore::Private::needsCompaction( const Index &index ) const
+{
+    if ( m_sizeLimit > 0 && quint64( index.m_end ) > m_sizeLimit ) {
+        return true;
+    }
+
+    // more than half of the store is occupied by replaced and removed entries
+    return index.m_end > minimumCompactionSize
+           && index.m_liveSize < ( index.m_end - qint64( sizeof( FileHeader ) ) ) / 2;
+}
+
+void TileStore::Private::scheduleCompaction( bool force )
+{
+    m_compactionForced |= force;
+    if ( !m_compactionScheduled ) {
+        m_compactionScheduled = true;
+        m_compactionThread.start( new CompactionJob( this ) );
+    }
+}
+
+void TileStore::Private::compact()
+{
+    QSharedPointer<const Index> index;
+    qint64 budget = std::numeric_limits<qint64>::max();
+    {
+        QMutexLocker locker( &m_writeMutex );
+        index = this->index();
+        const bool forced = m_compactionForced;
+        m_compactionScheduled = false;
+        m_compactionForced = false;
+        if ( !index || !( forced || needsCompaction( *index ) ) ) {
+            return;
+        }
+        if ( m_sizeLimit > 0 && quint64( index->m_end ) > m_sizeLimit ) {
+            // Compacting rewrites the whole store, so make some room for further writes
+            budget = qint64( m_sizeLimit * 0.8 );
+        }
+    }
+
+    const QVector<QPair<QString, const Entry *> > entries = entriesByRecency( *index );
+
+    qint64 keptSize = 0;
+    int keptCount = 0;
+    for ( ; keptCount < entries.size(); ++keptCount ) {
+        const Entry &entry = *entries[keptCount].second;
+        const qint64 size = recordSize( entry.keySize, entry.dataSize );
+        if ( keptSize + size > budget ) {
+            break;
+        }
+        keptSize += size;
+    }
+
+    // The copy is written next to the store while writers keep appending to the store
+    QSaveFile file( m_fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        qWarning() << "Cannot compact tile store" << m_fileName << file.errorString();
+        return;
+    }
+
+    const quint64 generation = nextGeneration( index->m_generation );
+    const FileHeader fileHeader = { fileMagic, fileVersion, generation };
+    file.write( reinterpret_cast<const char *>( &fileHeader ), sizeof( fileHeader ) );
+
+    // Write the least recently used entries first, so that the order of the records
+    // reflects the recency when the store is opened again
+    const uchar *const data = index->m_mapping->m_data;
+    QVector<qint64> offsets( keptCount );
+    qint64 offset = sizeof( FileHeader );
+    for ( int i = keptCount - 1; i >= 0; --i ) {
+        const Entry &entry = *entries[i].second;
+        const qint64 size = recordSize( entry.keySize, entry.dataSize );
+        file.write( reinterpret_cast<const char *>( data + entry.offset ), size );
+        offsets[i] = offset;
+        offset += size;
+    }
+
+#ifdef Q_OS_UNIX
+    // Most of the data reaches the disk before the writers are blocked below
+    file.flush();
+    fsync( file.handle() );
+#endif
+
+    QMutexLocker locker( &m_writeMutex );
+    const QSharedPointer<const Index> current = this->index();
+    if ( !current || current->m_generation != index->m_generation ) {
+        // the store has been cleared or closed meanwhile
+        file.cancelWriting();
+        return;
+    }
+
+    // Take over the records which have been written meanwhile, and record the removals
+    // which did not leave a record behind
+    const qint64 shift = offset - index->m_end;
+    const qint64 tailSize = current->m_end - index->m_end;
+    file.write( reinterpret_cast<const char *>( current->m_mapping->m_data + index->m_end ), tailSize );
+    offset += tailSize;
+    for ( int i = 0; i < keptCount; ++i ) {
+        if ( !current->find( entries[i].first ) ) {
+            const QByteArray keyData = entries[i].first.toUtf8();
+            QByteArray record( recordSize( keyData.size(), 0 ), 0 );
+            writeRecord( reinterpret_cast<uchar *>( record.data() ), keyData, QByteArray(), Removed );
+            file.write( record );
+            offset += record.size();
+        }
+    }
+
+    // Replaces the store at once. Readers still using the old file keep it until they
+    // are done; where the file system does not allow replacing a file in use, the
+    // commit fails and the old store is kept.
+    if ( !file.commit() ) {
+        qWarning() << "Cannot compact tile store" << m_fileName << file.errorString();
+        return;
+    }
+
+    QSharedPointer<Index> compacted( new Index );
+    compacted->m_mapping = Mapping::create( m_fileName, qMax( minimumCapacity, offset + offset / 4 ) );
+    if ( !compacted->m_mapping ) {
+        qWarning() << "Cannot reopen tile store" << m_fileName;
+        setIndex( QSharedPointer<const Index>() );
+        m_lockFile.unlock();
+        return;
+    }
+    compacted->m_generation = generation;
+    compacted->m_end = offset;
+
+    QHash<QString, Entry> *base = new QHash<QString, Entry>;
+    base->reserve( current->m_count );
+    for ( int i = 0; i < keptCount; ++i ) {
+        const Entry *entry = current->find( entries[i].first );
+        // entries which have been replaced meanwhile are taken over below
+        if ( entry && entry->offset == entries[i].second->offset ) {
+            Entry &moved = (*base)[entries[i].first];
+            moved = *entry;
+            moved.offset = offsets[i];
+        }
+    }
+    current->forEach( [&]( const QString &key, const Entry &entry ) {
+        if ( entry.offset >= index->m_end ) {
+            Entry &moved = (*base)[key];
+            moved = entry;
+            moved.offset = entry.offset + shift;
+        }
+    } );
+
+    compacted->m_base.reset( base );
+    compacted->m_count = base->size();
+    for ( const Entry &entry: *base ) {
+        compacted->m_liveSize += recordSize( entry.keySize, entry.dataSize );
+    }
+
+    mDebug() << "Compacted tile store" << m_fileName << "from" << current->m_end << "to" << offset << "bytes";
+    setIndex( compacted );
+}
+
+TileStore::TileStore( const QString &fileName ) :
+    d( new Private( fileName ) )
+{
+    d->open();
+}
+
+TileStore::~TileStore()
+{
+    d->close();
+    delete d;
+}
+
+TileStore *TileStore::sharedStore( const QString &fileName )
+{
+    static QMutex mutex;
+    static QHash<QString, QSharedPointer<TileStore> > stores;
+
+    QMutexLocker locker( &mutex );
+    const QString absoluteFileName = QDir::cleanPath( QFileInfo( fileName ).absoluteFilePath() );
+    QSharedPointer<TileStore> &store = stores[absoluteFileName];
+    if ( !store ) {
+        store.reset( new TileStore( absoluteFileName ) );
+    }
+
+    return store.data();
+}
+
+QString TileStore::fileName() const
+{
+    return d->m_fileName;
+}
+
+bool TileStore::isOpen() const
+{
+    return !d->index().isNull();
+}
+
+bool TileStore::contains( const QString &key ) const
+{
+    const QSharedPointer<const Private::Index> index = d->index();
+    return index && index->find( key );
+}
+
+QDateTime TileStore::lastModified( const QString &key ) const
+{
+    const QSharedPointer<const Private::Index> index = d->index();
+    const Private::Entry *entry = index ? index->find( key ) : nullptr;
+    if ( !entry ) {
+        return QDateTime();
+    }
+
+    return QDateTime::fromMSecsSinceEpoch( entry->timestamp );
+}
+
+QByteArray TileStore::data( const QString &key ) const
+{
+    // the index keeps the mapping alive, also if the store is replaced meanwhile
+    const QSharedPointer<const Private::Index> index = d->index();
+    const Private::Entry *entry = index ? index->find( key ) : nullptr;
+    if ( !entry ) {
+        return QByteArray();
+    }
+
+    entry->lastAccess.store( d->m_clock.fetchAndAddRelaxed( 1 ) + 1 );
+    const uchar *data = index->m_mapping->m_data + entry->offset + sizeof( RecordHeader ) + entry->keySize;
+    return QByteArray( reinterpret_cast<const char *>( data ), entry->dataSize );
+}
+
+bool TileStore::insert( const QString &key, const QByteArray &data )
+{
+    QMutexLocker locker( &d->m_writeMutex );
+    const QSharedPointer<const Private::Index> current = d->index();
+    if ( !current ) {
+        return false;
+    }
+
+    QSharedPointer<Private::Index> index( new Private::Index( *current ) );
+    const qint64 offset = d->append( index.data(), key, data, 0 );
+    if ( offset < 0 ) {
+        return false;
+    }
+
+    RecordHeader header;
+    memcpy( &header, index->m_mapping->m_data + offset, sizeof( header ) );
+    Private::Entry entry;
+    entry.offset = offset;
+    entry.keySize = header.keySize;
+    entry.dataSize = header.dataSize;
+    entry.timestamp = header.timestamp;
+    entry.lastAccess.store( d->m_clock.fetchAndAddRelaxed( 1 ) + 1 );
+    index->insert( key, entry );
+
+    d->setIndex( index );
+    if ( d->needsCompaction( *index ) ) {
+        d->scheduleCompaction( false );
+    }
+
+    return true;
+}
+
+void TileStore::remove( const QString &key )
+{
+    QMutexLocker locker( &d->m_writeMutex );
+    const QSharedPointer<const Private::Index> current = d->index();
+    if ( !current || !current->find( key ) ) {
+        return;
+    }
+
+    QSharedPointer<Private::Index> index( new Private::Index( *current ) );
+    d->append( index.data(), key, QByteArray(), Removed );
+    index->remove( key );
+
+    d->setIndex( index );
+    if ( d->needsCompaction( *index ) ) {
+        d->scheduleCompaction( false );
+    }
+}
+
+void TileStore::remove( const QStringList &keys )
+{
+    QMutexLocker locker( &d->m_writeMutex );
+    const QSharedPointer<const Private::Index> current = d->index();
+    if ( !current ) {
+        return;
+    }
+
+    QSharedPointer<Private::Index> index( new Private::Index( *current ) );
+    for ( const QString &key: keys ) {
+        index->remove( key );
+    }
+
+    if ( index->m_count < current->m_count ) {
+        // the removals are only written by the compaction
+        d->setIndex( index );
+        d->scheduleCompaction( true );
+    }
+}
+
+void TileStore::clear()
+{
+    QMutexLocker locker( &d->m_writeMutex );
+    const QSharedPointer<const Private::Index> current = d->index();
+    if ( current && !d->reset( nextGeneration( current->m_generation ) ) ) {
+        d->setIndex( QSharedPointer<const Private::Index>() );
+        d->m_lockFile.unlock();
+    }
+}
+
+QStringList TileStore::keys() const
+{
+    QStringList result;
+    const QSharedPointer<const Private::Index> index = d->index();
+    if ( index ) {
+        result.reserve( index->m_count );
+        index->forEach( [&result]( const QString &key, const Private::Entry & ) {
+            result << key;
+        } );
+    }
+
+    return result;
+}
+
+int TileStore::count() const
+{
+    const QSharedPointer<const Private::Index> index = d->index();
+    return index ? index->m_count : 0;
+}
+
+quint64 TileStore::size() const
+{
+    const QSharedPointer<const Private::Index> index = d->index();
+    return index ? index->m_end : 0;
+}
+
+void TileStore::setSizeLimit( quint64 bytes )
+{
+    QMutexLocker locker( &d->m_writeMutex );
+    d->m_sizeLimit = bytes;
+    const QSharedPointer<const Private::Index> index = d->index();
+    if ( index && d->needsCompaction( *index ) ) {
+        d->scheduleCompaction( false );
+    }
+}
+
+quint64 TileStore::sizeLimit() const
+{
+    QMutexLocker locker( &d->m_writeMutex );
+    return d->m_sizeLimit;
+}
+
+void TileStore::waitForCompaction()
+{
+    d->m_compactionThread.waitForDone();
+}
+
+}
@@ -0,0 +1,135 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_TILESTORE_H
+#define MARBLE_TILESTORE_H
+
+#include <QtGlobal>
+
+#include "marble_export.h"
+
+class QByteArray;
+class QDateTime;
+class QString;
+class QStringList;
+
+namespace Marble
+{
+
+/**
+ * @short A persistent key-value store for tiles and other cached files in a single file.
+ *
+ * Cached files are usually stored one file per tile. Looking up whether a tile is there
+ * and whether it has expired then needs a stat call per tile, and cache directories with
+ * millions of files take minutes to scan. A TileStore keeps all entries in one file
+ * instead, which is memory mapped:
+ *
+ * - The file is a log of records, each holding the key, the data, the time of the last
+ *   modification and a checksum. Lookups, including the expiry check via lastModified(),
+ *   only use the index of all entries in memory and don't touch the file system.
+ * - The index is saved next to the store file (with the suffix ".idx") when the store is
+ *   closed, and loaded again when it is opened. Only the records written after the saved
+ *   index, e.g. before a crash, are read from the store. Without a valid index, all records
+ *   are read.
+ * - Records are only ever appended. After a crash, the store is truncated to the last
+ *   record with a valid checksum, so an interrupted write loses this write only.
+ * - If the size limit is exceeded, or more than half of the store is occupied by replaced
+ *   and removed entries, the store is compacted in the background: the entries are copied
+ *   to a new file, which then replaces the store at once. When the limit is exceeded, the
+ *   least recently used entries are dropped until the store takes at most 80% of the limit.
+ *   Accesses since the store has been opened are tracked in memory; entries which were not
+ *   accessed are ordered by the time they have been written.
+ *
+ * Readers don't wait for writers or the compaction: they look up entries in an immutable
+ * snapshot of the index, which also keeps the mapped file alive, and only lock to fetch the
+ * pointer to the current snapshot. Writers are serialized.
+ *
+ * A store file is only opened by one TileStore at a time, also across processes. Use
+ * sharedStore() to access the same file from several places of the application. If the
+ * file is in use or cannot be opened, isOpen() is false and the store stays empty.
+ *
+ * The file uses the byte order of the machine and is not meant to be moved between machines.
+ */
+class MARBLE_EXPORT TileStore
+{
+public:
+    /**
+     * Opens the store @p fileName, which is created if it does not exist yet.
+     */
+    explicit TileStore( const QString &fileName );
+    ~TileStore();
+
+    /**
+     * Returns the store for @p fileName, which is opened when it is requested first
+     * and kept open until the application exits.
+     */
+    static TileStore *sharedStore( const QString &fileName );
+
+    QString fileName() const;
+
+    bool isOpen() const;
+
+    bool contains( const QString &key ) const;
+
+    /**
+     * Returns the time @p key has been written, or an invalid QDateTime if there is no such entry.
+     */
+    QDateTime lastModified( const QString &key ) const;
+
+    /**
+     * Returns the data stored for @p key, or a null QByteArray if there is no such entry.
+     */
+    QByteArray data( const QString &key ) const;
+
+    /**
+     * Stores @p data for @p key, replacing a previous entry.
+     * @return whether the data has been written
+     */
+    bool insert( const QString &key, const QByteArray &data );
+
+    void remove( const QString &key );
+
+    /**
+     * Removes all entries in @p keys at once, which is faster than removing them one by one.
+     */
+    void remove( const QStringList &keys );
+
+    void clear();
+
+    QStringList keys() const;
+
+    int count() const;
+
+    /**
+     * Returns the size of the store in bytes, including entries which have been removed
+     * or replaced but not compacted yet.
+     */
+    quint64 size() const;
+
+    /**
+     * Sets the maximum size of the store in @p bytes, or 0 for no limit.
+     */
+    void setSizeLimit( quint64 bytes );
+
+    quint64 sizeLimit() const;
+
+    /**
+     * Blocks until a compaction which is running in the background has finished.
+     */
+    void waitForCompaction();
+
+private:
+    Q_DISABLE_COPY( TileStore )
+
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif
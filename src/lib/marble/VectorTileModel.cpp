@@ -12,7 +12,9 @@
 #include "VectorTileModel.h"
 
 #include "GeoDataDocument.h"
+#include "GeoDataGeometry.h"
 #include "GeoDataLatLonBox.h"
+#include "GeoDataPlacemark.h"
 #include "GeoDataTreeModel.h"
 #include "GeoSceneVectorTileDataset.h"
 #include "MarbleGlobal.h"
@@ -27,16 +29,45 @@
 namespace Marble
 {
 
-TileRunner::TileRunner(TileLoader *loader, const GeoSceneVectorTileDataset *tileDataset, const TileId &id) :
+/**
+ * Bounding boxes are computed lazily and cached by the geometries. Computing them
+ * in the tile runner takes this work off the GUI thread, where the graphics items
+ * are sorted into the scene by their bounding box.
+ */
+static void updateLatLonAltBoxes(const GeoDataContainer *container)
+{
+    for (const GeoDataFeature *feature: container->featureList()) {
+        if (const auto placemark = geodata_cast<GeoDataPlacemark>(feature)) {
+            if (placemark->geometry()) {
+                placemark->geometry()->latLonAltBox();
+            }
+        } else if (const auto childContainer = dynamic_cast<const GeoDataContainer*>(feature)) {
+            updateLatLonAltBoxes(childContainer);
+        }
+    }
+}
+
+TileRunner::TileRunner(TileLoader *loader, const GeoSceneVectorTileDataset *tileDataset, const TileId &id,
+                       const QSharedPointer<QAtomicInt> &cancelled) :
     m_loader(loader),
     m_tileDataset(tileDataset),
-    m_id(id)
+    m_id(id),
+    m_cancelled(cancelled)
 {
 }
 
 void TileRunner::run()
 {
+    if (m_cancelled->load()) {
+        emit loadingCancelled(m_id);
+        return;
+    }
+
     GeoDataDocument *const document = m_loader->loadTileVectorData(m_tileDataset, m_id, DownloadBrowse);
+    if (document) {
+        document->setName(QString("%1/%2/%3").arg(m_id.zoomLevel()).arg(m_id.x()).arg(m_id.y()));
+        updateLatLonAltBoxes(document);
+    }
 
     emit documentLoaded(m_id, document);
 }
@@ -107,6 +138,10 @@ void VectorTileModel::setViewport(const GeoDataLatLonBox &latLonBox)
     // More info: http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames#Subtiles
     // More info: http://wiki.openstreetmap.org/wiki/Slippy_map_tilenames#C.2FC.2B.2B
     const QRect rect = m_layer->tileProjection()->tileIndexes(latLonBox, tileLoadLevel);
+    const GeoDataCoordinates viewportCenter = latLonBox.center();
+    const GeoDataLatLonBox centerBox(viewportCenter.latitude(), viewportCenter.latitude(),
+                                     viewportCenter.longitude(), viewportCenter.longitude());
+    m_centerTile = m_layer->tileProjection()->tileIndexes(centerBox, tileLoadLevel).topLeft();
 
     // Download tiles and send them to VectorTileLayer
     // When changing zoom, download everything inside the screen
@@ -124,6 +159,7 @@ void VectorTileModel::setViewport(const GeoDataLatLonBox &latLonBox)
         queryTiles(tileLoadLevel, QRect(rect.topLeft(), QPoint(maxTileX, rect.bottom())));
     }
     removeTilesOutOfView(latLonBox);
+    m_loader->setViewport(m_layer, latLonBox, tileLoadLevel);
 }
 
 void VectorTileModel::removeTilesOutOfView(const GeoDataLatLonBox &boundingBox)
@@ -137,6 +173,15 @@ void VectorTileModel::removeTilesOutOfView(const GeoDataLatLonBox &boundingBox)
             ++iter;
         }
     }
+
+    // Skip loading tiles which are not needed anymore
+    for (auto iter = m_pendingDocuments.constBegin(); iter != m_pendingDocuments.constEnd(); ++iter) {
+        bool const isOutOfView = iter.key().zoomLevel() != m_tileLoadLevel ||
+                !extendedViewport.intersects(m_layer->tileProjection()->geoCoordinates(iter.key()));
+        if (isOutOfView) {
+            iter.value()->store(1);
+        }
+    }
 }
 
 QString VectorTileModel::name() const
@@ -169,7 +214,7 @@ void VectorTileModel::reload()
 void VectorTileModel::updateTile(const TileId &idWithMapThemeHash, GeoDataDocument *document)
 {
     TileId const id(0, idWithMapThemeHash.zoomLevel(), idWithMapThemeHash.x(), idWithMapThemeHash.y());
-    m_pendingDocuments.removeAll(id);
+    m_pendingDocuments.remove(id);
     if (!document) {
         return;
     }
@@ -179,7 +224,10 @@ void VectorTileModel::updateTile(const TileId &idWithMapThemeHash, GeoDataDocume
         return;
     }
 
-    document->setName(QString("%1/%2/%3").arg(id.zoomLevel()).arg(id.x()).arg(id.y()));
+    if (document->name().isEmpty()) {
+        // downloaded tiles are not named by the tile runner
+        document->setName(QString("%1/%2/%3").arg(id.zoomLevel()).arg(id.x()).arg(id.y()));
+    }
     m_garbageQueue << document;
     if (m_documents.contains(id)) {
         m_documents.remove(id);
@@ -200,20 +248,49 @@ void VectorTileModel::clear()
 
 void VectorTileModel::queryTiles(int tileZoomLevel, const QRect &rect)
 {
-    // Download all the tiles inside the given indexes
+    // Download all the tiles inside the given indexes, those closest to the center first
     for (int x = rect.left(); x <= rect.right(); ++x) {
         for (int y = rect.top(); y <= rect.bottom(); ++y) {
             const TileId tileId = TileId(0, tileZoomLevel, x, y);
-            if (!m_documents.contains(tileId) && !m_pendingDocuments.contains(tileId)) {
-                m_pendingDocuments << tileId;
-                TileRunner *job = new TileRunner(m_loader, m_layer, tileId);
-                connect(job, SIGNAL(documentLoaded(TileId,GeoDataDocument*)), this, SLOT(updateTile(TileId,GeoDataDocument*)));
-                m_threadPool->start(job);
+            if (m_documents.contains(tileId)) {
+                continue;
+            }
+            const auto pending = m_pendingDocuments.constFind(tileId);
+            if (pending == m_pendingDocuments.constEnd()) {
+                queryTile(tileId);
+            } else if (pending.value()->load()) {
+                // back in view before its runner got started, or cancelTile() will requery it
+                pending.value()->store(0);
             }
         }
     }
 }
 
+void VectorTileModel::queryTile(const TileId &tileId)
+{
+    QSharedPointer<QAtomicInt> const cancelled(new QAtomicInt(0));
+    m_pendingDocuments.insert(tileId, cancelled);
+    TileRunner *job = new TileRunner(m_loader, m_layer, tileId, cancelled);
+    connect(job, SIGNAL(documentLoaded(TileId,GeoDataDocument*)), this, SLOT(updateTile(TileId,GeoDataDocument*)));
+    connect(job, SIGNAL(loadingCancelled(TileId)), this, SLOT(cancelTile(TileId)));
+    m_threadPool->start(job, tilePriority(tileId));
+}
+
+int VectorTileModel::tilePriority(const TileId &id) const
+{
+    return -qMax(qAbs(id.x() - m_centerTile.x()), qAbs(id.y() - m_centerTile.y()));
+}
+
+void VectorTileModel::cancelTile(const TileId &id)
+{
+    const QSharedPointer<QAtomicInt> cancelled = m_pendingDocuments.take(id);
+    if (cancelled && !cancelled->load() && id.zoomLevel() == m_tileLoadLevel) {
+        // the tile was requested again after its runner got cancelled, queue it
+        // behind the tiles closer to the center like any other tile
+        queryTile(id);
+    }
+}
+
 void VectorTileModel::cleanupTile(GeoDataObject *object)
 {
     if (GeoDataDocument *document = geodata_cast<GeoDataDocument>(object)) {
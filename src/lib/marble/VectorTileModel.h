@@ -15,7 +15,11 @@
 #include <QObject>
 #include <QRunnable>
 
+#include <QAtomicInt>
+#include <QHash>
 #include <QMap>
+#include <QPoint>
+#include <QSharedPointer>
 
 #include "TileId.h"
 #include "GeoDataLatLonBox.h"
@@ -36,16 +40,22 @@ class TileRunner : public QObject, public QRunnable
     Q_OBJECT
 
 public:
-    TileRunner( TileLoader *loader, const GeoSceneVectorTileDataset *texture, const TileId &id );
+    /**
+     * @param cancelled Loading is skipped if this is non-zero when the runner is started
+     */
+    TileRunner( TileLoader *loader, const GeoSceneVectorTileDataset *texture, const TileId &id,
+                const QSharedPointer<QAtomicInt> &cancelled );
     void run() override;
 
 Q_SIGNALS:
     void documentLoaded( const TileId &id, GeoDataDocument *document );
+    void loadingCancelled( const TileId &id );
 
 private:
     TileLoader *const m_loader;
     const GeoSceneVectorTileDataset *const m_tileDataset;
     const TileId m_id;
+    const QSharedPointer<QAtomicInt> m_cancelled;
 };
 
 class VectorTileModel : public QObject
@@ -79,10 +89,15 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     void cleanupTile(GeoDataObject* feature);
+    void cancelTile(const TileId &id);
 
 private:
     void removeTilesOutOfView(const GeoDataLatLonBox &boundingBox);
     void queryTiles(int tileZoomLevel, const QRect &rect);
+    void queryTile(const TileId &id);
+
+    /** Returns the thread pool priority of @p id, higher for tiles closer to the viewport center */
+    int tilePriority(const TileId &id) const;
 
 private:
     struct CacheDocument
@@ -109,7 +124,10 @@ private:
     QThreadPool *const m_threadPool;
     int m_tileLoadLevel;
     int m_tileZoomLevel;
-    QList<TileId> m_pendingDocuments;
+    /** The tile at the center of the viewport in m_tileLoadLevel */
+    QPoint m_centerTile;
+    /** Tiles queued in the thread pool, along with their cancellation flag */
+    QHash<TileId, QSharedPointer<QAtomicInt> > m_pendingDocuments;
     QList<GeoDataDocument*> m_garbageQueue;
     QMap<TileId, QSharedPointer<CacheDocument> > m_documents;
     bool m_deleteDocumentsLater;
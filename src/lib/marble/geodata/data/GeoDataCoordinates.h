@@ -27,7 +27,6 @@ class QString;
 namespace Marble
 {
 
-class GeoDataCoordinatesPrivate;
 class Quaternion;
 
 /**
@@ -284,8 +283,11 @@ class GEODATA_EXPORT GeoDataCoordinates
 
     /**
     * @brief return a Quaternion with the used coordinates
+    *
+    * The quaternion is computed on each call, so keep a copy when it is
+    * needed repeatedly.
     */
-    const Quaternion &quaternion() const;
+    Quaternion quaternion() const;
 
     /**
      * @brief slerp (spherical linear) interpolation between this coordinate and the given target coordinate
@@ -428,12 +430,17 @@ class GEODATA_EXPORT GeoDataCoordinates
     void unpack(QDataStream &stream);
 
  private:
-    void detach();
+    void markValid();
 
-    GeoDataCoordinatesPrivate *d;
+    // Stored by value so that a GeoDataCoordinates::Vector is one
+    // contiguous block without a heap allocation per vertex.
+    qreal m_lon;
+    qreal m_lat;
+    qreal m_altitude;     // in meters above sea level
+    quint8 m_detail;
+    bool m_valid;
 
     static GeoDataCoordinates::Notation s_notation;
-    static const GeoDataCoordinates null;
 };
 
 GEODATA_EXPORT uint qHash(const GeoDataCoordinates& coordinates );
@@ -441,6 +448,7 @@ GEODATA_EXPORT uint qHash(const GeoDataCoordinates& coordinates );
 
 }
 
+Q_DECLARE_TYPEINFO( Marble::GeoDataCoordinates, Q_MOVABLE_TYPE );
 Q_DECLARE_METATYPE( Marble::GeoDataCoordinates )
 
 #endif
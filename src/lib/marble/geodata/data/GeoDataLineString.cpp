@@ -19,6 +19,10 @@
 #include "MarbleDebug.h"
 
 #include <QDataStream>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <limits>
 
 
 namespace Marble
@@ -255,12 +259,254 @@ void GeoDataLineStringPrivate::optimize (GeoDataLineString& lineString) const
     lineString.last().setDetail(startLevel);
 }
 
+namespace {
+
+// Latitudes beyond are not shown by the Mercator projection, see MercatorProjection::maxValidLat()
+const qreal mercatorMaxLatitude = 85.05113 * DEG2RAD;
+
+// A node of a line string in the planes of the equirectangular and of the
+// Mercator projection, and as unit vector on the sphere
+struct SimplificationNode
+{
+    qreal lon;
+    qreal lat;
+    qreal mercatorY;
+    qreal x;
+    qreal y;
+    qreal z;
+    qreal mercatorScale;  // stretch of distances at the node by the Mercator projection
+};
+
+SimplificationNode simplificationNode( const GeoDataCoordinates &coordinates )
+{
+    SimplificationNode node;
+    node.lon = coordinates.longitude();
+    node.lat = coordinates.latitude();
+    const qreal mercatorLat = qBound( -mercatorMaxLatitude, node.lat, mercatorMaxLatitude );
+    node.mercatorY = atanh( sin( mercatorLat ) );
+    node.x = cos( node.lat ) * cos( node.lon );
+    node.y = cos( node.lat ) * sin( node.lon );
+    node.z = sin( node.lat );
+    node.mercatorScale = 1.0 / cos( mercatorLat );
+    return node;
+}
+
+// Distance of (px, py) to the segment from (ax, ay) to (bx, by)
+qreal planarDistance( qreal px, qreal py, qreal ax, qreal ay, qreal bx, qreal by )
+{
+    const qreal dx = bx - ax;
+    const qreal dy = by - ay;
+    px -= ax;
+    py -= ay;
+
+    const qreal lengthSquared = dx * dx + dy * dy;
+    const qreal t = lengthSquared > 0 ? qBound<qreal>( 0.0, ( px * dx + py * dy ) / lengthSquared, 1.0 ) : 0.0;
+    return sqrt( ( px - t * dx ) * ( px - t * dx ) + ( py - t * dy ) * ( py - t * dy ) );
+}
+
+// Angle between the unit vectors of u and v
+qreal angle( const SimplificationNode &u, const SimplificationNode &v )
+{
+    const qreal cx = u.y * v.z - u.z * v.y;
+    const qreal cy = u.z * v.x - u.x * v.z;
+    const qreal cz = u.x * v.y - u.y * v.x;
+    return atan2( sqrt( cx * cx + cy * cy + cz * cz ), u.x * v.x + u.y * v.y + u.z * v.z );
+}
+
+// Angular distance of p to the great circle arc from a to b
+qreal greatCircleDistance( const SimplificationNode &p, const SimplificationNode &a, const SimplificationNode &b )
+{
+    // normal of the plane of the great circle
+    const qreal nx = a.y * b.z - a.z * b.y;
+    const qreal ny = a.z * b.x - a.x * b.z;
+    const qreal nz = a.x * b.y - a.y * b.x;
+    const qreal length = sqrt( nx * nx + ny * ny + nz * nz );
+    if ( length < 1e-12 ) {
+        return angle( p, a );
+    }
+
+    // p is beside the arc if it lies before a or after b along the great circle
+    const qreal afterA = ( a.y * p.z - a.z * p.y ) * nx + ( a.z * p.x - a.x * p.z ) * ny + ( a.x * p.y - a.y * p.x ) * nz;
+    const qreal beforeB = ( p.y * b.z - p.z * b.y ) * nx + ( p.z * b.x - p.x * b.z ) * ny + ( p.x * b.y - p.y * b.x ) * nz;
+    if ( afterA < 0 || beforeB < 0 ) {
+        return qMin( angle( p, a ), angle( p, b ) );
+    }
+
+    return asin( qMin<qreal>( 1.0, qAbs( p.x * nx + p.y * ny + p.z * nz ) / length ) );
+}
+
+// Deviation of p from the segment from a to b on the screen, in units of
+// the angular resolution at the equator
+qreal deviation( const SimplificationNode &p, const SimplificationNode &a, const SimplificationNode &b,
+                 TessellationFlags f )
+{
+    if ( f.testFlag( Tessellate ) && !( f.testFlag( RespectLatitudeCircle ) && a.lat == b.lat ) ) {
+        // The segment follows the great circle. Mercator stretches distances
+        // at p by its scale, the equirectangular projection by at most that much.
+        return p.mercatorScale * greatCircleDistance( p, a, b );
+    }
+
+    // The segment is a straight line on the screen, so it is measured in the
+    // plane of each cylindrical projection. Mercator stretches latitudes by up
+    // to 1 / cos(lat) compared to the longitude/latitude plane.
+    return qMax( planarDistance( p.lon, p.lat, a.lon, a.lat, b.lon, b.lat ),
+                 planarDistance( p.lon, p.mercatorY, a.lon, a.mercatorY, b.lon, b.mercatorY ) );
+}
+
+struct SimplificationRange
+{
+    int first;
+    int last;
+    qreal significance;
+};
+
+class NodeLevelsJob : public QRunnable
+{
+public:
+    NodeLevelsJob( const QVector<GeoDataCoordinates> &nodes, TessellationFlags f, bool isClosed,
+                   const QSharedPointer<GeoDataLineStringNodeLevels> &result ) :
+        m_nodes( nodes ),
+        m_tessellationFlags( f ),
+        m_isClosed( isClosed ),
+        m_result( result )
+    {
+    }
+
+    void run() override
+    {
+        if ( !m_result->cancelled.loadAcquire() ) {
+            GeoDataLineStringPrivate::updateNodeLevels( m_nodes, m_tessellationFlags, m_isClosed, *m_result );
+        }
+        m_result->ready.storeRelease( 1 );
+    }
+
+private:
+    // a shallow copy, the line string may change meanwhile
+    const QVector<GeoDataCoordinates> m_nodes;
+    const TessellationFlags m_tessellationFlags;
+    const bool m_isClosed;
+    const QSharedPointer<GeoDataLineStringNodeLevels> m_result;
+};
+
+}
+
+void GeoDataLineStringPrivate::updateNodeLevels( const QVector<GeoDataCoordinates> &nodes, TessellationFlags f,
+                                                 bool isClosed, GeoDataLineStringNodeLevels &result )
+{
+    const int size = nodes.size();
+    const qreal keep = std::numeric_limits<qreal>::max();
+
+    QVector<SimplificationNode> points( size );
+    for ( int i = 0; i < size; ++i ) {
+        points[i] = simplificationNode( nodes[i] );
+    }
+
+    // The significance of a node is the smallest deviation that removes it:
+    // its own distance to the segment that replaces it, bounded by the
+    // significance of the node that split the range it is part of. A
+    // Douglas-Peucker simplification with tolerance t keeps exactly those
+    // nodes whose significance is at least t.
+    QVector<qreal> significance( size, 0.0 );
+    significance[0] = keep;
+    significance[size - 1] = keep;
+
+    QVector<SimplificationRange> ranges;
+    if ( isClosed ) {
+        // Rings start and end at nearly the same node, so split them at the
+        // node farthest from the start
+        int farthest = 0;
+        qreal maxDistance = -1;
+        for ( int i = 1; i < size - 1; ++i ) {
+            const qreal distance = deviation( points[i], points[0], points[0], f );
+            if ( distance > maxDistance ) {
+                maxDistance = distance;
+                farthest = i;
+            }
+        }
+        significance[farthest] = keep;
+        ranges << SimplificationRange{ 0, farthest, keep } << SimplificationRange{ farthest, size - 1, keep };
+    } else {
+        ranges << SimplificationRange{ 0, size - 1, keep };
+    }
+
+    while ( !ranges.isEmpty() && !result.cancelled.loadAcquire() ) {
+        const SimplificationRange range = ranges.takeLast();
+        if ( range.last - range.first < 2 ) {
+            continue;
+        }
+
+        int split = range.first + 1;
+        qreal maxDistance = -1;
+        for ( int i = range.first + 1; i < range.last; ++i ) {
+            const qreal distance = deviation( points[i], points[range.first], points[range.last], f );
+            if ( distance > maxDistance ) {
+                maxDistance = distance;
+                split = i;
+            }
+        }
+
+        significance[split] = qMin( maxDistance, range.significance );
+        ranges << SimplificationRange{ range.first, split, significance[split] }
+               << SimplificationRange{ split, range.last, significance[split] };
+    }
+
+    if ( result.cancelled.loadAcquire() ) {
+        return;
+    }
+
+    // Level 18 marks nodes that are only needed at full resolution
+    result.levels.resize( size );
+    result.counts.fill( 0, 19 );
+    for ( int i = 0; i < size; ++i ) {
+        quint8 level = 0;
+        if ( significance[i] != keep ) {
+            level = 1;
+            while ( level < 18 && significance[i] < resolutionForLevel( level + 1 ) ) {
+                ++level;
+            }
+        }
+        result.levels[i] = level;
+        ++result.counts[level];
+    }
+    for ( int level = 1; level < result.counts.size(); ++level ) {
+        result.counts[level] += result.counts[level - 1];
+    }
+}
+
+int GeoDataLineStringPrivate::nextRevision()
+{
+    static QAtomicInt revision;
+    return revision.fetchAndAddRelaxed( 1 ) + 1;
+}
+
+void GeoDataLineStringPrivate::clearSimplified() const
+{
+    qDeleteAll( m_simplified );
+    m_simplified.clear();
+    if ( m_nodeLevels ) {
+        m_nodeLevels->cancelled.storeRelease( 1 );
+        m_nodeLevels.clear();
+    }
+}
+
 bool GeoDataLineString::isEmpty() const
 {
     Q_D(const GeoDataLineString);
     return d->m_vector.isEmpty();
 }
 
+int GeoDataLineString::revision() const
+{
+    Q_D(const GeoDataLineString);
+    return d->m_revision;
+}
+
+bool GeoDataLineString::isSimplifying() const
+{
+    Q_D(const GeoDataLineString);
+    return d->m_nodeLevels && !d->m_nodeLevels->ready.loadAcquire();
+}
+
 int GeoDataLineString::size() const
 {
     Q_D(const GeoDataLineString);
@@ -273,7 +519,9 @@ GeoDataCoordinates& GeoDataLineString::at( int pos )
 
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     return d->m_vector[pos];
 }
 
@@ -289,7 +537,9 @@ GeoDataCoordinates& GeoDataLineString::operator[]( int pos )
 
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     return d->m_vector[pos];
 }
 
@@ -299,6 +549,7 @@ GeoDataLineString GeoDataLineString::mid(int pos, int length) const
     auto d = substring.d_func();
     d->m_vector = d_func()->m_vector.mid(pos, length);
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     d->m_dirtyRange = true;
     d->m_tessellationFlags = d_func()->m_tessellationFlags;
     d->m_extrude = d_func()->m_extrude;
@@ -317,7 +568,9 @@ GeoDataCoordinates& GeoDataLineString::last()
 
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     return d->m_vector.last();
 }
 
@@ -326,6 +579,7 @@ GeoDataCoordinates& GeoDataLineString::first()
     detach();
 
     Q_D(GeoDataLineString);
+    d->m_dirtySimplified = true;
     return d->m_vector.first();
 }
 
@@ -346,6 +600,7 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::begin()
     detach();
 
     Q_D(GeoDataLineString);
+    d->m_dirtySimplified = true;
     return d->m_vector.begin();
 }
 
@@ -360,6 +615,7 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::end()
     detach();
 
     Q_D(GeoDataLineString);
+    d->m_dirtySimplified = true;
     return d->m_vector.end();
 }
 
@@ -389,7 +645,9 @@ void GeoDataLineString::insert( int index, const GeoDataCoordinates& value )
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     d->m_vector.insert( index, value );
 }
 
@@ -401,7 +659,9 @@ void GeoDataLineString::append ( const GeoDataCoordinates& value )
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     d->m_vector.append( value );
 }
 
@@ -419,7 +679,9 @@ void GeoDataLineString::append(const QVector<GeoDataCoordinates>& values)
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
 
 #if QT_VERSION >= 0x050500
     d->m_vector.append(values);
@@ -439,7 +701,9 @@ GeoDataLineString& GeoDataLineString::operator << ( const GeoDataCoordinates& va
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     d->m_vector.append( value );
     return *this;
 }
@@ -452,7 +716,9 @@ GeoDataLineString& GeoDataLineString::operator << ( const GeoDataLineString& val
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
 
     QVector<GeoDataCoordinates>::const_iterator itCoords = value.constBegin();
     QVector<GeoDataCoordinates>::const_iterator itEnd = value.constEnd();
@@ -504,7 +770,9 @@ void GeoDataLineString::clear()
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
 
     d->m_vector.clear();
 }
@@ -535,6 +803,7 @@ void GeoDataLineString::setTessellate( bool tessellate )
     } else {
         d->m_tessellationFlags &= ~(Tessellate | RespectLatitudeCircle);
     }
+    d->m_dirtySimplified = true;
 }
 
 TessellationFlags GeoDataLineString::tessellationFlags() const
@@ -549,6 +818,7 @@ void GeoDataLineString::setTessellationFlags( TessellationFlags f )
 
     Q_D(GeoDataLineString);
     d->m_tessellationFlags = f;
+    d->m_dirtySimplified = true;
 }
 
 void GeoDataLineString::reverse()
@@ -559,7 +829,9 @@ void GeoDataLineString::reverse()
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     std::reverse(begin(), end());
 }
 
@@ -846,7 +1118,9 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( const QVector<G
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     return d->m_vector.erase( pos );
 }
 
@@ -859,7 +1133,9 @@ QVector<GeoDataCoordinates>::Iterator GeoDataLineString::erase ( const QVector<G
     delete d->m_rangeCorrected;
     d->m_rangeCorrected = nullptr;
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     return d->m_vector.erase( begin, end );
 }
 
@@ -869,7 +1145,9 @@ void GeoDataLineString::remove ( int i )
 
     Q_D(GeoDataLineString);
     d->m_dirtyRange = true;
+    d->m_dirtySimplified = true;
     d->m_dirtyBox = true;
+    d->m_revision = GeoDataLineStringPrivate::nextRevision();
     d->m_vector.remove( i );
 }
 
@@ -888,6 +1166,65 @@ GeoDataLineString GeoDataLineString::optimized () const
     }
 }
 
+const GeoDataLineString &GeoDataLineString::simplified( int level ) const
+{
+    Q_D(const GeoDataLineString);
+
+    // Short line strings are cheap to project, optimized ones are
+    // filtered by the detail value of their nodes already
+    const int size = d->m_vector.size();
+    if ( size < 64 || level >= 17 || d->m_vector.first().detail() != 0 ) {
+        return *this;
+    }
+
+    if ( d->m_dirtySimplified ) {
+        qDeleteAll( d->m_simplified );
+        d->m_simplified.fill( nullptr, 18 );
+        ++d->m_simplifiedGeneration;
+        d->m_dirtySimplified = false;
+    }
+
+    // Large line strings take a while to simplify, so they are drawn in full
+    // until the simplification has been computed in the background. Changes
+    // meanwhile are picked up once the running computation has finished, so
+    // a line string that keeps changing occupies one thread at most.
+    if ( !d->m_nodeLevels || ( d->m_nodeLevels->ready.loadAcquire()
+                               && d->m_nodeLevels->generation != d->m_simplifiedGeneration ) ) {
+        d->m_nodeLevels = QSharedPointer<GeoDataLineStringNodeLevels>(
+                    new GeoDataLineStringNodeLevels( d->m_simplifiedGeneration ) );
+        QThreadPool::globalInstance()->start( new NodeLevelsJob( d->m_vector, tessellationFlags(), isClosed(),
+                                                                 d->m_nodeLevels ) );
+    }
+
+    const GeoDataLineStringNodeLevels &nodeLevels = *d->m_nodeLevels;
+    if ( !nodeLevels.ready.loadAcquire() || nodeLevels.generation != d->m_simplifiedGeneration ) {
+        return *this;
+    }
+
+    level = qMax( level, 0 );
+    const int count = nodeLevels.counts[level];
+    if ( 2 * count > size ) {
+        return *this;
+    }
+
+    GeoDataLineString *&simplified = d->m_simplified[level];
+    if ( !simplified ) {
+        QVector<GeoDataCoordinates> nodes;
+        nodes.reserve( count );
+        for ( int i = 0; i < size; ++i ) {
+            if ( nodeLevels.levels[i] <= level ) {
+                nodes << d->m_vector[i];
+            }
+        }
+
+        simplified = isClosed() ? new GeoDataLinearRing( tessellationFlags() )
+                                : new GeoDataLineString( tessellationFlags() );
+        simplified->append( nodes );
+    }
+
+    return *simplified;
+}
+
 void GeoDataLineString::pack( QDataStream& stream ) const
 {
     Q_D(const GeoDataLineString);
@@ -225,6 +225,16 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
     int size() const;
 
 
+/*!
+    \brief Returns a number that changes whenever the nodes of the LineString change.
+
+    Caches of data derived from the nodes, e.g. of their screen positions,
+    compare it to find out whether they are outdated.
+    @since 0.28.0
+*/
+    int revision() const;
+
+
 /*!
     \brief Returns a reference to the coordinates of a node at a given position.
     This method detaches the returned coordinate object from the line string.
@@ -384,6 +394,37 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
     */
     GeoDataLineString optimized() const;
 
+    /*!
+        \brief Returns the linestring reduced to the nodes that matter at the given detail level.
+
+        The nodes are picked by a Douglas-Peucker simplification that deviates
+        from the original by less than half of the resolution of @p level (see
+        the detail levels of optimized()) in the cylindrical projections.
+        Deviations are measured along great circles if the linestring is
+        tessellated. The simplification is computed once in the background
+        and kept until the linestring changes; the reduced linestring is valid
+        until then as well.
+
+        Returns the linestring itself if it is short, if its nodes carry detail
+        values already, if the simplification would not drop at least half
+        of the nodes, or while the simplification is being computed.
+
+        @since 0.28.0
+        @see isSimplifying()
+    */
+    const GeoDataLineString &simplified( int level ) const;
+
+    /*!
+        \brief Returns whether a simplification requested by simplified() is
+        still being computed in the background.
+
+        Callers that got the full linestring meanwhile should ask for the
+        simplified one again once this returns <code>false</code>.
+
+        @since 0.28.0
+    */
+    bool isSimplifying() const;
+
     // Serialization
 /*!
     \brief Serialize the LineString to a stream.
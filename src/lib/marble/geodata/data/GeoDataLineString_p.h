@@ -15,9 +15,27 @@
 
 #include "GeoDataTypes.h"
 
+#include <QAtomicInt>
+#include <QSharedPointer>
+
 namespace Marble
 {
 
+/**
+ * The lowest level at which a simplification keeps each node of a line
+ * string, computed in the background.
+ */
+struct GeoDataLineStringNodeLevels
+{
+    explicit GeoDataLineStringNodeLevels( int nodesGeneration ) : generation( nodesGeneration ) {}
+
+    QAtomicInt      ready;      // set once levels and counts are complete
+    QAtomicInt      cancelled;  // set once the line string does not need them anymore
+    const int       generation; // m_simplifiedGeneration of the nodes they are computed for
+    QVector<quint8> levels;     // lowest level that keeps the node
+    QVector<int>    counts;     // number of nodes kept per level
+};
+
 class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
 {
   public:
@@ -25,22 +43,29 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
         :  m_rangeCorrected( nullptr ),
            m_dirtyRange( true ),
            m_dirtyBox( true ),
+           m_revision( nextRevision() ),
            m_tessellationFlags( f ),
            m_previousResolution( -1 ),
-           m_level( -1 )
+           m_level( -1 ),
+           m_simplifiedGeneration( 0 ),
+           m_dirtySimplified( true )
     {
     }
 
     GeoDataLineStringPrivate()
          : m_rangeCorrected( nullptr ),
            m_dirtyRange( true ),
-           m_dirtyBox( true )
+           m_dirtyBox( true ),
+           m_revision( nextRevision() ),
+           m_simplifiedGeneration( 0 ),
+           m_dirtySimplified( true )
     {
     }
 
     ~GeoDataLineStringPrivate() override
     {
         delete m_rangeCorrected;
+        clearSimplified();
     }
 
     GeoDataLineStringPrivate& operator=( const GeoDataLineStringPrivate &other)
@@ -50,7 +75,10 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
         m_rangeCorrected = nullptr;
         m_dirtyRange = true;
         m_dirtyBox = other.m_dirtyBox;
+        m_revision = nextRevision();
         m_tessellationFlags = other.m_tessellationFlags;
+        clearSimplified();
+        m_dirtySimplified = true;
         return *this;
     }
 
@@ -81,6 +109,21 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
     static qreal resolutionForLevel(int level);
     void optimize(GeoDataLineString& lineString) const;
 
+    /**
+     * Assigns each of @p nodes the lowest level at which it is kept by a
+     * Douglas-Peucker simplification with a tolerance of half the
+     * resolution of that level. Deviations are measured along the lines
+     * that connect the nodes as of @p f.
+     */
+    static void updateNodeLevels( const QVector<GeoDataCoordinates> &nodes, TessellationFlags f,
+                                  bool isClosed, GeoDataLineStringNodeLevels &result );
+    void clearSimplified() const;
+
+    /**
+     * Returns a revision that no line string has had so far.
+     */
+    static int nextRevision();
+
     QVector<GeoDataCoordinates> m_vector;
 
     mutable GeoDataLineString*  m_rangeCorrected;
@@ -89,10 +132,17 @@ class GeoDataLineStringPrivate : public GeoDataGeometryPrivate
     mutable bool                m_dirtyBox; // tells whether there have been changes to the
                                             // GeoDataPoints since the LatLonAltBox has 
                                             // been calculated. Saves performance. 
+    int                         m_revision; // changes along with m_dirtyBox
     TessellationFlags           m_tessellationFlags;
     mutable qreal  m_previousResolution;
     mutable quint8 m_level;
 
+    // Simplified copies for rendering at low zoom levels, see simplified()
+    mutable QSharedPointer<GeoDataLineStringNodeLevels> m_nodeLevels;  // latest computation
+    mutable QVector<GeoDataLineString*> m_simplified;  // lazily built copy per level
+    mutable int                         m_simplifiedGeneration;  // counts the changes seen by simplified()
+    mutable bool                        m_dirtySimplified;
+
 };
 
 } // namespace Marble
@@ -18,9 +18,10 @@
 #include "GeoDataLineString.h"
 #include "GeoDataExtendedData.h"
 
-#include <QMap>
 #include <QDateTime>
 
+#include <algorithm>
+
 namespace Marble {
 
 class GeoDataTrackPrivate : public GeoDataGeometryPrivate
@@ -28,6 +29,8 @@ class GeoDataTrackPrivate : public GeoDataGeometryPrivate
 public:
     GeoDataTrackPrivate()
         : m_lineStringNeedsUpdate( false ),
+          m_timeIndexNeedsUpdate( false ),
+          m_timeCursor( 0 ),
           m_interpolate( false )
     {
     }
@@ -43,9 +46,21 @@ public:
         }
     }
 
+    void updateTimeIndex() const;
+    int upperBound( qint64 msecs ) const;
+    GeoDataCoordinates coordinatesAt( qint64 msecs, bool interpolate ) const;
+
     mutable GeoDataLineString m_lineString;
     mutable bool m_lineStringNeedsUpdate;
 
+    /// times of the points with a valid time in msecs since the epoch, sorted
+    mutable QVector<qint64> m_times;
+    /// indexes of the points in the order of m_times
+    mutable QVector<int> m_timeIndexes;
+    mutable bool m_timeIndexNeedsUpdate;
+    /// upper bound found by the last lookup, playback looks up times close to it
+    mutable int m_timeCursor;
+
     bool m_interpolate;
 
     QVector<QDateTime> m_when;
@@ -54,6 +69,101 @@ public:
     GeoDataExtendedData m_extendedData;
 };
 
+void GeoDataTrackPrivate::updateTimeIndex() const
+{
+    if ( !m_timeIndexNeedsUpdate ) {
+        return;
+    }
+
+    const int size = qMin( m_when.size(), m_coordinates.size() );
+    QVector<QPair<qint64, int> > points;
+    points.reserve( size );
+    bool sorted = true;
+    for ( int i = 0; i < size; ++i ) {
+        if ( m_when.at( i ).isValid() ) {
+            const qint64 msecs = m_when.at( i ).toMSecsSinceEpoch();
+            sorted = sorted && ( points.isEmpty() || points.last().first <= msecs );
+            points.append( qMakePair( msecs, i ) );
+        }
+    }
+
+    if ( !sorted ) {
+        // keep points with the same time in their order, like the track does
+        std::stable_sort( points.begin(), points.end(),
+                          []( const QPair<qint64, int> &a, const QPair<qint64, int> &b ) {
+            return a.first < b.first;
+        } );
+    }
+
+    m_times.resize( points.size() );
+    m_timeIndexes.resize( points.size() );
+    for ( int i = 0; i < points.size(); ++i ) {
+        m_times[i] = points.at( i ).first;
+        m_timeIndexes[i] = points.at( i ).second;
+    }
+    m_timeCursor = 0;
+    m_timeIndexNeedsUpdate = false;
+}
+
+int GeoDataTrackPrivate::upperBound( qint64 msecs ) const
+{
+    // Playback advances the time in small steps, so the result is most
+    // likely the last one or the one after it.
+    const int size = m_times.size();
+    for ( int cursor = m_timeCursor; cursor <= qMin( m_timeCursor + 1, size ); ++cursor ) {
+        if ( ( cursor == 0 || m_times.at( cursor - 1 ) <= msecs ) &&
+             ( cursor == size || m_times.at( cursor ) > msecs ) ) {
+            m_timeCursor = cursor;
+            return cursor;
+        }
+    }
+
+    m_timeCursor = std::upper_bound( m_times.constBegin(), m_times.constEnd(), msecs ) - m_times.constBegin();
+    return m_timeCursor;
+}
+
+GeoDataCoordinates GeoDataTrackPrivate::coordinatesAt( qint64 msecs, bool interpolate ) const
+{
+    updateTimeIndex();
+
+    const int next = upperBound( msecs );
+    if ( next > 0 && m_times.at( next - 1 ) == msecs ) {
+        //exact match found, use the first point with that time
+        int index = next - 1;
+        while ( index > 0 && m_times.at( index - 1 ) == msecs ) {
+            --index;
+        }
+        return m_coordinates.at( m_timeIndexes.at( index ) );
+    }
+
+    if ( !interpolate ) {
+        return GeoDataCoordinates();
+    }
+
+    // No tracked point happened before "when"
+    if ( next == 0 ) {
+        mDebug() << "No tracked point before " << QDateTime::fromMSecsSinceEpoch( msecs );
+        return GeoDataCoordinates();
+    }
+
+    if ( next == m_times.size() ) {
+        mDebug() << "No track point after" << QDateTime::fromMSecsSinceEpoch( msecs );
+        return GeoDataCoordinates();
+    }
+
+    // points with the same time replace each other, the last one counts
+    const int last = std::upper_bound( m_times.constBegin() + next, m_times.constEnd(), m_times.at( next ) )
+                     - m_times.constBegin() - 1;
+    const GeoDataCoordinates &previousCoord = m_coordinates.at( m_timeIndexes.at( next - 1 ) );
+    const GeoDataCoordinates &nextCoord = m_coordinates.at( m_timeIndexes.at( last ) );
+
+    const qint64 interval = m_times.at( next ) - m_times.at( next - 1 );
+    const qint64 position = msecs - m_times.at( next - 1 );
+    qreal t = (qreal)position / (qreal)interval;
+
+    return previousCoord.interpolate(nextCoord, t);
+}
+
 GeoDataTrack::GeoDataTrack() :
     GeoDataGeometry( new GeoDataTrackPrivate() )
 {
@@ -168,51 +278,36 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
         return GeoDataCoordinates();
     }
 
-    if (d->m_when.contains(when)) {
-        //exact match found
+    if (!when.isValid()) {
+        // matches the first point without time information, if any
         const int index = d->m_when.indexOf(when);
-        if (index < d->m_coordinates.size()) {
+        if (index >= 0 && index < d->m_coordinates.size()) {
             return d->m_coordinates.at(index);
         }
-    }
-
-    if ( !interpolate() ) {
         return GeoDataCoordinates();
     }
 
-    typedef QMap<QDateTime, GeoDataCoordinates> PointMap;
-    PointMap pointMap;
-    for (int i = 0; i < qMin(d->m_when.size(), d->m_coordinates.size()); ++i) {
-        if (d->m_when.at(i).isValid()) {
-            pointMap[d->m_when.at(i)] = d->m_coordinates.at(i);
-        }
-    }
+    return d->coordinatesAt(when.toMSecsSinceEpoch(), d->m_interpolate);
+}
 
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator nextEntry = const_cast<const PointMap&>(pointMap).upperBound( when );
+QVector<GeoDataCoordinates> GeoDataTrack::coordinatesAt( const QVector<const GeoDataTrack *> &tracks, const QDateTime &when )
+{
+    QVector<GeoDataCoordinates> result;
+    result.reserve(tracks.size());
 
-    // No tracked point happened before "when"
-    if ( nextEntry == pointMap.constBegin() ) {
-        mDebug() << "No tracked point before " << when;
-        return GeoDataCoordinates();
+    if (!when.isValid()) {
+        for (const GeoDataTrack *track: tracks) {
+            result.append(track->coordinatesAt(when));
+        }
+        return result;
     }
 
-    if ( nextEntry == pointMap.constEnd() ) {
-        mDebug() << "No track point after" << when;
-        return GeoDataCoordinates();
+    const qint64 msecs = when.toMSecsSinceEpoch();
+    for (const GeoDataTrack *track: tracks) {
+        const GeoDataTrackPrivate *d = track->d_func();
+        result.append(d->m_when.isEmpty() ? GeoDataCoordinates() : d->coordinatesAt(msecs, d->m_interpolate));
     }
-
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator previousEntry = nextEntry - 1;
-    GeoDataCoordinates previousCoord = previousEntry.value();
-
-    QDateTime previousWhen = previousEntry.key();
-    QDateTime nextWhen = nextEntry.key();
-    GeoDataCoordinates nextCoord = nextEntry.value();
-
-    int interval = previousWhen.msecsTo( nextWhen );
-    int position = previousWhen.msecsTo( when );
-    qreal t = (qreal)position / (qreal)interval;
-
-    return previousCoord.interpolate(nextCoord, t);
+    return result;
 }
 
 GeoDataCoordinates GeoDataTrack::coordinatesAt( int index ) const
@@ -229,6 +324,7 @@ void GeoDataTrack::addPoint( const QDateTime &when, const GeoDataCoordinates &co
     d->equalizeWhenSize();
     d->m_lineStringNeedsUpdate = true;
     int i=0;
+    d->m_timeIndexNeedsUpdate = true;
     while (i < d->m_when.size()) {
         if (d->m_when.at(i) > when) {
             break;
@@ -247,6 +343,7 @@ void GeoDataTrack::appendCoordinates( const GeoDataCoordinates &coord )
     d->equalizeWhenSize();
     d->m_lineStringNeedsUpdate = true;
     d->m_coordinates.append(coord);
+    d->m_timeIndexNeedsUpdate = true;
 }
 
 void GeoDataTrack::appendAltitude( qreal altitude )
@@ -270,6 +367,7 @@ void GeoDataTrack::appendWhen( const QDateTime &when )
 
     Q_D(GeoDataTrack);
     d->m_when.append(when);
+    d->m_timeIndexNeedsUpdate = true;
 }
 
 void GeoDataTrack::clear()
@@ -280,6 +378,7 @@ void GeoDataTrack::clear()
     d->m_when.clear();
     d->m_coordinates.clear();
     d->m_lineStringNeedsUpdate = true;
+    d->m_timeIndexNeedsUpdate = true;
 }
 
 void GeoDataTrack::removeBefore( const QDateTime &when )
@@ -297,6 +396,8 @@ void GeoDataTrack::removeBefore( const QDateTime &when )
         d->m_when.takeFirst();
         d->m_coordinates.takeFirst();
     }
+    d->m_lineStringNeedsUpdate = true;
+    d->m_timeIndexNeedsUpdate = true;
 }
 
 void GeoDataTrack::removeAfter( const QDateTime &when )
@@ -313,6 +414,8 @@ void GeoDataTrack::removeAfter( const QDateTime &when )
         d->m_when.takeLast();
         d->m_coordinates.takeLast();
     }
+    d->m_lineStringNeedsUpdate = true;
+    d->m_timeIndexNeedsUpdate = true;
 }
 
 const GeoDataLineString *GeoDataTrack::lineString() const
@@ -127,6 +127,16 @@ public:
      */
     GeoDataCoordinates coordinatesAt( const QDateTime &when ) const;
 
+    /**
+     * Returns the coordinates of each of the @p tracks at @p when, as
+     * coordinatesAt() of each track does. Looking up the positions of many
+     * tracks at once, e.g. for each frame of a playback, converts @p when only
+     * once.
+     *
+     * @since 0.28.0
+     */
+    static QVector<GeoDataCoordinates> coordinatesAt( const QVector<const GeoDataTrack *> &tracks, const QDateTime &when );
+
     /**
      * Return coordinates at specified index. This is useful when the track contains
      * coordinates without time information.
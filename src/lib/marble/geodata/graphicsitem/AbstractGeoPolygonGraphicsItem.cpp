@@ -37,7 +37,8 @@ AbstractGeoPolygonGraphicsItem::AbstractGeoPolygonGraphicsItem(const GeoDataPlac
     GeoGraphicsItem(placemark),
     m_polygon(polygon),
     m_ring(nullptr),
-    m_building(nullptr)
+    m_building(nullptr),
+    m_waiting(false)
 {
 }
 
@@ -45,7 +46,8 @@ AbstractGeoPolygonGraphicsItem::AbstractGeoPolygonGraphicsItem(const GeoDataPlac
     GeoGraphicsItem(placemark),
     m_polygon(nullptr),
     m_ring(ring),
-    m_building(nullptr)
+    m_building(nullptr),
+    m_waiting(false)
 {
 }
 
@@ -53,7 +55,8 @@ AbstractGeoPolygonGraphicsItem::AbstractGeoPolygonGraphicsItem(const GeoDataPlac
     GeoGraphicsItem(placemark),
     m_polygon(nullptr),
     m_ring(nullptr),
-    m_building(building)
+    m_building(building),
+    m_waiting(false)
 {
 }
 
@@ -77,6 +80,7 @@ void AbstractGeoPolygonGraphicsItem::paint( GeoPainter* painter, const ViewportP
     Q_UNUSED(layer);
     Q_UNUSED(tileZoomLevel);
 
+    m_waiting = false;
     bool isValid = true;
     if (s_previousStyle != style().data()) {
         isValid = configurePainter(painter, *viewport);
@@ -85,25 +89,44 @@ void AbstractGeoPolygonGraphicsItem::paint( GeoPainter* painter, const ViewportP
 
     if (!isValid) return;
 
-    if ( m_polygon ) {
+    if (!m_polygon && !m_ring) {
+        return;
+    }
+
+    const GeoDataLinearRing &outerBoundary = m_polygon ? m_polygon->outerBoundary() : *m_ring;
+    const GeoDataLatLonAltBox &viewLatLonAltBox = viewport->viewLatLonAltBox();
+    if (!viewLatLonAltBox.intersects(outerBoundary.latLonAltBox()) ||
+        !viewport->resolves(outerBoundary.latLonAltBox())) {
+        return;
+    }
+
+    // The screen polygons are kept across frames, with the outer boundary at index 0
+    m_projectedGeometry.setViewport(viewport);
+    QVector<QPolygonF*> innerPolygons;
+    if (m_polygon) {
         bool innerResolved = false;
+        bool innerOnScreen = false;
 
         for(auto const & ring : m_polygon->innerBoundaries()) {
-            if (viewport->resolves(ring.latLonAltBox(), 4)) {
-               innerResolved = true;
-               break;
-            }
+            innerResolved = innerResolved || viewport->resolves(ring.latLonAltBox(), 4);
+            innerOnScreen = innerOnScreen || viewLatLonAltBox.intersects(ring.latLonAltBox());
         }
 
-        if (innerResolved) {
-            painter->drawPolygon(*m_polygon);
-        }
-        else {
-            painter->drawPolygon(m_polygon->outerBoundary());
+        if (innerResolved && innerOnScreen) {
+            auto const & innerBoundaries = m_polygon->innerBoundaries();
+            for (int i = 0; i < innerBoundaries.size(); ++i) {
+                innerPolygons << m_projectedGeometry.polygons(i + 1, innerBoundaries[i]);
+            }
         }
-    } else if ( m_ring ) {
-        painter->drawPolygon( *m_ring );
     }
+
+    painter->drawScreenPolygons(m_projectedGeometry.polygons(0, outerBoundary), innerPolygons);
+    m_waiting = m_projectedGeometry.isWaiting();
+}
+
+bool AbstractGeoPolygonGraphicsItem::isWaiting() const
+{
+    return m_waiting;
 }
 
 bool AbstractGeoPolygonGraphicsItem::contains(const QPoint &screenPosition, const ViewportParams *viewport) const
@@ -227,6 +250,7 @@ void AbstractGeoPolygonGraphicsItem::setLinearRing(GeoDataLinearRing *ring)
     Q_ASSERT(m_building);
     Q_ASSERT(!m_polygon);
     m_ring = ring;
+    m_projectedGeometry.clear();
 }
 
 void AbstractGeoPolygonGraphicsItem::setPolygon(GeoDataPolygon *polygon)
@@ -234,6 +258,7 @@ void AbstractGeoPolygonGraphicsItem::setPolygon(GeoDataPolygon *polygon)
     Q_ASSERT(m_building);
     Q_ASSERT(!m_ring);
     m_polygon = polygon;
+    m_projectedGeometry.clear();
 }
 
 }
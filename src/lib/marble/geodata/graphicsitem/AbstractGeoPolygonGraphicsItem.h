@@ -12,6 +12,7 @@
 #define MARBLE_ABSTRACTGEOPOLYGONGRAPHICSITEM_H
 
 #include "GeoGraphicsItem.h"
+#include "ProjectedGeometryCache.h"
 #include "marble_export.h"
 
 #include <QImage>
@@ -37,6 +38,7 @@ public:
     const GeoDataLatLonAltBox& latLonAltBox() const override;
     void paint(GeoPainter* painter, const ViewportParams *viewport, const QString &layer, int tileZoomLevel) override;
     bool contains(const QPoint &screenPosition, const ViewportParams *viewport) const override;
+    bool isWaiting() const override;
 
     void setLinearRing(GeoDataLinearRing* ring);
     void setPolygon(GeoDataPolygon* polygon);
@@ -60,6 +62,8 @@ private:
     const GeoDataPolygon * m_polygon;
     const GeoDataLinearRing * m_ring;
     const GeoDataBuilding *const m_building;
+    ProjectedGeometryCache m_projectedGeometry;
+    bool m_waiting;
 };
 
 }
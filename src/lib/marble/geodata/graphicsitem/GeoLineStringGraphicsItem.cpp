@@ -54,7 +54,6 @@ GeoLineStringGraphicsItem::GeoLineStringGraphicsItem(const GeoDataPlacemark *pla
 
 GeoLineStringGraphicsItem::~GeoLineStringGraphicsItem()
 {
-    qDeleteAll(m_cachedPolygons);
 }
 
 
@@ -62,6 +61,8 @@ void GeoLineStringGraphicsItem::setLineString( const GeoDataLineString* lineStri
 {
     m_lineString = lineString;
     m_renderLineString = lineString;
+    m_cachedPolygons.clear();
+    m_projectedGeometry.clear();
 }
 
 const GeoDataLineString *GeoLineStringGraphicsItem::lineString() const
@@ -125,6 +126,8 @@ void GeoLineStringGraphicsItem::setMergedLineString(const GeoDataLineString &mer
 {
     m_mergedLineString = mergedLineString;
     m_renderLineString = mergedLineString.isEmpty() ? m_lineString : &m_mergedLineString;
+    m_cachedPolygons.clear();
+    m_projectedGeometry.clear();
 }
 
 const GeoDataLatLonAltBox& GeoLineStringGraphicsItem::latLonAltBox() const
@@ -137,10 +140,7 @@ void GeoLineStringGraphicsItem::paint(GeoPainter* painter, const ViewportParams*
     setRenderContext(RenderContext(tileLevel));
 
     if (layer.endsWith(QLatin1String("/outline"))) {
-        qDeleteAll(m_cachedPolygons);
-        m_cachedPolygons.clear();
-        m_cachedRegion = QRegion();
-        painter->polygonsFromLineString(*m_renderLineString, m_cachedPolygons);
+        updateCachedPolygons(viewport);
         if (m_cachedPolygons.empty()) {
             return;
         }
@@ -159,10 +159,7 @@ void GeoLineStringGraphicsItem::paint(GeoPainter* painter, const ViewportParams*
             }
         }
     } else {
-        qDeleteAll(m_cachedPolygons);
-        m_cachedPolygons.clear();
-        m_cachedRegion = QRegion();
-        painter->polygonsFromLineString(*m_renderLineString, m_cachedPolygons);
+        updateCachedPolygons(viewport);
         if (m_cachedPolygons.empty()) {
             return;
         }
@@ -172,6 +169,27 @@ void GeoLineStringGraphicsItem::paint(GeoPainter* painter, const ViewportParams*
     }
 }
 
+void GeoLineStringGraphicsItem::updateCachedPolygons(const ViewportParams *viewport)
+{
+    m_cachedRegion = QRegion();
+
+    // Like GeoPainter::polygonsFromLineString(), but the screen polygons are kept across frames
+    if (!viewport->viewLatLonAltBox().intersects(m_renderLineString->latLonAltBox()) ||
+        !viewport->resolves(m_renderLineString->latLonAltBox())) {
+        m_cachedPolygons.clear();
+        return;
+    }
+
+    m_projectedGeometry.setViewport(viewport);
+    m_cachedPolygons = m_projectedGeometry.polygons(0, *m_renderLineString);
+}
+
+bool GeoLineStringGraphicsItem::isWaiting() const
+{
+    // the polygons are cleared if the line string is not in view
+    return !m_cachedPolygons.isEmpty() && m_projectedGeometry.isWaiting();
+}
+
 bool GeoLineStringGraphicsItem::contains(const QPoint &screenPosition, const ViewportParams *) const
 {
     if (m_penWidth <= 0.0) {
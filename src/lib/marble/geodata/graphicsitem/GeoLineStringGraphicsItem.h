@@ -15,6 +15,7 @@
 #include "GeoDataCoordinates.h"
 #include "GeoDataLineString.h"
 #include "MarbleGlobal.h"
+#include "ProjectedGeometryCache.h"
 #include "marble_export.h"
 
 #include <QRegion>
@@ -41,6 +42,7 @@ public:
 
     void paint(GeoPainter* painter, const ViewportParams *viewport, const QString &layer, int tileZoomLevel) override;
     bool contains(const QPoint &screenPosition, const ViewportParams *viewport) const override;
+    bool isWaiting() const override;
 
     static const GeoDataStyle *s_previousStyle;
     static bool s_paintInline;
@@ -50,6 +52,7 @@ protected:
     void handleRelationUpdate(const QVector<const GeoDataRelation *> &relations) override;
 
 private:
+    void updateCachedPolygons(const ViewportParams *viewport);
     void paintOutline(GeoPainter *painter, const ViewportParams *viewport) const;
     void paintInline(GeoPainter *painter, const ViewportParams *viewport);
     void paintLabel(GeoPainter *painter, const ViewportParams *viewport) const;
@@ -62,6 +65,8 @@ private:
     const GeoDataLineString *m_lineString;
     const GeoDataLineString *m_renderLineString;
     GeoDataLineString m_mergedLineString;
+    ProjectedGeometryCache m_projectedGeometry;
+    // screen polygons of the last frame, owned by m_projectedGeometry
     QVector<QPolygonF*> m_cachedPolygons;
     bool m_renderLabel;
     qreal m_penWidth;
@@ -0,0 +1,133 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ProjectedGeometryCache.h"
+
+#include "AbstractProjection.h"
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataLineString.h"
+#include "ViewportParams.h"
+
+#include <QPolygonF>
+
+namespace Marble
+{
+
+ProjectedGeometryCache::ProjectedGeometryCache() :
+    m_viewport(nullptr),
+    m_projection(Spherical),
+    m_radius(0),
+    m_heading(0),
+    m_x(0),
+    m_y(0),
+    m_repeatsX(false),
+    m_waiting(false)
+{
+}
+
+ProjectedGeometryCache::~ProjectedGeometryCache()
+{
+    clear();
+}
+
+void ProjectedGeometryCache::setViewport(const ViewportParams *viewport)
+{
+    m_viewport = viewport;
+    m_waiting = false;
+
+    bool const sameScale = m_radius == viewport->radius() &&
+                           m_projection == viewport->projection() &&
+                           m_heading == viewport->heading() &&
+                           m_size == viewport->size();
+    bool const cylindrical = viewport->currentProjection()->surfaceType() == AbstractProjection::Cylindrical;
+
+    // The screen position of a reference point tells how far a cylindrical map was panned
+    qreal x = 0;
+    qreal y = 0;
+    bool repeatsX = false;
+    if (cylindrical) {
+        viewport->screenCoordinates(0.0, 0.0, x, y);
+
+        // Polygons get repeated if the map does not fill the width of the screen,
+        // depending on the position of the map
+        qreal const centerLatitude = viewport->viewLatLonAltBox().center().latitude();
+        qreal xWest = 0;
+        qreal xEast = 0;
+        qreal dummy = 0;
+        viewport->screenCoordinates(-M_PI, centerLatitude, xWest, dummy);
+        viewport->screenCoordinates(+M_PI, centerLatitude, xEast, dummy);
+        repeatsX = xWest > 0 || xEast < viewport->width() - 1;
+    }
+
+    if (sameScale && m_planetAxis == viewport->planetAxis()) {
+        // nothing changed
+    } else if (sameScale && cylindrical && !repeatsX && !m_repeatsX) {
+        translate(x - m_x, y - m_y);
+    } else {
+        clear();
+    }
+
+    m_projection = viewport->projection();
+    m_radius = viewport->radius();
+    m_heading = viewport->heading();
+    m_size = viewport->size();
+    m_planetAxis = viewport->planetAxis();
+    m_x = x;
+    m_y = y;
+    m_repeatsX = repeatsX;
+}
+
+const QVector<QPolygonF*> &ProjectedGeometryCache::polygons(int index, const GeoDataLineString &lineString)
+{
+    Q_ASSERT(m_viewport);
+    if (index >= m_entries.size()) {
+        m_entries.resize(index + 1);
+    }
+
+    Entry &entry = m_entries[index];
+    if (entry.lineString != &lineString || entry.revision != lineString.revision() ||
+        (entry.simplifying && !lineString.isSimplifying())) {
+        qDeleteAll(entry.polygons);
+        entry.polygons.clear();
+        m_viewport->screenCoordinates(lineString, entry.polygons);
+        entry.lineString = &lineString;
+        entry.revision = lineString.revision();
+        entry.simplifying = lineString.isSimplifying();
+    }
+    m_waiting = m_waiting || entry.simplifying;
+    return entry.polygons;
+}
+
+bool ProjectedGeometryCache::isWaiting() const
+{
+    return m_waiting;
+}
+
+void ProjectedGeometryCache::clear()
+{
+    for (Entry &entry: m_entries) {
+        qDeleteAll(entry.polygons);
+        entry.polygons.clear();
+        entry.lineString = nullptr;
+    }
+}
+
+void ProjectedGeometryCache::translate(qreal dx, qreal dy)
+{
+    if (dx == 0 && dy == 0) {
+        return;
+    }
+
+    for (const Entry &entry: m_entries) {
+        for (QPolygonF *polygon: entry.polygons) {
+            polygon->translate(dx, dy);
+        }
+    }
+}
+
+}
@@ -0,0 +1,96 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_PROJECTEDGEOMETRYCACHE_H
+#define MARBLE_PROJECTEDGEOMETRYCACHE_H
+
+#include "MarbleGlobal.h"
+#include "Quaternion.h"
+#include "marble_export.h"
+
+#include <QSize>
+#include <QVector>
+
+class QPolygonF;
+
+namespace Marble
+{
+
+class GeoDataLineString;
+class ViewportParams;
+
+/**
+ * Keeps the screen polygons of the line strings of a graphics item across frames.
+ *
+ * The polygons are only projected again when the projection, radius, planet axis,
+ * heading or size of the viewport or the nodes of the line strings change. When a cylindrical projection is only
+ * panned, the cached polygons are moved on the screen instead of being projected,
+ * tessellated and split at the date line again.
+ */
+class MARBLE_EXPORT ProjectedGeometryCache
+{
+public:
+    ProjectedGeometryCache();
+    ~ProjectedGeometryCache();
+
+    /**
+     * Prepares the cache for painting in @p viewport: keeps, moves or drops
+     * the cached polygons. Must be called before polygons().
+     */
+    void setViewport(const ViewportParams *viewport);
+
+    /**
+     * Returns the screen polygons of @p lineString, the line string cached
+     * at @p index, in the viewport passed to setViewport(). The polygons are
+     * owned by the cache and valid until the next call of setViewport().
+     */
+    const QVector<QPolygonF*> &polygons(int index, const GeoDataLineString &lineString);
+
+    /**
+     * Returns whether some of the polygons returned by polygons() since the last
+     * call of setViewport() show a line string in full while its simplification
+     * is computed in the background. They are projected again once it is ready.
+     */
+    bool isWaiting() const;
+
+    /**
+     * Drops all cached polygons, e.g. when the line strings change.
+     */
+    void clear();
+
+private:
+    Q_DISABLE_COPY(ProjectedGeometryCache)
+
+    struct Entry {
+        Entry() : lineString(nullptr), revision(0), simplifying(false) {}
+
+        const GeoDataLineString *lineString;
+        int revision;
+        bool simplifying;
+        QVector<QPolygonF*> polygons;
+    };
+
+    void translate(qreal dx, qreal dy);
+
+    const ViewportParams *m_viewport;
+    QVector<Entry> m_entries;
+
+    Projection m_projection;
+    int m_radius;
+    qreal m_heading;
+    QSize m_size;
+    Quaternion m_planetAxis;
+    qreal m_x;
+    qreal m_y;
+    bool m_repeatsX;
+    bool m_waiting;
+};
+
+}
+
+#endif
@@ -53,6 +53,7 @@ namespace dgml
     extern const char dgmlAttr_levelZeroColumns[];
     extern const char dgmlAttr_levelZeroRows[];
     extern const char dgmlAttr_maximumConnections[];
+    extern const char dgmlAttr_maximumConnectionsPerHost[];
     extern const char dgmlAttr_minimumTileLevel[];
     extern const char dgmlAttr_maximumTileLevel[];
     extern const char dgmlAttr_mode[];
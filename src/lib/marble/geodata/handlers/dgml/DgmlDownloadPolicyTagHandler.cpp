@@ -70,7 +70,20 @@ GeoNode* DgmlDownloadPolicyTagHandler::parse( GeoParser& parser ) const
         return nullptr;
     }
 
-    parentItem.nodeAs<GeoSceneTileDataset>()->addDownloadPolicy( usage, maximumConnections );
+    // Attribute maximumConnectionsPerHost, optional. QNetworkAccessManager opens
+    // at most 6 connections per host, further requests would wait in its queue
+    // where they cannot be reordered anymore.
+    int maximumConnectionsPerHost = 6;
+    const QString maximumConnectionsPerHostStr = parser.attribute( dgmlAttr_maximumConnectionsPerHost ).trimmed();
+    if ( !maximumConnectionsPerHostStr.isEmpty() ) {
+        maximumConnectionsPerHost = maximumConnectionsPerHostStr.toInt( &ok );
+        if ( !ok ) {
+            qCritical( "Parse error: invalid attribute downloadPolicy/@maximumConnectionsPerHost" );
+            return nullptr;
+        }
+    }
+
+    parentItem.nodeAs<GeoSceneTileDataset>()->addDownloadPolicy( usage, maximumConnections, maximumConnectionsPerHost );
     return nullptr;
 }
 
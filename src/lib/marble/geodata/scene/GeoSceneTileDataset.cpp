@@ -318,12 +318,14 @@ QList<const DownloadPolicy *> GeoSceneTileDataset::downloadPolicies() const
     return m_downloadPolicies;
 }
 
-void GeoSceneTileDataset::addDownloadPolicy( const DownloadUsage usage, const int maximumConnections )
+void GeoSceneTileDataset::addDownloadPolicy( const DownloadUsage usage, const int maximumConnections,
+                                             const int maximumConnectionsPerHost )
 {
     DownloadPolicy * const policy = new DownloadPolicy( DownloadPolicyKey( hostNames(), usage ));
     policy->setMaximumConnections( maximumConnections );
+    policy->setMaximumConnectionsPerHost( maximumConnectionsPerHost );
     m_downloadPolicies.append( policy );
-    mDebug() << "added download policy" << hostNames() << usage << maximumConnections;
+    mDebug() << "added download policy" << hostNames() << usage << maximumConnections << maximumConnectionsPerHost;
 }
 
 QStringList GeoSceneTileDataset::hostNames() const
@@ -105,7 +105,8 @@ class GEODATA_EXPORT GeoSceneTileDataset : public GeoSceneAbstractDataset
     QString themeStr() const;
 
     QList<const DownloadPolicy *> downloadPolicies() const;
-    void addDownloadPolicy( const DownloadUsage usage, const int maximumConnections );
+    void addDownloadPolicy( const DownloadUsage usage, const int maximumConnections,
+                            const int maximumConnectionsPerHost = 6 );
 
  private:
     Q_DISABLE_COPY( GeoSceneTileDataset )
@@ -84,6 +84,10 @@ bool DgmlTextureTagWriter::write(const GeoNode *node, GeoWriter& writer) const
             writer.writeAttribute( "usage", "Bulk" );
             writer.writeAttribute( "maximumConnections", QString::number( policy->maximumConnections() ) );
         }
+
+        if ( policy->maximumConnectionsPerHost() > 0 ) {
+            writer.writeAttribute( "maximumConnectionsPerHost", QString::number( policy->maximumConnectionsPerHost() ) );
+        }
         
         writer.writeEndElement();    
     }
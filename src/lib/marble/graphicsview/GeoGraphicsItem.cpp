@@ -106,6 +106,7 @@ GeoDataStyle::ConstPtr GeoGraphicsItem::style() const
 void GeoGraphicsItem::setStyleBuilder(const StyleBuilder *styleBuilder)
 {
     d->m_styleBuilder = styleBuilder;
+    d->updatePaintLayerIds();
 }
 
 void GeoGraphicsItem::resetStyle()
@@ -142,6 +143,21 @@ QStringList GeoGraphicsItem::paintLayers() const
 void GeoGraphicsItem::setPaintLayers(const QStringList &paintLayers)
 {
     d->m_paintLayers = paintLayers;
+    d->updatePaintLayerIds();
+}
+
+QVector<int> GeoGraphicsItem::paintLayerIds() const
+{
+    return d->m_paintLayerIds;
+}
+
+void GeoGraphicsItemPrivate::updatePaintLayerIds()
+{
+    m_paintLayerIds.clear();
+    m_paintLayerIds.reserve(m_paintLayers.size());
+    for (const QString &paintLayer: m_paintLayers) {
+        m_paintLayerIds << (m_styleBuilder ? m_styleBuilder->paintLayerId(paintLayer) : -1);
+    }
 }
 
 void GeoGraphicsItem::setRenderContext(const RenderContext &renderContext)
@@ -157,6 +173,11 @@ bool GeoGraphicsItem::contains(const QPoint &, const ViewportParams *) const
     return false;
 }
 
+bool GeoGraphicsItem::isWaiting() const
+{
+    return false;
+}
+
 void GeoGraphicsItem::setRelations(const QSet<const GeoDataRelation*> &relations)
 {
     d->m_relations.clear();
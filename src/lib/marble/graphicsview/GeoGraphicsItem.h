@@ -151,6 +151,12 @@ class MARBLE_EXPORT GeoGraphicsItem
 
     void setPaintLayers(const QStringList &paintLayers);
 
+    /**
+     * Returns the ids of paintLayers() as determined by StyleBuilder::paintLayerId(),
+     * or -1 for paint layers without an id.
+     */
+    QVector<int> paintLayerIds() const;
+
     void setRenderContext(const RenderContext &renderContext);
 
     /**
@@ -161,6 +167,13 @@ class MARBLE_EXPORT GeoGraphicsItem
      */
     virtual bool contains(const QPoint &screenPosition, const ViewportParams *viewport) const;
 
+    /**
+     * Returns whether the last paint() showed a preliminary version of the item
+     * while data for it is computed in the background, e.g. a line string that
+     * is being simplified. The item should be painted again soon.
+     */
+    virtual bool isWaiting() const;
+
     void setRelations(const QSet<const GeoDataRelation *> &relations);
 
  protected:
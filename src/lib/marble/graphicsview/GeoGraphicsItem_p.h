@@ -38,6 +38,8 @@ class GeoGraphicsItemPrivate
     {
     }
 
+    void updatePaintLayerIds();
+
     qreal m_zValue;
     GeoGraphicsItem::GeoGraphicsItemFlags m_flags;
 
@@ -49,6 +51,7 @@ class GeoGraphicsItemPrivate
     QVector<const GeoDataRelation*> m_relations;
 
     QStringList m_paintLayers;
+    QVector<int> m_paintLayerIds;
 
     // To highlight a placemark
     bool m_highlighted;
@@ -57,6 +57,9 @@
 #include <qmath.h>
 #include <QAbstractItemModel>
 #include <QModelIndex>
+#include <QTimer>
+
+#include <algorithm>
 
 namespace Marble
 {
@@ -68,15 +71,6 @@ public:
     typedef QHash<const GeoDataFeature *, Relations> FeatureRelationHash;
     using GeoGraphicItems = QVector<GeoGraphicsItem *>;
 
-    struct PaintFragments {
-        // Three lists for different z values
-        // A z value of 0 is default and used by the majority of items, so sorting
-        // can be avoided for it
-        QVector<GeoGraphicsItem*> negative; // subways
-        QVector<GeoGraphicsItem*> null;     // areas and roads
-        QVector<GeoGraphicsItem*> positive; // buildings
-    };
-
     explicit GeometryLayerPrivate(const QAbstractItemModel *model, const StyleBuilder *styleBuilder);
 
     void createGraphicsItems(const GeoDataObject *object);
@@ -84,9 +78,17 @@ public:
     void createGraphicsItemFromGeometry(const GeoDataGeometry *object, const GeoDataPlacemark *placemark, const Relations &relations);
     void createGraphicsItemFromOverlay(const GeoDataOverlay *overlay);
     void removeGraphicsItems(const GeoDataFeature *feature);
+    void collectGraphicsItems(const GeoDataFeature *feature, QSet<GeoGraphicsItem*> &items) const;
+    void removeSceneItems(const GeoDataFeature *feature, QSet<qint64> &osmIds);
+    static bool isTiledLineString(const GeoDataPlacemark *placemark);
     void updateTiledLineStrings(const GeoDataPlacemark *placemark, GeoLineStringGraphicsItem* lineStringItem);
     static void updateTiledLineStrings(OsmLineStringItems &lineStringItems);
     void clearCache();
+    void clearPaintFragments();
+    void updatePaintFragments(const GeoDataLatLonBox &box, int zoomLevel);
+    void addPaintFragments(const GeoGraphicItems &items);
+    void removePaintFragments(const QSet<GeoGraphicsItem*> &items);
+    void sortPaintFragments();
     bool showRelation(const GeoDataRelation* relation) const;
     void updateRelationVisibility();
 
@@ -101,8 +103,12 @@ public:
     GeoGraphicsItem* m_lastFeatureAt;
 
     bool m_dirty;
-    int m_cachedItemCount;
-    QHash<QString, GeoGraphicItems> m_cachedPaintFragments;
+    QSet<GeoGraphicsItem*> m_cachedItems;
+    int m_cachedZoomLevel;
+    // Items of each paint layer sorted by z value and style, indexed by paint layer id
+    QVector<GeoGraphicItems> m_cachedPaintFragments;
+    // Paint layers whose items may have been restyled since they were sorted
+    QVector<bool> m_unsortedPaintFragments;
     typedef QPair<QString, GeoGraphicsItem*> LayerItem;
     QList<LayerItem> m_cachedDefaultLayer;
     QDateTime m_cachedDateTime;
@@ -111,6 +117,8 @@ public:
     GeoDataRelation::RelationTypes m_visibleRelationTypes;
     bool m_levelTagDebugModeEnabled;
     int m_debugLevelTag;
+    // repaints items that wait for data computed in the background
+    QTimer m_waitingTimer;
 };
 
 GeometryLayerPrivate::GeometryLayerPrivate(const QAbstractItemModel *model, const StyleBuilder *styleBuilder) :
@@ -119,11 +127,15 @@ GeometryLayerPrivate::GeometryLayerPrivate(const QAbstractItemModel *model, cons
     m_tileLevel(0),
     m_lastFeatureAt(nullptr),
     m_dirty(true),
-    m_cachedItemCount(0),
+    m_cachedZoomLevel(-1),
+    m_cachedPaintFragments(styleBuilder->renderOrder().size()),
+    m_unsortedPaintFragments(m_cachedPaintFragments.size(), false),
     m_visibleRelationTypes(GeoDataRelation::RouteFerry),
     m_levelTagDebugModeEnabled(false),
     m_debugLevelTag(0)
 {
+    m_waitingTimer.setSingleShot(true);
+    m_waitingTimer.setInterval(100);
 }
 
 void GeometryLayerPrivate::createGraphicsItems(const GeoDataObject *object)
@@ -152,6 +164,8 @@ GeometryLayer::GeometryLayer(const QAbstractItemModel *model, const StyleBuilder
             &d->m_scene, SLOT(applyHighlight(QVector<GeoDataPlacemark*>)));
     connect(&d->m_scene, SIGNAL(repaintNeeded()),
             this, SIGNAL(repaintNeeded()));
+    connect(&d->m_waitingTimer, SIGNAL(timeout()),
+            this, SIGNAL(repaintNeeded()));
 }
 
 GeometryLayer::~GeometryLayer()
@@ -190,64 +204,15 @@ bool GeometryLayer::render(GeoPainter *painter, ViewportParams *viewport,
         d->m_dirty = false;
 
         const int maxZoomLevel = qMin(d->m_tileLevel, d->m_styleBuilder->maximumZoomLevel());
-        auto const items = d->m_scene.items(box, maxZoomLevel);
-        d->m_cachedLatLonBox = box;
         d->m_cachedDateTime = now;
-
-        d->m_cachedItemCount = items.size();
-        d->m_cachedDefaultLayer.clear();
-        d->m_cachedPaintFragments.clear();
-        QHash<QString, GeometryLayerPrivate::PaintFragments> paintFragments;
-        QSet<QString> const knownLayers = QSet<QString>::fromList(d->m_styleBuilder->renderOrder());
-        for (GeoGraphicsItem* item: items) {
-            QStringList paintLayers = item->paintLayers();
-            if (paintLayers.isEmpty()) {
-                mDebug() << item << " provides no paint layers, so I force one onto it.";
-                paintLayers << QString();
-            }
-            for (const auto &layer: paintLayers) {
-                if (knownLayers.contains(layer)) {
-                    GeometryLayerPrivate::PaintFragments &fragments = paintFragments[layer];
-                    double const zValue = item->zValue();
-                    // assign subway stations
-                    if (zValue == 0.0) {
-                        fragments.null << item;
-                        // assign areas and streets
-                    } else if (zValue < 0.0) {
-                        fragments.negative << item;
-                        // assign buildings
-                    } else {
-                        fragments.positive << item;
-                    }
-                } else {
-                    // assign symbols
-                    d->m_cachedDefaultLayer << GeometryLayerPrivate::LayerItem(layer, item);
-                    static QSet<QString> missingLayers;
-                    if (!missingLayers.contains(layer)) {
-                        mDebug() << "Missing layer " << layer << ", in render order, will render it on top";
-                        missingLayers << layer;
-                    }
-                }
-            }
-        }
-        // Sort each fragment by z-level
-        for (const QString &layer: d->m_styleBuilder->renderOrder()) {
-            GeometryLayerPrivate::PaintFragments & layerItems = paintFragments[layer];
-            std::sort(layerItems.negative.begin(), layerItems.negative.end(), GeoGraphicsItem::zValueLessThan);
-            // The idea here is that layerItems.null has most items and does not need to be sorted by z-value
-            // since they are all equal (=0). We do sort them by style pointer though for batch rendering
-            std::sort(layerItems.null.begin(), layerItems.null.end(), GeoGraphicsItem::styleLessThan);
-            std::sort(layerItems.positive.begin(), layerItems.positive.end(), GeoGraphicsItem::zValueAndStyleLessThan);
-            auto const count = layerItems.negative.size() + layerItems.null.size() + layerItems.positive.size();
-            d->m_cachedPaintFragments[layer].reserve(count);
-            d->m_cachedPaintFragments[layer] << layerItems.negative;
-            d->m_cachedPaintFragments[layer] << layerItems.null;
-            d->m_cachedPaintFragments[layer] << layerItems.positive;
-        }
+        d->updatePaintFragments(box, maxZoomLevel);
     }
 
-    for (const QString &layer: d->m_styleBuilder->renderOrder()) {
-        auto & layerItems = d->m_cachedPaintFragments[layer];
+    bool waiting = false;
+    QStringList const renderOrder = d->m_styleBuilder->renderOrder();
+    for (int i = 0; i < renderOrder.size(); ++i) {
+        const QString &layer = renderOrder[i];
+        auto & layerItems = d->m_cachedPaintFragments[i];
         AbstractGeoPolygonGraphicsItem::s_previousStyle = nullptr;
         GeoLineStringGraphicsItem::s_previousStyle = nullptr;
         for (auto item: layerItems) {
@@ -265,11 +230,19 @@ bool GeometryLayer::render(GeoPainter *painter, ViewportParams *viewport,
                 }
             }
             item->paint(painter, viewport, layer, d->m_tileLevel);
+            waiting = waiting || item->isWaiting();
         }
     }
 
     for (const auto & item: d->m_cachedDefaultLayer) {
         item.second->paint(painter, viewport, item.first, d->m_tileLevel);
+        waiting = waiting || item.second->isWaiting();
+    }
+
+    // Simplified line strings are computed in the background. Paint again
+    // until all items got theirs, the polygons of the others are reused.
+    if (waiting && !d->m_waitingTimer.isActive()) {
+        d->m_waitingTimer.start();
     }
 
     for (ScreenOverlayGraphicsItem* item: d->m_screenOverlays) {
@@ -278,7 +251,7 @@ bool GeometryLayer::render(GeoPainter *painter, ViewportParams *viewport,
 
     painter->restore();
     d->m_runtimeTrace = QStringLiteral("Geometries: %1 Zoom: %2")
-                        .arg(d->m_cachedItemCount)
+                        .arg(d->m_cachedItems.size())
                         .arg(d->m_tileLevel);
     return true;
 }
@@ -299,9 +272,8 @@ bool GeometryLayer::hasFeatureAt(const QPoint &curpos, const ViewportParams *vie
         return true;
     }
 
-    auto const renderOrder = d->m_styleBuilder->renderOrder();
-    for (int i = renderOrder.size() - 1; i >= 0; --i) {
-        auto & layerItems = d->m_cachedPaintFragments[renderOrder[i]];
+    for (int i = d->m_cachedPaintFragments.size() - 1; i >= 0; --i) {
+        auto & layerItems = d->m_cachedPaintFragments[i];
         for (auto item : layerItems) {
             if (item->contains(curpos, viewport)) {
                 d->m_lastFeatureAt = item;
@@ -383,10 +355,138 @@ void GeometryLayerPrivate::clearCache()
     m_lastFeatureAt = nullptr;
     m_dirty = true;
     m_cachedDateTime = QDateTime();
-    m_cachedItemCount = 0;
-    m_cachedPaintFragments.clear();
-    m_cachedDefaultLayer.clear();
     m_cachedLatLonBox = GeoDataLatLonBox();
+    clearPaintFragments();
+}
+
+void GeometryLayerPrivate::clearPaintFragments()
+{
+    m_cachedItems.clear();
+    m_cachedZoomLevel = -1;
+    for (auto &layerItems: m_cachedPaintFragments) {
+        layerItems.clear();
+    }
+    m_unsortedPaintFragments.fill(false);
+    m_cachedDefaultLayer.clear();
+}
+
+void GeometryLayerPrivate::updatePaintFragments(const GeoDataLatLonBox &box, int zoomLevel)
+{
+    GeoGraphicItems enteringItems;
+    if (zoomLevel != m_cachedZoomLevel || m_cachedLatLonBox.isEmpty()) {
+        // Different items are shown at other zoom levels, so start over
+        clearPaintFragments();
+        m_cachedZoomLevel = zoomLevel;
+        m_scene.visitItems(box, zoomLevel, [&](GeoGraphicsItem *item) {
+            enteringItems << item;
+        });
+    } else {
+        // Only items entering or leaving the view are added to or removed from the paint layers
+        QSet<GeoGraphicsItem*> leavingItems;
+        m_scene.visitItems(m_cachedLatLonBox, box, zoomLevel, [&](GeoGraphicsItem *item) {
+            leavingItems.insert(item);
+        });
+        removePaintFragments(leavingItems);
+        m_scene.visitItems(box, m_cachedLatLonBox, zoomLevel, [&](GeoGraphicsItem *item) {
+            enteringItems << item;
+        });
+    }
+    m_cachedLatLonBox = box;
+    addPaintFragments(enteringItems);
+}
+
+void GeometryLayerPrivate::addPaintFragments(const GeoGraphicItems &items)
+{
+    // Items are merged into sorted paint layers only
+    sortPaintFragments();
+
+    int const layerCount = m_cachedPaintFragments.size();
+    QVector<GeoGraphicItems> enteringItems(layerCount);
+    for (auto item: items) {
+        if (m_cachedItems.contains(item)) {
+            continue;
+        }
+        m_cachedItems.insert(item);
+        QVector<int> paintLayerIds = item->paintLayerIds();
+        if (paintLayerIds.isEmpty()) {
+            mDebug() << item << " provides no paint layers, so I force one onto it.";
+            paintLayerIds << -1;
+        }
+        for (int i = 0; i < paintLayerIds.size(); ++i) {
+            if (paintLayerIds[i] >= 0) {
+                enteringItems[paintLayerIds[i]] << item;
+            } else {
+                // assign symbols
+                QString const layer = item->paintLayers().value(i);
+                m_cachedDefaultLayer << LayerItem(layer, item);
+                static QSet<QString> missingLayers;
+                if (!missingLayers.contains(layer)) {
+                    mDebug() << "Missing layer " << layer << ", in render order, will render it on top";
+                    missingLayers << layer;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < layerCount; ++i) {
+        GeoGraphicItems &newItems = enteringItems[i];
+        if (newItems.isEmpty()) {
+            continue;
+        }
+        // Keep the items sorted by z value, and items of equal z value by style for batch rendering.
+        GeoGraphicItems &layerItems = m_cachedPaintFragments[i];
+        std::sort(newItems.begin(), newItems.end(), GeoGraphicsItem::zValueAndStyleLessThan);
+        int const size = layerItems.size();
+        layerItems << newItems;
+        std::inplace_merge(layerItems.begin(), layerItems.begin() + size, layerItems.end(),
+                           GeoGraphicsItem::zValueAndStyleLessThan);
+        // Styles are created lazily when painting, so the order needs an update once after that.
+        m_unsortedPaintFragments[i] = true;
+    }
+}
+
+void GeometryLayerPrivate::removePaintFragments(const QSet<GeoGraphicsItem*> &items)
+{
+    int const layerCount = m_cachedPaintFragments.size();
+    QVector<bool> leavingItems(layerCount, false);
+    bool leavingDefaultLayer = false;
+    for (auto item: items) {
+        if (m_cachedItems.remove(item)) {
+            QVector<int> const paintLayerIds = item->paintLayerIds();
+            leavingDefaultLayer |= paintLayerIds.isEmpty();
+            for (int paintLayerId: paintLayerIds) {
+                if (paintLayerId >= 0) {
+                    leavingItems[paintLayerId] = true;
+                } else {
+                    leavingDefaultLayer = true;
+                }
+            }
+        }
+    }
+
+    auto const isLeaving = [&items](GeoGraphicsItem *item) { return items.contains(item); };
+    for (int i = 0; i < layerCount; ++i) {
+        if (leavingItems[i]) {
+            GeoGraphicItems &layerItems = m_cachedPaintFragments[i];
+            layerItems.erase(std::remove_if(layerItems.begin(), layerItems.end(), isLeaving), layerItems.end());
+        }
+    }
+    if (leavingDefaultLayer) {
+        for (auto iter = m_cachedDefaultLayer.begin(); iter != m_cachedDefaultLayer.end(); ) {
+            iter = isLeaving(iter->second) ? m_cachedDefaultLayer.erase(iter) : iter + 1;
+        }
+    }
+}
+
+void GeometryLayerPrivate::sortPaintFragments()
+{
+    for (int i = 0; i < m_cachedPaintFragments.size(); ++i) {
+        if (m_unsortedPaintFragments[i]) {
+            GeoGraphicItems &layerItems = m_cachedPaintFragments[i];
+            std::sort(layerItems.begin(), layerItems.end(), GeoGraphicsItem::zValueAndStyleLessThan);
+            m_unsortedPaintFragments[i] = false;
+        }
+    }
 }
 
 inline bool GeometryLayerPrivate::showRelation(const GeoDataRelation *relation) const
@@ -409,6 +509,7 @@ void GeometryLayerPrivate::updateRelationVisibility()
         }
     }
     m_scene.resetStyle();
+    m_unsortedPaintFragments.fill(true);
 }
 
 void GeometryLayerPrivate::createGraphicsItemFromGeometry(const GeoDataGeometry* object, const GeoDataPlacemark *placemark, const Relations &relations)
@@ -479,13 +580,57 @@ void GeometryLayerPrivate::createGraphicsItemFromOverlay(const GeoDataOverlay *o
 
 void GeometryLayerPrivate::removeGraphicsItems(const GeoDataFeature *feature)
 {
-    clearCache();
+    // The scene deletes the items, so they leave the paint layers before. So do the
+    // other parts of tiled line strings, as they may be merged differently afterwards.
+    QSet<GeoGraphicsItem*> items;
+    collectGraphicsItems(feature, items);
+    removePaintFragments(items);
+    if (items.contains(m_lastFeatureAt)) {
+        m_lastFeatureAt = nullptr;
+    }
+
+    QSet<qint64> osmIds;
+    removeSceneItems(feature, osmIds);
+
+    if (m_cachedZoomLevel < 0 || m_cachedLatLonBox.isEmpty()) {
+        return;
+    }
+    GeoGraphicItems enteringItems;
+    for (qint64 osmId: osmIds) {
+        for (auto item: m_osmLineStringItems.value(osmId)) {
+            if (item->visible() && item->minZoomLevel() <= m_cachedZoomLevel &&
+                item->latLonAltBox().intersects(m_cachedLatLonBox)) {
+                enteringItems << item;
+            }
+        }
+    }
+    addPaintFragments(enteringItems);
+}
+
+void GeometryLayerPrivate::collectGraphicsItems(const GeoDataFeature *feature, QSet<GeoGraphicsItem*> &items) const
+{
     if (const auto placemark = geodata_cast<GeoDataPlacemark>(feature)) {
-        if (placemark->isGloballyVisible() &&
-            geodata_cast<GeoDataLineString>(placemark->geometry()) &&
-            placemark->hasOsmData() &&
-            placemark->osmData().oid() > 0) {
-            auto & items = m_osmLineStringItems[placemark->osmData().oid()];
+        for (auto item: m_scene.items(placemark)) {
+            items.insert(item);
+        }
+        if (isTiledLineString(placemark)) {
+            for (auto item: m_osmLineStringItems.value(placemark->osmData().oid())) {
+                items.insert(item);
+            }
+        }
+    } else if (const auto container = dynamic_cast<const GeoDataContainer*>(feature)) {
+        for (const GeoDataFeature *child: container->featureList()) {
+            collectGraphicsItems(child, items);
+        }
+    }
+}
+
+void GeometryLayerPrivate::removeSceneItems(const GeoDataFeature *feature, QSet<qint64> &osmIds)
+{
+    if (const auto placemark = geodata_cast<GeoDataPlacemark>(feature)) {
+        if (isTiledLineString(placemark)) {
+            qint64 const osmId = placemark->osmData().oid();
+            auto & items = m_osmLineStringItems[osmId];
             bool removed = false;
             for (auto item : items) {
                 if (item->feature() == feature) {
@@ -496,11 +641,12 @@ void GeometryLayerPrivate::removeGraphicsItems(const GeoDataFeature *feature)
             }
             Q_ASSERT(removed);
             updateTiledLineStrings(items);
+            osmIds << osmId;
         }
         m_scene.removeItem(feature);
     } else if (const auto container = dynamic_cast<const GeoDataContainer*>(feature)) {
         for (const GeoDataFeature *child: container->featureList()) {
-            removeGraphicsItems(child);
+            removeSceneItems(child, osmIds);
         }
     } else if (geodata_cast<GeoDataScreenOverlay>(feature)) {
         for (ScreenOverlayGraphicsItem  *item: m_screenOverlays) {
@@ -511,6 +657,14 @@ void GeometryLayerPrivate::removeGraphicsItems(const GeoDataFeature *feature)
     }
 }
 
+bool GeometryLayerPrivate::isTiledLineString(const GeoDataPlacemark *placemark)
+{
+    return placemark->isGloballyVisible() &&
+           geodata_cast<GeoDataLineString>(placemark->geometry()) &&
+           placemark->hasOsmData() &&
+           placemark->osmData().oid() > 0;
+}
+
 void GeometryLayer::addPlacemarks(const QModelIndex& parent, int first, int last)
 {
     Q_ASSERT(first < d->m_model->rowCount(parent));
@@ -563,6 +717,10 @@ void GeometryLayer::resetCacheData()
 
 void GeometryLayer::setTileLevel(int tileLevel)
 {
+    if (tileLevel != d->m_tileLevel) {
+        // line strings are styled for the tile level
+        d->m_unsortedPaintFragments.fill(true);
+    }
     d->m_tileLevel = tileLevel;
 }
 
@@ -576,7 +734,7 @@ QVector<const GeoDataFeature*> GeometryLayer::whichFeatureAt(const QPoint &curpo
         if (renderOrder[i].endsWith(label)) {
             continue;
         }
-        auto & layerItems = d->m_cachedPaintFragments[renderOrder[i]];
+        auto & layerItems = d->m_cachedPaintFragments[i];
         for (auto j = layerItems.size()-1; j >= 0; --j) {
             auto const & layerItem = layerItems[j];
             if (!checked.contains(layerItem)) {
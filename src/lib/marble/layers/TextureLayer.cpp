@@ -23,6 +23,7 @@
 #include "GenericScanlineTextureMapper.h"
 #include "TileScalingTextureMapper.h"
 #include "GeoDataGroundOverlay.h"
+#include "GeoDataLatLonAltBox.h"
 #include "GeoPainter.h"
 #include "GeoSceneGroup.h"
 #include "GeoSceneTextureTileDataset.h"
@@ -34,6 +35,7 @@
 #include "StackedTile.h"
 #include "StackedTileLoader.h"
 #include "SunLocator.h"
+#include "SunShadingCompositor.h"
 #include "TextureColorizer.h"
 #include "TileLoader.h"
 #include "ViewportParams.h"
@@ -53,8 +55,14 @@ public:
              TextureLayer *parent );
 
     void requestDelayedRepaint();
+    void updateSunShading();
+    static int tileLevel( const MergedLayerDecorator &layerDecorator, const ViewportParams *viewport );
+    static TextureMapperInterface *createTextureMapper( Projection projection, StackedTileLoader *tileLoader,
+                                                        const GeoSceneTextureTileDataset *texture );
     void updateTextureLayers();
     void updateTile( const TileId &tileId, const QImage &tileImage );
+    void dropTile( const TileId &tileId );
+    StackedTileLoader *tileLoader( const TileId &tileId );
 
     void addGroundOverlays( const QModelIndex& parent, int first, int last );
     void removeGroundOverlays( const QModelIndex& parent, int first, int last );
@@ -71,6 +79,12 @@ public:
     TileLoader m_loader;
     MergedLayerDecorator m_layerDecorator;
     StackedTileLoader    m_tileLoader;
+    // the night texture (city lights) is mapped separately and blended in by m_sunShading
+    MergedLayerDecorator m_nightLayerDecorator;
+    StackedTileLoader    m_nightTileLoader;
+    TextureMapperInterface *m_nightTexmapper;
+    QImage m_nightImage;
+    SunShadingCompositor m_sunShading;
     GeoDataCoordinates m_centerCoordinates;
     int m_tileZoomLevel;
     TextureMapperInterface *m_texmapper;
@@ -96,6 +110,10 @@ TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
     , m_loader( downloadManager, pluginManager )
     , m_layerDecorator( &m_loader, sunLocator )
     , m_tileLoader( &m_layerDecorator )
+    , m_nightLayerDecorator( &m_loader, sunLocator )
+    , m_nightTileLoader( &m_nightLayerDecorator )
+    , m_nightTexmapper( nullptr )
+    , m_sunShading( sunLocator )
     , m_centerCoordinates()
     , m_tileZoomLevel( -1 )
     , m_texmapper( nullptr )
@@ -128,15 +146,70 @@ void TextureLayer::Private::requestDelayedRepaint()
     if ( m_texmapper ) {
         m_texmapper->setRepaintNeeded();
     }
+    if ( m_nightTexmapper ) {
+        m_nightTexmapper->setRepaintNeeded();
+    }
 
     if ( !m_repaintTimer.isActive() ) {
         m_repaintTimer.start();
     }
 }
 
+void TextureLayer::Private::updateSunShading()
+{
+    // the shading and the city lights are painted over the map, so the tiles stay valid
+    emit m_parent->repaintNeeded();
+}
+
+int TextureLayer::Private::tileLevel( const MergedLayerDecorator &layerDecorator, const ViewportParams *viewport )
+{
+    // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
+    const int levelZeroWidth = layerDecorator.tileSize().width() * layerDecorator.tileColumnCount( 0 );
+    const int levelZeroHight = layerDecorator.tileSize().height() * layerDecorator.tileRowCount( 0 );
+    const int levelZeroMinDimension = qMin( levelZeroWidth, levelZeroHight );
+
+    // limit to 1 as dirty fix for invalid entry linearLevel
+    const qreal linearLevel = qMax<qreal>( 1.0, viewport->radius() * 4.0 / levelZeroMinDimension );
+
+    // As our tile resolution doubles with each level we calculate
+    // the tile level from tilesize and the globe radius via log(2)
+    const qreal tileLevelF = qLn( linearLevel ) / qLn( 2.0 ) * 1.00001;  // snap to the sharper tile level a tiny bit earlier
+                                                                         // to work around rounding errors when the radius
+                                                                         // roughly equals the global texture width
+
+    return qMin<int>( layerDecorator.maximumTileLevel(), tileLevelF );
+}
+
+TextureMapperInterface *TextureLayer::Private::createTextureMapper( Projection projection, StackedTileLoader *tileLoader,
+                                                                    const GeoSceneTextureTileDataset *texture )
+{
+    // FIXME: replace this with an approach based on the factory method pattern.
+    switch( projection ) {
+        case Spherical:
+            return new SphericalScanlineTextureMapper( tileLoader );
+        case Equirectangular:
+            return new EquirectScanlineTextureMapper( tileLoader );
+        case Mercator:
+            if ( texture->tileProjectionType() == GeoSceneAbstractTileProjection::Mercator ) {
+                return new TileScalingTextureMapper( tileLoader );
+            } else {
+                return new MercatorScanlineTextureMapper( tileLoader );
+            }
+        case Gnomonic:
+        case Stereographic:
+        case LambertAzimuthal:
+        case AzimuthalEquidistant:
+        case VerticalPerspective:
+            return new GenericScanlineTextureMapper( tileLoader );
+        default:
+            return nullptr;
+    }
+}
+
 void TextureLayer::Private::updateTextureLayers()
 {
     QVector<GeoSceneTextureTileDataset const *> result;
+    QVector<GeoSceneTextureTileDataset const *> nightResult;
 
     for ( const GeoSceneTextureTileDataset *candidate: m_textures ) {
         bool enabled = true;
@@ -145,7 +218,12 @@ void TextureLayer::Private::updateTextureLayers()
             enabled |= !propertyExists; // if property doesn't exist, enable texture nevertheless
         }
         if ( enabled ) {
-            result.append( candidate );
+            // the sun light blending depends on the time, so it is not merged into the tiles
+            if ( candidate->blending() == QLatin1String( "SunLightBlending" ) ) {
+                nightResult.append( candidate );
+            } else {
+                result.append( candidate );
+            }
             mDebug() << "enabling texture" << candidate->name();
         } else {
             mDebug() << "disabling texture" << candidate->name();
@@ -154,8 +232,15 @@ void TextureLayer::Private::updateTextureLayers()
 
     updateGroundOverlays();
 
-    m_layerDecorator.setTextureLayers( result );
-    m_tileLoader.clear();
+    // toggling the city lights leaves the day tiles alone
+    if ( result != m_layerDecorator.textureLayers() ) {
+        m_layerDecorator.setTextureLayers( result );
+        m_tileLoader.clear();
+    }
+    if ( nightResult != m_nightLayerDecorator.textureLayers() ) {
+        m_nightLayerDecorator.setTextureLayers( nightResult );
+        m_nightTileLoader.clear();
+    }
 
     m_tileZoomLevel = -1;
     m_parent->setNeedsUpdate();
@@ -166,11 +251,28 @@ void TextureLayer::Private::updateTile( const TileId &tileId, const QImage &tile
     if ( tileImage.isNull() )
         return; // keep tiles in cache to improve performance
 
-    m_tileLoader.updateTile( tileId, tileImage );
+    tileLoader( tileId )->updateTile( tileId, tileImage );
 
     requestDelayedRepaint();
 }
 
+void TextureLayer::Private::dropTile( const TileId &tileId )
+{
+    // the tile only holds a scaled lower level tile, which would stay in the cache
+    tileLoader( tileId )->dropTile( tileId );
+}
+
+StackedTileLoader *TextureLayer::Private::tileLoader( const TileId &tileId )
+{
+    for ( const GeoSceneTextureTileDataset *texture: m_nightLayerDecorator.textureLayers() ) {
+        if ( TileId( texture->sourceDir(), 0, 0, 0 ).mapThemeIdHash() == tileId.mapThemeIdHash() ) {
+            return &m_nightTileLoader;
+        }
+    }
+
+    return &m_tileLoader;
+}
+
 bool TextureLayer::Private::drawOrderLessThan( const GeoDataGroundOverlay* o1, const GeoDataGroundOverlay* o2 )
 {
     return o1->drawOrder() < o2->drawOrder();
@@ -249,6 +351,12 @@ TextureLayer::TextureLayer( HttpDownloadManager *downloadManager,
 {
     connect( &d->m_loader, SIGNAL(tileCompleted(TileId,QImage)),
              this, SLOT(updateTile(TileId,QImage)) );
+    connect( &d->m_loader, SIGNAL(downloadCancelled(TileId)),
+             this, SLOT(dropTile(TileId)) );
+    connect( &d->m_tileLoader, SIGNAL(placeholderReplaced(TileId)),
+             this, SLOT(requestDelayedRepaint()) );
+    connect( &d->m_nightTileLoader, SIGNAL(placeholderReplaced(TileId)),
+             this, SLOT(requestDelayedRepaint()) );
 
     // Repaint timer
     d->m_repaintTimer.setSingleShot( true );
@@ -261,6 +369,7 @@ TextureLayer::~TextureLayer()
 {
     qDeleteAll(d->m_customTextures);
     delete d->m_texmapper;
+    delete d->m_nightTexmapper;
     delete d->m_texcolorizer;
     delete d;
 }
@@ -291,6 +400,11 @@ int TextureLayer::textureLayerCount() const
     return d->m_layerDecorator.textureLayersSize();
 }
 
+QVector<const GeoSceneTextureTileDataset *> TextureLayer::textureLayers() const
+{
+    return d->m_layerDecorator.textureLayers() + d->m_nightLayerDecorator.textureLayers();
+}
+
 bool TextureLayer::showSunShading() const
 {
     return d->m_layerDecorator.showSunShading();
@@ -325,33 +439,50 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
          d->m_centerCoordinates.latitude() != viewport->centerLatitude() ) {
         d->m_centerCoordinates.setLongitude( viewport->centerLongitude() );
         d->m_centerCoordinates.setLatitude( viewport->centerLatitude() );
-        d->m_texmapper->setRepaintNeeded();
+        d->m_texmapper->setCenterChanged();
+        if ( d->m_nightTexmapper ) {
+            d->m_nightTexmapper->setCenterChanged();
+        }
     }
 
-    // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
-    const int levelZeroWidth = d->m_layerDecorator.tileSize().width() * d->m_layerDecorator.tileColumnCount( 0 );
-    const int levelZeroHight = d->m_layerDecorator.tileSize().height() * d->m_layerDecorator.tileRowCount( 0 );
-    const int levelZeroMinDimension = qMin( levelZeroWidth, levelZeroHight );
-
-    // limit to 1 as dirty fix for invalid entry linearLevel
-    const qreal linearLevel = qMax<qreal>( 1.0, viewport->radius() * 4.0 / levelZeroMinDimension );
-
-    // As our tile resolution doubles with each level we calculate
-    // the tile level from tilesize and the globe radius via log(2)
-    const qreal tileLevelF = qLn( linearLevel ) / qLn( 2.0 ) * 1.00001;  // snap to the sharper tile level a tiny bit earlier
-                                                                         // to work around rounding errors when the radius
-                                                                         // roughly equals the global texture width
-
-    const int tileLevel = qMin<int>( d->m_layerDecorator.maximumTileLevel(), tileLevelF );
+    const int tileLevel = Private::tileLevel( d->m_layerDecorator, viewport );
 
     if ( tileLevel != d->m_tileZoomLevel ) {
         d->m_tileZoomLevel = tileLevel;
         emit tileLevelChanged( d->m_tileZoomLevel );
     }
 
+    // let downloads of the tiles around the center go first
+    for ( const GeoSceneTextureTileDataset *texture: d->m_textures ) {
+        d->m_loader.setViewport( texture, viewport->viewLatLonAltBox(), d->m_tileZoomLevel );
+    }
+
     const QRect dirtyRect = QRect( QPoint( 0, 0), viewport->size() );
     d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer );
     d->m_renderState.addChild( d->m_tileLoader.renderState() );
+
+    if ( d->m_nightTexmapper && d->m_nightLayerDecorator.textureLayersSize() > 0 ) {
+        // the night texture replaces the shading, see SunLocator::shadePixelComposite()
+        if ( d->m_nightImage.size() != viewport->size() ) {
+            d->m_nightImage = QImage( viewport->size(), QImage::Format_ARGB32_Premultiplied );
+        }
+        d->m_nightImage.fill( Qt::transparent );
+
+        GeoPainter nightPainter( &d->m_nightImage, viewport, painter->mapQuality() );
+        d->m_nightTexmapper->mapTexture( &nightPainter, viewport, Private::tileLevel( d->m_nightLayerDecorator, viewport ),
+                                         dirtyRect, nullptr );
+        nightPainter.end();
+
+        d->m_sunShading.paintNightImage( painter, viewport, &d->m_nightImage );
+        d->m_renderState.addChild( d->m_nightTileLoader.renderState() );
+    } else if ( showSunShading() ) {
+        d->m_sunShading.paint( painter, viewport );
+    }
+
+    const TextureMapperInterface::LoadStatistics loadStatistics = d->m_texmapper->loadStatistics();
+    if ( loadStatistics.workerCount > 0 ) {
+        d->m_runtimeTrace += QStringLiteral("Load Imbalance: %1 ").arg( loadStatistics.imbalance(), 0, 'f', 2 );
+    }
     return true;
 }
 
@@ -370,23 +501,25 @@ void TextureLayer::setShowRelief( bool show )
 void TextureLayer::setShowSunShading( bool show )
 {
     disconnect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                this, SLOT(reset()) );
+                this, SLOT(updateSunShading()) );
 
     if ( show ) {
         connect( d->m_sunLocator, SIGNAL(positionChanged(qreal,qreal)),
-                 this,       SLOT(reset()) );
+                 this,       SLOT(updateSunShading()) );
     }
 
     d->m_layerDecorator.setShowSunShading( show );
 
-    reset();
+    // the shading is painted over the map
+    setNeedsUpdate();
 }
 
 void TextureLayer::setShowCityLights( bool show )
 {
     d->m_layerDecorator.setShowCityLights( show );
 
-    reset();
+    // the city lights are toggled as a texture layer, which updates the tiles
+    setNeedsUpdate();
 }
 
 void TextureLayer::setShowTileId( bool show )
@@ -402,32 +535,16 @@ void TextureLayer::setProjection( Projection projection )
         return;
     }
 
-    // FIXME: replace this with an approach based on the factory method pattern.
     delete d->m_texmapper;
+    d->m_texmapper = Private::createTextureMapper( projection, &d->m_tileLoader, d->m_textures.at( 0 ) );
 
-    switch( projection ) {
-        case Spherical:
-            d->m_texmapper = new SphericalScanlineTextureMapper( &d->m_tileLoader );
-            break;
-        case Equirectangular:
-            d->m_texmapper = new EquirectScanlineTextureMapper( &d->m_tileLoader );
+    delete d->m_nightTexmapper;
+    d->m_nightTexmapper = nullptr;
+    for ( const GeoSceneTextureTileDataset *texture: d->m_textures ) {
+        if ( texture->blending() == QLatin1String( "SunLightBlending" ) ) {
+            d->m_nightTexmapper = Private::createTextureMapper( projection, &d->m_nightTileLoader, texture );
             break;
-        case Mercator:
-            if (d->m_textures.at(0)->tileProjectionType() == GeoSceneAbstractTileProjection::Mercator) {
-                d->m_texmapper = new TileScalingTextureMapper( &d->m_tileLoader );
-            } else {
-                d->m_texmapper = new MercatorScanlineTextureMapper( &d->m_tileLoader );
-            }
-            break;
-        case Gnomonic:
-        case Stereographic:
-        case LambertAzimuthal:
-        case AzimuthalEquidistant:
-        case VerticalPerspective:
-            d->m_texmapper = new GenericScanlineTextureMapper( &d->m_tileLoader );
-            break;
-        default:
-            d->m_texmapper = nullptr;
+        }
     }
     Q_ASSERT( d->m_texmapper );
 }
@@ -437,6 +554,9 @@ void TextureLayer::setNeedsUpdate()
     if ( d->m_texmapper ) {
         d->m_texmapper->setRepaintNeeded();
     }
+    if ( d->m_nightTexmapper ) {
+        d->m_nightTexmapper->setRepaintNeeded();
+    }
 
     emit repaintNeeded();
 }
@@ -444,11 +564,13 @@ void TextureLayer::setNeedsUpdate()
 void TextureLayer::setVolatileCacheLimit( quint64 kilobytes )
 {
     d->m_tileLoader.setVolatileCacheLimit( kilobytes );
+    d->m_nightTileLoader.setVolatileCacheLimit( kilobytes );
 }
 
 void TextureLayer::reset()
 {
     d->m_tileLoader.clear();
+    d->m_nightTileLoader.clear();
     setNeedsUpdate();
 }
 
@@ -467,6 +589,20 @@ void TextureLayer::downloadStackedTile( const TileId &stackedTileId )
     d->m_layerDecorator.downloadStackedTile( stackedTileId, DownloadBulk );
 }
 
+void TextureLayer::updateDownloadedTile( const TileId &tileId, const QByteArray &data )
+{
+    StackedTileLoader *const tileLoader = d->tileLoader( tileId );
+    const TileId stackedTileId( 0, tileId.zoomLevel(), tileId.x(), tileId.y() );
+
+    if ( !tileLoader->visibleTiles().contains( stackedTileId ) ) {
+        // decoding every tile of a bulk download would keep the GUI thread busy
+        tileLoader->dropTile( tileId );
+        return;
+    }
+
+    d->updateTile( tileId, QImage::fromData( data ) );
+}
+
 void TextureLayer::setMapTheme( const QVector<const GeoSceneTextureTileDataset *> &textures, const GeoSceneGroup *textureLayerSettings, const QString &seaFile, const QString &landFile )
 {
     delete d->m_texcolorizer;
@@ -480,6 +616,10 @@ void TextureLayer::setMapTheme( const QVector<const GeoSceneTextureTileDataset *
     d->addCustomTextures();
     d->m_textureLayerSettings = textureLayerSettings;
 
+    // the ground overlays depend on the colorizer
+    d->m_tileLoader.clear();
+    d->m_nightTileLoader.clear();
+
     if ( d->m_textureLayerSettings ) {
         connect( d->m_textureLayerSettings, SIGNAL(valueChanged(QString,bool)),
                  this,                      SLOT(updateTextureLayers()) );
@@ -518,6 +658,21 @@ quint64 TextureLayer::volatileCacheLimit() const
     return d->m_tileLoader.volatileCacheLimit();
 }
 
+int TextureLayer::tileCacheHits() const
+{
+    return d->m_tileLoader.cacheHits();
+}
+
+int TextureLayer::tileCacheMisses() const
+{
+    return d->m_tileLoader.cacheMisses();
+}
+
+void TextureLayer::resetTileCacheStatistics()
+{
+    d->m_tileLoader.resetCacheStatistics();
+}
+
 int TextureLayer::preferredRadiusCeil( int radius ) const
 {
     if (!d->m_layerDecorator.hasTextureLayer()) {
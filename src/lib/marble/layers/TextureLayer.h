@@ -54,6 +54,11 @@ class MARBLE_EXPORT TextureLayer : public QObject, public LayerInterface
 
     int textureLayerCount() const;
 
+    /**
+     * Returns the texture layers which are currently shown.
+     */
+    QVector<const GeoSceneTextureTileDataset *> textureLayers() const;
+
     /**
      * @brief Adds texture sublayer, taking ownership of the object's memory
      *        Does nothing if a texture with the same source directory was already
@@ -87,6 +92,14 @@ class MARBLE_EXPORT TextureLayer : public QObject, public LayerInterface
 
     quint64 volatileCacheLimit() const;
 
+    /**
+     * @brief Number of tiles taken from the volatile cache, and number of
+     * tiles that had to be loaded, since the last resetTileCacheStatistics()
+     */
+    int tileCacheHits() const;
+    int tileCacheMisses() const;
+    void resetTileCacheStatistics();
+
     int preferredRadiusCeil( int radius ) const;
     int preferredRadiusFloor( int radius ) const;
 
@@ -125,14 +138,23 @@ public Q_SLOTS:
 
     void downloadStackedTile( const TileId &stackedTileId );
 
+    /**
+     * Updates the tile @p tileId after it has been downloaded apart from the
+     * browse downloads, e.g. by a BulkTileDownloader. Only tiles on display are
+     * decoded from @p data, the others are loaded again when they are needed.
+     */
+    void updateDownloadedTile( const TileId &tileId, const QByteArray &data );
+
  Q_SIGNALS:
     void tileLevelChanged( int );
     void repaintNeeded();
 
  private:
     Q_PRIVATE_SLOT( d, void requestDelayedRepaint() )
+    Q_PRIVATE_SLOT( d, void updateSunShading() )
     Q_PRIVATE_SLOT( d, void updateTextureLayers() )
     Q_PRIVATE_SLOT( d, void updateTile( const TileId &tileId, const QImage &tileImage ) )
+    Q_PRIVATE_SLOT( d, void dropTile( const TileId &tileId ) )
     Q_PRIVATE_SLOT( d, void addGroundOverlays( const QModelIndex& parent, int first, int last ) )
     Q_PRIVATE_SLOT( d, void removeGroundOverlays( const QModelIndex& parent, int first, int last ) )
     Q_PRIVATE_SLOT( d, void resetGroundOverlaysCache() )
@@ -14,6 +14,7 @@
 #include "VectorTileLayer.h"
 
 #include <qmath.h>
+#include <QThread>
 #include <QThreadPool>
 
 #include "VectorTileModel.h"
@@ -69,7 +70,8 @@ VectorTileLayer::Private::Private(HttpDownloadManager *downloadManager,
     m_layerSettings(nullptr),
     m_treeModel(treeModel)
 {
-    m_threadPool.setMaxThreadCount(1);
+    // leave one core to the GUI thread, which turns the loaded tiles into graphics items
+    m_threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
 }
 
 VectorTileLayer::Private::~Private()
@@ -186,6 +188,8 @@ void VectorTileLayer::reset()
 
 void VectorTileLayer::setMapTheme(const QVector<const GeoSceneVectorTileDataset *> &textures, const GeoSceneGroup *textureLayerSettings)
 {
+    // tiles queued for the old theme are not needed anymore
+    d->m_threadPool.clear();
     qDeleteAll(d->m_tileModels);
     d->m_tileModels.clear();
     d->m_activeTileModels.clear();
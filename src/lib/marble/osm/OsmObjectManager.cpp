@@ -21,7 +21,7 @@
 
 namespace Marble {
 
-qint64 OsmObjectManager::m_minId = -1;
+QAtomicInteger<qint64> OsmObjectManager::m_minId( -1 );
 
 void OsmObjectManager::initializeOsmData( GeoDataPlacemark* placemark )
 {
@@ -117,7 +117,10 @@ void OsmObjectManager::initializeOsmData( GeoDataPlacemark* placemark )
 
 void OsmObjectManager::registerId( qint64 id )
 {
-    m_minId = qMin( id, m_minId );
+    qint64 minId = m_minId.load();
+    while ( id < minId && !m_minId.testAndSetOrdered( minId, id, minId ) ) {
+        // another thread changed the minimum, retry with its value
+    }
 }
 
 }
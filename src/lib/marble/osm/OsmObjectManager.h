@@ -12,6 +12,7 @@
 #define MARBLE_OSMOBJECTMANAGER_H
 
 #include <marble_export.h>
+#include <QAtomicInteger>
 #include <QtGlobal>
 
 namespace Marble
@@ -43,9 +44,9 @@ private:
     /**
      * @brief newly created placemarks are assigned negative unique IDs.
      * In order to assure there are no duplicate IDs, they are assigned the
-     * minId - 1 id.
+     * minId - 1 id. Atomic as placemarks may be initialized from several threads.
      */
-    static qint64 m_minId;
+    static QAtomicInteger<qint64> m_minId;
 };
 
 }
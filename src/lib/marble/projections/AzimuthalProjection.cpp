@@ -48,7 +48,8 @@ bool AzimuthalProjection::screenCoordinates( const GeoDataLineString &lineString
         return false;
     }
 
-    d->lineStringToPolygon( lineString, viewport, polygons );
+    const int level = d->levelForResolution( viewport->angularResolution() );
+    d->lineStringToPolygon( lineString.simplified( level ), viewport, polygons );
     return true;
 }
 
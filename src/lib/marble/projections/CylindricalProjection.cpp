@@ -95,7 +95,9 @@ bool CylindricalProjection::screenCoordinates( const GeoDataLineString &lineStri
     }
 
     QVector<QPolygonF *> subPolygons;
-    d->lineStringToPolygon( lineString, viewport, subPolygons );
+    // Zoomed out views only need the nodes that differ by at least half a pixel
+    const int level = d->levelForResolution( viewport->angularResolution() );
+    d->lineStringToPolygon( lineString.simplified( level ), viewport, subPolygons );
 
     polygons << subPolygons;
     return polygons.isEmpty();
@@ -10,14 +10,73 @@
 
 #include "Route.h"
 
+#include "MarbleGlobal.h"
+
+#include <qmath.h>
+
+#include <limits>
+
 namespace Marble
 {
 
+namespace
+{
+    /** Edge length of the cells of the segment grid, in radians (about 30 km) */
+    const qreal segmentGridCellSize = 0.005;
+
+    const int segmentGridColumns = qCeil( 2 * M_PI / segmentGridCellSize );
+
+    /** Segments before and after the last closest one that are always examined */
+    const int positionSearchWindow = 4;
+
+    int gridColumn( qreal lon )
+    {
+        return qBound( 0, int( ( lon + M_PI ) / segmentGridCellSize ), segmentGridColumns - 1 );
+    }
+
+    int gridRow( qreal lat )
+    {
+        return int( ( lat + M_PI / 2 ) / segmentGridCellSize );
+    }
+
+    quint64 gridCell( int row, int column )
+    {
+        return ( quint64( row ) << 32 ) | quint64( column );
+    }
+
+    /**
+     * Calls @p function for each grid cell overlapping the given bounds, which
+     * may cross the date line (west > east). Returns false without calling
+     * @p function if more than @p maxCells cells would be visited.
+     */
+    template<class Function>
+    bool forEachGridCell( qreal north, qreal south, qreal east, qreal west, int maxCells, Function function )
+    {
+        const int firstRow = gridRow( south );
+        const int lastRow = gridRow( north );
+        const int firstColumn = gridColumn( west );
+        const int lastColumn = gridColumn( east );
+        const int columns = firstColumn <= lastColumn ? lastColumn - firstColumn + 1
+                                                      : segmentGridColumns - firstColumn + lastColumn + 1;
+        if ( qint64( columns ) * ( lastRow - firstRow + 1 ) > maxCells ) {
+            return false;
+        }
+
+        for ( int row = firstRow; row <= lastRow; ++row ) {
+            for ( int i = 0; i < columns; ++i ) {
+                function( gridCell( row, ( firstColumn + i ) % segmentGridColumns ) );
+            }
+        }
+        return true;
+    }
+}
+
 Route::Route() :
     m_distance( 0.0 ),
     m_travelTime( 0 ),
     m_positionDirty( true ),
-    m_closestSegmentIndex( -1 )
+    m_closestSegmentIndex( -1 ),
+    m_segmentStampGeneration( 0 )
 {
     // nothing to do
 }
@@ -34,15 +93,87 @@ void Route::addRouteSegment( const RouteSegment &segment )
         if ( segment.maneuver().hasWaypoint() ) {
             m_waypoints << segment.maneuver().waypoint();
         }
+        const RouteSegment *const segments = m_segments.constData();
         m_segments.push_back( segment );
         m_positionDirty = true;
 
-        for ( int i=1; i<m_segments.size(); ++i ) {
-            m_segments[i-1].setNextRouteSegment(&m_segments[i]);
+        if ( m_segments.constData() == segments ) {
+            if ( m_segments.size() > 1 ) {
+                m_segments[m_segments.size()-2].setNextRouteSegment( &m_segments.last() );
+            }
+        } else {
+            // the segments were moved in memory, update all links
+            for ( int i=1; i<m_segments.size(); ++i ) {
+                m_segments[i-1].setNextRouteSegment(&m_segments[i]);
+            }
         }
+
+        indexSegment( m_segments.size() - 1 );
     }
 }
 
+void Route::indexSegment( int index )
+{
+    qreal north, south, east, west;
+    m_segments[index].bounds().boundaries( north, south, east, west );
+    forEachGridCell( north, south, east, west, std::numeric_limits<int>::max(), [this, index]( quint64 cell ) {
+        m_segmentGrid[cell] << index;
+    } );
+}
+
+QVector<int> Route::segmentsNear( qreal distance ) const
+{
+    QVector<int> result;
+
+    // Grow the position to a box containing all points within the given distance
+    const qreal radius = 1.001 * distance / EARTH_RADIUS;
+    const qreal lat = m_position.latitude();
+    const qreal maxLat = qAbs( lat ) + radius;
+    const qreal north = qMin( lat + radius, M_PI / 2 );
+    const qreal south = qMax( lat - radius, -M_PI / 2 );
+    qreal east = M_PI;
+    qreal west = -M_PI;
+    if ( maxLat < M_PI / 2 && radius < M_PI / 2 ) {
+        const qreal sinLonRadius = qSin( radius / 2 ) / qCos( maxLat );
+        if ( sinLonRadius < 1.0 ) {
+            const qreal lonRadius = 2 * qAsin( sinLonRadius );
+            east = GeoDataCoordinates::normalizeLon( m_position.longitude() + lonRadius );
+            west = GeoDataCoordinates::normalizeLon( m_position.longitude() - lonRadius );
+        }
+    }
+
+    // Segments spanning several cells are reported once, those stamped with
+    // the current generation have been seen already. The stamps are reset
+    // only when the generation counter wraps around.
+    if ( m_segmentStamps.size() != m_segments.size() || ++m_segmentStampGeneration == 0 ) {
+        m_segmentStamps.fill( 0, m_segments.size() );
+        m_segmentStampGeneration = 1;
+    }
+    const quint32 generation = m_segmentStampGeneration;
+
+    // Visiting more cells than there are segments is slower than checking them all
+    const bool indexed = forEachGridCell( north, south, east, west, m_segments.size(), [&]( quint64 cell ) {
+        const auto iter = m_segmentGrid.constFind( cell );
+        if ( iter != m_segmentGrid.constEnd() ) {
+            for ( int index: *iter ) {
+                if ( m_segmentStamps[index] != generation ) {
+                    m_segmentStamps[index] = generation;
+                    result << index;
+                }
+            }
+        }
+    } );
+
+    if ( !indexed ) {
+        result.resize( m_segments.size() );
+        for ( int i=0; i<m_segments.size(); ++i ) {
+            result[i] = i;
+        }
+    }
+
+    return result;
+}
+
 GeoDataLatLonBox Route::bounds() const
 {
     return m_bounds;
@@ -106,16 +237,33 @@ void Route::updatePosition() const
             m_closestSegmentIndex = 0;
         }
 
+        // Positions usually move along the route, so the segments around the last
+        // closest one give a tight upper bound for the distance to the route
         qreal distance = m_segments[m_closestSegmentIndex].distanceTo( m_position, m_currentWaypoint, m_positionOnRoute );
-        QList<int> candidates;
+        const int windowStart = qMax( 0, m_closestSegmentIndex - positionSearchWindow );
+        const int windowEnd = qMin( m_segments.size() - 1, m_closestSegmentIndex + positionSearchWindow );
+        GeoDataCoordinates closest, interpolated;
+        for ( int i=windowStart; i<=windowEnd; ++i ) {
+            if ( i == m_closestSegmentIndex ) {
+                continue;
+            }
+            qreal const dist = m_segments[i].distanceTo( m_position, closest, interpolated );
+            if ( dist < distance ) {
+                distance = dist;
+                m_closestSegmentIndex = i;
+                m_positionOnRoute = interpolated;
+                m_currentWaypoint = closest;
+            }
+        }
 
-        for ( int i=0; i<m_segments.size(); ++i ) {
-            if ( i != m_closestSegmentIndex && m_segments[i].minimalDistanceTo( m_position ) <= distance ) {
+        // Only segments with bounds within that distance can be closer
+        QVector<int> candidates;
+        for ( int i: segmentsNear( distance ) ) {
+            if ( ( i < windowStart || i > windowEnd ) && m_segments[i].minimalDistanceTo( m_position ) <= distance ) {
                 candidates << i;
             }
         }
 
-        GeoDataCoordinates closest, interpolated;
         for( int i: candidates ) {
             qreal const dist = m_segments[i].distanceTo( m_position, closest, interpolated );
             if ( distance < 0.0 || dist < distance ) {
@@ -14,6 +14,9 @@
 #include "RouteSegment.h"
 #include "GeoDataLatLonBox.h"
 
+#include <QHash>
+#include <QVector>
+
 namespace Marble
 {
 
@@ -55,6 +58,15 @@ public:
 private:
     void updatePosition() const;
 
+    /** Adds segment @p index to the grid cells overlapped by its bounds */
+    void indexSegment( int index );
+
+    /**
+     * Returns the indices of all segments whose bounds may be within
+     * @p distance meters of the current position
+     */
+    QVector<int> segmentsNear( qreal distance ) const;
+
     GeoDataLatLonBox m_bounds;
 
     qreal m_distance;
@@ -78,6 +90,14 @@ private:
     mutable GeoDataCoordinates m_currentWaypoint;
 
     GeoDataCoordinates m_position;
+
+    /** Grid of the segments' bounding boxes, keyed by cell, see indexSegment() */
+    QHash<quint64, QVector<int> > m_segmentGrid;
+
+    /** Query generation that last reported each segment in segmentsNear() */
+    mutable QVector<quint32> m_segmentStamps;
+
+    mutable quint32 m_segmentStampGeneration;
 };
 
 }
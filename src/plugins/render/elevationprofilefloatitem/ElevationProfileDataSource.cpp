@@ -38,13 +38,26 @@ ElevationProfileDataSource::ElevationProfileDataSource( QObject *parent ) :
 
 QVector<QPointF> ElevationProfileDataSource::calculateElevationData(const GeoDataLineString &lineString) const
 {
+    QVector<qreal> elevations;
+    elevations.reserve( lineString.size() );
+    for ( int i = 0; i < lineString.size(); i++ ) {
+        elevations << getElevation( lineString[i] );
+    }
+
+    return calculateElevationData( lineString, elevations );
+}
+
+QVector<QPointF> ElevationProfileDataSource::calculateElevationData(const GeoDataLineString &lineString, const QVector<qreal> &elevations) const
+{
+    Q_ASSERT( elevations.size() == lineString.size() );
+
     // TODO: Don't re-calculate the whole route if only a small part of it was changed
     QVector<QPointF> result;
     qreal distance = 0;
 
     //GeoDataLineString path;
     for ( int i = 0; i < lineString.size(); i++ ) {
-        const qreal ele = getElevation( lineString[i] );
+        const qreal ele = elevations[i];
 
         if ( i ) {
             distance += EARTH_RADIUS * lineString[i-1].sphericalDistanceTo(lineString[i]);
@@ -215,6 +228,7 @@ ElevationProfileRouteDataSource::ElevationProfileRouteDataSource( const RoutingM
     m_elevationModel( elevationModel ),
     m_routeAvailable( false )
 {
+    connect( &m_elevationWatcher, SIGNAL(finished()), SLOT(handleElevationsReady()) );
 }
 
 void ElevationProfileRouteDataSource::requestUpdate()
@@ -225,9 +239,16 @@ void ElevationProfileRouteDataSource::requestUpdate()
         m_routeAvailable = isDataAvailable();
     }
 
-    const GeoDataLineString routePoints = m_routingModel->route().path();
-    const QVector<QPointF> elevationData = calculateElevationData(routePoints);
-    emit dataUpdated( routePoints, elevationData );
+    // query the elevations in the background, long routes would block the UI otherwise;
+    // setting a new future drops the result of a still running outdated query
+    m_pendingRoute = m_routingModel->route().path();
+    m_elevationWatcher.setFuture( m_elevationModel->heights( m_pendingRoute ) );
+}
+
+void ElevationProfileRouteDataSource::handleElevationsReady()
+{
+    const QVector<QPointF> elevationData = calculateElevationData( m_pendingRoute, m_elevationWatcher.result() );
+    emit dataUpdated( m_pendingRoute, elevationData );
 }
 
 bool ElevationProfileRouteDataSource::isDataAvailable() const
@@ -13,8 +13,11 @@
 #ifndef ELEVATIONPROFILEDATASOURCE_H
 #define ELEVATIONPROFILEDATASOURCE_H
 
+#include "GeoDataLineString.h"
+
 #include <QObject>
 
+#include <QFutureWatcher>
 #include <QHash>
 #include <QList>
 #include <QPointF>
@@ -25,7 +28,6 @@ namespace Marble
 
 class ElevationModel;
 class GeoDataCoordinates;
-class GeoDataLineString;
 class GeoDataObject;
 class GeoDataTrack;
 class GeoDataTreeModel;
@@ -53,6 +55,7 @@ Q_SIGNALS:
 
 protected:
     QVector<QPointF> calculateElevationData(const GeoDataLineString &lineString) const;
+    QVector<QPointF> calculateElevationData(const GeoDataLineString &lineString, const QVector<qreal> &elevations) const;
     virtual qreal getElevation(const GeoDataCoordinates &coordinates) const = 0;
 };
 
@@ -109,10 +112,15 @@ public Q_SLOTS:
 protected:
     qreal getElevation(const GeoDataCoordinates &coordinates) const override;
 
+private Q_SLOTS:
+    void handleElevationsReady();
+
 private:
     const RoutingModel *const m_routingModel;
     const ElevationModel *const m_elevationModel;
     bool m_routeAvailable; // save state if route is available to notify FloatItem when this changes
+    GeoDataLineString m_pendingRoute; // route whose elevations are being queried
+    QFutureWatcher<QVector<qreal> > m_elevationWatcher;
 };
 
 }
@@ -0,0 +1,88 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CACHEFORMAT_H
+#define MARBLE_CACHEFORMAT_H
+
+#include <QtEndian>
+#include <QtGlobal>
+
+#include <cstring>
+
+namespace Marble
+{
+
+/**
+ * Layout of the memory-mappable placemark cache format. All values are
+ * stored in little endian byte order:
+ *
+ * - a header of HeaderSize bytes,
+ * - recordCount records of RecordSize bytes, one per placemark,
+ * - stringCount + 1 offsets (quint32) of the strings in the string data,
+ *   the last one being the size of the string data,
+ * - the UTF-8 encoded string data.
+ *
+ * The records refer to strings by their index in the string table. The first
+ * string is the empty string. The magic number differs from the one of the
+ * field by field QDataStream format, so older versions of Marble reject the
+ * file instead of misreading it.
+ */
+namespace CacheFormat
+{
+    /// The QDataStream format written by earlier versions of kml2cache
+    const quint32 StreamMagicNumber = 0x31415926;
+    const qint32 StreamVersion = 015;
+
+    /// "MPLC" in little endian byte order
+    const quint32 MappedMagicNumber = 0x434c504d;
+    const quint32 MappedVersion = 1;
+
+    enum HeaderField {
+        HeaderMagic = 0,            // quint32
+        HeaderVersion = 4,          // quint32
+        HeaderRecordCount = 8,      // quint32
+        HeaderStringCount = 12,     // quint32
+        HeaderRecordSize = 16,      // quint32
+        HeaderSize = 32
+    };
+
+    enum RecordField {
+        RecordLongitude = 0,        // double, radian
+        RecordLatitude = 8,         // double, radian
+        RecordAltitude = 16,        // double
+        RecordArea = 24,            // double
+        RecordPopulation = 32,      // qint64
+        RecordName = 40,            // quint32 string index
+        RecordRole = 44,            // quint32 string index
+        RecordDescription = 48,     // quint32 string index
+        RecordCountryCode = 52,     // quint32 string index
+        RecordState = 56,           // quint32 string index
+        RecordGmt = 60,             // qint16
+        RecordDst = 62,             // qint8
+        RecordSize = 64
+    };
+
+    inline double readDouble( const uchar *data )
+    {
+        const quint64 bits = qFromLittleEndian<quint64>( data );
+        double value;
+        std::memcpy( &value, &bits, sizeof( value ) );
+        return value;
+    }
+
+    inline void writeDouble( double value, uchar *data )
+    {
+        quint64 bits;
+        std::memcpy( &bits, &value, sizeof( bits ) );
+        qToLittleEndian<quint64>( bits, data );
+    }
+}
+
+}
+
+#endif
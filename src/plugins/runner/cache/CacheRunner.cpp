@@ -9,6 +9,7 @@
 
 #include "CacheRunner.h"
 
+#include "CacheFormat.h"
 #include "GeoDataDocument.h"
 #include "GeoDataExtendedData.h"
 #include "GeoDataData.h"
@@ -17,13 +18,13 @@
 
 #include <QFile>
 #include <QDataStream>
+#include <QHash>
 #include <QSet>
+#include <QVector>
 
 namespace Marble
 {
 
-const quint32 MarbleMagicNumber = 0x31415926;
-
 CacheRunner::CacheRunner(QObject *parent) :
     ParsingRunner(parent)
 {
@@ -42,22 +43,55 @@ GeoDataDocument* CacheRunner::parseFile( const QString &fileName, DocumentRole r
         return nullptr;
     }
 
-    file.open( QIODevice::ReadOnly );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        error = QStringLiteral("Cannot open cache file %1").arg(fileName);
+        mDebug() << error;
+        return nullptr;
+    }
+
+    GeoDataDocument *document = nullptr;
+    uchar magic[4];
+    if ( file.peek( reinterpret_cast<char*>( magic ), sizeof( magic ) ) == sizeof( magic ) &&
+         qFromLittleEndian<quint32>( magic ) == CacheFormat::MappedMagicNumber ) {
+        // Files in the Qt resource system cannot be mapped
+        const qint64 size = file.size();
+        if ( const uchar *data = file.map( 0, size ) ) {
+            document = parseMapped( fileName, data, size, error );
+        } else {
+            const QByteArray content = file.readAll();
+            document = parseMapped( fileName, reinterpret_cast<const uchar*>( content.constData() ), content.size(), error );
+        }
+    } else {
+        document = parseStream( file, error );
+    }
+
+    if ( document ) {
+        document->setDocumentRole( role );
+        document->setFileName( fileName );
+    } else if ( !error.isEmpty() ) {
+        mDebug() << error;
+    }
+
+    file.close();
+    return document;
+}
+
+GeoDataDocument* CacheRunner::parseStream( QFile &file, QString& error )
+{
     QDataStream in( &file );
 
     // Read and check the header
     quint32 magic;
     in >> magic;
-    if ( magic != MarbleMagicNumber ) {
+    if ( magic != CacheFormat::StreamMagicNumber ) {
         return nullptr;
     }
 
     // Read the version
     qint32 version;
     in >> version;
-    if ( version < 015 ) {
-        error = QStringLiteral("Bad cache file %1: Version %2 is too old, need 15 or later").arg(fileName).arg(version);
-        mDebug() << error;
+    if ( version < CacheFormat::StreamVersion ) {
+        error = QStringLiteral("Bad cache file %1: Version %2 is too old, need 15 or later").arg(file.fileName()).arg(version);
         return nullptr;
     }
     /*
@@ -67,7 +101,6 @@ GeoDataDocument* CacheRunner::parseFile( const QString &fileName, DocumentRole r
       }
     */
     GeoDataDocument *document = new GeoDataDocument();
-    document->setDocumentRole( role );
 
     in.setVersion( QDataStream::Qt_4_2 );
 
@@ -113,9 +146,103 @@ GeoDataDocument* CacheRunner::parseFile( const QString &fileName, DocumentRole r
 
         document->append( mark );
     }
-    document->setFileName( fileName );
 
-    file.close();
+    return document;
+}
+
+GeoDataDocument* CacheRunner::parseMapped( const QString &fileName, const uchar *data, qint64 size, QString& error )
+{
+    using namespace CacheFormat;
+
+    if ( size < HeaderSize ) {
+        error = QStringLiteral("Bad cache file %1: Truncated header").arg(fileName);
+        return nullptr;
+    }
+
+    const quint32 version = qFromLittleEndian<quint32>( data + HeaderVersion );
+    if ( version != MappedVersion ) {
+        error = QStringLiteral("Bad cache file %1: Unsupported version %2").arg(fileName).arg(version);
+        return nullptr;
+    }
+
+    const quint32 recordCount = qFromLittleEndian<quint32>( data + HeaderRecordCount );
+    const quint32 stringCount = qFromLittleEndian<quint32>( data + HeaderStringCount );
+    const quint32 recordSize = qFromLittleEndian<quint32>( data + HeaderRecordSize );
+    const qint64 offsetsStart = HeaderSize + qint64( recordCount ) * recordSize;
+    const qint64 stringsStart = offsetsStart + ( qint64( stringCount ) + 1 ) * sizeof( quint32 );
+    if ( recordSize < RecordSize || stringCount == 0 || stringsStart > size ||
+         stringsStart + qFromLittleEndian<quint32>( data + stringsStart - sizeof( quint32 ) ) > size ) {
+        error = QStringLiteral("Bad cache file %1: Truncated data").arg(fileName);
+        return nullptr;
+    }
+
+    const uchar *offsets = data + offsetsStart;
+    const char *strings = reinterpret_cast<const char*>( data + stringsStart );
+
+    // Strings are decoded on first use, and shared by all placemarks using them
+    QVector<QString> stringTable( stringCount );
+    QVector<bool> decoded( stringCount, false );
+    bool valid = true;
+    auto const string = [&]( const uchar *field ) {
+        const quint32 index = qFromLittleEndian<quint32>( field );
+        if ( index >= stringCount ) {
+            valid = false;
+            return QString();
+        }
+        if ( !decoded[index] ) {
+            const quint32 begin = qFromLittleEndian<quint32>( offsets + index * sizeof( quint32 ) );
+            const quint32 end = qFromLittleEndian<quint32>( offsets + ( index + 1 ) * sizeof( quint32 ) );
+            if ( begin <= end && end <= qFromLittleEndian<quint32>( offsets + stringCount * sizeof( quint32 ) ) ) {
+                stringTable[index] = QString::fromUtf8( strings + begin, end - begin );
+            } else {
+                valid = false;
+            }
+            decoded[index] = true;
+        }
+        return stringTable[index];
+    };
+
+    // Most placemarks share the few time zones, so share their extended data as well
+    QHash<int, GeoDataExtendedData> timeZones;
+    const QString gmtId = QStringLiteral("gmt");
+    const QString dstId = QStringLiteral("dst");
+
+    GeoDataDocument *document = new GeoDataDocument();
+    const uchar *record = data + HeaderSize;
+    for ( quint32 i = 0; i < recordCount && valid; ++i, record += recordSize ) {
+        GeoDataPlacemark *mark = new GeoDataPlacemark;
+        mark->setName( string( record + RecordName ) );
+        mark->setCoordinate( readDouble( record + RecordLongitude ),
+                             readDouble( record + RecordLatitude ),
+                             readDouble( record + RecordAltitude ) );
+        mark->setRole( string( record + RecordRole ) );
+        mark->setDescription( string( record + RecordDescription ) );
+        mark->setCountryCode( string( record + RecordCountryCode ) );
+        mark->setState( string( record + RecordState ) );
+        mark->setArea( readDouble( record + RecordArea ) );
+        mark->setPopulation( qFromLittleEndian<qint64>( record + RecordPopulation ) );
+
+        const int gmt = qFromLittleEndian<qint16>( record + RecordGmt );
+        const int dst = qint8( record[RecordDst] );
+        const int timeZone = ( gmt << 8 ) | ( dst & 0xff );
+        auto iter = timeZones.find( timeZone );
+        if ( iter == timeZones.end() ) {
+            GeoDataExtendedData extendedData;
+            extendedData.addValue( GeoDataData( gmtId, gmt ) );
+            extendedData.addValue( GeoDataData( dstId, dst ) );
+            iter = timeZones.insert( timeZone, extendedData );
+        }
+        mark->setExtendedData( iter.value() );
+
+        document->append( mark );
+    }
+
+    if ( !valid ) {
+        delete document;
+        error = QStringLiteral("Bad cache file %1: Invalid string reference").arg(fileName);
+        return nullptr;
+    }
+
     return document;
 }
 
@@ -12,6 +12,8 @@
 
 #include "ParsingRunner.h"
 
+class QFile;
+
 namespace Marble
 {
 
@@ -23,6 +25,12 @@ public:
     ~CacheRunner() override;
     GeoDataDocument* parseFile( const QString &fileName, DocumentRole role, QString& error ) override;
 
+private:
+    /** Reads the field by field QDataStream format */
+    static GeoDataDocument* parseStream( QFile &file, QString& error );
+
+    /** Reads the memory-mappable format described in CacheFormat.h */
+    static GeoDataDocument* parseMapped( const QString &fileName, const uchar *data, qint64 size, QString& error );
 };
 
 }
@@ -0,0 +1,105 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "CacheWriter.h"
+
+#include "CacheFormat.h"
+#include "GeoDataData.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataFolder.h"
+#include "GeoDataPlacemark.h"
+
+#include <QIODevice>
+
+namespace Marble
+{
+
+bool CacheWriter::write(QIODevice *device, const GeoDataDocument &document)
+{
+    if (!device || !device->isWritable()) {
+        return false;
+    }
+
+    QVector<const GeoDataPlacemark*> placemarks;
+    collectPlacemarks(&document, placemarks);
+
+    StringTable stringTable;
+    QVector<QString> strings;
+    stringIndex(QString(), stringTable, strings);
+
+    QByteArray records(placemarks.size() * CacheFormat::RecordSize, '\0');
+    uchar *record = reinterpret_cast<uchar*>(records.data());
+    for (const GeoDataPlacemark *placemark: placemarks) {
+        qreal lon, lat, alt;
+        placemark->coordinate().geoCoordinates(lon, lat, alt);
+        CacheFormat::writeDouble(lon, record + CacheFormat::RecordLongitude);
+        CacheFormat::writeDouble(lat, record + CacheFormat::RecordLatitude);
+        CacheFormat::writeDouble(alt, record + CacheFormat::RecordAltitude);
+        CacheFormat::writeDouble(placemark->area(), record + CacheFormat::RecordArea);
+        qToLittleEndian<qint64>(placemark->population(), record + CacheFormat::RecordPopulation);
+        qToLittleEndian<quint32>(stringIndex(placemark->name(), stringTable, strings), record + CacheFormat::RecordName);
+        qToLittleEndian<quint32>(stringIndex(placemark->role(), stringTable, strings), record + CacheFormat::RecordRole);
+        qToLittleEndian<quint32>(stringIndex(placemark->description(), stringTable, strings), record + CacheFormat::RecordDescription);
+        qToLittleEndian<quint32>(stringIndex(placemark->countryCode(), stringTable, strings), record + CacheFormat::RecordCountryCode);
+        qToLittleEndian<quint32>(stringIndex(placemark->state(), stringTable, strings), record + CacheFormat::RecordState);
+        const GeoDataExtendedData &extendedData = placemark->extendedData();
+        qToLittleEndian<qint16>(extendedData.value(QStringLiteral("gmt")).value().toInt(), record + CacheFormat::RecordGmt);
+        record[CacheFormat::RecordDst] = uchar(qint8(extendedData.value(QStringLiteral("dst")).value().toInt()));
+        record += CacheFormat::RecordSize;
+    }
+
+    QByteArray offsets((strings.size() + 1) * sizeof(quint32), '\0');
+    QByteArray stringData;
+    uchar *offset = reinterpret_cast<uchar*>(offsets.data());
+    for (const QString &string: strings) {
+        qToLittleEndian<quint32>(stringData.size(), offset);
+        offset += sizeof(quint32);
+        stringData += string.toUtf8();
+    }
+    qToLittleEndian<quint32>(stringData.size(), offset);
+
+    QByteArray header(CacheFormat::HeaderSize, '\0');
+    uchar *headerData = reinterpret_cast<uchar*>(header.data());
+    qToLittleEndian<quint32>(CacheFormat::MappedMagicNumber, headerData + CacheFormat::HeaderMagic);
+    qToLittleEndian<quint32>(CacheFormat::MappedVersion, headerData + CacheFormat::HeaderVersion);
+    qToLittleEndian<quint32>(placemarks.size(), headerData + CacheFormat::HeaderRecordCount);
+    qToLittleEndian<quint32>(strings.size(), headerData + CacheFormat::HeaderStringCount);
+    qToLittleEndian<quint32>(CacheFormat::RecordSize, headerData + CacheFormat::HeaderRecordSize);
+
+    return device->write(header) == header.size()
+            && device->write(records) == records.size()
+            && device->write(offsets) == offsets.size()
+            && device->write(stringData) == stringData.size();
+}
+
+void CacheWriter::collectPlacemarks(const GeoDataContainer *container, QVector<const GeoDataPlacemark*> &placemarks)
+{
+    for (const GeoDataPlacemark *placemark: container->placemarkList()) {
+        placemarks << placemark;
+    }
+    for (const GeoDataFolder *folder: container->folderList()) {
+        collectPlacemarks(folder, placemarks);
+    }
+}
+
+quint32 CacheWriter::stringIndex(const QString &string, StringTable &stringTable, QVector<QString> &strings)
+{
+    StringTable::const_iterator const iter = stringTable.constFind(string);
+    if (iter != stringTable.constEnd()) {
+        return iter.value();
+    }
+    quint32 const index = strings.size();
+    stringTable.insert(string, index);
+    strings << string;
+    return index;
+}
+
+MARBLE_ADD_WRITER(CacheWriter, "cache")
+
+}
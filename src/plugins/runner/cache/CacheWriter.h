@@ -0,0 +1,41 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CACHEWRITER_H
+#define MARBLE_CACHEWRITER_H
+
+#include "GeoWriterBackend.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace Marble
+{
+
+class GeoDataContainer;
+class GeoDataPlacemark;
+
+/**
+ * Writes the placemarks of a document in the memory-mappable placemark
+ * cache format described in CacheFormat.h.
+ */
+class CacheWriter: public GeoWriterBackend
+{
+public:
+    bool write(QIODevice *device, const GeoDataDocument &document) override;
+
+private:
+    typedef QHash<QString, quint32> StringTable;
+
+    static void collectPlacemarks(const GeoDataContainer *container, QVector<const GeoDataPlacemark*> &placemarks);
+    static quint32 stringIndex(const QString &string, StringTable &stringTable, QVector<QString> &strings);
+};
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QFile>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "CacheRunner.h"
+#include "CacheWriter.h"
+#include "GeoDataData.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataPlacemark.h"
+
+using namespace Marble;
+
+class CacheRunnerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void convert();
+    void rejectTruncated();
+    void benchmarkLoad_data();
+    void benchmarkLoad();
+
+private:
+    static GeoDataDocument *load( const QString &fileName );
+
+    QTemporaryDir m_tempDir;
+    QString m_streamFile;
+    QString m_mappedFile;
+};
+
+GeoDataDocument *CacheRunnerTest::load( const QString &fileName )
+{
+    CacheRunner runner;
+    QString error;
+    return runner.parseFile( fileName, UserDocument, error );
+}
+
+void CacheRunnerTest::initTestCase()
+{
+    // the places cache loaded at startup
+    m_streamFile = QString( MARBLE_SRC_DIR ).append( "/data/placemarks/cityplacemarks.cache" );
+    QVERIFY( m_tempDir.isValid() );
+    m_mappedFile = m_tempDir.path() + QLatin1String( "/cityplacemarks.cache" );
+
+    QScopedPointer<GeoDataDocument> document( load( m_streamFile ) );
+    QVERIFY( document );
+
+    QFile file( m_mappedFile );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    CacheWriter writer;
+    QVERIFY( writer.write( &file, *document ) );
+}
+
+void CacheRunnerTest::convert()
+{
+    QScopedPointer<GeoDataDocument> stream( load( m_streamFile ) );
+    QScopedPointer<GeoDataDocument> mapped( load( m_mappedFile ) );
+    QVERIFY( stream );
+    QVERIFY( mapped );
+    QCOMPARE( mapped->fileName(), m_mappedFile );
+    QCOMPARE( mapped->documentRole(), UserDocument );
+
+    const QVector<GeoDataPlacemark*> expected = stream->placemarkList();
+    const QVector<GeoDataPlacemark*> actual = mapped->placemarkList();
+    QVERIFY( !expected.isEmpty() );
+    QCOMPARE( actual.size(), expected.size() );
+
+    for ( int i = 0; i < expected.size(); ++i ) {
+        QCOMPARE( actual[i]->name(), expected[i]->name() );
+        QCOMPARE( actual[i]->coordinate(), expected[i]->coordinate() );
+        QCOMPARE( actual[i]->role(), expected[i]->role() );
+        QCOMPARE( actual[i]->description(), expected[i]->description() );
+        QCOMPARE( actual[i]->countryCode(), expected[i]->countryCode() );
+        QCOMPARE( actual[i]->state(), expected[i]->state() );
+        QCOMPARE( actual[i]->area(), expected[i]->area() );
+        QCOMPARE( actual[i]->population(), expected[i]->population() );
+        QCOMPARE( actual[i]->extendedData().value( "gmt" ).value().toInt(),
+                  expected[i]->extendedData().value( "gmt" ).value().toInt() );
+        QCOMPARE( actual[i]->extendedData().value( "dst" ).value().toInt(),
+                  expected[i]->extendedData().value( "dst" ).value().toInt() );
+    }
+}
+
+void CacheRunnerTest::rejectTruncated()
+{
+    QFile mapped( m_mappedFile );
+    QVERIFY( mapped.open( QIODevice::ReadOnly ) );
+    const QByteArray content = mapped.readAll();
+
+    const QString truncatedFile = m_tempDir.path() + QLatin1String( "/truncated.cache" );
+    QFile truncated( truncatedFile );
+    QVERIFY( truncated.open( QIODevice::WriteOnly ) );
+    truncated.write( content.left( content.size() - 1 ) );
+    truncated.close();
+
+    CacheRunner runner;
+    QString error;
+    QScopedPointer<GeoDataDocument> document( runner.parseFile( truncatedFile, UserDocument, error ) );
+    QVERIFY( !document );
+    QVERIFY( !error.isEmpty() );
+}
+
+void CacheRunnerTest::benchmarkLoad_data()
+{
+    QTest::addColumn<bool>( "mapped" );
+
+    QTest::newRow( "stream" ) << false;
+    QTest::newRow( "mapped" ) << true;
+}
+
+void CacheRunnerTest::benchmarkLoad()
+{
+    QFETCH( bool, mapped );
+
+    const QString fileName = mapped ? m_mappedFile : m_streamFile;
+    QBENCHMARK {
+        QScopedPointer<GeoDataDocument> document( load( fileName ) );
+        QVERIFY( document );
+    }
+}
+
+QTEST_MAIN( CacheRunnerTest )
+
+#include "CacheRunnerTest.moc"
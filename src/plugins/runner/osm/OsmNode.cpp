@@ -18,10 +18,46 @@
 #include <MarbleDirs.h>
 #include <StyleBuilder.h>
 
+#include <QDateTime>
 #include <QXmlStreamAttributes>
 
+#include <algorithm>
+
 namespace Marble {
 
+namespace {
+
+/** Parses @p text as an integer that is written back verbatim by QString::number */
+template<class T>
+bool parseCanonicalNumber(const QStringRef &text, T &number)
+{
+    bool ok;
+    number = T(text.toLongLong(&ok));
+    return ok && text == QString::number(number);
+}
+
+QString timestampString(qint64 seconds)
+{
+    return QDateTime::fromMSecsSinceEpoch(seconds * 1000, Qt::UTC).toString(Qt::ISODate);
+}
+
+/** Sorts @p nodes by id if needed and returns the node @p id, or nullptr if missing */
+template<class Node>
+const Node * findNode(QVector<Node> &nodes, bool &sorted, qint64 id)
+{
+    auto const lessThan = [](const Node &a, const Node &b) { return a.id < b.id; };
+    if (!sorted) {
+        std::stable_sort(nodes.begin(), nodes.end(), lessThan);
+        sorted = true;
+    }
+
+    auto const iter = std::lower_bound(nodes.constBegin(), nodes.constEnd(), id,
+                                       [](const Node &node, qint64 key) { return node.id < key; });
+    return iter != nodes.constEnd() && iter->id == id ? iter : nullptr;
+}
+
+}
+
 void OsmNode::parseCoordinates(const QXmlStreamAttributes &attributes)
 {
     qreal const lon = attributes.value(QLatin1String("lon")).toDouble();
@@ -117,4 +153,235 @@ const OsmPlacemarkData &OsmNode::osmData() const
     return m_osmData;
 }
 
+OsmNodes::Metadata::Metadata() :
+    m_changeset(0),
+    m_timestamp(0),
+    m_version(0),
+    m_uid(0),
+    m_attributes(0),
+    m_visible(true)
+{
+    // nothing to do
+}
+
+bool OsmNodes::Metadata::parseAttributes(const QXmlStreamAttributes &attributes)
+{
+    *this = Metadata();
+    for (auto const &attribute: attributes) {
+        QStringRef const name = attribute.name();
+        QStringRef const value = attribute.value();
+        if (name == QLatin1String("id") || name == QLatin1String("lon") || name == QLatin1String("lat")) {
+            continue;
+        } else if (name == QLatin1String("version")) {
+            if (!parseCanonicalNumber(value, m_version)) {
+                return false;
+            }
+            m_attributes |= Version;
+        } else if (name == QLatin1String("changeset")) {
+            if (!parseCanonicalNumber(value, m_changeset)) {
+                return false;
+            }
+            m_attributes |= Changeset;
+        } else if (name == QLatin1String("uid")) {
+            if (!parseCanonicalNumber(value, m_uid)) {
+                return false;
+            }
+            m_attributes |= Uid;
+        } else if (name == QLatin1String("timestamp")) {
+            QDateTime const timestamp = QDateTime::fromString(value.toString(), Qt::ISODate);
+            if (!timestamp.isValid()) {
+                return false;
+            }
+            m_timestamp = timestamp.toMSecsSinceEpoch() / 1000;
+            if (value != timestampString(m_timestamp)) {
+                return false;
+            }
+            m_attributes |= Timestamp;
+        } else if (name == QLatin1String("user")) {
+            m_user = value.toString();
+            m_attributes |= User;
+        } else if (name == QLatin1String("visible") && (value == QLatin1String("true") || value == QLatin1String("false"))) {
+            m_visible = value == QLatin1String("true");
+            m_attributes |= Visible;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OsmNodes::Metadata::isEmpty() const
+{
+    return m_attributes == 0;
+}
+
+QString &OsmNodes::Metadata::user()
+{
+    return m_user;
+}
+
+void OsmNodes::Metadata::apply(OsmPlacemarkData &osmData) const
+{
+    if (m_attributes & Version) {
+        osmData.setVersion(QString::number(m_version));
+    }
+    if (m_attributes & Changeset) {
+        osmData.setChangeset(QString::number(m_changeset));
+    }
+    if (m_attributes & Timestamp) {
+        osmData.setTimestamp(timestampString(m_timestamp));
+    }
+    if (m_attributes & Uid) {
+        osmData.setUid(QString::number(m_uid));
+    }
+    if (m_attributes & User) {
+        osmData.setUser(m_user);
+    }
+    if (m_attributes & Visible) {
+        osmData.setVisible(m_visible ? QStringLiteral("true") : QStringLiteral("false"));
+    }
+}
+
+OsmNodes::OsmNodes() :
+    m_compactNodesSorted(true),
+    m_compactNodesWithMetadataSorted(true)
+{
+    // nothing to do
+}
+
+void OsmNodes::addCompactNode(qint64 id, qint32 lon, qint32 lat, const Metadata &metadata)
+{
+    // OSM files are sorted by id usually, then there is no need to sort later
+    if (metadata.isEmpty()) {
+        if (!m_compactNodes.isEmpty() && m_compactNodes.last().id > id) {
+            m_compactNodesSorted = false;
+        }
+        m_compactNodes.append({id, lon, lat});
+    } else {
+        if (!m_compactNodesWithMetadata.isEmpty() && m_compactNodesWithMetadata.last().id > id) {
+            m_compactNodesWithMetadataSorted = false;
+        }
+        CompactNodeWithMetadata node;
+        node.id = id;
+        node.lon = lon;
+        node.lat = lat;
+        node.metadata = metadata;
+        m_compactNodesWithMetadata.append(node);
+    }
+}
+
+OsmNode &OsmNodes::operator[](qint64 id)
+{
+    return m_nodes[id];
+}
+
+bool OsmNodes::contains(qint64 id) const
+{
+    return m_nodes.contains(id) || compactNode(id);
+}
+
+bool OsmNodes::find(qint64 id, GeoDataCoordinates &coordinates, OsmPlacemarkData &osmData, bool &full) const
+{
+    auto const iter = m_nodes.constFind(id);
+    if (iter != m_nodes.constEnd()) {
+        coordinates = iter->coordinates();
+        osmData = iter->osmData();
+        full = true;
+        return true;
+    }
+
+    const Metadata *metadata;
+    if (auto const node = compactNode(id, &metadata)) {
+        coordinates = OsmNodes::coordinates(*node);
+        osmData = OsmPlacemarkData();
+        osmData.setId(id);
+        if (metadata) {
+            metadata->apply(osmData);
+        }
+        full = false;
+        return true;
+    }
+
+    return false;
+}
+
+GeoDataCoordinates OsmNodes::coordinates(qint64 id) const
+{
+    auto const iter = m_nodes.constFind(id);
+    if (iter != m_nodes.constEnd()) {
+        return iter->coordinates();
+    }
+
+    auto const node = compactNode(id);
+    return node ? coordinates(*node) : GeoDataCoordinates();
+}
+
+OsmPlacemarkData OsmNodes::osmData(qint64 id) const
+{
+    auto const iter = m_nodes.constFind(id);
+    if (iter != m_nodes.constEnd()) {
+        return iter->osmData();
+    }
+
+    OsmPlacemarkData result;
+    const Metadata *metadata;
+    if (compactNode(id, &metadata)) {
+        result.setId(id);
+        if (metadata) {
+            metadata->apply(result);
+        }
+    }
+    return result;
+}
+
+void OsmNodes::remove(qint64 id)
+{
+    m_nodes.remove(id);
+}
+
+void OsmNodes::releaseCompactNodes()
+{
+    m_compactNodes = QVector<CompactNode>();
+    m_compactNodesSorted = true;
+    m_compactNodesWithMetadata = QVector<CompactNodeWithMetadata>();
+    m_compactNodesWithMetadataSorted = true;
+}
+
+OsmNodes::Iterator OsmNodes::begin()
+{
+    return m_nodes.begin();
+}
+
+OsmNodes::Iterator OsmNodes::end()
+{
+    return m_nodes.end();
+}
+
+OsmNodes::Iterator OsmNodes::erase(Iterator iter)
+{
+    return m_nodes.erase(iter);
+}
+
+const OsmNodes::CompactNode *OsmNodes::compactNode(qint64 id, const Metadata **metadata) const
+{
+    if (metadata) {
+        *metadata = nullptr;
+    }
+
+    if (auto const node = findNode(m_compactNodes, m_compactNodesSorted, id)) {
+        return node;
+    }
+
+    auto const node = findNode(m_compactNodesWithMetadata, m_compactNodesWithMetadataSorted, id);
+    if (node && metadata) {
+        *metadata = &node->metadata;
+    }
+    return node;
+}
+
+GeoDataCoordinates OsmNodes::coordinates(const CompactNode &node)
+{
+    return GeoDataCoordinates(node.lon*1.0e-7, node.lat*1.0e-7, 0.0, GeoDataCoordinates::Degree);
+}
+
 }
@@ -14,7 +14,9 @@
 #include <osm/OsmPlacemarkData.h>
 #include <GeoDataPlacemark.h>
 
+#include <QHash>
 #include <QString>
+#include <QVector>
 
 class QXmlStreamAttributes;
 
@@ -40,7 +42,115 @@ private:
     GeoDataCoordinates m_coordinates;
 };
 
-typedef QHash<qint64,OsmNode> OsmNodes;
+/**
+ * The nodes of an OSM file. Most nodes carry no tags and only serve as way
+ * vertices: these are kept as id, position and possibly metadata in compact
+ * arrays sorted by id, only the remaining ones are stored as OsmNode.
+ */
+class OsmNodes
+{
+public:
+    using Iterator = QHash<qint64, OsmNode>::iterator;
+
+    /**
+     * The metadata attributes of a node (version, changeset, timestamp, uid,
+     * user and visibility) in binary form instead of as OsmPlacemarkData tags.
+     */
+    class Metadata
+    {
+    public:
+        Metadata();
+
+        /**
+         * Reads the metadata from the attributes of a node element. Returns false
+         * if the attributes contain anything else than id, position and metadata
+         * that can be restored verbatim, e.g. an action of an edited node.
+         */
+        bool parseAttributes(const QXmlStreamAttributes &attributes);
+
+        /** Returns true if none of the metadata attributes is set */
+        bool isEmpty() const;
+
+        /** The user name, to be shared with other nodes of the same user */
+        QString &user();
+
+        /** Sets the metadata attributes that are present in @p osmData */
+        void apply(OsmPlacemarkData &osmData) const;
+
+    private:
+        enum Attribute {
+            Version = 0x1,
+            Changeset = 0x2,
+            Timestamp = 0x4,
+            Uid = 0x8,
+            User = 0x10,
+            Visible = 0x20
+        };
+
+        qint64 m_changeset;
+        qint64 m_timestamp; // seconds since the epoch, UTC
+        qint32 m_version;
+        qint32 m_uid;
+        QString m_user;
+        quint8 m_attributes;
+        bool m_visible;
+    };
+
+    OsmNodes();
+
+    /**
+     * Adds a node without tags. @p lon and @p lat are given in units of 1e-7
+     * degrees, the precision of OSM data.
+     */
+    void addCompactNode(qint64 id, qint32 lon, qint32 lat, const Metadata &metadata = Metadata());
+
+    /** Returns the node @p id with tags, creating it if needed */
+    OsmNode & operator[](qint64 id);
+
+    bool contains(qint64 id) const;
+
+    /**
+     * Looks up the node @p id. Returns false if there is no such node. Otherwise
+     * sets @p coordinates and @p osmData, and @p full to whether it is an OsmNode.
+     */
+    bool find(qint64 id, GeoDataCoordinates &coordinates, OsmPlacemarkData &osmData, bool &full) const;
+
+    GeoDataCoordinates coordinates(qint64 id) const;
+    OsmPlacemarkData osmData(qint64 id) const;
+
+    /** Removes the OsmNode @p id. Compact nodes are only removed by releaseCompactNodes() */
+    void remove(qint64 id);
+
+    /** Frees the compact nodes once they are not needed as way vertices anymore */
+    void releaseCompactNodes();
+
+    /** Iteration over the nodes with tags */
+    Iterator begin();
+    Iterator end();
+    Iterator erase(Iterator iter);
+
+private:
+    struct CompactNode
+    {
+        qint64 id;
+        qint32 lon;
+        qint32 lat;
+    };
+
+    struct CompactNodeWithMetadata : public CompactNode
+    {
+        Metadata metadata;
+    };
+
+    const CompactNode * compactNode(qint64 id, const Metadata **metadata = nullptr) const;
+    static GeoDataCoordinates coordinates(const CompactNode &node);
+
+    QHash<qint64, OsmNode> m_nodes;
+    mutable QVector<CompactNode> m_compactNodes;
+    mutable bool m_compactNodesSorted;
+    mutable QVector<CompactNodeWithMetadata> m_compactNodesWithMetadata;
+    mutable bool m_compactNodesWithMetadataSorted;
+};
 
 }
 
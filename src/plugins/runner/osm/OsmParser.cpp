@@ -26,6 +26,7 @@
 #include <QFileInfo>
 #include <QBuffer>
 #include <QSet>
+#include <QXmlStreamReader>
 
 namespace Marble {
 
@@ -68,14 +69,21 @@ GeoDataDocument* OsmParser::parseO5m(const QString &filename, QString &error)
         switch (data.type) {
         case O5MREADER_DS_NODE:
         {
-            OsmNode& node = nodes[data.id];
-            node.osmData().setId(data.id);
-            node.setCoordinates(GeoDataCoordinates(data.lon*1.0e-7, data.lat*1.0e-7,
-                                                   0.0, GeoDataCoordinates::Degree));
+            // Most nodes are plain way vertices, only tagged ones need an OsmNode
+            OsmNode* node = nullptr;
             while ((innerState = o5mreader_iterateTags(reader, &key, &value)) == O5MREADER_ITERATE_RET_NEXT) {
+                if (!node) {
+                    node = &nodes[data.id];
+                    node->osmData().setId(data.id);
+                    node->setCoordinates(GeoDataCoordinates(data.lon*1.0e-7, data.lat*1.0e-7,
+                                                            0.0, GeoDataCoordinates::Degree));
+                }
                 const QString keyString = *stringPool.insert(QString::fromUtf8(key));
                 const QString valueString = *stringPool.insert(QString::fromUtf8(value));
-                node.osmData().addTag(keyString, valueString);
+                node->osmData().addTag(keyString, valueString);
+            }
+            if (!node) {
+                nodes.addCompactNode(data.id, data.lon, data.lat);
             }
         }
             break;
@@ -157,6 +165,18 @@ GeoDataDocument* OsmParser::parseXml(const QString &filename, QString &error)
     OsmWays m_ways;
     OsmRelations m_relations;
 
+    // A node is kept compact unless a tag follows
+    bool compactNode(false);
+    qint32 compactNodeLon(0);
+    qint32 compactNodeLat(0);
+    OsmNodes::Metadata compactNodeMetadata;
+    auto const addCompactNode = [&]() {
+        if (compactNode) {
+            m_nodes.addCompactNode(parentId, compactNodeLon, compactNodeLat, compactNodeMetadata);
+            compactNode = false;
+        }
+    };
+
     while (!parser.atEnd()) {
         parser.readNext();
         if (!parser.isStartElement()) {
@@ -165,10 +185,17 @@ GeoDataDocument* OsmParser::parseXml(const QString &filename, QString &error)
 
         QStringRef const tagName = parser.name();
         if (tagName == osm::osmTag_node || tagName == osm::osmTag_way || tagName == osm::osmTag_relation) {
+            addCompactNode();
             parentTag = parser.name().toString();
             parentId = parser.attributes().value(QLatin1String("id")).toLongLong();
 
-            if (tagName == osm::osmTag_node) {
+            if (tagName == osm::osmTag_node && compactNodeMetadata.parseAttributes(parser.attributes())) {
+                compactNodeLon = qRound(parser.attributes().value(QLatin1String("lon")).toDouble() * 1.0e7);
+                compactNodeLat = qRound(parser.attributes().value(QLatin1String("lat")).toDouble() * 1.0e7);
+                compactNodeMetadata.user() = *stringPool.insert(compactNodeMetadata.user());
+                compactNode = true;
+                osmData = nullptr;
+            } else if (tagName == osm::osmTag_node) {
                 m_nodes[parentId].osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
                 m_nodes[parentId].parseCoordinates(parser.attributes());
                 osmData = &m_nodes[parentId].osmData();
@@ -180,7 +207,16 @@ GeoDataDocument* OsmParser::parseXml(const QString &filename, QString &error)
                 m_relations[parentId].osmData() = OsmPlacemarkData::fromParserAttributes(parser.attributes());
                 osmData = &m_relations[parentId].osmData();
             }
-        } else if (osmData && tagName == osm::osmTag_tag) {
+        } else if ((osmData || compactNode) && tagName == osm::osmTag_tag) {
+            if (compactNode) {
+                OsmNode &node = m_nodes[parentId];
+                node.osmData().setId(parentId);
+                compactNodeMetadata.apply(node.osmData());
+                node.setCoordinates(GeoDataCoordinates(compactNodeLon*1.0e-7, compactNodeLat*1.0e-7,
+                                                       0.0, GeoDataCoordinates::Degree));
+                osmData = &node.osmData();
+                compactNode = false;
+            }
             const QXmlStreamAttributes &attributes = parser.attributes();
             const QString keyString = *stringPool.insert(attributes.value(QLatin1String("k")).toString());
             const QString valueString = *stringPool.insert(attributes.value(QLatin1String("v")).toString());
@@ -191,6 +227,7 @@ GeoDataDocument* OsmParser::parseXml(const QString &filename, QString &error)
             m_relations[parentId].parseMember(parser.attributes());
         } // other tags like osm, bounds ignored
     }
+    addCompactNode();
 
     if (parser.hasError()) {
         error = parser.errorString();
@@ -220,23 +257,25 @@ GeoDataDocument *OsmParser::createDocument(OsmNodes &nodes, OsmWays &ways, OsmRe
         ways.remove(id);
     }
 
+    // Ways and nodes are dropped as soon as their placemarks exist to keep the peak memory low
     QHash<qint64, GeoDataPlacemark*> placemarks;
-    for (auto iter=ways.constBegin(), end=ways.constEnd(); iter != end; ++iter) {
+    for (auto iter=ways.begin(); iter != ways.end(); iter = ways.erase(iter)) {
         auto placemark = iter.value().create(nodes, usedNodes);
         if (placemark) {
             document->append(placemark);
             placemarks[placemark->osmData().oid()] = placemark;
         }
     }
+    nodes.releaseCompactNodes();
 
     for(auto id: usedNodes) {
-        if (nodes[id].osmData().isEmpty()) {
+        if (nodes.osmData(id).isEmpty()) {
             nodes.remove(id);
         }
     }
 
-    for(auto const &node: nodes) {
-        auto placemark = node.create();
+    for (auto iter=nodes.begin(); iter != nodes.end(); iter = nodes.erase(iter)) {
+        auto placemark = iter->create();
         if (placemark) {
             document->append(placemark);
             placemarks[placemark->osmData().oid()] = placemark;
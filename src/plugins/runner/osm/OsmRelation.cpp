@@ -97,7 +97,7 @@ void OsmRelation::createMultipolygon(GeoDataDocument *document, OsmWays &ways, c
         } // else we keep it
 
         for(auto nodeId: ways[wayId].references()) {
-            ways[wayId].osmData().addNodeReference(nodes[nodeId].coordinates(), nodes[nodeId].osmData());
+            ways[wayId].osmData().addNodeReference(nodes.coordinates(nodeId), nodes.osmData(nodeId));
         }
     }
 
@@ -226,7 +226,7 @@ OsmRelation::OsmRings OsmRelation::rings(const QStringList &roles, const OsmWays
                 // A node is missing. Return nothing.
                 return OsmRings();
             }
-            ring << nodes[id].coordinates();
+            ring << nodes.coordinates(id);
         }
         Q_ASSERT(ways.contains(wayId));
         currentWays << wayId;
@@ -256,7 +256,7 @@ OsmRelation::OsmRings OsmRelation::rings(const QStringList &roles, const OsmWays
                                 return OsmRings();
                             }
                             if ( id != lastReference ) {
-                                ring << nodes[id].coordinates();
+                                ring << nodes.coordinates(id);
                                 currentNodes << id;
                             }
                         }
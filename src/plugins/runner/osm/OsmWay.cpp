@@ -29,6 +29,9 @@ GeoDataPlacemark *OsmWay::create(const OsmNodes &nodes, QSet<qint64> &usedNodes)
 {
     OsmPlacemarkData osmData = m_osmData;
     GeoDataGeometry *geometry = nullptr;
+    GeoDataCoordinates coordinates;
+    OsmPlacemarkData nodeData;
+    bool fullNode;
 
     if (isArea()) {
         GeoDataLinearRing linearRing;
@@ -36,15 +39,15 @@ GeoDataPlacemark *OsmWay::create(const OsmNodes &nodes, QSet<qint64> &usedNodes)
         bool const stripLastNode = m_references.first() == m_references.last();
         for (int i=0, n=m_references.size() - (stripLastNode ? 1 : 0); i<n; ++i) {
             qint64 nodeId = m_references[i];
-            auto const nodeIter = nodes.constFind(nodeId);
-            if (nodeIter == nodes.constEnd()) {
+            if (!nodes.find(nodeId, coordinates, nodeData, fullNode)) {
                 return nullptr;
             }
 
-            OsmNode const & node = nodeIter.value();
-            osmData.addNodeReference(node.coordinates(), node.osmData());
-            linearRing.append(node.coordinates());
-            usedNodes << nodeId;
+            osmData.addNodeReference(coordinates, nodeData);
+            linearRing.append(coordinates);
+            if (fullNode) {
+                usedNodes << nodeId;
+            }
         }
 
         if (isBuilding()) {
@@ -63,15 +66,15 @@ GeoDataPlacemark *OsmWay::create(const OsmNodes &nodes, QSet<qint64> &usedNodes)
         lineString.reserve(m_references.size());
 
         for(auto nodeId: m_references) {
-            auto const nodeIter = nodes.constFind(nodeId);
-            if (nodeIter == nodes.constEnd()) {
+            if (!nodes.find(nodeId, coordinates, nodeData, fullNode)) {
                 return nullptr;
             }
 
-            OsmNode const & node = nodeIter.value();
-            osmData.addNodeReference(node.coordinates(), node.osmData());
-            lineString.append(node.coordinates());
-            usedNodes << nodeId;
+            osmData.addNodeReference(coordinates, nodeData);
+            lineString.append(coordinates);
+            if (fullNode) {
+                usedNodes << nodeId;
+            }
         }
 
         geometry = new GeoDataLineString(lineString.optimized());
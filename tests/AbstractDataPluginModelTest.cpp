@@ -92,6 +92,10 @@ private Q_SLOTS:
 
     void itemsVersusSetSticky();
 
+    void itemsVersusViewport();
+
+    void removeDeletedItem();
+
  private:
     const MarbleModel m_marbleModel;
     static const ViewportParams fullViewport;
@@ -341,6 +345,47 @@ void AbstractDataPluginModelTest::itemsVersusSetSticky()
     QVERIFY( !model.items( &fullViewport, 1 ).contains( item ) );
 }
 
+void AbstractDataPluginModelTest::itemsVersusViewport()
+{
+    const ViewportParams zoomedViewport( Equirectangular, 0, 0, 10000, QSize( 230, 230 ) );
+
+    TestDataPluginItem *visibleItem = new TestDataPluginItem;
+    visibleItem->setId( "visible" );
+    visibleItem->setInitialized( true );
+    visibleItem->setCoordinate( GeoDataCoordinates( 0.1, 0.1, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginItem *hiddenItem = new TestDataPluginItem;
+    hiddenItem->setId( "hidden" );
+    hiddenItem->setInitialized( true );
+    hiddenItem->setCoordinate( GeoDataCoordinates( 90, 45, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemToList( visibleItem );
+    model.addItemToList( hiddenItem );
+
+    const QList<AbstractDataPluginItem*> items = model.items( &zoomedViewport, 2 );
+    QVERIFY( items.contains( visibleItem ) );
+    QVERIFY( !items.contains( hiddenItem ) );
+    QVERIFY( model.items( &fullViewport, 2 ).contains( hiddenItem ) );
+}
+
+void AbstractDataPluginModelTest::removeDeletedItem()
+{
+    TestDataPluginItem *item = new TestDataPluginItem;
+    item->setId( "foo" );
+    item->setInitialized( true );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemToList( item );
+
+    QVERIFY( model.items( &fullViewport, 1 ).contains( item ) );
+
+    delete item;
+
+    QVERIFY( !model.itemExists( "foo" ) );
+    QVERIFY( model.items( &fullViewport, 1 ).isEmpty() );
+}
+
 QTEST_MAIN( AbstractDataPluginModelTest )
 
 #include "AbstractDataPluginModelTest.moc"
@@ -0,0 +1,223 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QFile>
+#include <QRect>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTimer>
+#include <QUrl>
+
+#include "BulkTileDownloader.h"
+#include "GeoSceneTileDataset.h"
+#include "TileCoordsPyramid.h"
+
+namespace Marble
+{
+
+/**
+ * Answers each GET request with a tile after a short delay.
+ */
+class TileServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit TileServer( QObject *parent = nullptr );
+
+    QUrl url() const;
+
+    QStringList requestedPaths() const { return m_requestedPaths; }
+
+private Q_SLOTS:
+    void acceptConnection();
+    void readRequests();
+
+private:
+    QStringList m_requestedPaths;
+};
+
+TileServer::TileServer( QObject *parent ) :
+    QTcpServer( parent )
+{
+    connect( this, SIGNAL(newConnection()), SLOT(acceptConnection()) );
+    listen( QHostAddress::LocalHost );
+}
+
+QUrl TileServer::url() const
+{
+    return QUrl( QString( "http://127.0.0.1:%1/tiles" ).arg( serverPort() ) );
+}
+
+void TileServer::acceptConnection()
+{
+    while ( hasPendingConnections() ) {
+        QTcpSocket *socket = nextPendingConnection();
+        connect( socket, SIGNAL(readyRead()), SLOT(readRequests()) );
+        connect( socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()) );
+    }
+}
+
+void TileServer::readRequests()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>( sender() );
+    QByteArray buffer = socket->property( "buffer" ).toByteArray() + socket->readAll();
+
+    int end;
+    while ( ( end = buffer.indexOf( "\r\n\r\n" ) ) >= 0 ) {
+        m_requestedPaths << QString::fromLatin1( buffer.left( end ).split( ' ' ).value( 1 ) );
+        buffer.remove( 0, end + 4 );
+        QTimer::singleShot( 20, socket, [socket]() {
+            socket->write( "HTTP/1.1 200 OK\r\nContent-Type: image/png\r\nContent-Length: 4\r\n\r\ntile" );
+        } );
+    }
+    socket->setProperty( "buffer", buffer );
+}
+
+class BulkTileDownloaderTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void downloadAndSkip();
+    void resume();
+
+private:
+    static QVector<TileCoordsPyramid> region();
+
+    QTemporaryDir m_dataHome;
+};
+
+void BulkTileDownloaderTest::initTestCase()
+{
+    // keep the downloaded tiles away from the user's cache
+    QVERIFY( m_dataHome.isValid() );
+    qputenv( "XDG_DATA_HOME", QFile::encodeName( m_dataHome.path() ) );
+}
+
+QVector<TileCoordsPyramid> BulkTileDownloaderTest::region()
+{
+    // two overlapping pyramids with 20 + 5 + 2 distinct tiles on levels 2, 1 and 0
+    TileCoordsPyramid first( 0, 2 );
+    first.setBottomLevelCoords( QRect( QPoint( 0, 0 ), QPoint( 3, 3 ) ) );
+    TileCoordsPyramid second( 0, 2 );
+    second.setBottomLevelCoords( QRect( QPoint( 2, 0 ), QPoint( 5, 1 ) ) );
+
+    return QVector<TileCoordsPyramid>() << first << second;
+}
+
+void BulkTileDownloaderTest::downloadAndSkip()
+{
+    TileServer server;
+    QVERIFY( server.isListening() );
+
+    GeoSceneTileDataset dataset( "test" );
+    dataset.setSourceDir( "earth/bulk" );
+    dataset.setFileFormat( "png" );
+    dataset.addDownloadUrl( server.url() );
+
+    const QString journal = m_dataHome.path() + QLatin1String( "/bulk.journal" );
+
+    {
+        BulkTileDownloader downloader;
+        downloader.setTileDatasets( QVector<const GeoSceneTileDataset *>() << &dataset );
+        downloader.setRegion( region() );
+        downloader.setJournalFileName( journal );
+        QSignalSpy finished( &downloader, SIGNAL(finished()) );
+
+        downloader.start();
+        QVERIFY( downloader.isRunning() );
+        QCOMPARE( downloader.totalTiles(), qint64( 27 ) );
+
+        QTRY_COMPARE_WITH_TIMEOUT( finished.count(), 1, 10000 );
+        QVERIFY( !downloader.isRunning() );
+        QCOMPARE( downloader.processedTiles(), qint64( 27 ) );
+        QCOMPARE( downloader.downloadedTiles(), qint64( 27 ) );
+        QCOMPARE( downloader.skippedTiles(), qint64( 0 ) );
+        QCOMPARE( downloader.failedTiles(), qint64( 0 ) );
+        QCOMPARE( downloader.downloadedBytes(), qint64( 27 * 4 ) );
+        QCOMPARE( downloader.estimatedTimeRemaining(), qint64( 0 ) );
+    }
+
+    QCOMPARE( server.requestedPaths().size(), 27 );
+    QCOMPARE( server.requestedPaths().toSet().size(), 27 );
+    // low resolution tiles come first
+    QVERIFY( server.requestedPaths().first().startsWith( "/tiles/0/" ) );
+    QVERIFY( server.requestedPaths().last().startsWith( "/tiles/2/" ) );
+    QVERIFY( !QFile::exists( journal ) );
+
+    // the tiles have not expired, so downloading the region again only skips them
+    BulkTileDownloader downloader;
+    downloader.setTileDatasets( QVector<const GeoSceneTileDataset *>() << &dataset );
+    downloader.setRegion( region() );
+    QSignalSpy finished( &downloader, SIGNAL(finished()) );
+
+    downloader.start();
+    QTRY_COMPARE( finished.count(), 1 );
+    QCOMPARE( downloader.processedTiles(), qint64( 27 ) );
+    QCOMPARE( downloader.downloadedTiles(), qint64( 0 ) );
+    QCOMPARE( downloader.skippedTiles(), qint64( 27 ) );
+    QCOMPARE( server.requestedPaths().size(), 27 );
+}
+
+void BulkTileDownloaderTest::resume()
+{
+    TileServer server;
+    QVERIFY( server.isListening() );
+
+    GeoSceneTileDataset dataset( "test" );
+    dataset.setSourceDir( "earth/resume" );
+    dataset.setFileFormat( "png" );
+    dataset.addDownloadUrl( server.url() );
+
+    const QString journal = m_dataHome.path() + QLatin1String( "/resume.journal" );
+
+    {
+        BulkTileDownloader downloader;
+        downloader.setTileDatasets( QVector<const GeoSceneTileDataset *>() << &dataset );
+        downloader.setRegion( region() );
+        downloader.setMaximumConnections( 1 );
+        downloader.setJournalFileName( journal );
+
+        downloader.start();
+        QTRY_VERIFY( downloader.processedTiles() >= 5 );
+        downloader.stop();
+        QVERIFY( !downloader.isRunning() );
+        QVERIFY( downloader.processedTiles() < 27 );
+        QVERIFY( QFile::exists( journal ) );
+    }
+
+    const int firstRunRequests = server.requestedPaths().size();
+
+    BulkTileDownloader downloader;
+    downloader.setTileDatasets( QVector<const GeoSceneTileDataset *>() << &dataset );
+    downloader.setRegion( region() );
+    downloader.setJournalFileName( journal );
+    QSignalSpy finished( &downloader, SIGNAL(finished()) );
+
+    downloader.start();
+    QVERIFY( downloader.processedTiles() >= 5 );
+    QTRY_COMPARE_WITH_TIMEOUT( finished.count(), 1, 10000 );
+
+    QCOMPARE( downloader.processedTiles(), qint64( 27 ) );
+    QCOMPARE( downloader.downloadedTiles() + downloader.skippedTiles(), qint64( 27 ) );
+    QCOMPARE( downloader.failedTiles(), qint64( 0 ) );
+    // the resumed run does not start over
+    QVERIFY( server.requestedPaths().size() - firstRunRequests <= 27 - 5 + 1 );
+    QVERIFY( !QFile::exists( journal ) );
+}
+
+}
+
+QTEST_MAIN( Marble::BulkTileDownloaderTest )
+
+#include "BulkTileDownloaderTest.moc"
@@ -0,0 +1,274 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QHash>
+#include <QRect>
+#include <QSet>
+#include <QTest>
+
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoGraphicsItem.h"
+#include "GeoGraphicsScene.h"
+#include "TileCoordsPyramid.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+class BoxGraphicsItem : public GeoGraphicsItem
+{
+public:
+    BoxGraphicsItem( const GeoDataFeature *feature, const GeoDataLatLonAltBox &box, int minZoomLevel ) :
+        GeoGraphicsItem( feature ),
+        m_box( box )
+    {
+        setMinZoomLevel( minZoomLevel );
+    }
+
+    const GeoDataLatLonAltBox &latLonAltBox() const override { return m_box; }
+
+    void paint( GeoPainter *, const ViewportParams *, const QString &, int ) override {}
+
+private:
+    GeoDataLatLonAltBox m_box;
+};
+
+/**
+ * The index GeoGraphicsScene used before: items are kept in the smallest tile
+ * containing them, queries look up all tiles of the box on all levels.
+ */
+class TileHashIndex
+{
+public:
+    void addItem( GeoGraphicsItem *item );
+    QList<GeoGraphicsItem *> items( const GeoDataLatLonBox &box, int zoomLevel ) const;
+
+private:
+    QHash<TileId, QList<GeoGraphicsItem *> > m_tiledItems;
+};
+
+void TileHashIndex::addItem( GeoGraphicsItem *item )
+{
+    int zoomLevel;
+    qreal north, south, east, west;
+    item->latLonAltBox().boundaries( north, south, east, west );
+    for ( zoomLevel = item->minZoomLevel(); zoomLevel >= 0; zoomLevel-- ) {
+        if ( TileId::fromCoordinates( GeoDataCoordinates( west, north, 0 ), zoomLevel ) ==
+             TileId::fromCoordinates( GeoDataCoordinates( east, south, 0 ), zoomLevel ) )
+            break;
+    }
+    m_tiledItems[TileId::fromCoordinates( GeoDataCoordinates( west, north, 0 ), zoomLevel )] << item;
+}
+
+QList<GeoGraphicsItem *> TileHashIndex::items( const GeoDataLatLonBox &box, int zoomLevel ) const
+{
+    QList<GeoGraphicsItem *> result;
+    qreal north, south, east, west;
+    box.boundaries( north, south, east, west );
+
+    const TileId topLeft = TileId::fromCoordinates( GeoDataCoordinates( west, north, 0 ), zoomLevel );
+    const TileId bottomRight = TileId::fromCoordinates( GeoDataCoordinates( east, south, 0 ), zoomLevel );
+    TileCoordsPyramid pyramid( 0, zoomLevel );
+    pyramid.setBottomLevelCoords( QRect( QPoint( topLeft.x(), topLeft.y() ), QPoint( bottomRight.x(), bottomRight.y() ) ) );
+
+    for ( int level = pyramid.topLevel(); level <= pyramid.bottomLevel(); ++level ) {
+        QRect const coords = pyramid.coords( level );
+        int x1, y1, x2, y2;
+        coords.getCoords( &x1, &y1, &x2, &y2 );
+        for ( int x = x1; x <= x2; ++x ) {
+            bool const isBorderX = x == x1 || x == x2;
+            for ( int y = y1; y <= y2; ++y ) {
+                bool const isBorder = isBorderX || y == y1 || y == y2;
+                for ( GeoGraphicsItem *object: m_tiledItems.value( TileId( 0, level, x, y ) ) ) {
+                    if ( object->minZoomLevel() <= zoomLevel && object->visible() ) {
+                        if ( !isBorder || object->latLonAltBox().intersects( box ) ) {
+                            result.push_back( object );
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+class GeoGraphicsSceneTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void itemsInBox_data();
+    void itemsInBox();
+    void removeItems();
+    void benchmarkTileHash();
+    void benchmarkScene();
+    void benchmarkSceneVisitor();
+
+private:
+    static qreal random( qreal min, qreal max );
+    static QList<GeoGraphicsItem *> expectedItems( const QList<GeoGraphicsItem *> &items,
+                                                   const GeoDataLatLonBox &box, int zoomLevel );
+    void fillScene( GeoGraphicsScene &scene, int count );
+
+    QVector<GeoDataPlacemark *> m_placemarks;
+    QList<GeoGraphicsItem *> m_benchmarkItems;
+    GeoGraphicsScene m_benchmarkScene;
+    TileHashIndex m_tileHashIndex;
+};
+
+qreal GeoGraphicsSceneTest::random( qreal min, qreal max )
+{
+    return min + ( max - min ) * qrand() / RAND_MAX;
+}
+
+QList<GeoGraphicsItem *> GeoGraphicsSceneTest::expectedItems( const QList<GeoGraphicsItem *> &items,
+                                                              const GeoDataLatLonBox &box, int zoomLevel )
+{
+    QList<GeoGraphicsItem *> result;
+    for ( GeoGraphicsItem *item: items ) {
+        if ( item->minZoomLevel() <= zoomLevel && item->visible() && item->latLonAltBox().intersects( box ) ) {
+            result << item;
+        }
+    }
+    return result;
+}
+
+void GeoGraphicsSceneTest::fillScene( GeoGraphicsScene &scene, int count )
+{
+    // mostly small items, like buildings and streets, and a few large ones
+    for ( int i = 0; i < count; ++i ) {
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        m_placemarks << placemark;
+        const qreal size = i % 100 == 0 ? random( 1.0, 40.0 ) : random( 0.0001, 0.05 );
+        const qreal lon = random( -180.0, 180.0 - size );
+        const qreal lat = random( -85.0, 85.0 - size );
+        const GeoDataLatLonBox box( lat + size, lat, lon + size, lon, GeoDataCoordinates::Degree );
+        GeoGraphicsItem *item = new BoxGraphicsItem( placemark, GeoDataLatLonAltBox( box, 0, 0 ), i % 18 );
+        item->setVisible( i % 50 != 1 );
+        scene.addItem( item );
+        m_benchmarkItems << item;
+    }
+}
+
+void GeoGraphicsSceneTest::initTestCase()
+{
+    qsrand( 42 );
+    fillScene( m_benchmarkScene, 200000 );
+    for ( GeoGraphicsItem *item: m_benchmarkItems ) {
+        m_tileHashIndex.addItem( item );
+    }
+}
+
+void GeoGraphicsSceneTest::cleanupTestCase()
+{
+    m_benchmarkScene.clear();
+    qDeleteAll( m_placemarks );
+}
+
+void GeoGraphicsSceneTest::itemsInBox_data()
+{
+    QTest::addColumn<GeoDataLatLonBox>( "box" );
+    QTest::addColumn<int>( "zoomLevel" );
+
+    QTest::newRow( "world" ) << GeoDataLatLonBox( 90, -90, 180, -180, GeoDataCoordinates::Degree ) << 3;
+    QTest::newRow( "country" ) << GeoDataLatLonBox( 55.1, 47.2, 15.1, 5.8, GeoDataCoordinates::Degree ) << 8;
+    QTest::newRow( "city" ) << GeoDataLatLonBox( 48.9, 48.7, 9.3, 9.0, GeoDataCoordinates::Degree ) << 13;
+    QTest::newRow( "street" ) << GeoDataLatLonBox( 48.78, 48.77, 9.19, 9.17, GeoDataCoordinates::Degree ) << 17;
+    QTest::newRow( "date line" ) << GeoDataLatLonBox( 20, -20, -170, 170, GeoDataCoordinates::Degree ) << 9;
+}
+
+void GeoGraphicsSceneTest::itemsInBox()
+{
+    QFETCH( GeoDataLatLonBox, box );
+    QFETCH( int, zoomLevel );
+
+    const QList<GeoGraphicsItem *> items = m_benchmarkScene.items( box, zoomLevel );
+    const QSet<GeoGraphicsItem *> itemSet = items.toSet();
+    QCOMPARE( itemSet.size(), items.size() );
+    QCOMPARE( itemSet, expectedItems( m_benchmarkItems, box, zoomLevel ).toSet() );
+
+    int visited = 0;
+    m_benchmarkScene.visitItems( box, zoomLevel, [&]( GeoGraphicsItem *item ) {
+        ++visited;
+        QVERIFY( itemSet.contains( item ) );
+    } );
+    QCOMPARE( visited, items.size() );
+}
+
+void GeoGraphicsSceneTest::removeItems()
+{
+    GeoGraphicsScene scene;
+    QList<GeoGraphicsItem *> keptItems;
+    QVector<GeoDataPlacemark *> placemarks;
+    for ( int i = 0; i < 2000; ++i ) {
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        placemarks << placemark;
+        const qreal lon = random( -170.0, 170.0 );
+        const qreal lat = random( -80.0, 80.0 );
+        const GeoDataLatLonBox box( lat + 1, lat, lon + 1, lon, GeoDataCoordinates::Degree );
+        // two items per feature, like multi geometries create
+        for ( int j = 0; j < 2; ++j ) {
+            GeoGraphicsItem *item = new BoxGraphicsItem( placemark, GeoDataLatLonAltBox( box, 0, 0 ), j * 5 );
+            scene.addItem( item );
+            if ( i % 2 == 1 ) {
+                keptItems << item;
+            }
+        }
+    }
+
+    const GeoDataLatLonBox world( 90, -90, 180, -180, GeoDataCoordinates::Degree );
+    QCOMPARE( scene.items( world, 10 ).size(), 4000 );
+
+    for ( int i = 0; i < placemarks.size(); i += 2 ) {
+        scene.removeItem( placemarks[i] );
+    }
+
+    QCOMPARE( scene.items( world, 10 ).size(), 2000 );
+    QCOMPARE( scene.items( world, 10 ).toSet(), keptItems.toSet() );
+    QCOMPARE( scene.items( world, 4 ).size(), 1000 );
+
+    scene.clear();
+    QVERIFY( scene.items( world, 10 ).isEmpty() );
+    qDeleteAll( placemarks );
+}
+
+void GeoGraphicsSceneTest::benchmarkTileHash()
+{
+    const GeoDataLatLonBox box( 55.1, 47.2, 15.1, 5.8, GeoDataCoordinates::Degree );
+    QBENCHMARK {
+        m_tileHashIndex.items( box, 10 );
+    }
+}
+
+void GeoGraphicsSceneTest::benchmarkScene()
+{
+    const GeoDataLatLonBox box( 55.1, 47.2, 15.1, 5.8, GeoDataCoordinates::Degree );
+    QBENCHMARK {
+        m_benchmarkScene.items( box, 10 );
+    }
+}
+
+void GeoGraphicsSceneTest::benchmarkSceneVisitor()
+{
+    const GeoDataLatLonBox box( 55.1, 47.2, 15.1, 5.8, GeoDataCoordinates::Degree );
+    int count = 0;
+    QBENCHMARK {
+        m_benchmarkScene.visitItems( box, 10, [&count]( GeoGraphicsItem * ) { ++count; } );
+    }
+    QVERIFY( count > 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::GeoGraphicsSceneTest )
+
+#include "GeoGraphicsSceneTest.moc"
@@ -0,0 +1,251 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QHash>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+#include <QTimer>
+#include <QUrl>
+
+#include "DownloadPolicy.h"
+#include "HttpDownloadManager.h"
+
+namespace Marble
+{
+
+/**
+ * Answers each GET request with its path as content, after a delay
+ * which lets the client have several requests running at a time.
+ */
+class LocalHttpServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit LocalHttpServer( QObject *parent = nullptr );
+
+    QUrl url( const QString &path ) const;
+
+    QStringList requestedPaths() const { return m_requestedPaths; }
+    int maximumRunningRequests() const { return m_maximumRunningRequests; }
+
+private Q_SLOTS:
+    void acceptConnection();
+    void readRequests();
+    void dropConnection();
+
+private:
+    void respond( QTcpSocket *socket, const QByteArray &path );
+
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QHash<QTcpSocket *, int> m_runningRequests;
+    QStringList m_requestedPaths;
+    int m_maximumRunningRequests;
+};
+
+LocalHttpServer::LocalHttpServer( QObject *parent ) :
+    QTcpServer( parent ),
+    m_maximumRunningRequests( 0 )
+{
+    connect( this, SIGNAL(newConnection()), SLOT(acceptConnection()) );
+    listen( QHostAddress::LocalHost );
+}
+
+QUrl LocalHttpServer::url( const QString &path ) const
+{
+    return QUrl( QString( "http://127.0.0.1:%1/%2" ).arg( serverPort() ).arg( path ) );
+}
+
+void LocalHttpServer::acceptConnection()
+{
+    while ( hasPendingConnections() ) {
+        QTcpSocket *socket = nextPendingConnection();
+        connect( socket, SIGNAL(readyRead()), SLOT(readRequests()) );
+        connect( socket, SIGNAL(disconnected()), SLOT(dropConnection()) );
+    }
+}
+
+void LocalHttpServer::readRequests()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>( sender() );
+    QByteArray &buffer = m_buffers[socket];
+    buffer += socket->readAll();
+
+    // requests may be pipelined, GET requests don't have a body
+    int end;
+    while ( ( end = buffer.indexOf( "\r\n\r\n" ) ) >= 0 ) {
+        const QByteArray request = buffer.left( end );
+        buffer.remove( 0, end + 4 );
+        const QByteArray path = request.split( ' ' ).value( 1 ).mid( 1 );
+        m_requestedPaths << QString::fromLatin1( path );
+
+        int running = 0;
+        for ( int n: m_runningRequests ) {
+            running += n;
+        }
+        ++m_runningRequests[socket];
+        m_maximumRunningRequests = qMax( m_maximumRunningRequests, running + 1 );
+
+        QTimer::singleShot( 50, socket, [this, socket, path]() { respond( socket, path ); } );
+    }
+}
+
+void LocalHttpServer::respond( QTcpSocket *socket, const QByteArray &path )
+{
+    --m_runningRequests[socket];
+    socket->write( "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: "
+                   + QByteArray::number( path.size() ) + "\r\n\r\n" + path );
+}
+
+void LocalHttpServer::dropConnection()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>( sender() );
+    m_buffers.remove( socket );
+    m_runningRequests.remove( socket );
+    socket->deleteLater();
+}
+
+class HttpDownloadManagerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void priorityOrder();
+    void duplicateJobs();
+    void removeJobs();
+    void connectionsPerHost();
+
+private:
+    static DownloadPolicy localPolicy( int maximumConnections, int maximumConnectionsPerHost = 0 );
+    static QStringList completedIds( const QSignalSpy &spy );
+};
+
+void HttpDownloadManagerTest::initTestCase()
+{
+    qRegisterMetaType<DownloadUsage>( "DownloadUsage" );
+}
+
+DownloadPolicy HttpDownloadManagerTest::localPolicy( int maximumConnections, int maximumConnectionsPerHost )
+{
+    DownloadPolicy policy( DownloadPolicyKey( "127.0.0.1", DownloadBrowse ) );
+    policy.setMaximumConnections( maximumConnections );
+    policy.setMaximumConnectionsPerHost( maximumConnectionsPerHost );
+    return policy;
+}
+
+QStringList HttpDownloadManagerTest::completedIds( const QSignalSpy &spy )
+{
+    QStringList result;
+    for ( const QList<QVariant> &arguments: spy ) {
+        result << arguments.at( 1 ).toString();
+    }
+    return result;
+}
+
+void HttpDownloadManagerTest::priorityOrder()
+{
+    LocalHttpServer server;
+    QVERIFY( server.isListening() );
+
+    HttpDownloadManager manager( nullptr );
+    manager.addDownloadPolicy( localPolicy( 1 ) );
+    QSignalSpy completed( &manager, SIGNAL(downloadComplete(QByteArray,QString)) );
+
+    // the first job is started right away, the others wait for the connection
+    manager.addJob( server.url( "first" ), "first", "first", DownloadBrowse, 9 );
+    manager.addJob( server.url( "far" ), "far", "far", DownloadBrowse, 5 );
+    manager.addJob( server.url( "center" ), "center", "center", DownloadBrowse, 1 );
+    manager.addJob( server.url( "near" ), "near", "near", DownloadBrowse, 3 );
+    manager.addJob( server.url( "recent" ), "recent", "recent", DownloadBrowse, 3 );
+
+    QTRY_COMPARE( completed.count(), 5 );
+    QCOMPARE( completedIds( completed ),
+              QStringList() << "first" << "center" << "recent" << "near" << "far" );
+    QCOMPARE( completed.at( 1 ).at( 0 ).toByteArray(), QByteArray( "center" ) );
+}
+
+void HttpDownloadManagerTest::duplicateJobs()
+{
+    LocalHttpServer server;
+    QVERIFY( server.isListening() );
+
+    HttpDownloadManager manager( nullptr );
+    manager.addDownloadPolicy( localPolicy( 1 ) );
+    QSignalSpy completed( &manager, SIGNAL(downloadComplete(QByteArray,QString)) );
+
+    manager.addJob( server.url( "first" ), "first", "first", DownloadBrowse, 0 );
+    manager.addJob( server.url( "a" ), "a", "a", DownloadBrowse, 1 );
+    manager.addJob( server.url( "b" ), "b", "b", DownloadBrowse, 2 );
+    // requesting a waiting job again only updates its priority
+    manager.addJob( server.url( "b" ), "b", "b", DownloadBrowse, 0 );
+    manager.addJob( server.url( "first" ), "first", "first", DownloadBrowse, 0 );
+
+    QTRY_COMPARE( completed.count(), 3 );
+    QCOMPARE( completedIds( completed ), QStringList() << "first" << "b" << "a" );
+
+    // give stray requests a chance to show up
+    QTest::qWait( 100 );
+    QCOMPARE( server.requestedPaths(), QStringList() << "first" << "b" << "a" );
+}
+
+void HttpDownloadManagerTest::removeJobs()
+{
+    LocalHttpServer server;
+    QVERIFY( server.isListening() );
+
+    HttpDownloadManager manager( nullptr );
+    manager.addDownloadPolicy( localPolicy( 1 ) );
+    QSignalSpy completed( &manager, SIGNAL(downloadComplete(QByteArray,QString)) );
+    QSignalSpy progress( &manager, SIGNAL(progressChanged(int,int)) );
+
+    for ( const QString &name: QStringList() << "active" << "a" << "b" << "c" ) {
+        manager.addJob( server.url( name ), name, name, DownloadBrowse, 0 );
+    }
+    manager.setJobPriorities( QHash<QString, int>{ { "c", 0 }, { "b", 1 }, { "a", 2 } }, DownloadBrowse );
+
+    // removing bulk downloads does not affect downloads for browsing
+    manager.removeJobs( QStringList() << "c", DownloadBulk );
+    manager.removeJobs( QStringList() << "active" << "b" << "unknown", DownloadBrowse );
+
+    QTRY_COMPARE( completed.count(), 2 );
+    QCOMPARE( completedIds( completed ), QStringList() << "c" << "a" );
+
+    QTest::qWait( 100 );
+    QCOMPARE( completed.count(), 2 );
+    QVERIFY( !server.requestedPaths().contains( "b" ) );
+    QCOMPARE( progress.last().at( 0 ).toInt(), 0 );
+    QCOMPARE( progress.last().at( 1 ).toInt(), 0 );
+}
+
+void HttpDownloadManagerTest::connectionsPerHost()
+{
+    LocalHttpServer server;
+    QVERIFY( server.isListening() );
+
+    HttpDownloadManager manager( nullptr );
+    manager.addDownloadPolicy( localPolicy( 8, 2 ) );
+    QSignalSpy completed( &manager, SIGNAL(downloadComplete(QByteArray,QString)) );
+
+    for ( int i = 0; i < 10; ++i ) {
+        const QString name = QString::number( i );
+        manager.addJob( server.url( name ), name, name, DownloadBrowse, 0 );
+    }
+
+    QTRY_COMPARE( completed.count(), 10 );
+    QCOMPARE( server.requestedPaths().size(), 10 );
+    QCOMPARE( server.maximumRunningRequests(), 2 );
+}
+
+}
+
+QTEST_MAIN( Marble::HttpDownloadManagerTest )
+
+#include "HttpDownloadManagerTest.moc"
@@ -11,8 +11,13 @@
 #include "GeoPainter.h"
 #include "MarbleMap.h"
 #include "MarbleModel.h"
+#include "RenderProfiler.h"
 #include "TestUtils.h"
 
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
 #include <QThreadPool>
 
 namespace Marble
@@ -66,6 +71,8 @@ class MarbleMapTest : public QObject
     void paint_data();
     void paint();
 
+    void renderProfiler();
+
  private:
     MarbleModel m_model;
 };
@@ -594,6 +601,57 @@ void MarbleMapTest::paint()
     QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
 }
 
+void MarbleMapTest::renderProfiler()
+{
+    MarbleMap map;
+    map.setMapThemeId( "earth/plain/plain.dgml" );
+    map.setSize( 200, 200 );
+
+    RenderProfiler *const profiler = map.renderProfiler();
+    QVERIFY( profiler );
+    QVERIFY( !profiler->isEnabled() );
+
+    QPixmap paintDevice( map.size() );
+    GeoPainter painter( &paintDevice, map.viewport(), map.mapQuality() );
+    map.paint( painter, QRect() );
+    QCOMPARE( profiler->frameCount(), 0 );
+
+    profiler->setEnabled( true );
+    profiler->setHistorySize( 3 );
+    for ( int i = 0; i < 5; ++i ) {
+        map.paint( painter, QRect() );
+    }
+    QCOMPARE( profiler->frameCount(), 3 );
+    QVERIFY( profiler->renderPositions().contains( "SURFACE" ) );
+    QVERIFY( !profiler->layers().isEmpty() );
+
+    const RenderProfiler::Statistics frames = profiler->frameStatistics();
+    QCOMPARE( frames.frames, 3 );
+    QCOMPARE( frames.complete + frames.waitingForUpdate + frames.waitingForData + frames.incomplete, 3 );
+    QVERIFY( frames.minimum <= frames.median );
+    QVERIFY( frames.median <= frames.percentile95 );
+    QVERIFY( frames.percentile95 <= frames.percentile99 );
+    QVERIFY( frames.percentile99 <= frames.maximum );
+
+    for ( const QString &layer: profiler->layers() ) {
+        const RenderProfiler::Statistics statistics = profiler->layerStatistics( layer );
+        QVERIFY( statistics.frames > 0 );
+        QVERIFY( statistics.maximum <= frames.maximum );
+    }
+
+    const QJsonDocument trace = QJsonDocument::fromJson( profiler->toChromeTrace() );
+    const QJsonArray events = trace.object().value( "traceEvents" ).toArray();
+    QVERIFY( !events.isEmpty() );
+    QCOMPARE( events.first().toObject().value( "name" ).toString(), QString( "Frame" ) );
+    QCOMPARE( events.first().toObject().value( "ph" ).toString(), QString( "X" ) );
+
+    profiler->clear();
+    QCOMPARE( profiler->frameCount(), 0 );
+    QCOMPARE( profiler->frameStatistics().frames, 0 );
+
+    QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
+}
+
 }
 
 QTEST_MAIN( Marble::MarbleMapTest )
@@ -0,0 +1,199 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "MarbleDirs.h"
+#include "ParsingRunnerManager.h"
+#include "PluginManager.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "osm/OsmPlacemarkData.h"
+#include "TestUtils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryFile>
+
+namespace Marble
+{
+
+class OsmParserTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void wayNodes();
+    void benchmarkParse_data();
+    void benchmarkParse();
+    void benchmarkPeakMemory_data();
+    void benchmarkPeakMemory();
+
+private:
+    /** Peak resident set size of this process in kB, or -1 if unknown */
+    static qint64 peakMemoryUsage();
+
+    /** Starts measuring peakMemoryUsage() from the current resident set size */
+    static void resetPeakMemoryUsage();
+
+    PluginManager m_pluginManager;
+};
+
+void OsmParserTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+}
+
+qint64 OsmParserTest::peakMemoryUsage()
+{
+    QFile status( "/proc/self/status" );
+    if ( !status.open( QFile::ReadOnly ) ) {
+        return -1;
+    }
+
+    for ( QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine() ) {
+        if ( line.startsWith( "VmHWM:" ) ) {
+            return line.mid( 6 ).trimmed().split( ' ' ).first().toLongLong();
+        }
+    }
+    return -1;
+}
+
+void OsmParserTest::resetPeakMemoryUsage()
+{
+    // supported since Linux 4.0, older kernels keep the peak of the whole process
+    QFile clearRefs( "/proc/self/clear_refs" );
+    if ( clearRefs.open( QFile::WriteOnly ) ) {
+        clearRefs.write( "5" );
+    }
+}
+
+void OsmParserTest::wayNodes()
+{
+    // Plain, tagged, versioned and edited nodes must all resolve as way vertices
+    QTemporaryFile file( QDir::tempPath() + "/osmparsertest-XXXXXX.osm" );
+    QVERIFY( file.open() );
+    file.write( "<?xml version='1.0' encoding='UTF-8'?>\n"
+                "<osm version='0.6'>\n"
+                " <node id='3' lat='52.5' lon='13.3'/>\n"
+                " <node id='1' lat='52.5' lon='13.4'/>\n"
+                " <node id='2' lat='52.6' lon='13.4' version='2' changeset='157450' user='osm'"
+                " uid='42' visible='true' timestamp='2006-11-24T21:52:53Z'/>\n"
+                " <node id='4' lat='52.6' lon='13.5' version='3'>\n"
+                "  <tag k='amenity' v='restaurant'/>\n"
+                " </node>\n"
+                " <node id='5' lat='52.7' lon='13.5' version='1' action='modify'/>\n"
+                " <way id='10'>\n"
+                "  <nd ref='3'/>\n"
+                "  <nd ref='1'/>\n"
+                "  <nd ref='2'/>\n"
+                "  <nd ref='4'/>\n"
+                "  <nd ref='5'/>\n"
+                "  <tag k='highway' v='residential'/>\n"
+                " </way>\n"
+                "</osm>\n" );
+    file.close();
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    QScopedPointer<GeoDataDocument> document( runnerManager.openFile( file.fileName() ) );
+    QVERIFY( document );
+
+    GeoDataPlacemark *way = nullptr;
+    GeoDataPlacemark *restaurant = nullptr;
+    for ( GeoDataPlacemark *placemark: document->placemarkList() ) {
+        if ( placemark->osmData().id() == 10 ) {
+            way = placemark;
+        } else if ( placemark->osmData().id() == 4 ) {
+            restaurant = placemark;
+        }
+    }
+    QVERIFY( way );
+    QVERIFY( restaurant );
+    QCOMPARE( document->placemarkList().size(), 2 );
+
+    const GeoDataLineString *lineString = dynamic_cast<const GeoDataLineString*>( way->geometry() );
+    QVERIFY( lineString );
+    QCOMPARE( lineString->size(), 5 );
+    QFUZZYCOMPARE( lineString->at( 0 ).longitude( GeoDataCoordinates::Degree ), 13.3, 1e-7 );
+    QFUZZYCOMPARE( lineString->at( 1 ).latitude( GeoDataCoordinates::Degree ), 52.5, 1e-7 );
+
+    QList<qint64> expectedIds = QList<qint64>() << 3 << 1 << 2 << 4 << 5;
+    for ( int i = 0; i < lineString->size(); ++i ) {
+        OsmPlacemarkData const node = way->osmData().nodeReference( lineString->at( i ) );
+        QCOMPARE( node.id(), expectedIds[i] );
+    }
+
+    // Metadata has to survive the compact storage unchanged for writing the file back
+    OsmPlacemarkData const plain = way->osmData().nodeReference( lineString->at( 1 ) );
+    QVERIFY( plain.version().isEmpty() );
+    QVERIFY( plain.timestamp().isEmpty() );
+    OsmPlacemarkData const versioned = way->osmData().nodeReference( lineString->at( 2 ) );
+    QCOMPARE( versioned.version(), QString( "2" ) );
+    QCOMPARE( versioned.changeset(), QString( "157450" ) );
+    QCOMPARE( versioned.user(), QString( "osm" ) );
+    QCOMPARE( versioned.uid(), QString( "42" ) );
+    QCOMPARE( versioned.isVisible(), QString( "true" ) );
+    QCOMPARE( versioned.timestamp(), QString( "2006-11-24T21:52:53Z" ) );
+    OsmPlacemarkData const tagged = way->osmData().nodeReference( lineString->at( 3 ) );
+    QCOMPARE( tagged.tagValue( "amenity" ), QString( "restaurant" ) );
+    QCOMPARE( tagged.version(), QString( "3" ) );
+    QCOMPARE( way->osmData().nodeReference( lineString->at( 4 ) ).action(), QString( "modify" ) );
+}
+
+void OsmParserTest::benchmarkParse_data()
+{
+    QTest::addColumn<QString>( "fileName" );
+
+    addRow() << QString( MARBLE_SRC_DIR ).append( "/data/maps/earth/vectorosm/0/0/0.o5m" );
+    addRow() << QString( MARBLE_SRC_DIR ).append( "/examples/osm/map.osm" );
+}
+
+void OsmParserTest::benchmarkParse()
+{
+    QFETCH( QString, fileName );
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    QBENCHMARK {
+        QScopedPointer<GeoDataDocument> document( runnerManager.openFile( fileName ) );
+        QVERIFY( document );
+        QVERIFY( !document->placemarkList().isEmpty() );
+    }
+}
+
+void OsmParserTest::benchmarkPeakMemory_data()
+{
+    benchmarkParse_data();
+}
+
+void OsmParserTest::benchmarkPeakMemory()
+{
+    QFETCH( QString, fileName );
+
+    ParsingRunnerManager runnerManager( &m_pluginManager );
+    resetPeakMemoryUsage();
+    {
+        QScopedPointer<GeoDataDocument> document( runnerManager.openFile( fileName ) );
+        QVERIFY( document );
+        QVERIFY( !document->placemarkList().isEmpty() );
+    }
+
+    qint64 const peak = peakMemoryUsage();
+    if ( peak < 0 ) {
+        QSKIP( "The peak resident set size is only known on Linux" );
+    }
+
+    // reported as the benchmark result in bytes
+    QTest::setBenchmarkResult( peak * 1024, QTest::BytesAllocated );
+}
+
+}
+
+QTEST_MAIN( Marble::OsmParserTest )
+
+#include "OsmParserTest.moc"
@@ -0,0 +1,146 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QPolygonF>
+#include <QTest>
+
+#include "GeoDataLineString.h"
+#include "ProjectedGeometryCache.h"
+#include "ViewportParams.h"
+
+Q_DECLARE_METATYPE( Marble::Projection )
+
+namespace Marble
+{
+
+class ProjectedGeometryCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void pan_data();
+    void pan();
+    void zoom();
+    void changeLineString();
+
+private:
+    static GeoDataLineString lineString();
+    static void compare( const QVector<QPolygonF *> &actual, const GeoDataLineString &lineString,
+                         const ViewportParams &viewport );
+};
+
+GeoDataLineString ProjectedGeometryCacheTest::lineString()
+{
+    GeoDataLineString result;
+    result << GeoDataCoordinates( 9.0, 48.7, 0, GeoDataCoordinates::Degree )
+           << GeoDataCoordinates( 9.1, 48.8, 0, GeoDataCoordinates::Degree )
+           << GeoDataCoordinates( 9.3, 48.75, 0, GeoDataCoordinates::Degree )
+           << GeoDataCoordinates( 9.2, 48.6, 0, GeoDataCoordinates::Degree );
+    return result;
+}
+
+void ProjectedGeometryCacheTest::compare( const QVector<QPolygonF *> &actual, const GeoDataLineString &lineString,
+                                          const ViewportParams &viewport )
+{
+    QVector<QPolygonF *> expected;
+    viewport.screenCoordinates( lineString, expected );
+
+    QCOMPARE( actual.size(), expected.size() );
+    for ( int i = 0; i < expected.size(); ++i ) {
+        QCOMPARE( actual[i]->size(), expected[i]->size() );
+        for ( int j = 0; j < expected[i]->size(); ++j ) {
+            QVERIFY( qAbs( actual[i]->at( j ).x() - expected[i]->at( j ).x() ) < 1e-6 );
+            QVERIFY( qAbs( actual[i]->at( j ).y() - expected[i]->at( j ).y() ) < 1e-6 );
+        }
+    }
+
+    qDeleteAll( expected );
+}
+
+void ProjectedGeometryCacheTest::pan_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+    QTest::addColumn<int>( "radius" );
+
+    // the first two are moved, the others are projected again
+    QTest::newRow( "equirectangular" ) << Equirectangular << 20000;
+    QTest::newRow( "mercator" ) << Mercator << 20000;
+    QTest::newRow( "repeated" ) << Equirectangular << 50;
+    QTest::newRow( "spherical" ) << Spherical << 20000;
+    QTest::newRow( "azimuthal" ) << LambertAzimuthal << 20000;
+}
+
+void ProjectedGeometryCacheTest::pan()
+{
+    QFETCH( Projection, projection );
+    QFETCH( int, radius );
+
+    const GeoDataLineString line = lineString();
+    ViewportParams viewport( projection, 9.15 * DEG2RAD, 48.7 * DEG2RAD, radius, QSize( 800, 600 ) );
+
+    ProjectedGeometryCache cache;
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+
+    viewport.centerOn( 9.17 * DEG2RAD, 48.72 * DEG2RAD );
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+
+    viewport.centerOn( 9.1 * DEG2RAD, 48.65 * DEG2RAD );
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+}
+
+void ProjectedGeometryCacheTest::zoom()
+{
+    const GeoDataLineString line = lineString();
+    ViewportParams viewport( Mercator, 9.15 * DEG2RAD, 48.7 * DEG2RAD, 20000, QSize( 800, 600 ) );
+
+    ProjectedGeometryCache cache;
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+
+    viewport.setRadius( 40000 );
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+
+    viewport.setSize( QSize( 1024, 768 ) );
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+}
+
+void ProjectedGeometryCacheTest::changeLineString()
+{
+    GeoDataLineString line = lineString();
+    GeoDataLineString other;
+    other << GeoDataCoordinates( 9.05, 48.65, 0, GeoDataCoordinates::Degree )
+          << GeoDataCoordinates( 9.25, 48.8, 0, GeoDataCoordinates::Degree );
+    ViewportParams viewport( Equirectangular, 9.15 * DEG2RAD, 48.7 * DEG2RAD, 20000, QSize( 800, 600 ) );
+
+    ProjectedGeometryCache cache;
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+    compare( cache.polygons( 1, other ), other, viewport );
+
+    // a different line string at the same index is projected
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, other ), other, viewport );
+
+    // changes of a line string require clearing the cache
+    line << GeoDataCoordinates( 9.4, 48.7, 0, GeoDataCoordinates::Degree );
+    cache.clear();
+    cache.setViewport( &viewport );
+    compare( cache.polygons( 0, line ), line, viewport );
+    QCOMPARE( cache.polygons( 0, line ).first()->size(), line.size() );
+}
+
+}
+
+QTEST_MAIN( Marble::ProjectedGeometryCacheTest )
+
+#include "ProjectedGeometryCacheTest.moc"
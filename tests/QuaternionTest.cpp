@@ -13,6 +13,7 @@
 #include "TestUtils.h"
 
 #include <QMetaType>
+#include <QVector>
 
 Q_DECLARE_METATYPE( Marble::Quaternion )
 
@@ -29,6 +30,15 @@ private Q_SLOTS:
 
     void testSpherical_data();
     void testSpherical();
+
+    void testRotateToSpherical_data();
+    void testRotateToSpherical();
+
+    void benchmarkRotateToSpherical_data();
+    void benchmarkRotateToSpherical();
+
+private:
+    static void sampleHemisphere( int size, QVector<qreal> &x, QVector<qreal> &y, QVector<qreal> &z );
 };
 
 void QuaternionTest::testEuler_data()
@@ -170,6 +180,136 @@ void QuaternionTest::testSpherical()
 
 }
 
+void QuaternionTest::testRotateToSpherical_data()
+{
+    QTest::addColumn<int>( "instructionSet" );
+    QTest::addColumn<qreal>( "lon" );
+    QTest::addColumn<qreal>( "lat" );
+
+    const char *const names[] = { "scalar", "sse2", "avx2" };
+    const qreal axes[][2] = { { 0.0, 0.0 }, { -180.0, 0.0 }, { 90.0, 45.0 },
+                              { 13.4, 52.5 }, { -120.0, -89.0 }, { 0.0, 90.0 } };
+
+    for ( int instructionSet = Quaternion::ScalarInstructions; instructionSet <= Quaternion::Avx2Instructions; ++instructionSet ) {
+        for ( const auto &axis: axes ) {
+            const QString name = QString( "%1 %2 %3" ).arg( names[instructionSet] ).arg( axis[0] ).arg( axis[1] );
+            QTest::newRow( name.toLatin1().constData() ) << instructionSet << axis[0] << axis[1];
+        }
+    }
+}
+
+void QuaternionTest::testRotateToSpherical()
+{
+    QFETCH( int, instructionSet );
+    QFETCH( qreal, lon );
+    QFETCH( qreal, lat );
+
+    if ( instructionSet > Quaternion::batchInstructionSet() ) {
+        QSKIP( "Instruction set not supported by this CPU" );
+    }
+
+    const Quaternion axis = Quaternion::fromSpherical( lon * DEG2RAD, lat * DEG2RAD );
+    matrix axisMatrix;
+    axis.toMatrix( axisMatrix );
+
+    // sample the visible hemisphere, with a count that is not a multiple
+    // of the vector width
+    QVector<qreal> x;
+    QVector<qreal> y;
+    QVector<qreal> z;
+    sampleHemisphere( 37, x, y, z );
+    QVERIFY( x.size() % 4 != 0 );
+
+    QVector<qreal> batchLon( x.size() );
+    QVector<qreal> batchLat( x.size() );
+    Quaternion::rotateToSpherical( Quaternion::BatchInstructionSet( instructionSet ), axisMatrix,
+                                   x.constData(), y.constData(), z.constData(),
+                                   x.size(), batchLon.data(), batchLat.data() );
+
+    // the approximation of atan2() and asin() is accurate to 1e-10 radians,
+    // far below the size of a pixel at the highest zoom level
+    for ( int i = 0; i < x.size(); ++i ) {
+        Quaternion qpos( 0.0, x[i], y[i], z[i] );
+        qpos.rotateAroundAxis( axisMatrix );
+
+        qreal scalarLon, scalarLat;
+        qpos.getSpherical( scalarLon, scalarLat );
+
+        // -pi and +pi are the same longitude
+        qreal lonDifference = qAbs( batchLon[i] - scalarLon );
+        if ( lonDifference > M_PI ) {
+            lonDifference = qAbs( lonDifference - 2 * M_PI );
+        }
+        QVERIFY2( lonDifference < 1e-10, qPrintable( QString::number( lonDifference ) ) );
+        QFUZZYCOMPARE( batchLat[i], scalarLat, 1e-10 );
+    }
+}
+
+void QuaternionTest::benchmarkRotateToSpherical_data()
+{
+    QTest::addColumn<int>( "instructionSet" );
+
+    // -1 is the per-pixel path of the texture mapper
+    QTest::newRow( "quaternion" ) << -1;
+    QTest::newRow( "scalar" ) << int( Quaternion::ScalarInstructions );
+    QTest::newRow( "sse2" ) << int( Quaternion::Sse2Instructions );
+    QTest::newRow( "avx2" ) << int( Quaternion::Avx2Instructions );
+}
+
+void QuaternionTest::benchmarkRotateToSpherical()
+{
+    QFETCH( int, instructionSet );
+
+    if ( instructionSet > Quaternion::batchInstructionSet() ) {
+        QSKIP( "Instruction set not supported by this CPU" );
+    }
+
+    const Quaternion axis = Quaternion::fromSpherical( 13.4 * DEG2RAD, 52.5 * DEG2RAD );
+    matrix axisMatrix;
+    axis.toMatrix( axisMatrix );
+
+    // about as many samples as a globe filling a full-HD screen
+    QVector<qreal> x;
+    QVector<qreal> y;
+    QVector<qreal> z;
+    sampleHemisphere( 1080, x, y, z );
+
+    QVector<qreal> lon( x.size() );
+    QVector<qreal> lat( x.size() );
+
+    if ( instructionSet < 0 ) {
+        QBENCHMARK {
+            for ( int i = 0; i < x.size(); ++i ) {
+                Quaternion qpos( 0.0, x[i], y[i], z[i] );
+                qpos.rotateAroundAxis( axisMatrix );
+                qpos.getSpherical( lon[i], lat[i] );
+            }
+        }
+    } else {
+        QBENCHMARK {
+            Quaternion::rotateToSpherical( Quaternion::BatchInstructionSet( instructionSet ), axisMatrix,
+                                           x.constData(), y.constData(), z.constData(),
+                                           x.size(), lon.data(), lat.data() );
+        }
+    }
+}
+
+void QuaternionTest::sampleHemisphere( int size, QVector<qreal> &x, QVector<qreal> &y, QVector<qreal> &z )
+{
+    for ( int i = 0; i < size; ++i ) {
+        for ( int j = 0; j < size; ++j ) {
+            const qreal qx = 2.0 * i / ( size - 1 ) - 1.0;
+            const qreal qy = 2.0 * j / ( size - 1 ) - 1.0;
+            const qreal qr2z = 1.0 - qx * qx - qy * qy;
+            if ( qr2z >= 0.0 ) {
+                x << qx;
+                y << qy;
+                z << sqrt( qr2z );
+            }
+        }
+    }
+}
+
 QTEST_MAIN( Marble::QuaternionTest )
 
 #include "QuaternionTest.moc"
@@ -0,0 +1,148 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QTest>
+
+#include "routing/Route.h"
+#include "MarbleGlobal.h"
+
+#include <qmath.h>
+
+namespace Marble
+{
+
+class RouteTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void closestSegment_data();
+    void closestSegment();
+    void segmentLinks();
+    void benchmarkUpdatePosition();
+
+private:
+    static GeoDataCoordinates routePosition( qreal t );
+    static qreal bruteForceDistance( const Route &route, const GeoDataCoordinates &position );
+
+    Route m_route;
+    QVector<GeoDataCoordinates> m_track;
+};
+
+/**
+ * A long winding route crossing the date line, parametrized by t in [0, 1]
+ */
+GeoDataCoordinates RouteTest::routePosition( qreal t )
+{
+    qreal const lon = 170.0 + 30.0 * t;
+    qreal const lat = 40.0 + 5.0 * qSin( 40.0 * M_PI * t ) + 3.0 * t;
+    return GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+}
+
+qreal RouteTest::bruteForceDistance( const Route &route, const GeoDataCoordinates &position )
+{
+    qreal result = -1.0;
+    GeoDataCoordinates closest, interpolated;
+    for ( int i = 0; i < route.size(); ++i ) {
+        qreal const distance = route.at( i ).distanceTo( position, closest, interpolated );
+        if ( result < 0.0 || distance < result ) {
+            result = distance;
+        }
+    }
+    return result;
+}
+
+void RouteTest::initTestCase()
+{
+    // 5000 segments of 8 points each, similar to a long truck route
+    int const segments = 5000;
+    int const pointsPerSegment = 8;
+    int const points = segments * ( pointsPerSegment - 1 );
+    for ( int i = 0; i < segments; ++i ) {
+        GeoDataLineString path;
+        for ( int j = 0; j < pointsPerSegment; ++j ) {
+            path << routePosition( qreal( i * ( pointsPerSegment - 1 ) + j ) / points );
+        }
+        RouteSegment segment;
+        segment.setPath( path );
+        m_route.addRouteSegment( segment );
+    }
+
+    // A GPS track following the route with some noise at 10 Hz
+    qsrand( 42 );
+    int const fixes = 2000;
+    for ( int i = 0; i < fixes; ++i ) {
+        GeoDataCoordinates position = routePosition( qreal( i ) / fixes );
+        qreal const noise = ( qrand() % 200 - 100 ) * 0.00001;
+        position.setLatitude( position.latitude() + noise );
+        position.setLongitude( GeoDataCoordinates::normalizeLon( position.longitude() - noise ) );
+        m_track << position;
+    }
+}
+
+void RouteTest::closestSegment_data()
+{
+    QTest::addColumn<qreal>( "lon" );
+    QTest::addColumn<qreal>( "lat" );
+
+    QTest::newRow( "on route" ) << routePosition( 0.3 ).longitude( GeoDataCoordinates::Degree )
+                                << routePosition( 0.3 ).latitude( GeoDataCoordinates::Degree );
+    QTest::newRow( "route start" ) << 169.0 << 40.0;
+    QTest::newRow( "route end" ) << -159.0 << 44.0;
+    QTest::newRow( "date line" ) << 180.0 << 42.0;
+    QTest::newRow( "between bends" ) << 175.0 << 41.0;
+    QTest::newRow( "far away" ) << 10.0 << -20.0;
+    QTest::newRow( "north pole" ) << 0.0 << 90.0;
+}
+
+void RouteTest::closestSegment()
+{
+    QFETCH( qreal, lon );
+    QFETCH( qreal, lat );
+
+    GeoDataCoordinates const position( lon, lat, 0.0, GeoDataCoordinates::Degree );
+    qreal const expected = bruteForceDistance( m_route, position );
+
+    // Start the search from different segments, the result must not depend on it
+    for ( int start = 0; start < m_route.size(); start += 997 ) {
+        Route route = m_route;
+        route.setPosition( m_route.at( start ).path().at( 3 ) );
+        QCOMPARE( route.currentSegment(), m_route.at( start ) );
+
+        route.setPosition( position );
+        GeoDataCoordinates closest, interpolated;
+        qreal const distance = route.currentSegment().distanceTo( position, closest, interpolated );
+        QCOMPARE( distance, expected );
+    }
+}
+
+void RouteTest::segmentLinks()
+{
+    for ( int i = 1; i < m_route.size(); ++i ) {
+        QVERIFY( &m_route.at( i - 1 ).nextRouteSegment() == &m_route.at( i ) );
+    }
+    QVERIFY( !m_route.at( m_route.size() - 1 ).nextRouteSegment().isValid() );
+}
+
+void RouteTest::benchmarkUpdatePosition()
+{
+    Route route = m_route;
+    QBENCHMARK {
+        for ( const GeoDataCoordinates &position: m_track ) {
+            route.setPosition( position );
+            route.positionOnRoute();
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::RouteTest )
+
+#include "RouteTest.moc"
@@ -12,6 +12,7 @@
 #include "MarbleGlobal.h"
 #include "MarbleWidget.h"
 #include "GeoDataCoordinates.h"
+#include "Quaternion.h"
 #include "TestUtils.h"
 
 #include <QLocale>
@@ -38,6 +39,7 @@ private Q_SLOTS:
     void testSetLatitude_Radian();
     void testAltitude();
     void testOperatorAssignment();
+    void testQuaternion();
     void testDetail();
     void testIsPole_data();
     void testIsPole();
@@ -325,6 +327,37 @@ void TestGeoDataCoordinates::testOperatorAssignment()
     QCOMPARE(coordinates4, coordinates2);
 }
 
+/*
+ * test that the quaternion follows modifications of copies
+ */
+void TestGeoDataCoordinates::testQuaternion()
+{
+    // longitude, latitude, altitude, detail and validity, without a cache
+    QVERIFY(sizeof(GeoDataCoordinates) <= 4 * sizeof(qreal));
+
+    GeoDataCoordinates coordinates1(12.5, 34.5, 0, GeoDataCoordinates::Degree);
+    const Quaternion quat1 = coordinates1.quaternion();
+
+    GeoDataCoordinates coordinates2(coordinates1);
+    QCOMPARE(coordinates2.quaternion().v[Q_X], quat1.v[Q_X]);
+
+    coordinates2.setLongitude(-56.5, GeoDataCoordinates::Degree);
+    const Quaternion quat2 = Quaternion::fromSpherical(coordinates2.longitude(), coordinates2.latitude());
+    QCOMPARE(coordinates2.quaternion().v[Q_X], quat2.v[Q_X]);
+    QCOMPARE(coordinates2.quaternion().v[Q_Y], quat2.v[Q_Y]);
+    QCOMPARE(coordinates1.quaternion().v[Q_X], quat1.v[Q_X]); // stays unmodified
+
+    coordinates1 = coordinates2;
+    QCOMPARE(coordinates1.quaternion().v[Q_Y], quat2.v[Q_Y]);
+
+    GeoDataCoordinates::Vector vector;
+    for (int i = 0; i < 100; ++i) {
+        vector.append(GeoDataCoordinates(i, i * 0.5, i, GeoDataCoordinates::Degree));
+    }
+    const Quaternion quat3 = Quaternion::fromSpherical(50 * DEG2RAD, 25 * DEG2RAD);
+    QCOMPARE(vector.at(50).quaternion().v[Q_Z], quat3.v[Q_Z]);
+}
+
 /*
  * test setDetail() and detail()
  */
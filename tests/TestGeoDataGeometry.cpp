@@ -13,6 +13,8 @@
 
 #include <QObject>
 #include <QTest>
+#include <QThreadPool>
+#include <QtMath>
 
 using namespace Marble;
 
@@ -26,6 +28,9 @@ private Q_SLOTS:
     void deleteAndDetachTest1();
     void deleteAndDetachTest2();
     void deleteAndDetachTest3();
+    void revisionTest();
+    void simplifiedTest();
+    void simplifiedProjectionTest();
 };
 
 void TestGeoDataGeometry::downcastPointTest_data()
@@ -85,6 +90,122 @@ void TestGeoDataGeometry::deleteAndDetachTest3()
     line2 << GeoDataCoordinates();
 }
 
+void TestGeoDataGeometry::revisionTest()
+{
+    GeoDataLinearRing ring;
+    ring << GeoDataCoordinates( 0.0, 0.0 ) << GeoDataCoordinates( 0.1, 0.0 ) << GeoDataCoordinates( 0.1, 0.1 );
+
+    const GeoDataLinearRing &constRing = ring;
+    const int revision = constRing.revision();
+    constRing.at( 0 );
+    constRing.latLonAltBox();
+    QCOMPARE( constRing.revision(), revision );
+
+    // Nodes edited in place
+    ring.last() = GeoDataCoordinates( 0.2, 0.1 );
+    const int editedRevision = constRing.revision();
+    QVERIFY( editedRevision != revision );
+
+    // Copies keep the revision of their nodes only until they are changed
+    GeoDataLinearRing copy = ring;
+    QCOMPARE( copy.revision(), editedRevision );
+    copy << GeoDataCoordinates( 0.0, 0.1 );
+    QVERIFY( copy.revision() != editedRevision );
+    QCOMPARE( constRing.revision(), editedRevision );
+}
+
+void TestGeoDataGeometry::simplifiedTest()
+{
+    // A wavy line around the equator with many more nodes than pixels at world zoom
+    GeoDataLineString line;
+    const int size = 100000;
+    for ( int i = 0; i < size; ++i ) {
+        const qreal lon = -3.0 + 6.0 * i / ( size - 1 );
+        line << GeoDataCoordinates( lon, 0.3 * qSin( 5 * lon ) + 0.001 * qSin( 400 * lon ) );
+    }
+
+    // Non-const access to the nodes would drop the simplification
+    const GeoDataLineString &constLine = line;
+    QCOMPARE( &constLine.simplified( 17 ), &constLine );
+
+    // The simplification is computed in the background
+    QTRY_VERIFY( &constLine.simplified( 1 ) != &constLine );
+    const GeoDataLineString &simplified = constLine.simplified( 1 );
+    QVERIFY( simplified.size() > 2 );
+    QVERIFY( simplified.size() < size / 100 );
+    QCOMPARE( simplified.first(), constLine.first() );
+    QCOMPARE( simplified.last(), constLine.last() );
+    QCOMPARE( &constLine.simplified( 1 ), &simplified );
+
+    // Dropped nodes lie within half the resolution of level 1 of the segment
+    // that replaces them, which allows for twice that difference in latitude
+    // at the slopes of the line
+    const qreal tolerance = 2 * 0.016384;
+    int next = 1;
+    for ( int i = 1; i < size - 1; ++i ) {
+        if ( constLine.at( i ) == simplified.at( next ) ) {
+            ++next;
+            continue;
+        }
+        const GeoDataCoordinates &a = simplified.at( next - 1 );
+        const GeoDataCoordinates &b = simplified.at( next );
+        const qreal t = ( constLine.at( i ).longitude() - a.longitude() ) / ( b.longitude() - a.longitude() );
+        const qreal latitude = a.latitude() + t * ( b.latitude() - a.latitude() );
+        QVERIFY( qAbs( constLine.at( i ).latitude() - latitude ) < tolerance );
+    }
+    QCOMPARE( next, simplified.size() - 1 );
+
+    // Changing the line string drops the simplification
+    line << GeoDataCoordinates( 3.1, 0.0 );
+    QCOMPARE( constLine.simplified( 1 ).last(), constLine.last() );
+
+    // Changes during the computation are picked up once it has finished
+    line << GeoDataCoordinates( 3.12, 0.0 );
+    QCOMPARE( &constLine.simplified( 1 ), &constLine );
+    QTRY_VERIFY( &constLine.simplified( 1 ) != &constLine );
+    QCOMPARE( constLine.simplified( 1 ).last(), constLine.last() );
+    QVERIFY( !constLine.isSimplifying() );
+}
+
+void TestGeoDataGeometry::simplifiedProjectionTest()
+{
+    // Nodes along a great circle far from the equator
+    const GeoDataCoordinates start( -1.0, 1.0 );
+    const GeoDataCoordinates end( 1.0, 1.0 );
+    GeoDataLineString greatCircle( Tessellate );
+    GeoDataLineString straight;
+    for ( int i = 0; i < 1000; ++i ) {
+        const GeoDataCoordinates coordinates = start.interpolate( end, i / 999.0 );
+        greatCircle << coordinates;
+        straight << coordinates;
+    }
+
+    // A small wave at a high latitude, which Mercator stretches beyond half the
+    // resolution of level 1
+    GeoDataLineString wave;
+    for ( int i = 0; i < 1000; ++i ) {
+        const qreal lon = -3.0 + 6.0 * i / 999;
+        wave << GeoDataCoordinates( lon, 1.4 + 0.005 * qSin( 400 * lon ) );
+    }
+
+    const GeoDataLineString &constGreatCircle = greatCircle;
+    const GeoDataLineString &constStraight = straight;
+    const GeoDataLineString &constWave = wave;
+    constGreatCircle.simplified( 1 );
+    constStraight.simplified( 1 );
+    constWave.simplified( 1 );
+    QThreadPool::globalInstance()->waitForDone();
+
+    // Tessellated segments follow the great circle, so its end nodes suffice
+    QCOMPARE( constGreatCircle.simplified( 1 ).size(), 2 );
+
+    // Straight segments deviate from it towards the equator
+    QVERIFY( constStraight.simplified( 1 ).size() > 2 );
+
+    // Most nodes of the wave are kept, so it is used as it is
+    QCOMPARE( &constWave.simplified( 1 ), &constWave );
+}
+
 QTEST_MAIN( TestGeoDataGeometry )
 #include "TestGeoDataGeometry.moc"
 
@@ -33,13 +33,29 @@ private Q_SLOTS:
     void initTestCase();
     void defaultConstructor();
     void interpolate();
+    void unsortedTimes();
+    void playback();
+    void batchLookup();
+    void benchmarkPlayback();
     void simpleParseTest();
     void removeBeforeTest();
     void removeAfterTest();
     void extendedDataParseTest();
     void withoutTimeTest();
+
+private:
+    static void fillTrack( GeoDataTrack &track, int size, const QDateTime &start );
 };
 
+void TestGeoDataTrack::fillTrack( GeoDataTrack &track, int size, const QDateTime &start )
+{
+    // one point per second on a line heading north-east
+    for ( int i = 0; i < size; ++i ) {
+        track.appendCoordinates( GeoDataCoordinates( i * 1e-4, i * 0.5e-4, 0, GeoDataCoordinates::Degree ) );
+        track.appendWhen( start.addSecs( i ) );
+    }
+}
+
 void TestGeoDataTrack::initTestCase()
 {
     MarbleDebug::setEnabled( true );
@@ -81,6 +97,119 @@ void TestGeoDataTrack::interpolate()
     QCOMPARE( afterEnd, GeoDataCoordinates() );
 }
 
+void TestGeoDataTrack::unsortedTimes()
+{
+    GeoDataTrack track;
+    track.setInterpolate( true );
+
+    const QDateTime start( QDate( 2014, 8, 16 ), QTime( 8, 0, 0 ), Qt::UTC );
+    const GeoDataCoordinates coordinates1( 10, 50, 0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates coordinates2( 11, 50, 0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates coordinates3( 12, 50, 0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates coordinates4( 13, 50, 0, GeoDataCoordinates::Degree );
+
+    // points with the same time and out of order, like hand-written KML may have
+    track.appendCoordinates( coordinates3 );
+    track.appendWhen( start.addSecs( 20 ) );
+    track.appendCoordinates( coordinates1 );
+    track.appendWhen( start );
+    track.appendCoordinates( coordinates2 );
+    track.appendWhen( start.addSecs( 10 ) );
+    track.appendCoordinates( coordinates4 );
+    track.appendWhen( start.addSecs( 10 ) );
+
+    // exact matches return the first point with that time
+    QCOMPARE( track.coordinatesAt( start ), coordinates1 );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 10 ) ), coordinates2 );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 20 ) ), coordinates3 );
+
+    // interpolation uses the last point with the same time, before and after
+    const GeoDataCoordinates interpolated = track.coordinatesAt( start.addSecs( 15 ) );
+    QCOMPARE( interpolated, coordinates4.interpolate( coordinates3, 0.5 ) );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 5 ) ), coordinates1.interpolate( coordinates4, 0.5 ) );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 25 ) ), GeoDataCoordinates() );
+
+    track.setInterpolate( false );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 15 ) ), GeoDataCoordinates() );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 20 ) ), coordinates3 );
+
+    // changes of the track are taken into account
+    track.addPoint( start.addSecs( 15 ), coordinates1 );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 15 ) ), coordinates1 );
+    track.removeBefore( start.addSecs( 16 ) );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 15 ) ), GeoDataCoordinates() );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 20 ) ), coordinates3 );
+    track.clear();
+    QCOMPARE( track.coordinatesAt( start.addSecs( 20 ) ), GeoDataCoordinates() );
+}
+
+void TestGeoDataTrack::playback()
+{
+    GeoDataTrack track;
+    track.setInterpolate( true );
+    const QDateTime start( QDate( 2014, 8, 16 ), QTime( 0, 0, 0 ), Qt::UTC );
+    fillTrack( track, 1000, start );
+
+    // forward, backward and jumping lookups use the same index
+    QList<int> msecs;
+    for ( int i = 0; i < 3000; ++i ) {
+        msecs << i * 33;
+    }
+    for ( int i = 3000; i > 0; --i ) {
+        msecs << i * 100;
+    }
+    msecs << 998000 << 0 << 500500 << 999000 << 999001 << -1;
+
+    for ( int msec: msecs ) {
+        const GeoDataCoordinates actual = track.coordinatesAt( start.addMSecs( msec ) );
+        GeoDataCoordinates expected;
+        if ( msec >= 0 && msec <= 999000 ) {
+            const int index = msec / 1000;
+            expected = msec % 1000 == 0 ? track.coordinatesAt( index ) :
+                       track.coordinatesAt( index ).interpolate( track.coordinatesAt( index + 1 ), ( msec % 1000 ) / 1000.0 );
+        }
+        QCOMPARE( actual, expected );
+    }
+}
+
+void TestGeoDataTrack::batchLookup()
+{
+    const QDateTime start( QDate( 2014, 8, 16 ), QTime( 0, 0, 0 ), Qt::UTC );
+    GeoDataTrack first;
+    fillTrack( first, 100, start );
+    first.setInterpolate( true );
+    GeoDataTrack second;
+    fillTrack( second, 100, start.addSecs( 50 ) );
+    const GeoDataTrack empty;
+
+    const QVector<const GeoDataTrack *> tracks = QVector<const GeoDataTrack *>() << &first << &second << &empty;
+    for ( int msec = 0; msec < 200000; msec += 2500 ) {
+        const QDateTime when = start.addMSecs( msec );
+        const QVector<GeoDataCoordinates> coordinates = GeoDataTrack::coordinatesAt( tracks, when );
+        QCOMPARE( coordinates.size(), 3 );
+        QCOMPARE( coordinates[0], first.coordinatesAt( when ) );
+        QCOMPARE( coordinates[1], second.coordinatesAt( when ) );
+        QCOMPARE( coordinates[2], GeoDataCoordinates() );
+    }
+}
+
+void TestGeoDataTrack::benchmarkPlayback()
+{
+    // a day of positions every second, replayed at 30 frames per second
+    GeoDataTrack track;
+    track.setInterpolate( true );
+    const QDateTime start( QDate( 2014, 8, 16 ), QTime( 0, 0, 0 ), Qt::UTC );
+    fillTrack( track, 100000, start );
+    QVERIFY( track.coordinatesAt( start.addSecs( 1 ) ).isValid() );
+
+    int frame = 0;
+    QBENCHMARK {
+        for ( int i = 0; i < 1000; ++i, ++frame ) {
+            track.coordinatesAt( start.addMSecs( frame * 33 ) );
+        }
+    }
+}
+
     //"Simple Example" from kmlreference
     QString simpleExampleContent(
 "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
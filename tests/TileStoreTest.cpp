@@ -0,0 +1,270 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QDateTime>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "TileStore.h"
+
+namespace Marble
+{
+
+class TileStoreTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void insertAndReopen();
+    void replaceAndRemove();
+    void interruptedWrite();
+    void leastRecentlyUsedEviction();
+    void accessDuringCompaction();
+    void exclusiveAccess();
+
+private:
+    static QByteArray tileData( int i );
+};
+
+QByteArray TileStoreTest::tileData( int i )
+{
+    return QByteArray( 1000, char( 'a' + i % 26 ) );
+}
+
+void TileStoreTest::insertAndReopen()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QLatin1String( "/tiles.mts" );
+    const QDateTime before = QDateTime::currentDateTime().addSecs( -1 );
+
+    {
+        TileStore store( fileName );
+        QVERIFY( store.isOpen() );
+        QCOMPARE( store.count(), 0 );
+        QVERIFY( !store.contains( "maps/earth/osm/0/0/0.png" ) );
+        QVERIFY( store.data( "maps/earth/osm/0/0/0.png" ).isNull() );
+        QVERIFY( !store.lastModified( "maps/earth/osm/0/0/0.png" ).isValid() );
+
+        for ( int i = 0; i < 100; ++i ) {
+            QVERIFY( store.insert( QString( "maps/earth/osm/7/%1/0.png" ).arg( i ), tileData( i ) ) );
+        }
+        QCOMPARE( store.count(), 100 );
+        QCOMPARE( store.data( "maps/earth/osm/7/42/0.png" ), tileData( 42 ) );
+    }
+
+    TileStore store( fileName );
+    QVERIFY( store.isOpen() );
+    QCOMPARE( store.count(), 100 );
+    for ( int i = 0; i < 100; ++i ) {
+        const QString key = QString( "maps/earth/osm/7/%1/0.png" ).arg( i );
+        QCOMPARE( store.data( key ), tileData( i ) );
+        QVERIFY( store.lastModified( key ) >= before );
+        QVERIFY( store.lastModified( key ) <= QDateTime::currentDateTime() );
+    }
+}
+
+void TileStoreTest::replaceAndRemove()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QLatin1String( "/tiles.mts" );
+
+    {
+        TileStore store( fileName );
+        QVERIFY( store.insert( "a", "old" ) );
+        QVERIFY( store.insert( "b", "kept" ) );
+        QVERIFY( store.insert( "c", "removed" ) );
+        QVERIFY( store.insert( "d", "removed" ) );
+        QVERIFY( store.insert( "e", "removed" ) );
+        QVERIFY( store.insert( "a", "new" ) );
+        store.remove( "c" );
+        QCOMPARE( store.data( "a" ), QByteArray( "new" ) );
+        QVERIFY( !store.contains( "c" ) );
+    }
+
+    {
+        TileStore store( fileName );
+        QCOMPARE( store.count(), 4 );
+        QCOMPARE( store.data( "a" ), QByteArray( "new" ) );
+        QVERIFY( !store.contains( "c" ) );
+
+        const quint64 size = store.size();
+        store.remove( QStringList() << "d" << "e" << "unknown" );
+        QCOMPARE( store.count(), 2 );
+        store.waitForCompaction();
+        QVERIFY( store.size() < size );
+        QCOMPARE( store.count(), 2 );
+    }
+
+    {
+        TileStore store( fileName );
+        QCOMPARE( store.count(), 2 );
+        QCOMPARE( store.data( "a" ), QByteArray( "new" ) );
+        QCOMPARE( store.data( "b" ), QByteArray( "kept" ) );
+
+        store.clear();
+        QCOMPARE( store.count(), 0 );
+        QVERIFY( store.insert( "f", "after clear" ) );
+    }
+
+    TileStore store( fileName );
+    QCOMPARE( store.keys(), QStringList() << "f" );
+}
+
+void TileStoreTest::interruptedWrite()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QLatin1String( "/tiles.mts" );
+    const QString crashedFileName = dir.path() + QLatin1String( "/crashed.mts" );
+
+    {
+        TileStore store( fileName );
+        QVERIFY( store.insert( "first", "written before closing" ) );
+    }
+
+    {
+        TileStore store( fileName );
+        QVERIFY( store.insert( "second", "written before the crash" ) );
+        QVERIFY( store.insert( "third", "interrupted write" ) );
+
+        // take the files as they would be left behind by a crash
+        QVERIFY( QFile::copy( fileName, crashedFileName ) );
+        QVERIFY( QFile::copy( fileName + QLatin1String( ".idx" ), crashedFileName + QLatin1String( ".idx" ) ) );
+    }
+
+    QFile file( crashedFileName );
+    QVERIFY( file.open( QIODevice::ReadWrite ) );
+    QByteArray content = file.readAll();
+    const int position = content.indexOf( "interrupted write" );
+    QVERIFY( position > 0 );
+    content[position] = 'X';
+    QVERIFY( file.seek( 0 ) );
+    QCOMPARE( file.write( content ), qint64( content.size() ) );
+    file.close();
+
+    {
+        TileStore store( crashedFileName );
+        QVERIFY( store.isOpen() );
+        QCOMPARE( store.data( "first" ), QByteArray( "written before closing" ) );
+        QCOMPARE( store.data( "second" ), QByteArray( "written before the crash" ) );
+        QVERIFY( !store.contains( "third" ) );
+        QVERIFY( store.insert( "fourth", "written after the crash" ) );
+    }
+
+    TileStore store( crashedFileName );
+    QCOMPARE( store.count(), 3 );
+    QCOMPARE( store.data( "fourth" ), QByteArray( "written after the crash" ) );
+}
+
+void TileStoreTest::leastRecentlyUsedEviction()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QLatin1String( "/tiles.mts" );
+    const quint64 limit = 20 * 1024;
+
+    {
+        TileStore store( fileName );
+        store.setSizeLimit( limit );
+        QCOMPARE( store.sizeLimit(), limit );
+
+        QVERIFY( store.insert( "tile0", tileData( 0 ) ) );
+        for ( int i = 1; i < 100; ++i ) {
+            QVERIFY( store.insert( QString( "tile%1" ).arg( i ), tileData( i ) ) );
+            // keep the first tile in use
+            QCOMPARE( store.data( "tile0" ), tileData( 0 ) );
+            store.waitForCompaction();
+            QVERIFY( store.size() <= limit );
+        }
+
+        QVERIFY( store.count() < 20 );
+        QVERIFY( store.contains( "tile0" ) );
+        QVERIFY( store.contains( "tile99" ) );
+        QVERIFY( !store.contains( "tile1" ) );
+        QVERIFY( !store.contains( "tile50" ) );
+    }
+
+    // the recency survives reopening the store
+    TileStore store( fileName );
+    const int count = store.count();
+    store.setSizeLimit( limit );
+    for ( int i = 100; i < 103; ++i ) {
+        QVERIFY( store.insert( QString( "tile%1" ).arg( i ), tileData( i ) ) );
+    }
+    store.waitForCompaction();
+    QVERIFY( store.size() <= limit );
+    QVERIFY( store.count() <= count + 3 );
+    QVERIFY( store.contains( "tile0" ) );
+    QVERIFY( store.contains( "tile102" ) );
+}
+
+void TileStoreTest::accessDuringCompaction()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QLatin1String( "/tiles.mts" );
+
+    {
+        TileStore store( fileName );
+        QStringList removed;
+        for ( int i = 0; i < 200; ++i ) {
+            QVERIFY( store.insert( QString( "tile%1" ).arg( i ), tileData( i ) ) );
+            if ( i % 2 ) {
+                removed << QString( "tile%1" ).arg( i );
+            }
+        }
+
+        // the compaction runs in the background while the store is used
+        store.remove( removed );
+        for ( int i = 200; i < 300; ++i ) {
+            QVERIFY( store.insert( QString( "tile%1" ).arg( i ), tileData( i ) ) );
+        }
+        QVERIFY( store.insert( "tile0", "replaced" ) );
+        store.remove( "tile2" );
+        QCOMPARE( store.data( "tile4" ), tileData( 4 ) );
+        QVERIFY( !store.contains( "tile1" ) );
+
+        store.waitForCompaction();
+        QCOMPARE( store.count(), 99 + 100 );
+        QCOMPARE( store.data( "tile0" ), QByteArray( "replaced" ) );
+        QVERIFY( !store.contains( "tile2" ) );
+        QCOMPARE( store.data( "tile250" ), tileData( 250 ) );
+    }
+
+    // neither the removals nor the writes during the compaction are lost
+    TileStore store( fileName );
+    QCOMPARE( store.count(), 99 + 100 );
+    QCOMPARE( store.data( "tile0" ), QByteArray( "replaced" ) );
+    QVERIFY( !store.contains( "tile1" ) );
+    QVERIFY( !store.contains( "tile2" ) );
+    QCOMPARE( store.data( "tile4" ), tileData( 4 ) );
+    QCOMPARE( store.data( "tile299" ), tileData( 299 ) );
+}
+
+void TileStoreTest::exclusiveAccess()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.path() + QLatin1String( "/tiles.mts" );
+
+    TileStore store( fileName );
+    QVERIFY( store.isOpen() );
+    QVERIFY( store.insert( "a", "data" ) );
+
+    TileStore other( fileName );
+    QVERIFY( !other.isOpen() );
+    QVERIFY( !other.contains( "a" ) );
+    QVERIFY( !other.insert( "b", "data" ) );
+
+    QCOMPARE( TileStore::sharedStore( dir.path() + QLatin1String( "/shared.mts" ) ),
+              TileStore::sharedStore( dir.path() + QLatin1String( "/./shared.mts" ) ) );
+}
+
+}
+
+QTEST_MAIN( Marble::TileStoreTest )
+
+#include "TileStoreTest.moc"
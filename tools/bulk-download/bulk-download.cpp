@@ -0,0 +1,159 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "BulkTileDownloader.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoSceneAbstractTileProjection.h"
+#include "GeoSceneDocument.h"
+#include "GeoSceneLayer.h"
+#include "GeoSceneMap.h"
+#include "GeoSceneTileDataset.h"
+#include "MapThemeManager.h"
+#include "MarbleDirs.h"
+#include "TileCoordsPyramid.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QScopedPointer>
+
+#include <iostream>
+
+using namespace Marble;
+
+QString formatDuration(qint64 seconds)
+{
+    if (seconds < 0) {
+        return QStringLiteral("unknown");
+    }
+    return QString("%1:%2:%3").arg(seconds / 3600)
+            .arg((seconds / 60) % 60, 2, 10, QLatin1Char('0'))
+            .arg(seconds % 60, 2, 10, QLatin1Char('0'));
+}
+
+void printProgress(const BulkTileDownloader &downloader)
+{
+    QString const line = QString("\r%1/%2 tiles, %3 downloaded, %4 skipped, %5 failed, %6 kB/s, %7 remaining ")
+            .arg(downloader.processedTiles()).arg(downloader.totalTiles())
+            .arg(downloader.downloadedTiles()).arg(downloader.skippedTiles()).arg(downloader.failedTiles())
+            .arg(downloader.bytesPerSecond() / 1024, 0, 'f', 1)
+            .arg(formatDuration(downloader.estimatedTimeRemaining()));
+    std::cout << line.toStdString() << std::flush;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bulk-download");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Download the tiles of a region of a map theme for offline use. "
+                                     "An interrupted download continues when started again with the same arguments.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("maptheme", "Map theme id, e.g. earth/openstreetmap/openstreetmap.dgml");
+
+    parser.addOptions({
+                          {{"b", "bbox"}, "Download the region <west,south,east,north> in degrees", "bbox", "-180,-90,180,90"},
+                          {{"t", "tilelevels"}, "Download the tile levels <tilelevels>", "tilelevels", "0-5"},
+                          {{"c", "connections"}, "Use up to <connections> connections at a time", "connections", "2"},
+                          {{"j", "journal"}, "Record the progress in <journal>", "journal"},
+                          {{"q", "quiet"}, "No progress report to stdout"},
+                      });
+    parser.process(app);
+
+    QStringList const positionalArguments = parser.positionalArguments();
+    if (positionalArguments.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    QStringList const bbox = parser.value("bbox").split(QLatin1Char(','));
+    QVector<qreal> bounds;
+    for (const QString &value: bbox) {
+        bool ok;
+        bounds << value.toDouble(&ok);
+        if (!ok) {
+            bounds.clear();
+            break;
+        }
+    }
+    if (bounds.size() != 4) {
+        qDebug() << "Cannot parse bounding box. Expecting format 'west,south,east,north', e.g. '5.8,47.2,15.1,55.1'.";
+        return 2;
+    }
+    GeoDataLatLonBox const latLonBox(bounds[3], bounds[1], bounds[2], bounds[0], GeoDataCoordinates::Degree);
+
+    QStringList const tileLevels = parser.value("tilelevels").split(QLatin1Char('-'));
+    bool haveValidRange = tileLevels.size() == 2;
+    int topLevel = 0;
+    int bottomLevel = 0;
+    if (haveValidRange) {
+        bool topOk, bottomOk;
+        topLevel = tileLevels[0].toInt(&topOk);
+        bottomLevel = tileLevels[1].toInt(&bottomOk);
+        haveValidRange = topOk && bottomOk && 0 <= topLevel && topLevel <= bottomLevel && bottomLevel <= 30;
+    }
+    if (!haveValidRange) {
+        qDebug() << "Cannot parse tile level range. Expecting format 'minLevel-maxLevel', e.g. '3-7'.";
+        return 3;
+    }
+
+    QScopedPointer<GeoSceneDocument> mapTheme(MapThemeManager::loadMapTheme(positionalArguments.first()));
+    if (!mapTheme) {
+        qDebug() << "Cannot load map theme" << positionalArguments.first();
+        return 4;
+    }
+
+    QVector<const GeoSceneTileDataset *> datasets;
+    for (const GeoSceneLayer *layer: mapTheme->map()->layers()) {
+        for (const GeoSceneAbstractDataset *dataset: layer->datasets()) {
+            if (auto tileDataset = dynamic_cast<const GeoSceneTileDataset *>(dataset)) {
+                datasets << tileDataset;
+            }
+        }
+    }
+    if (datasets.isEmpty()) {
+        qDebug() << "The map theme" << positionalArguments.first() << "has no tiles to download";
+        return 5;
+    }
+
+    TileCoordsPyramid pyramid(topLevel, bottomLevel);
+    pyramid.setBottomLevelCoords(datasets.first()->tileProjection()->tileIndexes(latLonBox, bottomLevel));
+
+    QString journal = parser.value("journal");
+    if (journal.isEmpty()) {
+        journal = MarbleDirs::localPath() + QLatin1String("/cache/bulk-download.journal");
+    }
+
+    BulkTileDownloader downloader;
+    downloader.setTileDatasets(datasets);
+    downloader.setRegion(QVector<TileCoordsPyramid>() << pyramid);
+    downloader.setMaximumConnections(parser.value("connections").toInt());
+    downloader.setJournalFileName(journal);
+
+    bool const quiet = parser.isSet("quiet");
+    if (!quiet) {
+        QObject::connect(&downloader, &BulkTileDownloader::progressChanged, [&downloader]() {
+            printProgress(downloader);
+        });
+    }
+    QObject::connect(&downloader, &BulkTileDownloader::finished, &app, &QCoreApplication::quit);
+
+    downloader.start();
+    if (downloader.isRunning()) {
+        app.exec();
+    }
+
+    if (!quiet) {
+        printProgress(downloader);
+        std::cout << std::endl;
+    }
+
+    return downloader.failedTiles() > 0 ? 6 : 0;
+}
@@ -9,7 +9,9 @@
 // Copyright 2013      Dennis Nienhüser <nienhueser@kde.org>
 //
 
-// A simple tool to read a .kml file and write it back to a .cache file
+// A simple tool to read a .kml file and write it back to a .cache file.
+// The cache is written in the memory-mappable format of the cache plugin,
+// or with -legacy in the field by field format of earlier Marble versions.
 
 #include <ParsingRunnerManager.h>
 #include <PluginManager.h>
@@ -19,6 +21,7 @@
 #include <GeoDataPlacemark.h>
 #include <GeoDataExtendedData.h>
 #include <GeoDataData.h>
+#include <GeoDataDocumentWriter.h>
 
 #include <QApplication>
 #include <QDebug>
@@ -92,7 +95,7 @@ int main(int argc, char** argv)
     if ( inputIndex > 0 && inputIndex + 1 < argc ) {
         inputFilename = app.arguments().at( inputIndex + 1 );
     } else {
-        qDebug( " Syntax: kml2cache -i sourcefile [-o cache-targetfile]" );
+        qDebug( " Syntax: kml2cache -i sourcefile [-o cache-targetfile] [-legacy]" );
         return 1;
     }
 
@@ -108,5 +111,10 @@ int main(int argc, char** argv)
         return 2;
     }
 
-    saveFile( outputFilename, document );
+    if ( app.arguments().contains( "-legacy" ) ) {
+        saveFile( outputFilename, document );
+    } else if ( !GeoDataDocumentWriter::write( outputFilename, *document, "cache" ) ) {
+        qDebug() << "Could not write" << outputFilename;
+        return 3;
+    }
 }
@@ -0,0 +1,324 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <GeoPainter.h>
+#include <MarbleGlobal.h>
+#include <MarbleMap.h>
+#include <MarbleModel.h>
+#include <RenderProfiler.h>
+#include <RenderState.h>
+#include <layers/TextureLayer.h>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QThreadPool>
+
+#include <cmath>
+
+using namespace Marble;
+
+namespace {
+
+struct ProjectionName
+{
+    const char *name;
+    Projection projection;
+};
+
+const ProjectionName projectionNames[] = {
+    {"spherical", Spherical},
+    {"equirectangular", Equirectangular},
+    {"mercator", Mercator},
+    {"gnomonic", Gnomonic},
+    {"stereographic", Stereographic},
+    {"lambert-azimuthal", LambertAzimuthal},
+    {"azimuthal-equidistant", AzimuthalEquidistant},
+    {"vertical-perspective", VerticalPerspective}
+};
+
+QString statusName(RenderStatus status)
+{
+    switch (status) {
+    case Complete: return QStringLiteral("Complete");
+    case WaitingForUpdate: return QStringLiteral("WaitingForUpdate");
+    case WaitingForData: return QStringLiteral("WaitingForData");
+    case Incomplete: return QStringLiteral("Incomplete");
+    }
+    return QString();
+}
+
+QJsonObject toJson(const RenderProfiler::Statistics &statistics)
+{
+    QJsonObject result;
+    result["frames"] = statistics.frames;
+    result["min_ns"] = double(statistics.minimum);
+    result["p50_ns"] = double(statistics.median);
+    result["p95_ns"] = double(statistics.percentile95);
+    result["p99_ns"] = double(statistics.percentile99);
+    result["max_ns"] = double(statistics.maximum);
+    result["total_ns"] = double(statistics.total);
+    QJsonObject states;
+    states["Complete"] = statistics.complete;
+    states["WaitingForUpdate"] = statistics.waitingForUpdate;
+    states["WaitingForData"] = statistics.waitingForData;
+    states["Incomplete"] = statistics.incomplete;
+    result["status"] = states;
+    return result;
+}
+
+/**
+ * Processes events until all data needed for the current view is there,
+ * e.g. files are parsed and tiles are loaded from disk
+ */
+void settle(MarbleMap &map, GeoPainter &painter, int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        map.paint(painter, QRect());
+        QThreadPool::globalInstance()->waitForDone(50);
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    } while (map.renderStatus() != Complete && timer.elapsed() < timeout);
+}
+
+/**
+ * Sets the camera of frame @p frame out of @p frames along the path @p path
+ */
+void moveCamera(MarbleMap &map, const QString &path, int frame, int frames)
+{
+    qreal const t = frames > 1 ? qreal(frame) / (frames - 1) : 0.0;
+    if (path == QLatin1String("zoom")) {
+        // from the whole globe down to city level at constant speed in log scale
+        qreal const minimum = qMin(map.width(), map.height()) / 4.0;
+        map.centerOn(8.4, 49.0);
+        map.setRadius(qRound(minimum * std::pow(2.0, 12.0 * t)));
+    } else if (path == QLatin1String("pan")) {
+        // a few screen widths east at a regional zoom level
+        map.setRadius(qMin(map.width(), map.height()) * 16);
+        map.centerOn(8.4 + 6.0 * t, 49.0 + std::sin(M_PI * t));
+    } else {
+        // spin the globe once around its axis
+        map.setRadius(qMin(map.width(), map.height()) / 2.5);
+        map.centerOn(-180.0 + 360.0 * t, 30.0);
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    // Rendering does not need a display
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("marble-bench");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QStringList projections;
+    for (const auto &projection: projectionNames) {
+        projections << projection.name;
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders map themes along scripted camera paths without a window "
+                                     "and reports frame timings as JSON.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOptions({
+                          {{"t", "theme"}, "Map theme id to benchmark, can be given multiple times. Defaults to a texture, "
+                           "a vector tile and a KML heavy theme.", "theme"},
+                          {{"p", "projection"}, QString("Projection to benchmark, can be given multiple times: %1 or all.")
+                           .arg(projections.join(", ")), "projection"},
+                          {"path", "Camera path to benchmark, can be given multiple times: zoom, pan or rotate.", "path"},
+                          {"kml", "Additional file to load into the model, can be given multiple times.", "file"},
+                          {{"f", "frames"}, "Number of frames per camera path.", "frames", "60"},
+                          {{"s", "size"}, "Size of the rendered images.", "size", "1024x768"},
+                          {"settle-timeout", "Time in milliseconds to wait for data before each run.", "timeout", "10000"},
+                          {"trace", "Directory to write a Chrome trace file of each run to.", "directory"},
+                          {{"o", "output"}, "Output file for the JSON report instead of stdout.", "output"}
+                      });
+    parser.process(app);
+
+    QStringList themes = parser.values("theme");
+    if (themes.isEmpty()) {
+        // behaim1492 loads its annotations from KML files, all of them are installed locally
+        themes << "earth/bluemarble/bluemarble.dgml"
+               << "earth/vectorosm/vectorosm.dgml"
+               << "earth/behaim1492/behaim1492.dgml";
+    }
+
+    QVector<ProjectionName> runProjections;
+    QStringList projectionValues = parser.values("projection");
+    if (projectionValues.isEmpty()) {
+        projectionValues << "spherical" << "equirectangular" << "mercator";
+    } else if (projectionValues.contains("all")) {
+        projectionValues = projections;
+    }
+    for (const QString &value: projectionValues) {
+        int const index = projections.indexOf(value);
+        if (index < 0) {
+            qWarning() << "Unknown projection" << value;
+            parser.showHelp(1);
+        }
+        runProjections << projectionNames[index];
+    }
+
+    QStringList paths = parser.values("path");
+    if (paths.isEmpty()) {
+        paths << "zoom" << "pan" << "rotate";
+    }
+    for (const QString &path: paths) {
+        if (path != QLatin1String("zoom") && path != QLatin1String("pan") && path != QLatin1String("rotate")) {
+            qWarning() << "Unknown camera path" << path;
+            parser.showHelp(1);
+        }
+    }
+
+    int const frames = qMax(1, parser.value("frames").toInt());
+    QStringList const size = parser.value("size").split('x');
+    if (size.size() != 2 || size[0].toInt() <= 0 || size[1].toInt() <= 0) {
+        qWarning() << "Invalid size" << parser.value("size");
+        parser.showHelp(1);
+    }
+    QSize const imageSize(size[0].toInt(), size[1].toInt());
+    int const settleTimeout = parser.value("settle-timeout").toInt();
+
+    // Only local data, downloads would make the results depend on the network
+    MarbleModel model;
+    model.setWorkOffline(true);
+    for (const QString &file: parser.values("kml")) {
+        model.addGeoDataFile(file);
+    }
+
+    QJsonArray runs;
+    for (const QString &theme: themes) {
+        MarbleMap map(&model);
+        map.setMapThemeId(theme);
+        if (map.mapThemeId() != theme) {
+            qWarning() << "Cannot load map theme" << theme;
+            return 2;
+        }
+        map.setSize(imageSize);
+        map.setViewContext(Still);
+
+        QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+        RenderProfiler *const profiler = map.renderProfiler();
+        profiler->setHistorySize(frames);
+
+        for (const ProjectionName &projection: runProjections) {
+            map.setProjection(projection.projection);
+            QString const projectionName = projection.name;
+
+            for (const QString &path: paths) {
+                image.fill(Qt::transparent);
+                GeoPainter painter(&image, map.viewport(), map.mapQuality());
+
+                moveCamera(map, path, 0, frames);
+                settle(map, painter, settleTimeout);
+
+                profiler->clear();
+                profiler->setEnabled(true);
+                if (map.textureLayer()) {
+                    map.textureLayer()->resetTileCacheStatistics();
+                }
+
+                QJsonArray frameTimes;
+                QElapsedTimer timer;
+                for (int i = 0; i < frames; ++i) {
+                    moveCamera(map, path, i, frames);
+                    timer.start();
+                    map.paint(painter, QRect());
+                    qint64 const duration = timer.nsecsElapsed();
+                    QJsonObject frame;
+                    frame["duration_ns"] = double(duration);
+                    frame["status"] = statusName(map.renderStatus());
+                    frameTimes.append(frame);
+                    // deliver asynchronously loaded data like an event loop between frames would
+                    QCoreApplication::processEvents();
+                }
+                profiler->setEnabled(false);
+
+                QJsonObject run;
+                run["theme"] = theme;
+                run["projection"] = projectionName;
+                run["path"] = path;
+                run["frames"] = frameTimes;
+                run["frame_statistics"] = toJson(profiler->frameStatistics());
+
+                QJsonObject layers;
+                for (const QString &layer: profiler->layers()) {
+                    layers[layer] = toJson(profiler->layerStatistics(layer));
+                }
+                run["layers"] = layers;
+
+                QJsonObject renderPositions;
+                for (const QString &renderPosition: profiler->renderPositions()) {
+                    renderPositions[renderPosition] = toJson(profiler->renderPositionStatistics(renderPosition));
+                }
+                run["render_positions"] = renderPositions;
+
+                if (map.textureLayer()) {
+                    // Only the in-memory cache of stacked tiles, loads may still be served from
+                    // the tile store or the persistent cache without touching the network
+                    int const hits = map.textureLayer()->tileCacheHits();
+                    int const loads = map.textureLayer()->tileCacheMisses();
+                    QJsonObject tileCache;
+                    tileCache["hits"] = hits;
+                    tileCache["loads"] = loads;
+                    tileCache["hit_rate"] = hits + loads > 0 ? qreal(hits) / (hits + loads) : 1.0;
+                    run["volatile_tile_cache"] = tileCache;
+                }
+
+                if (parser.isSet("trace")) {
+                    QString const traceFile = QString("%1/%2-%3-%4.json").arg(parser.value("trace"))
+                            .arg(QString(theme).replace('/', '-').remove(".dgml")).arg(projectionName).arg(path);
+                    if (!profiler->writeChromeTrace(traceFile)) {
+                        qWarning() << "Cannot write trace file" << traceFile;
+                    }
+                }
+
+                runs.append(run);
+            }
+        }
+
+        QThreadPool::globalInstance()->waitForDone();
+    }
+
+    QJsonObject report;
+    report["marble_version"] = MARBLE_VERSION_STRING;
+    report["width"] = imageSize.width();
+    report["height"] = imageSize.height();
+    report["frames_per_run"] = frames;
+    report["threads"] = QThread::idealThreadCount();
+    report["runs"] = runs;
+    QByteArray const json = QJsonDocument(report).toJson();
+
+    if (parser.isSet("output")) {
+        QFile output(parser.value("output"));
+        if (!output.open(QFile::WriteOnly | QFile::Truncate) || output.write(json) != json.size()) {
+            qWarning() << "Cannot write" << output.fileName();
+            return 3;
+        }
+    } else {
+        QFile output;
+        output.open(stdout, QFile::WriteOnly);
+        output.write(json);
+    }
+
+    return 0;
+}
@@ -129,6 +129,12 @@ void TileDirectory::setInputFile(const QString &filename)
 }
 
 GeoDataDocument* TileDirectory::clip(int zoomLevel, int tileX, int tileY)
+{
+    auto const tileClipper = clipper(zoomLevel, tileX, tileY);
+    return tileClipper ? tileClipper->clipTo(zoomLevel, tileX, tileY) : nullptr;
+}
+
+QSharedPointer<VectorClipper> TileDirectory::clipper(int zoomLevel, int tileX, int tileY)
 {
     QSharedPointer<GeoDataDocument> oldMap = m_landmass;
     load(zoomLevel, tileX, tileY);
@@ -136,10 +142,15 @@ GeoDataDocument* TileDirectory::clip(int zoomLevel, int tileX, int tileY)
         setTagZoomLevel(zoomLevel);
         GeoDataDocument* input = m_tagsFilter ? m_tagsFilter->accepted() : m_landmass.data();
         if (input) {
-            m_clipper = QSharedPointer<VectorClipper>(new VectorClipper(input, m_maxZoomLevel));
+            // The clipper refers to the input placemarks. Keep them alive as long as the
+            // clipper, which may still be used by tile jobs after the next tile got loaded
+            auto const landmass = m_landmass;
+            auto const tagsFilter = m_tagsFilter;
+            m_clipper = QSharedPointer<VectorClipper>(new VectorClipper(input, m_maxZoomLevel),
+                                                      [landmass, tagsFilter](VectorClipper *clipper) { delete clipper; });
         }
     }
-    return m_clipper ? m_clipper->clipTo(zoomLevel, tileX, tileY) : nullptr;
+    return m_clipper;
 }
 
 QString TileDirectory::name() const
@@ -63,6 +63,13 @@ public:
 
     TileId tileFor(int zoomLevel, int tileX, int tileY) const;
     GeoDataDocument *clip(int zoomLevel, int tileX, int tileY);
+
+    /**
+     * Loads the input tile covering the given tile and returns a clipper for it.
+     * The clipper can be used from other threads, as long as it is not shared
+     * with later calls of clip() or clipper().
+     */
+    QSharedPointer<VectorClipper> clipper(int zoomLevel, int tileX, int tileY);
     QString name() const;
 
     static QSharedPointer<GeoDataDocument> open(const QString &filename, ParsingRunnerManager &manager);
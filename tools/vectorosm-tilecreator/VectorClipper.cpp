@@ -65,7 +65,7 @@ GeoDataDocument *VectorClipper::clipTo(const GeoDataLatLonBox &tileBoundary, int
     ring << GeoDataCoordinates(tileBoundary.east(), tileBoundary.north());
     ring << GeoDataCoordinates(tileBoundary.east(), tileBoundary.south());
     ring << GeoDataCoordinates(tileBoundary.west(), tileBoundary.south());
-    qreal const minArea = filterSmallAreas ? 0.01 * area(ring) : 0.0;
+    qreal const minArea = filterSmallAreas ? 0.01 * ringArea(ring) : 0.0;
     QSet<qint64> osmIds;
     for (GeoDataPlacemark const * placemark: potentialIntersections(tileBoundary)) {
         GeoDataGeometry const * const geometry = placemark ? placemark->geometry() : nullptr;
@@ -188,10 +188,22 @@ bool VectorClipper::canBeArea(GeoDataPlacemark::GeoDataVisualCategory visualCate
 
 qreal VectorClipper::area(const GeoDataLinearRing &ring)
 {
-    auto const iter = m_areas.find(&ring);
-    if (iter != m_areas.end()) {
-        return *iter;
+    {
+        QMutexLocker locker(&m_areasMutex);
+        auto const iter = m_areas.constFind(&ring);
+        if (iter != m_areas.constEnd()) {
+            return *iter;
+        }
     }
+
+    qreal const result = ringArea(ring);
+    QMutexLocker locker(&m_areasMutex);
+    m_areas.insert(&ring, result);
+    return result;
+}
+
+qreal VectorClipper::ringArea(const GeoDataLinearRing &ring)
+{
     int const n = ring.size();
     qreal area = 0;
     if (n<3) {
@@ -201,9 +213,7 @@ qreal VectorClipper::area(const GeoDataLinearRing &ring)
         area += (ring[i].longitude() - ring[i-1].longitude() ) * ( ring[i].latitude() + ring[i-1].latitude());
     }
     area += (ring[0].longitude() - ring[n-1].longitude() ) * (ring[0].latitude() + ring[n-1].latitude());
-    qreal const result = EARTH_RADIUS * EARTH_RADIUS * qAbs(area * 0.5);
-    m_areas.insert(&ring, result);
-    return result;
+    return EARTH_RADIUS * EARTH_RADIUS * qAbs(area * 0.5);
 }
 
 void VectorClipper::getBounds(const ClipperLib::Path &path, ClipperLib::cInt &minX, ClipperLib::cInt &maxX, ClipperLib::cInt &minY, ClipperLib::cInt &maxY) const
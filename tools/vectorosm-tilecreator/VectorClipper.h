@@ -26,6 +26,7 @@
 
 #include "clipper/clipper.hpp"
 #include <QMap>
+#include <QMutex>
 #include <QSet>
 
 namespace Marble {
@@ -33,6 +34,10 @@ namespace Marble {
 class GeoDataLinearRing;
 class GeoDataRelation;
 
+/**
+ * Clips the placemarks of a document to tiles. The document is not modified,
+ * so clipTo() can be called for different tiles from several threads at once.
+ */
 class VectorClipper
 {
 public:
@@ -46,6 +51,7 @@ private:
     QVector<GeoDataPlacemark*> potentialIntersections(const GeoDataLatLonBox &box) const;
     ClipperLib::Path clipPath(const GeoDataLatLonBox &box, int zoomLevel) const;
     qreal area(const GeoDataLinearRing &ring);
+    static qreal ringArea(const GeoDataLinearRing &ring);
     void getBounds(const ClipperLib::Path &path, ClipperLib::cInt &minX, ClipperLib::cInt &maxX, ClipperLib::cInt &minY, ClipperLib::cInt &maxY) const;
 
     template<class T>
@@ -131,6 +137,7 @@ private:
     int m_maxZoomLevel;
     GeoSceneMercatorTileProjection m_tileProjection;
     QHash<const GeoDataLinearRing*, qreal> m_areas;
+    QMutex m_areasMutex;
     QSet<GeoDataRelation*> m_relations;
 };
 
@@ -32,6 +32,10 @@
 
 #include <QMessageLogContext>
 #include <QProcess>
+#include <QQueue>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 
 #include "VectorClipper.h"
 #include "NodeReducer.h"
@@ -120,6 +124,150 @@ bool writeTile(GeoDataDocument* tile, const QString &outputFile)
     return true;
 }
 
+/**
+ * Outcome of processing a single tile in a tile job
+ */
+struct TileResult
+{
+    enum Status {
+        Written,   ///< written to disk, or serialized to data for the mbtile writer
+        Pending,   ///< processed, but needs to be merged with boundary tiles before writing
+        Skipped,   ///< empty or sea tile, nothing to write
+        Failed     ///< writing failed
+    };
+
+    Status status = Skipped;
+    qint64 count = 0;
+    TileId tileId;
+    QString filename;
+    QByteArray data;
+    QSharedPointer<GeoDataDocument> landmass;
+    QString message;
+};
+
+using TileFuture = QFuture<TileResult>;
+
+/**
+ * Removes finished tile jobs from the front of @p pending until at most @p maxPending
+ * jobs remain, blocking on the oldest one if needed. Results are handed to @p finish
+ * in the order the jobs were queued, so the progress output and a single writer can
+ * be driven from the calling thread. Returns false if a tile could not be written.
+ */
+template<class FinishFunction>
+bool finishTiles(QQueue<TileFuture> &pending, int maxPending, qint64 total, FinishFunction finish)
+{
+    while (pending.size() > maxPending) {
+        TileResult result = pending.dequeue().result();
+        if (!finish(result)) {
+            return false;
+        }
+        TileDirectory::printProgress(result.count / double(total));
+        std::cout << result.message.toStdString();
+        std::cout << std::string(20, ' ') << '\r';
+        std::cout.flush();
+    }
+    return true;
+}
+
+QString nodeReductionMessage(const NodeReducer &nodeReducer)
+{
+    double const reduction = nodeReducer.removedNodes() / qMax(1.0, double(nodeReducer.remainingNodes() + nodeReducer.removedNodes()));
+    return QString(" Node reduction: %1%").arg(qRound(reduction * 100.0));
+}
+
+/**
+ * Clips, reduces and writes a tile of the low zoom levels covering the whole world.
+ * Thread-safe as long as @p processor is not modified meanwhile.
+ */
+TileResult createWorldTile(VectorClipper *processor, const TileId &tileId, const QString &filename, qint64 count, qint64 total)
+{
+    TileResult result;
+    result.count = count;
+    result.tileId = tileId;
+    result.filename = filename;
+
+    QSharedPointer<GeoDataDocument> tile(processor->clipTo(tileId.zoomLevel(), tileId.x(), tileId.y()));
+    if (!tile->isEmpty()) {
+        NodeReducer nodeReducer(tile.data(), tileId);
+        result.status = writeTile(tile.data(), filename) ? TileResult::Written : TileResult::Failed;
+        result.message = QString(" Tile %1/%2 (%3) done.").arg(count).arg(total).arg(tile->name());
+        result.message += nodeReductionMessage(nodeReducer);
+    } else {
+        result.message = QString(" Skipping empty tile %1/%2 (%3).").arg(count).arg(total).arg(tile->name());
+    }
+    return result;
+}
+
+/**
+ * Clips the map and landmass data of a region tile, reduces, merges and serializes it.
+ * Thread-safe as long as the clippers are not modified meanwhile. Tiles needing to be
+ * merged with boundary tiles are returned with the Pending status instead of being written.
+ */
+TileResult createRegionTile(const QSharedPointer<VectorClipper> &mapClipper, const QSharedPointer<VectorClipper> &landmassClipper,
+                            const TileId &tileId, const QString &filename, qint64 count, qint64 total,
+                            const QString &extension, bool useMbTiles, bool writeBoundary, bool mergeBoundaries,
+                            const QString &region, const QCommandLineParser &parser)
+{
+    TileResult result;
+    result.count = count;
+    result.tileId = tileId;
+    result.filename = filename;
+
+    int const zoomLevel = tileId.zoomLevel();
+    using GeoDocPtr = QSharedPointer<GeoDataDocument>;
+    GeoDocPtr tile2 = GeoDocPtr(landmassClipper->clipTo(zoomLevel, tileId.x(), tileId.y()));
+    if (tile2->isEmpty()) {
+        result.message = QString("  Skipping sea tile %1/%2 (%3).").arg(count).arg(total).arg(tile2->name());
+        return result;
+    }
+
+    GeoDocPtr tile1 = GeoDocPtr(mapClipper->clipTo(zoomLevel, tileId.x(), tileId.y()));
+    TagsFilter::removeAnnotationTags(tile1.data());
+    int originalWays = 0;
+    int mergedWays = 0;
+    if (zoomLevel < 17) {
+        WayConcatenator concatenator(tile1.data());
+        originalWays = concatenator.originalWays();
+        mergedWays = concatenator.mergedWays();
+    }
+    NodeReducer nodeReducer(tile1.data(), tileId);
+    if (tile1->isEmpty()) {
+        result.message = QString("  Skipping empty tile %1/%2 (%3).").arg(count).arg(total).arg(tile1->name());
+        return result;
+    }
+
+    result.message = QString("  Tile %1/%2 (%3).").arg(count).arg(total).arg(tile1->name());
+    result.message += nodeReductionMessage(nodeReducer);
+    if (originalWays > 0) {
+        result.message += QString(" , %1 ways merged to %2").arg(originalWays).arg(mergedWays);
+    }
+
+    if (writeBoundary) {
+        writeBoundaryTile(tile1.data(), region, parser, tileId.x(), tileId.y(), zoomLevel);
+        if (mergeBoundaries) {
+            // merging needs the parsing runners, which are only available in the main thread
+            result.status = TileResult::Pending;
+            result.landmass = tile2;
+            return result;
+        }
+    }
+
+    GeoDocPtr combined = GeoDocPtr(mergeDocuments(tile1.data(), tile2.data()));
+    if (useMbTiles) {
+        QBuffer buffer(&result.data);
+        buffer.open(QBuffer::WriteOnly);
+        if (GeoDataDocumentWriter::write(&buffer, *combined, extension)) {
+            result.status = TileResult::Written;
+        } else {
+            qWarning() << "Could not write the tile " << combined->name();
+            result.data.clear();
+        }
+    } else {
+        result.status = writeTile(combined.data(), filename) ? TileResult::Written : TileResult::Failed;
+    }
+    return result;
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -144,7 +292,8 @@ int main(int argc, char *argv[])
                           {{"d", "development"}, "Use local development vector osm map theme as output storage"},
                           {{"z", "zoom-level"}, "Zoom level according to which OSM information has to be processed.", "levels", "11,13,15,17"},
                           {{"o", "output"}, "Output file or directory", "output", QString("%1/maps/earth/vectorosm").arg(MarbleDirs::localPath())},
-                          {{"e", "extension"}, "Output file type: o5m (default), osm or kml", "file extension", "o5m"}
+                          {{"e", "extension"}, "Output file type: o5m (default), osm or kml", "file extension", "o5m"},
+                          {{"j", "jobs"}, QString("Number of tiles to clip, reduce and serialize concurrently, e.g. %1 for all CPU cores.").arg(QThread::idealThreadCount()), "jobs", "1"}
                       });
 
     // Process the actual command line arguments given by the user
@@ -184,6 +333,14 @@ int main(int argc, char *argv[])
         mbtileWriter->setCommitInterval(500);
     }
 
+    int const jobs = qMax(1, parser.value("jobs").toInt());
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(jobs);
+    // Queue a few more tiles than there are threads to keep them busy while the
+    // finished tiles are written, but not too many to keep the memory bounded
+    int const maxPendingTiles = 2 * jobs;
+    QQueue<TileFuture> pendingTiles;
+
     MarbleModel model;
     ParsingRunnerManager manager(model.pluginManager());
     QString const cacheDirectory = parser.value("cache-directory");
@@ -202,6 +359,9 @@ int main(int argc, char *argv[])
             spellChecker.setVerbose(parser.isSet("verbose"));
             spellChecker.correctPlaceLabels(map.data()->placemarkList());
         }
+        auto const finishWorldTile = [](const TileResult &result) {
+            return result.status != TileResult::Failed;
+        };
         for(auto zoomLevel: zoomLevels) {
             TileIterator iter(world, zoomLevel);
             qint64 count = 0;
@@ -212,23 +372,16 @@ int main(int argc, char *argv[])
                 if (!overwriteTiles && QFileInfo(filename).exists()) {
                     continue;
                 }
-                GeoDataDocument* tile = processor.clipTo(zoomLevel, tileId.x(), tileId.y());
-                if (!tile->isEmpty()) {
-                    NodeReducer nodeReducer(tile, TileId(0, zoomLevel, tileId.x(), tileId.y()));
-                    if (!writeTile(tile, filename)) {
-                        return 4;
-                    }
-                    TileDirectory::printProgress(count / double(total));
-                    std::cout << " Tile " << count << "/" << total << " (" << tile->name().toStdString() << ") done.";
-                    double const reduction = nodeReducer.removedNodes() / qMax(1.0, double(nodeReducer.remainingNodes() + nodeReducer.removedNodes()));
-                    std::cout << " Node reduction: " << qRound(reduction * 100.0) << "%";
-                } else {
-                    TileDirectory::printProgress(count / double(total));
-                    std::cout << " Skipping empty tile " << count << "/" << total << " (" << tile->name().toStdString() << ").";
+                TileId const tile(0, zoomLevel, tileId.x(), tileId.y());
+                pendingTiles.enqueue(QtConcurrent::run(&threadPool, createWorldTile, &processor, tile, filename, count, total));
+                if (!finishTiles(pendingTiles, maxPendingTiles, total, finishWorldTile)) {
+                    threadPool.waitForDone();
+                    return 4;
                 }
-                std::cout << std::string(20, ' ') << '\r';
-                std::cout.flush();
-                delete tile;
+            }
+            if (!finishTiles(pendingTiles, 0, total, finishWorldTile)) {
+                threadPool.waitForDone();
+                return 4;
             }
         }
     } else {
@@ -267,6 +420,30 @@ int main(int argc, char *argv[])
             }
         }
 
+        // Runs in the main thread for each tile in the order the tiles were queued
+        auto const finishRegionTile = [&](TileResult &result) {
+            if (result.status == TileResult::Pending) {
+                auto const tileId = result.tileId;
+                auto const combined = mergeBoundaryTiles(result.landmass, manager, parser, tileId.x(), tileId.y(), tileId.zoomLevel());
+                if (tileId.zoomLevel() > 13 && mbtileWriter) {
+                    QBuffer buffer(&result.data);
+                    buffer.open(QBuffer::WriteOnly);
+                    if (!GeoDataDocumentWriter::write(&buffer, *combined, extension)) {
+                        qWarning() << "Could not write the tile " << combined->name();
+                        result.data.clear();
+                    }
+                } else if (!writeTile(combined.data(), result.filename)) {
+                    return false;
+                }
+            }
+            if (!result.data.isEmpty()) {
+                QBuffer buffer(&result.data);
+                buffer.open(QBuffer::ReadOnly);
+                mbtileWriter->addTile(&buffer, result.tileId.x(), result.tileId.y(), result.tileId.zoomLevel());
+            }
+            return result.status != TileResult::Failed;
+        };
+
         qint64 count = 0;
         for (auto iter = tiles.begin(), end = tiles.end(); iter != end; ++iter) {
             for(auto const &tileId: iter.value()) {
@@ -281,65 +458,28 @@ int main(int argc, char *argv[])
                     }
                 }
 
-                using GeoDocPtr = QSharedPointer<GeoDataDocument>;
-                GeoDocPtr tile2 = GeoDocPtr(loader.clip(zoomLevel, tileId.x(), tileId.y()));
-                if (!tile2->isEmpty()) {
-                    GeoDocPtr tile1 = GeoDocPtr(mapTiles.clip(zoomLevel, tileId.x(), tileId.y()));
-                    TagsFilter::removeAnnotationTags(tile1.data());
-                    int originalWays = 0;
-                    int mergedWays = 0;
-                    if (zoomLevel < 17) {
-                        WayConcatenator concatenator(tile1.data());
-                        originalWays = concatenator.originalWays();
-                        mergedWays = concatenator.mergedWays();
-                    }
-                    NodeReducer nodeReducer(tile1.data(), tileId);
-                    if (!tile1->isEmpty() && !tile2->isEmpty()) {
-                        GeoDocPtr combined = GeoDocPtr(mergeDocuments(tile1.data(), tile2.data()));
-
-                        if (writeBoundaries && boundaryTiles.contains(iter.key())) {
-                            writeBoundaryTile(tile1.data(), region, parser, tileId.x(), tileId.y(), zoomLevel);
-                            if (mergeTiles) {
-                                combined = mergeBoundaryTiles(tile2, manager, parser, tileId.x(), tileId.y(), zoomLevel);
-                            }
-                        }
-
-                        if (zoomLevel > 13 && mbtileWriter) {
-                            QBuffer buffer;
-                            buffer.open(QBuffer::ReadWrite);
-                            if (GeoDataDocumentWriter::write(&buffer, *combined, extension)) {
-                                buffer.seek(0);
-                                mbtileWriter->addTile(&buffer, tileId.x(), tileId.y(), zoomLevel);
-                            } else {
-                                qWarning() << "Could not write the tile " << combined->name();
-                            }
-                        } else {
-                            if (!writeTile(combined.data(), filename)) {
-                                return 4;
-                            }
-                        }
-
-                        TileDirectory::printProgress(count / double(total));
-                        std::cout << "  Tile " << count << "/" << total << " (";
-                        std::cout << combined->name().toStdString() << ").";
-                        double const reduction = nodeReducer.removedNodes() / qMax(1.0, double(nodeReducer.remainingNodes() + nodeReducer.removedNodes()));
-                        std::cout << " Node reduction: " << qRound(reduction * 100.0) << "%";
-                        if (originalWays > 0) {
-                            std::cout << " , " << originalWays << " ways merged to " << mergedWays;
-                        }
-                    } else {
-                        TileDirectory::printProgress(count / double(total));
-                        std::cout << "  Skipping empty tile " << count << "/" << total << " (" << tile1->name().toStdString() << ").";
-                    }
-                } else {
-                    TileDirectory::printProgress(count / double(total));
-                    std::cout << "  Skipping sea tile " << count << "/" << total << " (" << tile2->name().toStdString() << ").";
+                // Loading the input tiles is done here, the clippers are shared with the tile jobs
+                auto const landmassClipper = loader.clipper(zoomLevel, tileId.x(), tileId.y());
+                auto const mapClipper = mapTiles.clipper(zoomLevel, tileId.x(), tileId.y());
+                if (!landmassClipper || !mapClipper) {
+                    continue;
+                }
+                bool const useMbTiles = zoomLevel > 13 && mbtileWriter;
+                bool const writeBoundary = writeBoundaries && boundaryTiles.contains(iter.key());
+                pendingTiles.enqueue(QtConcurrent::run(&threadPool, [=, &parser]() {
+                    return createRegionTile(mapClipper, landmassClipper, tileId, filename, count, total,
+                                            extension, useMbTiles, writeBoundary, mergeTiles, region, parser);
+                }));
+                if (!finishTiles(pendingTiles, maxPendingTiles, total, finishRegionTile)) {
+                    threadPool.waitForDone();
+                    return 4;
                 }
-
-                std::cout << std::string(20, ' ') << '\r';
-                std::cout.flush();
             }
         }
+        if (!finishTiles(pendingTiles, 0, total, finishRegionTile)) {
+            threadPool.waitForDone();
+            return 4;
+        }
         TileDirectory::printProgress(1.0);
         std::cout << "  Vector OSM tiles complete." << std::string(30, ' ') << std::endl;
     }